@@ -0,0 +1,55 @@
+#!/usr/bin/python3
+
+# Compute alignments for one shard of the alignment candidates.
+# Invoke once for each shard, possibly on different machines
+# sharing the assembly directory, then use MergeAlignmentShards.py.
+# The shard is specified as i/N on the command line,
+# or else in the configuration file as Align.shard.
+
+import shasta
+import GetConfig
+import sys
+import ast
+
+# Read the config file.
+config = GetConfig.getConfig()
+
+# Initialize the assembler and access what we need.
+a = shasta.Assembler()
+a.accessKmers()
+a.accessMarkers()
+a.accessAlignmentCandidates()
+
+alignOptions = shasta.AlignOptions()
+alignOptions.alignMethod = int(config['Align']['alignMethod'])
+alignOptions.maxSkip = int(config['Align']['maxSkip'])
+alignOptions.maxDrift = int(config['Align']['maxDrift'])
+alignOptions.maxTrim = int(config['Align']['maxTrim'])
+alignOptions.maxMarkerFrequency = int(config['Align']['maxMarkerFrequency'])
+alignOptions.minAlignedMarkerCount = int(config['Align']['minAlignedMarkerCount'])
+alignOptions.minAlignedFraction = float(config['Align']['minAlignedFraction'])
+alignOptions.matchScore = int(config['Align']['matchScore'])
+alignOptions.mismatchScore = int(config['Align']['mismatchScore'])
+alignOptions.gapScore = int(config['Align']['gapScore'])
+alignOptions.downsamplingFactor = float(config['Align']['downsamplingFactor'])
+alignOptions.bandExtend = int(config['Align']['bandExtend'])
+alignOptions.maxBand = int(config['Align']['maxBand'])
+alignOptions.bandHintExtend = int(config['Align']['bandHintExtend'])
+alignOptions.suppressContainments = ast.literal_eval(config['Align']['suppressContainments'])
+alignOptions.method0DynamicProgramming = ast.literal_eval(config['Align']['method0DynamicProgramming'])
+alignOptions.sameChannelReadAlignmentSuppressDeltaThreshold = \
+    int(config['Align']['sameChannelReadAlignment.suppressDeltaThreshold'])
+alignOptions.align4DeltaX = int(config['Align']['align4.deltaX'])
+alignOptions.align4DeltaY = int(config['Align']['align4.deltaY'])
+alignOptions.align4MinEntryCountPerCell = int(config['Align']['align4.minEntryCountPerCell'])
+alignOptions.align4MaxDistanceFromBoundary = int(config['Align']['align4.maxDistanceFromBoundary'])
+
+alignOptions.shard = config['Align'].get('shard', '')
+if len(sys.argv) == 2:
+    alignOptions.shard = sys.argv[1]
+elif len(sys.argv) != 1:
+    raise Exception('Invoke with one argument, the shard to compute as i/N.')
+
+# Do the computation.
+a.computeAlignmentShard(alignOptions)
+
@@ -28,7 +28,9 @@ alignOptions.gapScore = int(config['Align']['gapScore'])
 alignOptions.downsamplingFactor = float(config['Align']['downsamplingFactor'])
 alignOptions.bandExtend = int(config['Align']['bandExtend'])
 alignOptions.maxBand = int(config['Align']['maxBand'])
+alignOptions.bandHintExtend = int(config['Align']['bandHintExtend'])
 alignOptions.suppressContainments = ast.literal_eval(config['Align']['suppressContainments'])
+alignOptions.method0DynamicProgramming = ast.literal_eval(config['Align']['method0DynamicProgramming'])
 alignOptions.sameChannelReadAlignmentSuppressDeltaThreshold = \
     int(config['Align']['sameChannelReadAlignment.suppressDeltaThreshold'])
 alignOptions.align4DeltaX = int(config['Align']['align4.deltaX'])
@@ -0,0 +1,16 @@
+#!/usr/bin/python3
+
+# Merge alignment shards created by ComputeAlignmentShard.py.
+# Invoke with one argument, the number of shards.
+
+import shasta
+import sys
+
+if not len(sys.argv) == 2:
+    raise Exception('Invoke with one argument, the number of shards.')
+shardCount = int(sys.argv[1]);
+
+a = shasta.Assembler()
+a.accessAlignmentCandidates()
+a.mergeAlignmentShards('AlignmentShards', shardCount)
+
@@ -2,6 +2,7 @@
 #include "Align4.hpp"
 #include "Alignment.hpp"
 #include "countingSort.hpp"
+#include "cpuDispatch.hpp"
 #include "hashArray.hpp"
 #include "Marker.hpp"
 #include "orderPairs.hpp"
@@ -34,11 +35,12 @@ void shasta::Align4::align(
     MemoryMapped::ByteAllocator& byteAllocator,
     Alignment& alignment,
     AlignmentInfo& alignmentInfo,
-    bool debug)
+    bool debug,
+    const pair<int32_t, int32_t>* bandHint)
 {
     Align4::Aligner graph(compressedMarkers, sortedMarkers,
         options, byteAllocator, alignment, alignmentInfo,
-        debug);
+        debug, bandHint);
 }
 
 
@@ -50,7 +52,8 @@ Aligner::Aligner(
     MemoryMapped::ByteAllocator& byteAllocator,
     Alignment& alignment,
     AlignmentInfo& alignmentInfo,
-    bool debug) :
+    bool debug,
+    const pair<int32_t, int32_t>* bandHint) :
     nx(uint32_t(compressedMarkers[0].size())),
     ny(uint32_t(compressedMarkers[1].size())),
     deltaX(int32_t(options.deltaX)),
@@ -63,6 +66,14 @@ Aligner::Aligner(
             nx << " and " << ny << " markers." << endl;
     }
 
+    if(bandHint) {
+        bandHintMin = bandHint->first;
+        bandHintMax = bandHint->second;
+        if(debug) {
+            cout << "Using band hint " << bandHintMin << " " << bandHintMax << endl;
+        }
+    }
+
     // Create the sparse representation of the alignment matrix.
     if(debug) {
         cout << timestamp << "Creating the alignment matrix." << endl;
@@ -233,6 +244,13 @@ void Aligner::createAlignmentMatrix(const array<span< const pair<KmerId, uint32_
                 const uint32_t x = jt0->second;
                 for(auto jt1=it1Begin; jt1!=it1End; ++jt1) {
                     const uint32_t y = jt1->second;
+
+                    // Skip entries outside the band hint, if any.
+                    const int32_t diagonal = int32_t(x) - int32_t(y);
+                    if(diagonal < bandHintMin or diagonal > bandHintMax) {
+                        continue;
+                    }
+
                     const Coordinates xy(x, y);
                     const Coordinates iXY = getCellIndexesFromxy(xy);
                     const uint32_t iY = iXY.second;
@@ -912,8 +930,9 @@ void Aligner::computeBandedAlignments(
         }
 
         // Compute the corresponding band.
-        const int32_t bandMin = int32_t(nx) -1 - int32_t(YMax);
-        const int32_t bandMax = int32_t(nx) -1 - int32_t(YMin);
+        // Cells can extend beyond the band hint, so restrict to it.
+        const int32_t bandMin = max(int32_t(nx) -1 - int32_t(YMax), bandHintMin);
+        const int32_t bandMax = min(int32_t(nx) -1 - int32_t(YMin), bandHintMax);
         const int32_t bandWidth = bandMax - bandMin + 1;
         const int32_t bandCenter = (bandMin + bandMax) / 2;
         const int32_t nominalAlignmentLength =
@@ -990,7 +1009,7 @@ void Aligner::computeBandedAlignments(
 
 
 // Compute a banded alignment with a given band.
-bool Aligner::computeBandedAlignment(
+SHASTA_CPU_DISPATCH bool Aligner::computeBandedAlignment(
     const array<CompressedMarkers, 2>& compressedMarkers,
     int32_t bandMin,
     int32_t bandMax,
@@ -85,6 +85,10 @@ namespace shasta {
 
         // Compute the alginment.
         // The sorted markers are pairs(KmerId, ordinal) sorted by KmnerId.
+        // If bandHint is not null, it gives the (min, max) range of x-y
+        // where the alignment is expected (for example, from the features
+        // found during alignment candidate discovery). Alignment matrix entries
+        // outside that range are ignored, and the SeqAn band is restricted to it.
         void align(
             const array<CompressedMarkers, 2>&,
             const array<span< const pair<KmerId, uint32_t> >, 2> sortedMarkers,
@@ -92,7 +96,8 @@ namespace shasta {
             MemoryMapped::ByteAllocator&,
             Alignment&,
             AlignmentInfo&,
-            bool debug);
+            bool debug,
+            const pair<int32_t, int32_t>* bandHint = 0);
     }
 
     namespace MemoryMapped {
@@ -143,7 +148,8 @@ public:
         MemoryMapped::ByteAllocator&,
         Alignment&,
         AlignmentInfo&,
-        bool debug);
+        bool debug,
+        const pair<int32_t, int32_t>* bandHint);
 
 private:
 
@@ -151,6 +157,10 @@ private:
     uint32_t nx;
     uint32_t ny;
 
+    // The range of x-y allowed by the band hint, if any.
+    int32_t bandHintMin = std::numeric_limits<int32_t>::min();
+    int32_t bandHintMax = std::numeric_limits<int32_t>::max();
+
     // Cell sizes in the X and Y direction.
     uint32_t deltaX;
     uint32_t deltaY;
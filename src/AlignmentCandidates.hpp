@@ -9,12 +9,28 @@
 #include "array.hpp"
 
 namespace shasta {
+    class AlignmentCandidateBand;
     class AlignmentCandidates;
     class OrientedReadPair;
 }
 
 
 
+// A compact estimate of the diagonal of the alignment matrix
+// near which an alignment candidate is expected to align,
+// computed from its featureOrdinals.
+class shasta::AlignmentCandidateBand {
+public:
+
+    // The median of ordinal1 - ordinal0 over the features of the candidate.
+    int32_t offset;
+
+    // The maximum distance of ordinal1 - ordinal0 of a feature from the median.
+    uint32_t spread;
+};
+
+
+
 // Alignment candidates found by the LowHash algorithm.
 // They all have readId0<readId1.
 // They are interpreted with readId0 on strand 0.
@@ -32,25 +48,33 @@ public:
     // and is indexed in the same way.
     MemoryMapped::VectorOfVectors< array<uint32_t, 2>, uint64_t> featureOrdinals;
 
+    // For each alignment candidate, the band computed from featureOrdinals
+    // by Assembler::computeAlignmentCandidateBands.
+    // It is used by alignment methods 3 and 4 to restrict the band
+    // of the alignment, and is indexed in the same way as the candidates vector.
+    // Like featureOrdinals, it is not created by LowHash0.
+    MemoryMapped::Vector<AlignmentCandidateBand> bands;
+
     // The candidate table stores the read pair that each oriented read is involved in.
     // Stores, for each OrientedReadId, a vector of indexes into the alignmentCandidate vector.
     // Indexed by OrientedReadId::getValue(),
     MemoryMapped::VectorOfVectors<uint64_t, uint64_t> candidateTable;
 
-    // Method to perform the indexing that fills candidateTable. Allocation of the memory mapped vector requires
-    // knowing the number of reads participating in the candidate pairs, and a name + page size to initialize with.
-    void computeCandidateTable(ReadId readCount, string largeDataName, size_t largeDataPageSize);
+    // The candidateTable is filled by Assembler::computeCandidateTable,
+    // which uses multiple threads.
 
     void unreserve() {
         candidates.unreserve();
         // featureOrdinals is not used by LowHash0
         if (featureOrdinals.isOpenWithWriteAccess()) featureOrdinals.unreserve();
+        if (bands.isOpenWithWriteAccess) bands.unreserve();
     }
 
     void clear() {
         candidates.clear();
         // featureOrdinals is not used by LowHash0
         if (featureOrdinals.isOpenWithWriteAccess()) featureOrdinals.clear();
+        if (bands.isOpenWithWriteAccess) bands.clear();
         unreserve();
     }
 };
@@ -8,6 +8,7 @@ using namespace shasta;
 // Standard library.
 #include "algorithm.hpp"
 #include "fstream.hpp"
+#include <random>
 
 
 // Compute an alignment of the markers of two oriented reads.
@@ -33,6 +34,10 @@ void shasta::align(
     // Change to size_t when conversion completed.
     uint32_t maxMarkerFrequency,
 
+    // If true, find the alignment using AlignmentGraph::findShortestChain
+    // instead of a shortest path search on the explicit graph.
+    bool useDynamicProgramming,
+
     // Flag to control various types of debug output.
     bool debug,
 
@@ -48,8 +53,8 @@ void shasta::align(
     AlignmentInfo& alignmentInfo
     )
 {
-    graph.create(markers, maxMarkerFrequency, maxSkip, maxDrift, debug,
-        alignment, alignmentInfo);
+    graph.create(markers, maxMarkerFrequency, maxSkip, maxDrift,
+        useDynamicProgramming, debug, alignment, alignmentInfo);
 }
 
 
@@ -60,6 +65,7 @@ void AlignmentGraph::create(
     uint32_t maxMarkerFrequency,
     size_t maxSkip,
     size_t maxDrift,
+    bool useDynamicProgramming,
     bool debug,
     Alignment& alignment,
     AlignmentInfo& alignmentInfo)
@@ -89,7 +95,11 @@ void AlignmentGraph::create(
     }
 
     // Create the edges.
-    createEdges(uint32_t(markers[0].size()), uint32_t(markers[1].size()), maxSkip, maxDrift);
+    // When using dynamic programming, they are only needed for debug output,
+    // because findShortestChain does not use them.
+    if(debug or not useDynamicProgramming) {
+        createEdges(uint32_t(markers[0].size()), uint32_t(markers[1].size()), maxSkip, maxDrift);
+    }
     if(debug) {
         writeEdges("AlignmentGraphEdges.csv");
     }
@@ -102,7 +112,11 @@ void AlignmentGraph::create(
     }
 
     // Look for the shortest path between vStart and vFinish.
-    findShortestPath(*this, vStart, vFinish, shortestPath, queue);
+    if(useDynamicProgramming) {
+        findShortestChain(uint32_t(markers[0].size()), uint32_t(markers[1].size()), maxSkip, maxDrift);
+    } else {
+        findShortestPath(*this, vStart, vFinish, shortestPath, queue);
+    }
     if(shortestPath.empty()) {
         alignment.clear();
         if(debug) {
@@ -398,6 +412,161 @@ void AlignmentGraph::createEdges(
 
 
 
+// Find the shortest path between vStart and vFinish,
+// considering only paths that move forward on both oriented reads,
+// which are the ones that correspond to valid alignments.
+// This is only used with --Align.method0DynamicProgramming.
+// Because the vertices are sorted by ordinal in the first oriented read,
+// this can be done by dynamic programming in a single pass over the vertices,
+// without explicitly creating the edges.
+// For each vertex, we only need to look back at vertices
+// within maxSkip markers on the first oriented read.
+// The skip, drift, and weight of each step are computed as in createEdges.
+// However, unlike the edges created by createEdges,
+// a step must move forward on both oriented reads, so a marker
+// is never used twice even if its k-mer appears more than once
+// in one of the oriented reads. findShortestPath on the explicit
+// graph can instead find such paths, or paths that go backwards,
+// because the graph is undirected.
+// When there is more than one shortest path, the path found
+// can also be different from the one found by findShortestPath,
+// whose choice depends on the order of equal distances
+// in its priority queue. Here, ties are broken as follows:
+// - Among predecessors that give the same distance to a vertex,
+//   we keep the one closest to it on the first oriented read
+//   (the first one encountered looking back).
+// - Among vertices that give the same distance to vFinish,
+//   we keep the one that comes first in the sorted vertices.
+void AlignmentGraph::findShortestChain(
+    uint32_t markerCount0,
+    uint32_t markerCount1,
+    size_t maxSkip,
+    size_t maxDrift)
+{
+    AlignmentGraph& graph = *this;
+    shortestPath.clear();
+
+    // The start and finish vertices were added after all other vertices.
+    const Int n = vertexCount() - 2;
+    SHASTA_ASSERT(vStart.v == n);
+    SHASTA_ASSERT(vFinish.v == n + 1);
+    if(n == 0) {
+        return;
+    }
+
+    uint64_t bestDistance = std::numeric_limits<uint64_t>::max();
+    vertex_descriptor vBest;
+    for(Int iB=0; iB<n; iB++) {
+        const vertex_descriptor vB(iB);
+        AlignmentGraphVertex& vertexB = graph[vB];
+        const int correctedOrdinalB0 = int(correctedOrdinals[0][vertexB.ordinals[0]]);
+        const int correctedOrdinalB1 = int(correctedOrdinals[1][vertexB.ordinals[1]]);
+        SHASTA_ASSERT(correctedOrdinalB0 < int(markerCount0));
+        SHASTA_ASSERT(correctedOrdinalB1 < int(markerCount1));
+
+        // Edge from vStart.
+        vertexB.distance = uint64_t(abs(correctedOrdinalB0) + abs(correctedOrdinalB1));
+        vertexB.predecessor = vStart;
+
+        // Edges from previous vertices.
+        for(Int iA=iB; iA>0; iA--) {
+            const vertex_descriptor vA(iA - 1);
+            const AlignmentGraphVertex& vertexA = graph[vA];
+            const int correctedOrdinalA0 = int(correctedOrdinals[0][vertexA.ordinals[0]]);
+            const int correctedOrdinalA1 = int(correctedOrdinals[1][vertexA.ordinals[1]]);
+
+            // If we got too far, we can end the inner loop,
+            // because vertices are sorted by position in sequence 0.
+            if(correctedOrdinalB0 > correctedOrdinalA0 + int(maxSkip)) {
+                break;
+            }
+
+            // Forbid the alignment from going backwards
+            // or using the same marker twice.
+            if(correctedOrdinalB0 == correctedOrdinalA0 or
+                correctedOrdinalB1 <= correctedOrdinalA1) {
+                continue;
+            }
+
+            // Check that the skip in the 1 direction is less than maxSkip.
+            if(abs(correctedOrdinalB1 - correctedOrdinalA1) > maxSkip) {
+                continue;
+            }
+
+            // Check for drift of the two reads relative to each other.
+            if(maxDrift < maxSkip) {
+                const int offsetA = correctedOrdinalA0 - correctedOrdinalA1;
+                const int offsetB = correctedOrdinalB0 - correctedOrdinalB1;
+                if(abs(offsetA - offsetB) > maxDrift) {
+                    continue;
+                }
+            }
+
+            const int delta0 = correctedOrdinalB0 - correctedOrdinalA0;
+            const int delta1 = correctedOrdinalB1 - correctedOrdinalA1;
+            const uint64_t weight = abs(delta0-1) + abs(delta1-1);
+            if(vertexA.distance + weight < vertexB.distance) {
+                vertexB.distance = vertexA.distance + weight;
+                vertexB.predecessor = vA;
+            }
+        }
+
+        // Edge to vFinish.
+        const int deltaFinish0 = int(markerCount0) - correctedOrdinalB0;
+        const int deltaFinish1 = int(markerCount1) - correctedOrdinalB1;
+        const uint64_t distance = vertexB.distance + uint64_t(abs(deltaFinish0) + abs(deltaFinish1));
+        if(distance < bestDistance) {
+            bestDistance = distance;
+            vBest = vB;
+        }
+    }
+
+    // Walk back to construct the path.
+    shortestPath.push_back(vFinish);
+    for(vertex_descriptor v=vBest; v!=vStart; v=graph[v].predecessor) {
+        shortestPath.push_back(v);
+    }
+    shortestPath.push_back(vStart);
+    std::reverse(shortestPath.begin(), shortestPath.end());
+}
+
+
+
+// Return the weight of shortestPath, computed as in createEdges.
+uint64_t AlignmentGraph::shortestPathWeight(
+    uint32_t markerCount0,
+    uint32_t markerCount1) const
+{
+    const AlignmentGraph& graph = *this;
+    SHASTA_ASSERT(shortestPath.size() >= 3);
+    SHASTA_ASSERT(shortestPath.front() == vStart);
+    SHASTA_ASSERT(shortestPath.back() == vFinish);
+
+    uint64_t weight = 0;
+    int previousOrdinal0 = 0;
+    int previousOrdinal1 = 0;
+    for(uint64_t i=1; i<shortestPath.size()-1; i++) {
+        const AlignmentGraphVertex& vertex = graph[shortestPath[i]];
+        const int correctedOrdinal0 = int(correctedOrdinals[0][vertex.ordinals[0]]);
+        const int correctedOrdinal1 = int(correctedOrdinals[1][vertex.ordinals[1]]);
+        if(i == 1) {
+            weight += uint64_t(correctedOrdinal0 + correctedOrdinal1);
+        } else {
+            weight += uint64_t(
+                abs(correctedOrdinal0 - previousOrdinal0 - 1) +
+                abs(correctedOrdinal1 - previousOrdinal1 - 1));
+        }
+        previousOrdinal0 = correctedOrdinal0;
+        previousOrdinal1 = correctedOrdinal1;
+    }
+    weight += uint64_t(
+        abs(int(markerCount0) - previousOrdinal0) +
+        abs(int(markerCount1) - previousOrdinal1));
+    return weight;
+}
+
+
+
 void AlignmentGraph::writeEdges(const string& fileName) const
 {
     ofstream csv(fileName);
@@ -571,3 +740,159 @@ void AlignmentGraph::writeImage(
     image.write(fileName);
 }
 
+
+
+// Check on random marker sequences that findShortestChain finds
+// shortest paths with the same weight as a search on the explicit graph
+// created by createEdges, using only edges that move forward on both sequences.
+// Also compare with findShortestPath on the explicit graph,
+// which is used to compute alignments unless --Align.method0DynamicProgramming
+// is used. Because the graph is undirected, that can find paths
+// that go backwards or use a marker twice, which can be shorter
+// but don't correspond to valid alignments.
+// The k-mers are drawn from a small set, so many of them
+// appear more than once in each sequence.
+void shasta::testAlignmentGraph()
+{
+    std::mt19937 randomSource(231);
+    const uint64_t caseCount = 10000;
+    uint64_t differentPathCount = 0;
+    uint64_t backwardPathCount = 0;
+
+    AlignmentGraph graph;
+    FindShortestPathQueue<AlignmentGraph> queue;
+    array<vector<MarkerWithOrdinal>, 2> markers;
+    for(uint64_t caseId=0; caseId<caseCount; caseId++) {
+        const uint64_t kmerCount = std::uniform_int_distribution<uint64_t>(4, 60)(randomSource);
+        const uint32_t markerCount0 = std::uniform_int_distribution<uint32_t>(1, 150)(randomSource);
+        const uint32_t maxMarkerFrequency = std::uniform_int_distribution<uint32_t>(1, 4)(randomSource);
+        const size_t maxSkip = std::uniform_int_distribution<size_t>(2, 30)(randomSource);
+        const size_t maxDrift = std::uniform_int_distribution<size_t>(1, 35)(randomSource);
+        std::uniform_int_distribution<KmerId> randomKmerId(0, KmerId(kmerCount - 1));
+        std::uniform_int_distribution<int> randomEvent(0, 9);
+
+        // The second sequence is a copy of the first
+        // with random substitutions, insertions, and deletions.
+        array<vector<KmerId>, 2> kmerIds;
+        for(uint32_t i=0; i<markerCount0; i++) {
+            kmerIds[0].push_back(randomKmerId(randomSource));
+        }
+        kmerIds[1].clear();
+        for(const KmerId kmerId: kmerIds[0]) {
+            const int event = randomEvent(randomSource);
+            if(event == 0) {
+                kmerIds[1].push_back(randomKmerId(randomSource));
+            } else if(event == 1) {
+                kmerIds[1].push_back(kmerId);
+                kmerIds[1].push_back(randomKmerId(randomSource));
+            } else if(event != 2) {
+                kmerIds[1].push_back(kmerId);
+            }
+        }
+        if(kmerIds[1].empty()) {
+            kmerIds[1].push_back(randomKmerId(randomSource));
+        }
+
+        // Create the markers, sorted by KmerId.
+        for(uint64_t i=0; i<2; i++) {
+            markers[i].clear();
+            for(uint32_t ordinal=0; ordinal<uint32_t(kmerIds[i].size()); ordinal++) {
+                Marker marker;
+                marker.kmerId = kmerIds[i][ordinal];
+                marker.position = ordinal;
+                markers[i].push_back(MarkerWithOrdinal(marker, ordinal));
+            }
+            std::stable_sort(markers[i].begin(), markers[i].end());
+            kmerIds[i].clear();
+        }
+        const uint32_t markerCount1 = uint32_t(markers[1].size());
+
+        // Create the graph, including the edges, as AlignmentGraph::create
+        // did before findShortestChain was introduced.
+        graph.clear();
+        graph.createVertices(markers, maxMarkerFrequency);
+        graph.sortVertices();
+        graph.vStart = graph.addVertex();
+        graph.vFinish = graph.addVertex();
+        graph.doneAddingVertices();
+        graph.createEdges(markerCount0, markerCount1, maxSkip, maxDrift);
+        graph.doneAddingEdges();
+
+        // Find the shortest path using the explicit graph, as done
+        // when not using --Align.method0DynamicProgramming.
+        // Because the graph is undirected, this path can go backwards
+        // or use a marker twice, and then does not correspond to a valid alignment.
+        findShortestPath(graph, graph.vStart, graph.vFinish, graph.shortestPath, queue);
+        const vector<AlignmentGraph::vertex_descriptor> graphPath = graph.shortestPath;
+        bool graphPathIsIncreasing = true;
+        for(uint64_t i=2; i+1<graphPath.size(); i++) {
+            const AlignmentGraphVertex& vertex0 = graph[graphPath[i-1]];
+            const AlignmentGraphVertex& vertex1 = graph[graphPath[i]];
+            if(vertex1.ordinals[0] <= vertex0.ordinals[0] or
+                vertex1.ordinals[1] <= vertex0.ordinals[1]) {
+                graphPathIsIncreasing = false;
+            }
+        }
+        const uint64_t graphWeight = graphPath.empty() ? 0 : graph[graph.vFinish].distance;
+
+        // Find the shortest path on the explicit graph, using only
+        // edges that move forward on both sequences. The vertices are sorted,
+        // so this can be done in a single pass over the vertices.
+        const uint64_t n = graph.vertexCount() - 2;
+        vector<uint64_t> forwardDistance(n);
+        uint64_t forwardWeight = std::numeric_limits<uint64_t>::max();
+        for(uint64_t iB=0; iB<n; iB++) {
+            const AlignmentGraph::vertex_descriptor vB(iB);
+            const AlignmentGraphVertex& vertexB = graph[vB];
+            const uint32_t correctedOrdinal0 = graph.correctedOrdinals[0][vertexB.ordinals[0]];
+            const uint32_t correctedOrdinal1 = graph.correctedOrdinals[1][vertexB.ordinals[1]];
+            forwardDistance[iB] = correctedOrdinal0 + correctedOrdinal1;
+            BGL_FORALL_OUTEDGES(vB, e, graph, AlignmentGraph) {
+                const uint64_t iA = target(e, graph).v;
+                if(iA >= n) {
+                    continue;
+                }
+                const AlignmentGraphVertex& vertexA = graph[target(e, graph)];
+                if(vertexA.ordinals[0] < vertexB.ordinals[0] and
+                    vertexA.ordinals[1] < vertexB.ordinals[1]) {
+                    forwardDistance[iB] = min(forwardDistance[iB], forwardDistance[iA] + graph[e].weight);
+                }
+            }
+            forwardWeight = min(forwardWeight, forwardDistance[iB] +
+                (markerCount0 - correctedOrdinal0) + (markerCount1 - correctedOrdinal1));
+        }
+
+        // Find the shortest path using dynamic programming.
+        graph.findShortestChain(markerCount0, markerCount1, maxSkip, maxDrift);
+        SHASTA_ASSERT(graph.shortestPath.empty() == graphPath.empty());
+        if(graphPath.empty()) {
+            continue;
+        }
+        const uint64_t chainWeight = graph.shortestPathWeight(markerCount0, markerCount1);
+        SHASTA_ASSERT(chainWeight == forwardWeight);
+        if(graphPathIsIncreasing) {
+            SHASTA_ASSERT(chainWeight == graphWeight);
+            if(graph.shortestPath != graphPath) {
+                ++differentPathCount;
+            }
+        } else {
+            SHASTA_ASSERT(chainWeight >= graphWeight);
+            ++backwardPathCount;
+        }
+
+        // The alignment must be strictly increasing on both sequences.
+        Alignment alignment;
+        for(uint64_t i=1; i<graph.shortestPath.size()-1; i++) {
+            const AlignmentGraphVertex& vertex = graph[graph.shortestPath[i]];
+            alignment.ordinals.push_back(
+                array<uint32_t, 2>({uint32_t(vertex.ordinals[0]), uint32_t(vertex.ordinals[1])}));
+        }
+        alignment.checkStrictlyIncreasing();
+    }
+
+    cout << "testAlignmentGraph: " << caseCount << " cases passed." << endl;
+    cout << "In " << differentPathCount << " cases a different shortest path "
+        "with the same weight was found." << endl;
+    cout << "In " << backwardPathCount << " cases findShortestPath on the explicit graph "
+        "found a path going backwards or using a marker twice, which is not a valid alignment." << endl;
+}
@@ -16,6 +16,10 @@ between the two pairs of markers on each of the
 oriented reads, measured using ordinals (not position).
 
 To find a good alignment, we find a shortest path in the graph.
+Optionally (--Align.method0DynamicProgramming), this is instead done
+by dynamic programming over the vertices sorted by ordinals
+(see AlignmentGraph::findShortestChain), and the edges are only
+created explicitly for debug output.
 
 *******************************************************************************/
 
@@ -62,6 +66,10 @@ namespace shasta {
         // Change to size_t when conversion completed.
         uint32_t maxMarkerFrequency,
 
+        // If true, find the alignment using AlignmentGraph::findShortestChain
+        // instead of a shortest path search on the explicit graph.
+        bool useDynamicProgramming,
+
         // Flag to control various types of debug output.
         bool debug,
 
@@ -76,6 +84,12 @@ namespace shasta {
         // Also create alignment summary information.
         AlignmentInfo&
         );
+
+    // Check on random marker sequences, including repeated k-mers,
+    // that AlignmentGraph::findShortestChain finds shortest paths
+    // with the same weight as a shortest path search on the explicit graph
+    // restricted to edges that move forward on both oriented reads.
+    void testAlignmentGraph();
 }
 
 
@@ -132,6 +146,7 @@ public:
         uint32_t maxMarkerFrequency,
         size_t maxSkip,
         size_t maxDrift,
+        bool useDynamicProgramming,
         bool debug,
         Alignment&,
         AlignmentInfo&);
@@ -176,8 +191,20 @@ private:
     // Data members used to find the shortest path.
     vector<vertex_descriptor> shortestPath;
     FindShortestPathQueue<AlignmentGraph> queue;
+    void findShortestChain(
+        uint32_t markerCount0,
+        uint32_t markerCount1,
+        size_t maxSkip,
+        size_t maxDrift);
     void writeShortestPath(const string& fileName) const;
 
+    // Return the weight of shortestPath, computed as in createEdges.
+    uint64_t shortestPathWeight(
+        uint32_t markerCount0,
+        uint32_t markerCount1) const;
+
+    friend void testAlignmentGraph();
+
     // Flags that are set for markers whose k-mers
     // have frequency maxMarkerFrequency or less in
     // both oriented reads being aligned.
@@ -7,6 +7,7 @@
 #include "AssemblyGraph2Statistics.hpp"
 #include "HttpServer.hpp"
 #include "Kmer.hpp"
+#include "KmerChecker.hpp"
 #include "Marker.hpp"
 #include "MarkerGraph.hpp"
 #include "MemoryMappedObject.hpp"
@@ -38,10 +39,12 @@ namespace shasta {
     class ConsensusCaller;
     class Histogram2;
     class InducedAlignment;
+    class InducedAlignmentWorkArea;
     class LocalAssemblyGraph;
     class LocalAlignmentCandidateGraph;
     class LocalAlignmentGraph;
     class LocalMarkerGraph;
+    class LocalMarkerGraphFlat;
     class LocalReadGraph;
     class LocalReadGraphTriangles;
     class LocalMarkerGraphRequestParameters;
@@ -65,6 +68,9 @@ namespace shasta {
         bool select0,           // Whether strand 0 is selected.
         bool select1);          // Whether strand 1 is selected.
 
+    // Write a string, with escapes, in JSON format.
+    void writeJsonString(ostream&, const span<const char>&);
+
     namespace Align4 {
         class MatrixEntry;
         class Options;
@@ -102,6 +108,12 @@ public:
     // The length of k-mers used to define markers.
     size_t k;
 
+    // In builds with long k-mers (SHASTA_LONG_KMERS) there is no k-mer table,
+    // and markers are selected using a hash of the canonical KmerId.
+    // These define the KmerChecker used (see KmerChecker.hpp).
+    uint64_t kmerHashThreshold = 0;
+    uint64_t kmerHashSeed = 0;
+
     // The page size in use for this run.
     size_t largeDataPageSize;
 
@@ -268,10 +280,39 @@ public:
         // the number of virtual processors is used.
         size_t threadCount
     );
+
+    // Compute alignments for one shard of the alignment candidates,
+    // as specified by AlignOptions::shard, and store them in a
+    // subdirectory of shardsDirectory. Shards can be computed
+    // by separate processes, possibly on different machines
+    // sharing a filesystem. When all shards are available,
+    // mergeAlignmentShards combines them into alignmentData,
+    // compressedAlignments, and alignmentTable, identical to
+    // the ones created by computeAlignments.
+    void computeAlignmentShard(
+        const AlignOptions&,
+        const string& shardsDirectory,
+        size_t threadCount);
+    void mergeAlignmentShards(
+        const string& shardsDirectory,
+        uint64_t shardCount);
+
     void accessAlignmentData();
     void accessAlignmentDataReadWrite();
     void writeAlignmentDetails() const;
 
+    // Compute alignments for a batch of pairs of oriented reads,
+    // using multiple threads. This does not use or modify the stored alignments.
+    // For each pair, returns the AlignmentInfo and a flag that is set
+    // if the alignment satisfies the criteria used by computeAlignments
+    // to decide whether to store it.
+    void alignOrientedReadPairs(
+        const vector< array<OrientedReadId, 2> >&,
+        const AlignOptions&,
+        size_t threadCount,
+        vector<AlignmentInfo>&,
+        vector<uint8_t>& isGood);
+
 
     // Loop over all alignments in the read graph
     // to create vertices of the global marker graph.
@@ -444,6 +485,16 @@ private:
     MemoryMapped::Vector<KmerInfo> kmerTable;
     void checkKmersAreOpen() const;
 
+    // Get a KmerChecker to decide which k-mers are markers.
+    // It uses the k-mer table or, in builds with long k-mers,
+    // a hash of the canonical KmerId.
+    KmerChecker getKmerChecker() const;
+
+    // Get the total number of RLE k-mers and the number
+    // of RLE k-mers used as markers.
+    // In builds with long k-mers, the second number is an estimate.
+    void countRleMarkerKmers(uint64_t& totalRleKmerCount, uint64_t& markerRleKmerCount) const;
+
 public:
     void accessKmers();
     void writeKmers(const string& fileName) const;
@@ -580,6 +631,12 @@ private:
     // The markers on all oriented reads. Indexed by OrientedReadId::getValue().
     MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t> markers;
     void checkMarkersAreOpen() const;
+public:
+    const MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t>& getCompressedMarkers() const
+    {
+        return markers;
+    }
+private:
 
     // Get markers sorted by KmerId for a given OrientedReadId.
     void getMarkersSortedByKmerId(
@@ -648,6 +705,10 @@ private:
         double alignedFractionThreshold;
         double nearDiagonalFractionThreshold;
         uint32_t deltaThreshold;
+
+        // The number of reads for which the marker alignment
+        // with the reverse complement was computed.
+        uint64_t alignedReadCount;
     };
     FlagPalindromicReadsData flagPalindromicReadsData;
 
@@ -655,6 +716,9 @@ private:
     // Check if an alignment between two reads should be suppressed,
     // bases on the setting of command line option
     // --Align.sameChannelReadAlignment.suppressDeltaThreshold.
+    // This uses the numeric meta data computed by computeSameChannelMetaData
+    // and only looks at the meta data strings to confirm
+    // alignments that are about to be suppressed.
     bool suppressAlignment(ReadId, ReadId, uint64_t delta);
 
     // Remove all alignment candidates for which suppressAlignment
@@ -662,13 +726,51 @@ private:
 public:
     void suppressAlignmentCandidates(uint64_t delta, size_t threadCount);
 private:
+
+    // The meta data fields used by suppressAlignment,
+    // parsed once for each read.
+    // Fields ch, sampleid, runid are stored as hashes of their values.
+    // Equal hashes are later confirmed by comparing the strings.
+    class SameChannelMetaData {
+    public:
+        uint64_t chHash;
+        uint64_t sampleidHash;
+        uint64_t runidHash;
+        int64_t read;
+
+        // False if any of the four fields is missing.
+        bool isValid;
+    };
+
     class SuppressAlignmentCandidatesData {
     public:
         uint64_t delta;
-        MemoryMapped::Vector<bool> suppress; // For each alignment candidate.
+
+        // Indexed by ReadId.
+        MemoryMapped::Vector<SameChannelMetaData> sameChannelMetaData;
+
+        // For each alignment candidate.
+        MemoryMapped::Vector<bool> suppress;
+
+        // The candidates we keep, before they are copied back to
+        // alignmentCandidates.candidates.
+        MemoryMapped::Vector<OrientedReadPair> keptCandidates;
+
+        // Same, for alignmentCandidates.bands, if available.
+        MemoryMapped::Vector<AlignmentCandidateBand> keptBands;
+
+        // For each batch of candidates, the number of candidates we keep.
+        // After the prefix sum, the position in keptCandidates
+        // of the first candidate kept for each batch.
+        uint64_t batchSize;
+        vector<uint64_t> batchKeptCount;
     };
     SuppressAlignmentCandidatesData suppressAlignmentCandidatesData;
-    void suppressAlignmentCandidatesThreadFunction(size_t threadId);
+    void computeSameChannelMetaData(size_t threadCount);
+    void computeSameChannelMetaDataThreadFunction(size_t threadId);
+    void suppressAlignmentCandidatesThreadFunction1(size_t threadId);
+    void suppressAlignmentCandidatesThreadFunction2(size_t threadId);
+    void suppressAlignmentCandidatesThreadFunction3(size_t threadId);
 
 
 
@@ -679,6 +781,10 @@ private:
 
 public:
     void writeAlignmentCandidates(bool useReadName=false, bool verbose=false) const;
+    uint64_t getAlignmentCandidateCount() const
+    {
+        return alignmentCandidates.candidates.size();
+    }
 private:
 
 
@@ -708,15 +814,39 @@ public:
         size_t minFrequency,            // Minimum number of lowHash hits for a pair to become a candidate.
         size_t threadCount
     );
+
+    // Single pass version that chains common features
+    // with consistent offsets. See LowHash2.hpp.
+    void findAlignmentCandidatesLowHash2(
+        size_t m,                       // Number of consecutive k-mers that define a feature.
+        double hashFraction,            // Low hash threshold.
+        size_t minBucketSize,           // The minimum frequency for a feature to be used.
+        size_t maxBucketSize,           // The maximum frequency for a feature to be used.
+        size_t minFrequency,            // Minimum number of chained common features for a pair to become a candidate.
+        size_t maxDrift,                // Maximum offset difference between chained common features.
+        size_t threadCount
+    );
     void markAlignmentCandidatesAllPairs();
     void accessAlignmentCandidates();
     void accessAlignmentCandidateTable();
     vector<OrientedReadPair> getAlignmentCandidates() const;
-    void computeCandidateTable();
+    void computeCandidateTable(size_t threadCount = 0);
 
 private:
     void checkAlignmentCandidatesAreOpen() const;
 
+    // Compute alignmentCandidates.bands from alignmentCandidates.featureOrdinals.
+    void computeAlignmentCandidateBands(size_t threadCount);
+    void computeAlignmentCandidateBandsThreadFunction(size_t threadId);
+
+    // Remove alignmentCandidates.bands, including any left
+    // in the binary data by a previous computation of alignment candidates.
+    void removeAlignmentCandidateBands();
+
+    void computeCandidateTableThreadFunction1(size_t threadId);
+    void computeCandidateTableThreadFunction2(size_t threadId);
+    void computeCandidateTableThreadFunction3(size_t threadId);
+
 
     // LowHash statistics for read.
     // For each read we count the number of times a low hash
@@ -781,6 +911,7 @@ private:
         size_t maxSkip,             // Maximum ordinal skip allowed.
         size_t maxDrift,            // Maximum ordinal drift allowed.
         uint32_t maxMarkerFrequency,
+        bool useDynamicProgramming, // See --Align.method0DynamicProgramming.
         bool debug,
         AlignmentGraph&,
         Alignment&,
@@ -817,6 +948,8 @@ private:
 
 
     // Alternative alignment function with 3 suffix (SeqAn, banded).
+    // If bandHint is not null, it is used as the (min, max) band
+    // of ordinal0 - ordinal1, and the downsampled alignment is skipped.
     void alignOrientedReads3(
         OrientedReadId,
         OrientedReadId,
@@ -827,7 +960,21 @@ private:
         int bandExtend,
         int maxBand,
         Alignment&,
-        AlignmentInfo&);
+        AlignmentInfo&,
+        const pair<int32_t, int32_t>* bandHint = 0);
+
+    // Use an alignment of downsampled markers to compute the band
+    // used by alignOrientedReads3. Returns false if the downsampled
+    // alignment is empty.
+    bool computeAlignOrientedReads3Band(
+        const array<span<CompressedMarker>, 2>& allMarkers,
+        int matchScore,
+        int mismatchScore,
+        int gapScore,
+        double downsamplingFactor,
+        int bandExtend,
+        int32_t& bandMin,
+        int32_t& bandMax);
 
 
 
@@ -855,6 +1002,8 @@ public:
     // Align two reads using alignment method 4.
     // If debug is true, detailed output to html is produced.
     // Otherwise, html is not used.
+    // If bandHint is not null, it restricts the (min, max) band
+    // of ordinal0 - ordinal1 (see Align4::align).
     void alignOrientedReads4(
         OrientedReadId,
         OrientedReadId,
@@ -862,7 +1011,8 @@ public:
         MemoryMapped::ByteAllocator&,
         Alignment&,
         AlignmentInfo&,
-        bool debug) const;
+        bool debug,
+        const pair<int32_t, int32_t>* bandHint = 0) const;
 
     // Intermediate level version used by the http server.
     void alignOrientedReads4(
@@ -944,6 +1094,10 @@ private:
 
     void checkAlignmentDataAreOpen() const;
 public:
+    const MemoryMapped::Vector<AlignmentData>& getAlignmentData() const
+    {
+        return alignmentData;
+    }
     void accessCompressedAlignments();
 private:
 
@@ -975,24 +1129,110 @@ private:
     MemoryMapped::VectorOfVectors<uint32_t, uint32_t> alignmentTable;
     void computeAlignmentTable();
 
+    // Information stored with each shard created by computeAlignmentShard.
+    class AlignmentShardInfo {
+    public:
+        uint64_t shardIndex;
+        uint64_t shardCount;
+
+        // The total number of alignment candidates and
+        // the ones processed by this shard.
+        uint64_t candidateCount;
+        uint64_t candidateBegin;
+        uint64_t candidateEnd;
+
+        // The number of alignments stored.
+        uint64_t alignmentCount;
+
+        // Set last, so we don't merge shards that did not complete.
+        bool isComplete;
+    };
+    static string alignmentShardDirectory(
+        const string& shardsDirectory,
+        uint64_t shardIndex,
+        uint64_t shardCount);
 
 
     // Private functions and data used by computeAlignments.
+    // Compute alignments for alignment candidates in [candidateBegin, candidateEnd)
+    // and store them in alignmentData and compressedAlignments,
+    // in the order of the alignment candidates.
+    void computeAlignments(
+        const AlignOptions&,
+        uint64_t candidateBegin,
+        uint64_t candidateEnd,
+        const string& alignmentDataName,
+        const string& compressedAlignmentsName,
+        size_t pageSize,
+        size_t threadCount);
     void computeAlignmentsThreadFunction(size_t threadId);
+
+    // Name and page size for temporary binary data used while computing alignments.
+    // When computing a shard, temporary data go to the shard directory,
+    // so shards computed at the same time don't conflict.
+    string alignmentTemporaryDataName(const string& name) const;
+    size_t alignmentTemporaryDataPageSize() const;
+
     class ComputeAlignmentsData {
     public:
 
         // Not owned.
         const AlignOptions* alignOptions = 0;
 
+        // The first alignment candidate to be processed.
+        uint64_t candidateBegin = 0;
+
+        // Only set when computing a shard.
+        string shardDirectory;
+
+        // Set if alignmentCandidates.bands are used to restrict
+        // the band of alignment methods 3 and 4.
+        bool useBandHints = false;
+
         // The AlignmentInfo found by each thread.
         vector< vector<AlignmentData> > threadAlignmentData;
 
+        // The alignment candidate index corresponding to each entry
+        // of threadAlignmentData. For each thread these are increasing,
+        // because getNextBatch hands out batches in increasing order.
+        vector< vector<uint64_t> > threadCandidateIndexes;
+
         // Compressed alignments corresponding to the AlignmentInfo found by each thread.
         vector< shared_ptr< MemoryMapped::VectorOfVectors<char, uint64_t> > > threadCompressedAlignments;
     };
     ComputeAlignmentsData computeAlignmentsData;
 
+    // Compute the alignment of two oriented reads using the alignment method
+    // specified in the AlignOptions, and return true if the alignment
+    // satisfies the criteria used by computeAlignments to store it.
+    // Used by computeAlignments and alignOrientedReadPairs.
+    // If not null, the AlignmentCandidateBand is used as a hint
+    // to restrict the band of alignment methods 3 and 4.
+    bool computeAlignment(
+        const array<OrientedReadId, 2>&,
+        const AlignOptions&,
+        const Align4::Options&,
+        MemoryMapped::ByteAllocator&,
+        array<vector<MarkerWithOrdinal>, 2>& markersSortedByKmerId,
+        AlignmentGraph&,
+        Alignment&,
+        AlignmentInfo&,
+        const AlignmentCandidateBand* bandHint = 0);
+    static Align4::Options getAlign4Options(const AlignOptions&);
+
+    // Private functions and data used by alignOrientedReadPairs.
+    void alignOrientedReadPairsThreadFunction(size_t threadId);
+    class AlignOrientedReadPairsData {
+    public:
+
+        // None of these are owned.
+        const vector< array<OrientedReadId, 2> >* orientedReadIdPairs = 0;
+        const AlignOptions* alignOptions = 0;
+        vector<AlignmentInfo>* alignmentInfos = 0;
+        vector<uint8_t>* isGood = 0;
+    };
+    AlignOrientedReadPairsData alignOrientedReadPairsData;
+
 
 
     // Find in the alignment table the alignments involving
@@ -1013,6 +1253,10 @@ private:
     // For more information, see comments in ReadGraph.hpp.
     ReadGraph readGraph;
 public:
+    const ReadGraph& getReadGraph() const
+    {
+        return readGraph;
+    }
     void createReadGraph(
         uint32_t maxAlignmentCount,
         uint32_t maxTrim);
@@ -1225,8 +1469,44 @@ public:
 
 
 
+    // Estimate the histogram of disjoint set sizes computed by
+    // createMarkerGraphVertices (DisjointSetsHistogram.csv),
+    // and the value of minCoverage it would select automatically,
+    // using a random sample of reads. This runs before marker graph
+    // vertices are created and is much faster than createMarkerGraphVertices.
+    // The next call to createMarkerGraphVertices compares
+    // the estimate with the exact histogram.
+    // See AssemblerMarkerGraphCoverageEstimate.cpp.
+    void estimateMarkerGraphCoverageHistogram(
+        uint64_t sampleReadCount,
+        uint64_t maxCoverage,
+        double peakFinderMinAreaFraction,
+        uint64_t peakFinderAreaStartIndex,
+        size_t threadCount);
+
+    // Incremental computation of the marker graph disjoint sets.
+    // This is used in iterative assembly, where the marker graph
+    // is recreated at each iteration, but only the read graph changes
+    // between iterations.
+    // When this is enabled, createMarkerGraphVertices stores the disjoint sets
+    // it computes, and the next call updates them, recomputing
+    // only the disjoint sets affected by read graph edges
+    // that were added or removed.
+    // If verify is true, the updated disjoint sets are compared
+    // against the ones obtained by a full computation
+    // and an exception is thrown if they are not identical.
+    // This is expensive and should only be used for testing.
+    // See AssemblerMarkerGraphIncremental.cpp.
+    void enableIncrementalMarkerGraphVertices(bool verify);
+    void disableIncrementalMarkerGraphVertices();
+
+
+
     // Private functions and data used by createMarkerGraphVertices.
 private:
+    void computeMarkerGraphDisjointSets(size_t threadCount);
+    bool isReadGraphEdgeUsedForMarkerGraphVertices(const ReadGraphEdge&) const;
+    void getAlignmentsUsedForMarkerGraphVertices(vector<bool>&) const;
     void createMarkerGraphVerticesThreadFunction1(size_t threadId);
     void createMarkerGraphVerticesThreadFunction2(size_t threadId);
     void createMarkerGraphVerticesThreadFunction21(size_t threadId);
@@ -1267,6 +1547,81 @@ private:
     };
     CreateMarkerGraphVerticesData createMarkerGraphVerticesData;
 
+    // Functions and data used by estimateMarkerGraphCoverageHistogram.
+    void estimateMarkerGraphCoverageHistogramThreadFunction(size_t threadId);
+    void estimateMarkerGraphCoverageForRead(
+        ReadId,
+        uint64_t maxCoverage,
+        vector<double>& histogram) const;
+    void compareMarkerGraphCoverageHistogramEstimate(
+        const vector<uint64_t>& histogram,
+        uint64_t minCoverage,
+        uint64_t maxCoverage,
+        bool minCoverageWasSelectedAutomatically);
+    class MarkerGraphCoverageEstimateData {
+    public:
+        uint64_t maxCoverage;
+        vector<ReadId> sampledReadIds;
+
+        // The histogram computed by each thread,
+        // before normalization.
+        vector< vector<double> > threadHistograms;
+
+        // The estimated histogram of disjoint set sizes.
+        // The last entry (index maxCoverage+1) is for all disjoint sets
+        // with more than maxCoverage markers.
+        // Only valid if isValid is true.
+        bool isValid = false;
+        vector<double> histogram;
+
+        // The value of minCoverage that PeakFinder selected
+        // using the estimated histogram, or 0 if it did not find one.
+        uint64_t minCoverage = 0;
+    };
+    MarkerGraphCoverageEstimateData markerGraphCoverageEstimateData;
+
+    // Functions and data used for the incremental computation
+    // of the marker graph disjoint sets.
+    void updateMarkerGraphDisjointSets(size_t threadCount);
+    void updateMarkerGraphDisjointSetsThreadFunction(size_t threadId);
+    void storeMarkerGraphDisjointSets();
+    class IncrementalMarkerGraphData {
+    public:
+        bool isEnabled = false;
+        bool verify = false;
+
+        // The disjoint set that each oriented marker was assigned to
+        // by the last call to createMarkerGraphVertices.
+        // Only valid if isValid is true.
+        bool isValid = false;
+        MemoryMapped::Vector<MarkerGraph::VertexId> disjointSetTable;
+
+        // For each alignment, whether it was used to compute disjointSetTable.
+        // Indexed by alignmentId.
+        vector<bool> alignmentWasUsed;
+
+        // Return true if the stored disjoint sets can be updated.
+        bool canUpdate(uint64_t orientedMarkerCount, uint64_t alignmentCount) const
+        {
+            return
+                isEnabled and
+                isValid and
+                disjointSetTable.size() == orientedMarkerCount and
+                alignmentWasUsed.size() == alignmentCount;
+        }
+
+        // Data used by updateMarkerGraphDisjointSets.
+        // For each oriented marker, whether it belongs to a disjoint set
+        // that needs to be recomputed.
+        vector<bool> isAffectedMarker;
+        // For each read, whether any of its markers (on either strand)
+        // belong to a disjoint set that needs to be recomputed.
+        vector<bool> isAffectedRead;
+        // The pairs of aligned affected markers found by each thread.
+        vector< vector< pair<MarkerId, MarkerId> > > threadMarkerPairs;
+    };
+    IncrementalMarkerGraphData incrementalMarkerGraphData;
+
 
 
     void checkMarkerGraphVerticesAreAvailable() const;
@@ -1472,6 +1827,32 @@ private:
         uint32_t secondaryEdgeMaxSkip,
         bool aggressive,
         size_t threadCount);
+    void createMarkerGraphSecondaryEdgesThreadFunction1(size_t threadId);
+    void createMarkerGraphSecondaryEdgesThreadFunction2(size_t threadId);
+    class CreateMarkerGraphSecondaryEdgesData {
+    public:
+        uint32_t secondaryEdgeMaxSkip;
+        bool aggressive;
+
+        // Flags that tell us if each marker graph vertex
+        // has at least one outgoing/incoming edge.
+        // They are updated as secondary edges are added, so
+        // edgesBySource and edgesByTarget only need to be recreated
+        // once, after all secondary edges have been added.
+        vector<bool> hasOutEdges;
+        vector<bool> hasInEdges;
+
+        // The forward dead ends.
+        vector<MarkerGraphVertexId> forwardDeadEnds;
+
+        // The secondary edges found by each thread.
+        vector< vector< array<MarkerGraphVertexId, 2> > > threadSecondaryEdges;
+
+        // The deduplicated secondary edges and their marker intervals.
+        vector< array<MarkerGraphVertexId, 2> > secondaryEdges;
+        vector< vector<MarkerInterval> > secondaryEdgesMarkerIntervals;
+    };
+    CreateMarkerGraphSecondaryEdgesData createMarkerGraphSecondaryEdgesData;
 public:
 
 
@@ -1654,6 +2035,19 @@ private:
         vector< pair<uint32_t, uint32_t> >& pathOrdinals
         ) const;
 
+    // Given the marker graph path of an oriented read over its entire
+    // ordinal range, as computed by computeOrientedReadMarkerGraphPath,
+    // compute the marker graph path of the reverse complemented oriented read.
+    // This uses markerGraph.reverseComplementEdge and is much faster than
+    // calling computeOrientedReadMarkerGraphPath again.
+    void reverseComplementOrientedReadMarkerGraphPath(
+        OrientedReadId,
+        const vector<MarkerGraphEdgeId>& path,
+        const vector< pair<uint32_t, uint32_t> >& pathOrdinals,
+        vector<MarkerGraphEdgeId>& reverseComplementedPath,
+        vector< pair<uint32_t, uint32_t> >& reverseComplementedPathOrdinals
+        ) const;
+
     // Create the marker connectivity graph starting with a given marker.
     void createMarkerConnectivityGraph(
         OrientedReadId,
@@ -1667,21 +2061,50 @@ private:
         MarkerConnectivityGraph&,
         MarkerConnectivityGraphVertexMap&) const;
 
+    // Flat version of createMarkerConnectivityGraph, usable when all
+    // the markers that can be reached are known in advance
+    // (for example, the markers of a marker graph vertex).
+    // The markers are passed in sorted order, and the BFS starts
+    // at the first one. Vertices are identified by their index
+    // in markerDescriptors, and each edge is returned once
+    // as a pair of indexes (i0, i1) with i0 < i1.
+    // On return, isReached tells which markers were reached by the BFS.
+    void createMarkerConnectivityGraphFlat(
+        const vector<MarkerDescriptor>& markerDescriptors,
+        bool useReadGraphAlignmentsOnly,
+        vector< pair<uint64_t, uint64_t> >& edges,
+        vector<bool>& isReached) const;
+
     // Compute an alignment between two oriented reads
     // induced by the marker graph. See InducedAlignment.hpp for more
     // information.
+    // This also fills in the compressed ordinals.
     void computeInducedAlignment(
         OrientedReadId,
         OrientedReadId,
         InducedAlignment&
-    );
+    ) const;
 
     // Compute induced alignments between an oriented read orientedReadId0
     // and the oriented reads stored sorted in orientedReadIds1.
     void computeInducedAlignments(
         OrientedReadId orientedReadId0,
         const vector<OrientedReadId>& orientedReadIds1,
-        vector<InducedAlignment>& inducedAlignments);
+        vector<InducedAlignment>& inducedAlignments) const;
+
+    // Batched computation of induced alignments between an anchor
+    // oriented read and many other oriented reads.
+    // Call setInducedAlignmentAnchor once for the anchor, then
+    // computeInducedAlignment for each of the other oriented reads.
+    // These only use const data and can be called from multiple threads,
+    // each with its own InducedAlignmentWorkArea.
+    void setInducedAlignmentAnchor(
+        OrientedReadId,
+        InducedAlignmentWorkArea&) const;
+    void computeInducedAlignment(
+        InducedAlignmentWorkArea&,
+        OrientedReadId orientedReadId1,
+        InducedAlignment&) const;
 
     // Fill in compressed ordinals of an InducedAlignment.
     void fillCompressedOrdinals(
@@ -1727,6 +2150,30 @@ private:
         LocalMarkerGraph&
         );
 
+    // Flat version of extractLocalMarkerGraph. This does the BFS and finds
+    // the edges without using the Boost Graph library, and is used by
+    // extractLocalMarkerGraph, which then converts to a LocalMarkerGraph.
+    // See LocalMarkerGraphFlat.hpp for more information.
+    bool extractLocalMarkerGraphFlat(
+        MarkerGraph::VertexId,
+        uint64_t distance,
+        int timeout,                 // Or 0 for no timeout.
+        uint64_t minVertexCoverage,
+        uint64_t minEdgeCoverage,
+        bool useWeakEdges,
+        bool usePrunedEdges,
+        bool useSuperBubbleEdges,
+        bool useLowCoverageCrossEdges,
+        bool useRemovedSecondaryEdges,
+        LocalMarkerGraphFlat&
+        ) const;
+private:
+    // The LocalMarkerGraphFlat used by extractLocalMarkerGraph.
+    // It is kept between calls so its vectors indexed by global VertexId
+    // don't have to be reallocated each time.
+    shared_ptr<LocalMarkerGraphFlat> localMarkerGraphFlatPointer;
+public:
+
     // Compute consensus sequence for a vertex of the marker graph.
     void computeMarkerGraphVertexConsensusSequence(
         MarkerGraph::VertexId,
@@ -1863,6 +2310,27 @@ private:
     void gatherOrientedReadsByAssemblyGraphEdgePass2(size_t threadId);
     void gatherOrientedReadsByAssemblyGraphEdgePass(int);
 
+    // Write placements of reads on assembled segments in PAF format.
+    // The placements are obtained from the marker graph path
+    // of each read, without aligning the read to the assembly.
+public:
+    void writeReadPlacements(const string& fileName, size_t threadCount);
+private:
+    void writeReadPlacementsThreadFunction(size_t threadId);
+    class WriteReadPlacementsData {
+    public:
+        // The first read of the current chunk of reads.
+        ReadId readBegin;
+
+        // The PAF lines for each read in the current chunk.
+        vector<string> lines;
+
+        // The raw length of each assembled segment, indexed by
+        // assembly graph edge id. Zero for edges that are not output.
+        vector<uint64_t> segmentLengths;
+    };
+    WriteReadPlacementsData writeReadPlacementsData;
+
     // Extract a local assembly graph from the global assembly graph.
     // This returns false if the timeout was exceeded.
     bool extractLocalAssemblyGraph(
@@ -1957,6 +2425,13 @@ public:
 
         // The pseudo-path computed by this function.
         PseudoPath&) const;
+
+    // Same as above, but using a marker graph path
+    // that was already computed.
+    void computePseudoPath(
+        const vector<MarkerGraphEdgeId>& path,
+        const vector< pair<uint32_t, uint32_t> >& pathOrdinals,
+        PseudoPath&) const;
     void writePseudoPath(ReadId, Strand) const;
     static void getPseudoPathSegments(const PseudoPath&, vector<AssemblyGraphEdgeId>&);
 
@@ -2190,6 +2665,22 @@ public:
         const vector<string>& request,
         ostream&,
         const BrowserInformation&) override;
+    bool isCacheable(const vector<string>& request) const override;
+    void setupHttpResponseCache(uint64_t maxByteCount, const string& directory);
+    void exploreHttpResponseCache(const vector<string>&, ostream&);
+
+    // JSON endpoints of the http server.
+    // See AssemblerHttpServer-Json.cpp for more information.
+    OrientedReadId getJsonOrientedReadId(const vector<string>&) const;
+    void jsonIndex(const vector<string>&, ostream&);
+    void jsonReads(const vector<string>&, ostream&);
+    void jsonAlignments(const vector<string>&, ostream&);
+    void jsonReadGraphNeighbors(const vector<string>&, ostream&);
+    void jsonMarkerGraphVertices(const vector<string>&, ostream&);
+    void jsonMarkerGraphEdges(const vector<string>&, ostream&);
+    void jsonAssemblyGraphSegments(const vector<string>&, ostream&);
+    void jsonMode3Segments(const vector<string>&, ostream&);
+    void jsonMode3Links(const vector<string>&, ostream&);
     void exploreSummary(const vector<string>&, ostream&);
     void exploreRead(const vector<string>&, ostream&);
     void exploreReadRaw(const vector<string>&, ostream&);
@@ -2255,6 +2746,7 @@ public:
     void exploreMarkerGraphEdge(const vector<string>&, ostream&);
     void exploreMarkerCoverage(const vector<string>&, ostream&);
     void exploreMarkerGraphInducedAlignment(const vector<string>&, ostream&);
+    void exploreMarkerGraphInducedAlignments(const vector<string>&, ostream&);
     void followReadInMarkerGraph(const vector<string>&, ostream&);
     void exploreMarkerConnectivity(const vector<string>&, ostream&);
     void renderEditableAlignmentConfig(
@@ -2329,10 +2821,50 @@ public:
         uint64_t align4DeltaY;
         uint64_t align4MinEntryCountPerCell;
         uint64_t align4MaxDistanceFromBoundary;
+
+        // Parameters of the indexed search, see AlignmentSearchIndexData.
+        // If minSharedFeatureCount is 0, all oriented reads are aligned.
+        uint64_t minSharedFeatureCount;
+        uint64_t maxBucketSize;
+
+        // The oriented reads to align with orientedReadId0.
+        vector<OrientedReadId> orientedReadIds1;
+
         // The alignments found by each thread.
         vector< vector< pair<OrientedReadId, AlignmentInfo> > > threadAlignments;
     };
     ComputeAllAlignmentsData computeAllAlignmentsData;
+    void getAllAlignmentsSearchParameters(const vector<string>& request);
+    void writeAllAlignmentsSearchForm(ostream&) const;
+    void findAllAlignmentsCandidates(OrientedReadId);
+
+
+
+    // Inverted index used by the http server to find the oriented reads
+    // that are worth aligning with a given oriented read, without
+    // aligning against all reads. It is built on demand the first time
+    // it is needed and kept for the life of the http server.
+    // A feature is a pair of consecutive markers.
+    // The index stores, for each hash bucket of features,
+    // the ReadIds that have a feature in that bucket on strand 0.
+    // Matches on strand 1 are found by looking up the features
+    // of the reverse complement of the query oriented read.
+    class AlignmentSearchIndexData {
+    public:
+        uint64_t bucketMask = 0;
+        MemoryMapped::VectorOfVectors<ReadId, uint64_t> index;
+
+        // Number of shared features for each oriented read
+        // (indexed by OrientedReadId::getValue()) and
+        // the oriented reads where it is not zero.
+        vector<uint64_t> sharedFeatureCount;
+        vector<OrientedReadId> touched;
+    };
+    AlignmentSearchIndexData alignmentSearchIndexData;
+    void createAlignmentSearchIndex();
+    void createAlignmentSearchIndexThreadFunction1(size_t threadId);
+    void createAlignmentSearchIndexThreadFunction2(size_t threadId);
+    uint64_t getAlignmentSearchBucket(KmerId, KmerId) const;
 
 
     // Access all available assembly data, without thorwing an exception
@@ -8,7 +8,9 @@
 #include "Align4.hpp"
 #include "AssemblerOptions.hpp"
 #include "compressAlignment.hpp"
+#include "cpuDispatch.hpp"
 #include "performanceLog.hpp"
+#include "MurmurHash2.hpp"
 #include "Reads.hpp"
 #include "span.hpp"
 #include "timestamp.hpp"
@@ -17,8 +19,10 @@ using namespace shasta;
 // Standard libraries.
 #include "chrono.hpp"
 #include <filesystem>
+#include <queue>
 #include "iterator.hpp"
 #include "tuple.hpp"
+#include <unordered_map>
 
 
 
@@ -63,7 +67,7 @@ void Assembler::alignOrientedReads(
     const bool debug = true;
     alignOrientedReads(
         markersSortedByKmerId,
-        maxSkip, maxDrift, maxMarkerFrequency, debug, graph, alignment, alignmentInfo);
+        maxSkip, maxDrift, maxMarkerFrequency, false, debug, graph, alignment, alignmentInfo);
 
     // Compute the AlignmentInfo.
     uint32_t leftTrim;
@@ -103,7 +107,7 @@ void Assembler::alignOrientedReads(
     const bool debug = true;
     alignOrientedReads(
         markersSortedByKmerId,
-        maxSkip, maxDrift, maxMarkerFrequency, debug, graph, alignment, alignmentInfo);
+        maxSkip, maxDrift, maxMarkerFrequency, false, debug, graph, alignment, alignmentInfo);
 }
 
 
@@ -113,6 +117,7 @@ void Assembler::alignOrientedReads(
     size_t maxSkip,             // Maximum ordinal skip allowed.
     size_t maxDrift,            // Maximum ordinal drift allowed.
     uint32_t maxMarkerFrequency,
+    bool useDynamicProgramming, // See --Align.method0DynamicProgramming.
     bool debug,
     AlignmentGraph& graph,
     Alignment& alignment,
@@ -120,7 +125,8 @@ void Assembler::alignOrientedReads(
 )
 {
     align(markersSortedByKmerId,
-        maxSkip, maxDrift, maxMarkerFrequency, debug, graph, alignment, alignmentInfo);
+        maxSkip, maxDrift, maxMarkerFrequency, useDynamicProgramming, debug,
+        graph, alignment, alignmentInfo);
 }
 
 
@@ -179,7 +185,7 @@ void Assembler::alignOverlappingOrientedReads(
         const bool debug = false;
         alignOrientedReads(
             markersSortedByKmerId,
-            maxSkip, maxDrift, maxMarkerFrequency, debug, graph, alignment, alignmentInfo);
+            maxSkip, maxDrift, maxMarkerFrequency, false, debug, graph, alignment, alignmentInfo);
 
         uint32_t leftTrim;
         uint32_t rightTrim;
@@ -224,10 +230,6 @@ void Assembler::computeAlignments(
     checkMarkersAreOpen();
     checkAlignmentCandidatesAreOpen();
 
-    // Store parameters so they are accessible to the threads.
-    auto& data = computeAlignmentsData;
-    data.alignOptions = &alignOptions;
-
     // Adjust the numbers of threads, if necessary.
     if(threadCount == 0) {
         threadCount = std::thread::hardware_concurrency();
@@ -239,10 +241,74 @@ void Assembler::computeAlignments(
         computeSortedMarkers(threadCount);
     }
 
+    computeAlignments(alignOptions,
+        0, alignmentCandidates.candidates.size(),
+        largeDataName("AlignmentData"),
+        largeDataName("CompressedAlignments"),
+        largeDataPageSize,
+        threadCount);
+
+    // For alignment method 4, remove the sorted markers.
+    if(alignOptions.alignMethod == 4) {
+        sortedMarkers.remove();
+    }
+
+    cout << "Found and stored " << alignmentData.size() << " good alignments." << endl;
+    performanceLog << timestamp << "Creating alignment table." << endl;
+    computeAlignmentTable();
+
+    const auto tEnd = steady_clock::now();
+    const double tTotal = seconds(tEnd - tBegin);
+    performanceLog << timestamp << "Computation of alignments ";
+    performanceLog << "completed in " << tTotal << " s." << endl;
+
+    performanceLog << timestamp;
+}
+
+
+
+// Compute alignments for alignment candidates in [candidateBegin, candidateEnd)
+// and store them in alignmentData and compressedAlignments,
+// in the order of the alignment candidates.
+// This makes the result independent of the number of threads
+// and of how the candidates are split into shards.
+void Assembler::computeAlignments(
+    const AlignOptions& alignOptions,
+    uint64_t candidateBegin,
+    uint64_t candidateEnd,
+    const string& alignmentDataName,
+    const string& compressedAlignmentsName,
+    size_t pageSize,
+    size_t threadCount)
+{
+    SHASTA_ASSERT(candidateBegin <= candidateEnd);
+    SHASTA_ASSERT(candidateEnd <= alignmentCandidates.candidates.size());
+    const uint64_t candidateCount = candidateEnd - candidateBegin;
+
+    // Store parameters so they are accessible to the threads.
+    auto& data = computeAlignmentsData;
+    data.alignOptions = &alignOptions;
+    data.candidateBegin = candidateBegin;
+
+    // Use the bands computed during candidate discovery, if requested and available.
+    // If they don't correspond to the alignment candidates, don't use them.
+    data.useBandHints =
+        alignOptions.bandHintExtend >= 0 and
+        (alignOptions.alignMethod == 3 or alignOptions.alignMethod == 4) and
+        alignmentCandidates.bands.isOpen and
+        alignmentCandidates.bands.size() == alignmentCandidates.candidates.size();
+    if(data.useBandHints) {
+        performanceLog << timestamp << "Alignment bands are restricted using band hints "
+            "from alignment candidates." << endl;
+    }
+    if(alignOptions.alignMethod == 4) {
+        writeCpuDispatchInformation(performanceLog);
+    }
+
     // Pick the batch size for computing alignments.
     size_t batchSize = 10;
-    if(batchSize > alignmentCandidates.candidates.size()/threadCount) {
-        batchSize = alignmentCandidates.candidates.size()/threadCount;
+    if(batchSize > candidateCount/threadCount) {
+        batchSize = candidateCount/threadCount;
     }
     if(batchSize == 0) {
         batchSize = 1;
@@ -251,56 +317,55 @@ void Assembler::computeAlignments(
 
     // Compute the alignments.
     data.threadAlignmentData.resize(threadCount);
+    data.threadCandidateIndexes.resize(threadCount);
     data.threadCompressedAlignments.resize(threadCount);
     
     performanceLog << timestamp << "Alignment computation begins." << endl;
-    setupLoadBalancing(alignmentCandidates.candidates.size(), batchSize);
+    setupLoadBalancing(candidateCount, batchSize);
     runThreads(&Assembler::computeAlignmentsThreadFunction, threadCount);
     performanceLog << timestamp << "Alignment computation completed." << endl;
 
-    // Store the alignments found by each thread.
+    // Store the alignments found by each thread, in the order
+    // of the alignment candidates. The alignments found by each
+    // thread are already in that order, so we just merge them.
     performanceLog << timestamp << "Storing the alignment found by each thread." << endl;
-    alignmentData.createNew(largeDataName("AlignmentData"), largeDataPageSize);
-    compressedAlignments.createNew(largeDataName("CompressedAlignments"), largeDataPageSize);
-    
+    alignmentData.createNew(alignmentDataName, pageSize);
+    compressedAlignments.createNew(compressedAlignmentsName, pageSize);
+
+    using QueueEntry = pair<uint64_t, size_t>; // (candidateIndex, threadId)
+    std::priority_queue<QueueEntry, vector<QueueEntry>, std::greater<QueueEntry> > q;
+    vector<uint64_t> nextPosition(threadCount, 0);
     for(size_t threadId=0; threadId<threadCount; threadId++) {
-        const vector<AlignmentData>& threadAlignmentData = data.threadAlignmentData[threadId];
-        for(const AlignmentData& ad: threadAlignmentData) {
-            alignmentData.push_back(ad);
+        if(not data.threadCandidateIndexes[threadId].empty()) {
+            q.push({data.threadCandidateIndexes[threadId].front(), threadId});
         }
-
-        const auto threadCompressedAlignments = data.threadCompressedAlignments[threadId];
-        const auto size = threadCompressedAlignments->size();
-        for(size_t i=0; i<size; i++) {
-            compressedAlignments.appendVector(
-                (*threadCompressedAlignments)[i].begin(),
-                (*threadCompressedAlignments)[i].end()
-            );
+    }
+    while(not q.empty()) {
+        const size_t threadId = q.top().second;
+        q.pop();
+        uint64_t& position = nextPosition[threadId];
+
+        alignmentData.push_back(data.threadAlignmentData[threadId][position]);
+        const auto compressedAlignment = (*data.threadCompressedAlignments[threadId])[position];
+        compressedAlignments.appendVector(compressedAlignment.begin(), compressedAlignment.end());
+
+        ++position;
+        if(position < data.threadCandidateIndexes[threadId].size()) {
+            q.push({data.threadCandidateIndexes[threadId][position], threadId});
         }
+    }
 
-        // Clean up thread storage.
+    // Clean up thread storage.
+    for(size_t threadId=0; threadId<threadCount; threadId++) {
         data.threadCompressedAlignments[threadId]->remove();
     }
+    data.threadAlignmentData.clear();
+    data.threadCandidateIndexes.clear();
+    data.threadCompressedAlignments.clear();
 
     // Release unused allocated memory.
     alignmentData.unreserve();
     compressedAlignments.unreserve();
-
-    // For alignment method 4, remove the sorted markers.
-    if(alignOptions.alignMethod == 4) {
-        sortedMarkers.remove();
-    }
-
-    cout << "Found and stored " << alignmentData.size() << " good alignments." << endl;
-    performanceLog << timestamp << "Creating alignment table." << endl;
-    computeAlignmentTable();
-
-    const auto tEnd = steady_clock::now();
-    const double tTotal = seconds(tEnd - tBegin);
-    performanceLog << timestamp << "Computation of alignments ";
-    performanceLog << "completed in " << tTotal << " s." << endl;
-
-    performanceLog << timestamp;
 }
 
 
@@ -315,58 +380,38 @@ void Assembler::computeAlignmentsThreadFunction(size_t threadId)
     AlignmentInfo alignmentInfo;
     string compressedAlignment;
 
-    const bool debug = false;
     auto& data = computeAlignmentsData;
-    const size_t alignmentMethod = data.alignOptions->alignMethod;
-    const uint32_t maxMarkerFrequency = data.alignOptions->maxMarkerFrequency;
-    const size_t maxSkip = data.alignOptions->maxSkip;
-    const size_t maxDrift = data.alignOptions->maxDrift;
-    const size_t minAlignedMarkerCount = data.alignOptions->minAlignedMarkerCount;
-    const double minAlignedFraction = data.alignOptions->minAlignedFraction;
-    const size_t maxTrim = data.alignOptions->maxTrim;
-    const int matchScore = data.alignOptions->matchScore;
-    const int mismatchScore = data.alignOptions->mismatchScore;
-    const int gapScore = data.alignOptions->gapScore;
-    const double downsamplingFactor = data.alignOptions->downsamplingFactor;
-    const int bandExtend = data.alignOptions->bandExtend;
-    const int maxBand = data.alignOptions->maxBand;
-    const bool suppressContainments = data.alignOptions->suppressContainments;
+    const AlignOptions& alignOptions = *data.alignOptions;
+    const size_t alignmentMethod = alignOptions.alignMethod;
 
 
     // Align4-specific items.
-    Align4::Options align4Options;
+    const Align4::Options align4Options = getAlign4Options(alignOptions);
+    const size_t temporaryDataPageSize = alignmentTemporaryDataPageSize();
     MemoryMapped::ByteAllocator byteAllocator;
     if(alignmentMethod == 4) {
-        align4Options.deltaX = data.alignOptions->align4DeltaX;
-        align4Options.deltaY = data.alignOptions->align4DeltaY;
-        align4Options.minEntryCountPerCell = data.alignOptions->align4MinEntryCountPerCell;
-        align4Options.maxDistanceFromBoundary = data.alignOptions->align4MaxDistanceFromBoundary;
-        align4Options.minAlignedMarkerCount = minAlignedMarkerCount;
-        align4Options.minAlignedFraction = minAlignedFraction;
-        align4Options.maxSkip = maxSkip;
-        align4Options.maxDrift = maxDrift;
-        align4Options.maxTrim = maxTrim;
-        align4Options.maxBand = maxBand;
-        align4Options.matchScore = matchScore;
-        align4Options.mismatchScore = mismatchScore;
-        align4Options.gapScore = gapScore;
         byteAllocator.createNew(
-            largeDataName("tmp-ByteAllocator-" + to_string(threadId)),
-            largeDataPageSize, 2ULL * 1024 * 1024 * 1024);
+            alignmentTemporaryDataName("ByteAllocator-" + to_string(threadId)),
+            temporaryDataPageSize, 2ULL * 1024 * 1024 * 1024);
     }
 
     vector<AlignmentData>& threadAlignmentData = data.threadAlignmentData[threadId];
-    
+    vector<uint64_t>& threadCandidateIndexes = data.threadCandidateIndexes[threadId];
+    threadAlignmentData.clear();
+    threadCandidateIndexes.clear();
+
     shared_ptr< MemoryMapped::VectorOfVectors<char, uint64_t> > thisThreadCompressedAlignmentsPointer =
         make_shared< MemoryMapped::VectorOfVectors<char, uint64_t> >();
     data.threadCompressedAlignments[threadId] = thisThreadCompressedAlignmentsPointer;
     auto& thisThreadCompressedAlignments = *thisThreadCompressedAlignmentsPointer;
     thisThreadCompressedAlignments.createNew(
-        largeDataName("tmp-ThreadGlobalCompressedAlignments-" + to_string(threadId)),
-        largeDataPageSize);
+        alignmentTemporaryDataName("ThreadGlobalCompressedAlignments-" + to_string(threadId)),
+        temporaryDataPageSize);
 
     uint64_t begin, end;
     while(getNextBatch(begin, end)) {
+        begin += data.candidateBegin;
+        end += data.candidateBegin;
         if((begin % 1000000) == 0){
             std::lock_guard<std::mutex> lock(mutex);
             performanceLog << timestamp << "Working on alignment " << begin;
@@ -384,38 +429,14 @@ void Assembler::computeAlignmentsThreadFunction(size_t threadId)
 
 
             // Compute the alignment.
+            const AlignmentCandidateBand* bandHint =
+                data.useBandHints ? &alignmentCandidates.bands[i] : 0;
+            bool isGood = false;
             try {
-                if(alignmentMethod == 0) {
-
-                    // Get the markers for the two oriented reads in this candidate.
-                    for(size_t j=0; j<2; j++) {
-                        getMarkersSortedByKmerId(orientedReadIds[j], markersSortedByKmerId[j]);
-                    }
-
-                    // Compute the Alignment.
-                    alignOrientedReads(
-                        markersSortedByKmerId,
-                        maxSkip, maxDrift, maxMarkerFrequency, debug, graph, alignment, alignmentInfo);
-
-                } else if(alignmentMethod == 1) {
-                    alignOrientedReads1(orientedReadIds[0], orientedReadIds[1],
-                        matchScore, mismatchScore, gapScore,
-                        alignment, alignmentInfo);
-                } else if(alignmentMethod == 3) {
-                    alignOrientedReads3(orientedReadIds[0], orientedReadIds[1],
-                        matchScore, mismatchScore, gapScore,
-                        downsamplingFactor, bandExtend, maxBand,
-                        alignment, alignmentInfo);
-                } else if(alignmentMethod == 4) {
-                    alignOrientedReads4(orientedReadIds[0], orientedReadIds[1],
-                        align4Options,
-                        byteAllocator,
-                        alignment, alignmentInfo,
-                        false);
-                    SHASTA_ASSERT(byteAllocator.isEmpty());
-                } else {
-                    SHASTA_ASSERT(0);
-                }
+                isGood = computeAlignment(orientedReadIds,
+                    alignOptions, align4Options, byteAllocator,
+                    markersSortedByKmerId, graph, alignment, alignmentInfo,
+                    bandHint);
             } catch (std::exception& e) {
                 std::lock_guard<std::mutex> lock(mutex);
                 cout <<
@@ -432,48 +453,13 @@ void Assembler::computeAlignmentsThreadFunction(size_t threadId)
                     ". This alignment candidate will be skipped. " << endl;
                 continue;
             }
-
-
-
-            // If the alignment has too few markers, skip it.
-            if(alignment.ordinals.size() < minAlignedMarkerCount) {
-                // cout << orientedReadIds[0] << " " << orientedReadIds[1] << " too few markers." << endl;
-                continue;
-            }
-
-            // If the aligned fraction is too small, skip it.
-            if(min(alignmentInfo.alignedFraction(0), alignmentInfo.alignedFraction(1)) < minAlignedFraction) {
-                continue;
-            }
-
-            // If the alignment has too much trim, skip it.
-            uint32_t leftTrim;
-            uint32_t rightTrim;
-            tie(leftTrim, rightTrim) = alignmentInfo.computeTrim();
-            if(leftTrim>maxTrim || rightTrim>maxTrim) {
-                // cout << orientedReadIds[0] << " " << orientedReadIds[1] << " too much trim." << endl;
-                continue;
-            }
-
-            // For alignment methods other than method 0, we also need to check for
-            // maxSip and maxDrift. Method 0 does that automatically.
-            if(alignmentMethod != 0) {
-                if(alignment.maxSkip() > maxSkip) {
-                    continue;
-                }
-                if(alignment.maxDrift() > maxDrift) {
-                    continue;
-                }
-            }
-
-            // Skip containing alignments, if so requested.
-            if(suppressContainments and alignmentInfo.isContaining(uint32_t(maxTrim))) {
+            if(not isGood) {
                 continue;
             }
 
             // If getting here, this is a good alignment.
-            // cout << orientedReadIds[0] << " " << orientedReadIds[1] << " good." << endl;
             threadAlignmentData.push_back(AlignmentData(candidate, alignmentInfo));
+            threadCandidateIndexes.push_back(i);
 
             // Store the alignment in compressed form.
             shasta::compress(alignment, compressedAlignment);
@@ -496,6 +482,263 @@ void Assembler::computeAlignmentsThreadFunction(size_t threadId)
 
 
 
+// Get the options for alignment method 4 from the AlignOptions.
+Align4::Options Assembler::getAlign4Options(const AlignOptions& alignOptions)
+{
+    Align4::Options align4Options;
+    align4Options.deltaX = alignOptions.align4DeltaX;
+    align4Options.deltaY = alignOptions.align4DeltaY;
+    align4Options.minEntryCountPerCell = alignOptions.align4MinEntryCountPerCell;
+    align4Options.maxDistanceFromBoundary = alignOptions.align4MaxDistanceFromBoundary;
+    align4Options.minAlignedMarkerCount = alignOptions.minAlignedMarkerCount;
+    align4Options.minAlignedFraction = alignOptions.minAlignedFraction;
+    align4Options.maxSkip = alignOptions.maxSkip;
+    align4Options.maxDrift = alignOptions.maxDrift;
+    align4Options.maxTrim = alignOptions.maxTrim;
+    align4Options.maxBand = alignOptions.maxBand;
+    align4Options.matchScore = alignOptions.matchScore;
+    align4Options.mismatchScore = alignOptions.mismatchScore;
+    align4Options.gapScore = alignOptions.gapScore;
+    return align4Options;
+}
+
+
+
+// Compute the alignment of two oriented reads using the alignment method
+// specified in the AlignOptions, and return true if the alignment
+// satisfies the criteria used by computeAlignments to store it.
+// The remaining arguments are work areas that can be reused between calls.
+// The ByteAllocator is only used by alignment method 4.
+bool Assembler::computeAlignment(
+    const array<OrientedReadId, 2>& orientedReadIds,
+    const AlignOptions& alignOptions,
+    const Align4::Options& align4Options,
+    MemoryMapped::ByteAllocator& byteAllocator,
+    array<vector<MarkerWithOrdinal>, 2>& markersSortedByKmerId,
+    AlignmentGraph& graph,
+    Alignment& alignment,
+    AlignmentInfo& alignmentInfo,
+    const AlignmentCandidateBand* bandHint)
+{
+    const bool debug = false;
+    const size_t alignmentMethod = alignOptions.alignMethod;
+    const uint32_t maxMarkerFrequency = alignOptions.maxMarkerFrequency;
+    const size_t maxSkip = alignOptions.maxSkip;
+    const size_t maxDrift = alignOptions.maxDrift;
+    const size_t minAlignedMarkerCount = alignOptions.minAlignedMarkerCount;
+    const double minAlignedFraction = alignOptions.minAlignedFraction;
+    const size_t maxTrim = alignOptions.maxTrim;
+    const int matchScore = alignOptions.matchScore;
+    const int mismatchScore = alignOptions.mismatchScore;
+    const int gapScore = alignOptions.gapScore;
+    const double downsamplingFactor = alignOptions.downsamplingFactor;
+    const int bandExtend = alignOptions.bandExtend;
+    const int maxBand = alignOptions.maxBand;
+    const bool suppressContainments = alignOptions.suppressContainments;
+
+    // If we have a band hint, turn it into a band in terms of
+    // ordinal0 - ordinal1, as used by SeqAn.
+    // Don't use it if it is too wide, because then the features
+    // found during candidate discovery were not consistent,
+    // and the aligner is better off finding the band by itself.
+    pair<int32_t, int32_t> band;
+    const pair<int32_t, int32_t>* bandPointer = 0;
+    if(bandHint and alignOptions.bandHintExtend >= 0) {
+        const int64_t halfWidth = int64_t(bandHint->spread) + alignOptions.bandHintExtend;
+        if(2 * halfWidth <= maxBand) {
+            band.first = -bandHint->offset - int32_t(halfWidth);
+            band.second = -bandHint->offset + int32_t(halfWidth);
+            bandPointer = &band;
+        }
+    }
+
+    // Compute the alignment.
+    if(alignmentMethod == 0) {
+
+        // Get the markers for the two oriented reads.
+        for(size_t j=0; j<2; j++) {
+            getMarkersSortedByKmerId(orientedReadIds[j], markersSortedByKmerId[j]);
+        }
+
+        // Compute the Alignment.
+        alignOrientedReads(
+            markersSortedByKmerId,
+            maxSkip, maxDrift, maxMarkerFrequency, alignOptions.method0DynamicProgramming, debug,
+            graph, alignment, alignmentInfo);
+
+    } else if(alignmentMethod == 1) {
+        alignOrientedReads1(orientedReadIds[0], orientedReadIds[1],
+            matchScore, mismatchScore, gapScore,
+            alignment, alignmentInfo);
+    } else if(alignmentMethod == 3) {
+        alignOrientedReads3(orientedReadIds[0], orientedReadIds[1],
+            matchScore, mismatchScore, gapScore,
+            downsamplingFactor, bandExtend, maxBand,
+            alignment, alignmentInfo, bandPointer);
+    } else if(alignmentMethod == 4) {
+        alignOrientedReads4(orientedReadIds[0], orientedReadIds[1],
+            align4Options,
+            byteAllocator,
+            alignment, alignmentInfo,
+            false, bandPointer);
+        SHASTA_ASSERT(byteAllocator.isEmpty());
+    } else {
+        SHASTA_ASSERT(0);
+    }
+
+
+
+    // If the alignment has too few markers, skip it.
+    if(alignment.ordinals.size() < minAlignedMarkerCount) {
+        return false;
+    }
+
+    // If the aligned fraction is too small, skip it.
+    if(min(alignmentInfo.alignedFraction(0), alignmentInfo.alignedFraction(1)) < minAlignedFraction) {
+        return false;
+    }
+
+    // If the alignment has too much trim, skip it.
+    uint32_t leftTrim;
+    uint32_t rightTrim;
+    tie(leftTrim, rightTrim) = alignmentInfo.computeTrim();
+    if(leftTrim>maxTrim || rightTrim>maxTrim) {
+        return false;
+    }
+
+    // For alignment methods other than method 0, we also need to check for
+    // maxSip and maxDrift. Method 0 does that automatically.
+    if(alignmentMethod != 0) {
+        if(alignment.maxSkip() > maxSkip) {
+            return false;
+        }
+        if(alignment.maxDrift() > maxDrift) {
+            return false;
+        }
+    }
+
+    // Skip containing alignments, if so requested.
+    if(suppressContainments and alignmentInfo.isContaining(uint32_t(maxTrim))) {
+        return false;
+    }
+
+    return true;
+}
+
+
+
+string Assembler::alignmentTemporaryDataName(const string& name) const
+{
+    const string& shardDirectory = computeAlignmentsData.shardDirectory;
+    if(shardDirectory.empty()) {
+        return largeDataName("tmp-" + name);
+    } else {
+        return shardDirectory + "/tmp-" + name;
+    }
+}
+
+
+
+size_t Assembler::alignmentTemporaryDataPageSize() const
+{
+    return computeAlignmentsData.shardDirectory.empty() ? largeDataPageSize : 4096;
+}
+
+
+
+// Compute alignments for a batch of pairs of oriented reads, using multiple threads.
+// This does not use or modify the stored alignments.
+void Assembler::alignOrientedReadPairs(
+    const vector< array<OrientedReadId, 2> >& orientedReadIdPairs,
+    const AlignOptions& alignOptions,
+    size_t threadCount,
+    vector<AlignmentInfo>& alignmentInfos,
+    vector<uint8_t>& isGood)
+{
+    // Check that we have what we need.
+    reads->checkReadsAreOpen();
+    checkMarkersAreOpen();
+    const ReadId orientedReadCount = ReadId(markers.size());
+    for(const auto& orientedReadIdPair: orientedReadIdPairs) {
+        for(const OrientedReadId orientedReadId: orientedReadIdPair) {
+            if(orientedReadId.getValue() >= orientedReadCount) {
+                throw runtime_error("Invalid oriented read id " + orientedReadId.getString());
+            }
+        }
+    }
+
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    // Store parameters so they are accessible to the threads.
+    alignmentInfos.clear();
+    alignmentInfos.resize(orientedReadIdPairs.size());
+    isGood.clear();
+    isGood.resize(orientedReadIdPairs.size(), 0);
+    auto& data = alignOrientedReadPairsData;
+    data.orientedReadIdPairs = &orientedReadIdPairs;
+    data.alignOptions = &alignOptions;
+    data.alignmentInfos = &alignmentInfos;
+    data.isGood = &isGood;
+
+    setupLoadBalancing(orientedReadIdPairs.size(), 1);
+    runThreads(&Assembler::alignOrientedReadPairsThreadFunction, threadCount);
+
+    data = AlignOrientedReadPairsData();
+}
+
+
+
+void Assembler::alignOrientedReadPairsThreadFunction(size_t threadId)
+{
+    array<vector<MarkerWithOrdinal>, 2> markersSortedByKmerId;
+    AlignmentGraph graph;
+    Alignment alignment;
+    AlignmentInfo alignmentInfo;
+
+    auto& data = alignOrientedReadPairsData;
+    const AlignOptions& alignOptions = *data.alignOptions;
+    const Align4::Options align4Options = getAlign4Options(alignOptions);
+    MemoryMapped::ByteAllocator byteAllocator;
+    if(alignOptions.alignMethod == 4) {
+        byteAllocator.createNew(
+            alignmentTemporaryDataName("AlignOrientedReadPairs-ByteAllocator-" + to_string(threadId)),
+            alignmentTemporaryDataPageSize(), 2ULL * 1024 * 1024 * 1024);
+    }
+
+    // If an alignment fails, the pair is left flagged as not good.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(uint64_t i=begin; i!=end; i++) {
+            const array<OrientedReadId, 2>& orientedReadIds = (*data.orientedReadIdPairs)[i];
+            try {
+                const bool isGood = computeAlignment(orientedReadIds,
+                    alignOptions, align4Options, byteAllocator,
+                    markersSortedByKmerId, graph, alignment, alignmentInfo);
+                (*data.alignmentInfos)[i] = alignmentInfo;
+                (*data.isGood)[i] = isGood ? 1 : 0;
+            } catch (std::exception& e) {
+                std::lock_guard<std::mutex> lock(mutex);
+                cout <<
+                    "An error occurred while computing a marker alignment "
+                    " of oriented reads " << orientedReadIds[0] << " and " << orientedReadIds[1] <<
+                    ". This pair will be flagged as not good. Error description is: " <<
+                    e.what() << endl;
+            } catch(...) {
+                std::lock_guard<std::mutex> lock(mutex);
+                cout <<
+                    "An error occurred while computing a marker alignment "
+                    " of oriented reads " << orientedReadIds[0] << " and " << orientedReadIds[1] <<
+                    ". This pair will be flagged as not good. " << endl;
+            }
+        }
+    }
+}
+
+
+
 void Assembler::accessCompressedAlignments()
 {
     compressedAlignments.accessExistingReadOnly(
@@ -672,6 +915,7 @@ void Assembler::flagPalindromicReads(
     flagPalindromicReadsData.alignedFractionThreshold = alignedFractionThreshold;
     flagPalindromicReadsData.nearDiagonalFractionThreshold = nearDiagonalFractionThreshold;
     flagPalindromicReadsData.deltaThreshold = deltaThreshold;
+    flagPalindromicReadsData.alignedReadCount = 0;
 
     // Reset all palindromic flags.
     reads->assertReadsAndFlagsOfSameSize();
@@ -692,6 +936,8 @@ void Assembler::flagPalindromicReads(
         }
     }
     assemblerInfo->palindromicReadCount = palindromicReadCount;
+    performanceLog << timestamp << "A marker alignment was needed for " <<
+        flagPalindromicReadsData.alignedReadCount << " reads out of " << readCount << endl;
     cout << "Flagged " << palindromicReadCount <<
         " reads as palindromic out of " << readCount << " total." << endl;
     cout << "Palindromic fraction is " <<
@@ -701,6 +947,77 @@ void Assembler::flagPalindromicReads(
 
 
 
+// Compute upper bounds for the number of aligned markers, and for the number
+// of aligned markers near the diagonal, in a marker alignment of an oriented read
+// (markers0) with its reverse complement (markers1).
+// Each aligned marker pairs a marker of markers0 with a marker
+// of markers1 with the same KmerId, and each marker of markers0
+// appears at most once in the alignment.
+// Therefore the number of aligned markers cannot exceed the number of
+// markers of markers0 for which the same KmerId appears in markers1.
+// Similarly, the number of aligned markers near the diagonal
+// cannot exceed the number of markers of markers0 for which
+// the same KmerId appears in markers1 at an ordinal offset less than deltaThreshold.
+// This is computed in linear time using a sliding window over markers1.
+// The two maps are work areas.
+static void computePalindromicAlignmentBounds(
+    span<const CompressedMarker> markers0,
+    span<const CompressedMarker> markers1,
+    uint32_t deltaThreshold,
+    std::unordered_map<KmerId, uint32_t>& kmerIds1,
+    std::unordered_map<KmerId, uint32_t>& windowKmerIds1,
+    uint64_t& alignedMarkerCountBound,
+    uint64_t& nearDiagonalMarkerCountBound)
+{
+    SHASTA_ASSERT(markers0.size() == markers1.size());
+    const int64_t n = int64_t(markers0.size());
+
+    kmerIds1.clear();
+    for(const CompressedMarker& marker: markers1) {
+        ++kmerIds1[marker.kmerId];
+    }
+    alignedMarkerCountBound = 0;
+    for(const CompressedMarker& marker: markers0) {
+        if(kmerIds1.find(marker.kmerId) != kmerIds1.end()) {
+            ++alignedMarkerCountBound;
+        }
+    }
+
+    // The window for ordinal0 contains the markers1 with
+    // ordinal1 in [ordinal0 - deltaThreshold + 1, ordinal0 + deltaThreshold - 1].
+    nearDiagonalMarkerCountBound = 0;
+    if(deltaThreshold == 0) {
+        return;
+    }
+    const int64_t halfWidth = int64_t(deltaThreshold) - 1;
+    windowKmerIds1.clear();
+    for(int64_t ordinal1=0; ordinal1<min(n, halfWidth); ordinal1++) {
+        ++windowKmerIds1[markers1[ordinal1].kmerId];
+    }
+    for(int64_t ordinal0=0; ordinal0<n; ordinal0++) {
+
+        // Update the window.
+        const int64_t ordinal1Added = ordinal0 + halfWidth;
+        if(ordinal1Added < n) {
+            ++windowKmerIds1[markers1[ordinal1Added].kmerId];
+        }
+        const int64_t ordinal1Removed = ordinal0 - halfWidth - 1;
+        if(ordinal1Removed >= 0) {
+            const auto it = windowKmerIds1.find(markers1[ordinal1Removed].kmerId);
+            SHASTA_ASSERT(it != windowKmerIds1.end());
+            if(--(it->second) == 0) {
+                windowKmerIds1.erase(it);
+            }
+        }
+
+        if(windowKmerIds1.find(markers0[ordinal0].kmerId) != windowKmerIds1.end()) {
+            ++nearDiagonalMarkerCountBound;
+        }
+    }
+}
+
+
+
 void Assembler::flagPalindromicReadsThreadFunction(size_t threadId)
 {
 
@@ -710,6 +1027,8 @@ void Assembler::flagPalindromicReadsThreadFunction(size_t threadId)
     Alignment alignment;
     AlignmentInfo alignmentInfo;
     array<vector<MarkerWithOrdinal>, 2> markersSortedByKmerId;
+    std::unordered_map<KmerId, uint32_t> kmerIds1;
+    std::unordered_map<KmerId, uint32_t> windowKmerIds1;
 
     // Make local copies of the parameters.
     const uint32_t maxSkip = flagPalindromicReadsData.maxSkip;
@@ -729,13 +1048,35 @@ void Assembler::flagPalindromicReadsThreadFunction(size_t threadId)
         // Loop over all reads in this batch.
         for(ReadId readId=ReadId(begin); readId!=ReadId(end); readId++) {
 
+            // Before computing the alignment, check upper bounds
+            // for the aligned fraction and near diagonal fraction.
+            // If either is below threshold, the read cannot be palindromic.
+            // The comparisons are done in the same way as for the
+            // alignment below, so the decision is the same.
+            {
+                const span<const CompressedMarker> markers0 = markers[OrientedReadId(readId, 0).getValue()];
+                const span<const CompressedMarker> markers1 = markers[OrientedReadId(readId, 1).getValue()];
+                uint64_t alignedMarkerCountBound;
+                uint64_t nearDiagonalMarkerCountBound;
+                computePalindromicAlignmentBounds(markers0, markers1, deltaThreshold,
+                    kmerIds1, windowKmerIds1, alignedMarkerCountBound, nearDiagonalMarkerCountBound);
+                const double totalMarkerCount = double(markers0.size());
+                if(double(alignedMarkerCountBound)/totalMarkerCount < alignedFractionThreshold) {
+                    continue;
+                }
+                if(double(nearDiagonalMarkerCountBound)/totalMarkerCount < nearDiagonalFractionThreshold) {
+                    continue;
+                }
+            }
+            __sync_fetch_and_add(&flagPalindromicReadsData.alignedReadCount, 1);
+
             // Get markers sorted by KmerId for this read and its reverse complement.
             for(Strand strand=0; strand<2; strand++) {
                 getMarkersSortedByKmerId(OrientedReadId(readId, strand), markersSortedByKmerId[strand]);
             }
 
             // Compute a marker alignment of this read versus its reverse complement.
-            alignOrientedReads(markersSortedByKmerId, maxSkip, maxDrift, maxMarkerFrequency, false,
+            alignOrientedReads(markersSortedByKmerId, maxSkip, maxDrift, maxMarkerFrequency, false, false,
                 graph, alignment, alignmentInfo);
 
             // If the alignment has too few markers, skip it.
@@ -1073,6 +1414,67 @@ void Assembler::writeAlignmentDetails() const
 }
 
 
+// Parse the meta data fields used by suppressAlignment, once for each read.
+void Assembler::computeSameChannelMetaData(size_t threadCount)
+{
+    auto& sameChannelMetaData = suppressAlignmentCandidatesData.sameChannelMetaData;
+    sameChannelMetaData.createNew(
+        largeDataName("tmp-SameChannelMetaData"), largeDataPageSize);
+    sameChannelMetaData.reserveAndResize(reads->readCount());
+
+    setupLoadBalancing(reads->readCount(), 10000);
+    runThreads(&Assembler::computeSameChannelMetaDataThreadFunction, threadCount);
+}
+
+
+
+void Assembler::computeSameChannelMetaDataThreadFunction(size_t /* threadId */)
+{
+    auto& sameChannelMetaData = suppressAlignmentCandidatesData.sameChannelMetaData;
+    const string chKey = "ch";
+    const string sampleidKey = "sampleid";
+    const string runidKey = "runid";
+    const string readKey = "read";
+
+    auto hashValue = [](const span<const char>& value)
+    {
+        return MurmurHash64A(value.data(), int(value.size()), 759);
+    };
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(ReadId readId=ReadId(begin); readId!=ReadId(end); readId++) {
+            SameChannelMetaData& m = sameChannelMetaData[readId];
+            m.isValid = false;
+
+            const auto ch = reads->getMetaData(readId, chKey);
+            if(ch.empty()) {
+                continue;
+            }
+            const auto sampleid = reads->getMetaData(readId, sampleidKey);
+            if(sampleid.empty()) {
+                continue;
+            }
+            const auto runid = reads->getMetaData(readId, runidKey);
+            if(runid.empty()) {
+                continue;
+            }
+            const auto read = reads->getMetaData(readId, readKey);
+            if(read.empty()) {
+                continue;
+            }
+
+            m.chHash = hashValue(ch);
+            m.sampleidHash = hashValue(sampleid);
+            m.runidHash = hashValue(runid);
+            m.read = int64_t(atoul(read));
+            m.isValid = true;
+        }
+    }
+}
+
+
+
 // Check if an alignment between two reads should be suppressed,
 // bases on the setting of command line option
 // --Align.sameChannelReadAlignment.suppressDeltaThreshold.
@@ -1081,84 +1483,43 @@ bool Assembler::suppressAlignment(
     ReadId readId1,
     uint64_t delta)
 {
+    const SameChannelMetaData& m0 = suppressAlignmentCandidatesData.sameChannelMetaData[readId0];
+    const SameChannelMetaData& m1 = suppressAlignmentCandidatesData.sameChannelMetaData[readId1];
 
-    // If the ch meta data fields of the two reads are missing or different,
+    // If any of the meta data fields of the two reads are missing,
     // don't suppress the alignment.
-    // Check the channel first for efficiency,
-    // so we can return faster in most cases.
-    const auto ch0 = reads->getMetaData(readId0, "ch");
-    if(ch0.empty()) {
+    if(not (m0.isValid and m1.isValid)) {
         return false;
     }
-    const auto ch1 = reads->getMetaData(readId1, "ch");
-    if(ch1.empty()) {
-        return false;
-    }
-    if(ch0 not_eq ch1) {
-        return false;
-    }
-
 
-
-    // If the sampleid meta data fields of the two reads are missing or different,
+    // If the ch, sampleid, or runid meta data fields of the two reads are different,
     // don't suppress the alignment.
-    const auto sampleid0 = reads->getMetaData(readId0, "sampleid");
-    if(sampleid0.empty()) {
+    if(m0.chHash != m1.chHash) {
         return false;
     }
-    const auto sampleid1 = reads->getMetaData(readId1, "sampleid");
-    if(sampleid1.empty()) {
+    if(m0.sampleidHash != m1.sampleidHash) {
         return false;
     }
-    if(sampleid0 not_eq sampleid1) {
+    if(m0.runidHash != m1.runidHash) {
         return false;
     }
 
-
-
-    // If the runid meta data fields of the two reads are missing or different,
-    // don't suppress the alignment.
-    const auto runid0 = reads->getMetaData(readId0, "runid");
-    if(runid0.empty()) {
-        return false;
-    }
-    const auto runid1 = reads->getMetaData(readId1, "runid");
-    if(runid1.empty()) {
-        return false;
-    }
-    if(runid0 not_eq runid1) {
+    // Don't suppress the alignment if the absolute difference of the
+    // read meta data fields is not less than delta.
+    if(abs(m0.read - m1.read) >= int64_t(delta)) {
         return false;
     }
 
-    // cout << "Checking " << readId0 << " " << readId1 << endl;
-
-
-    // If the read meta data fields of the two reads are missing,
-    // don't suppress the alignment.
-    const auto read0 = reads->getMetaData(readId0, "read");
-    if(read0.empty()) {
-        return false;
-    }
-    const auto read1 = reads->getMetaData(readId1, "read");
-    if(read1.empty()) {
-        return false;
+    // We are about to suppress the alignment.
+    // Guard against hash collisions by comparing the meta data strings.
+    for(const string key: {"ch", "sampleid", "runid"}) {
+        const auto value0 = reads->getMetaData(readId0, key);
+        const auto value1 = reads->getMetaData(readId1, key);
+        if(not std::ranges::equal(value0, value1)) {
+            return false;
+        }
     }
-    // cout << read0 << " " << read1 << endl;
-
-
-
-    // Convert the read meta data fields to integers.
-    // Keep in mind the span<char> is not null-terminated.
-    const int64_t r0 = int64_t(atoul(read0));
-    const int64_t r1 = int64_t(atoul(read1));
-    // cout << r0 << " " << r1 << endl;
-
-
-
-    // Suppress the alignment if the absolute difference of the
-    // read meta data fields is less than delta.
-    return abs(r0 - r1) < int64_t(delta);
-
+    return true;
 }
 
 
@@ -1171,70 +1532,170 @@ void Assembler::suppressAlignmentCandidates(
 {
     performanceLog << timestamp << "Suppressing alignment candidates." << endl;
 
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    SuppressAlignmentCandidatesData& data = suppressAlignmentCandidatesData;
+
+    // Parse the meta data we need, once for each read.
+    computeSameChannelMetaData(threadCount);
+
     // Allocate memory for flags to keep track of which alignments
     // should be suppressed.
-    suppressAlignmentCandidatesData.suppress.createNew(
+    data.suppress.createNew(
         largeDataName("tmp-suppressAlignmentCandidates"), largeDataPageSize);
     const uint64_t candidateCount = alignmentCandidates.candidates.size();
-    suppressAlignmentCandidatesData.suppress.resize(candidateCount);
-
-    // Figure out which candidates should be suppressed.
-    suppressAlignmentCandidatesData.delta = delta;
-    const uint64_t batchSize = 10000;
-    setupLoadBalancing(alignmentCandidates.candidates.size(), batchSize);
-    runThreads(&Assembler::suppressAlignmentCandidatesThreadFunction, threadCount);
+    data.suppress.resize(candidateCount);
+
+    // Figure out which candidates should be suppressed,
+    // and count the candidates we keep in each batch.
+    data.delta = delta;
+    data.batchSize = 10000;
+    const uint64_t batchCount = (candidateCount + data.batchSize - 1) / data.batchSize;
+    data.batchKeptCount.clear();
+    data.batchKeptCount.resize(batchCount + 1, 0);
+    setupLoadBalancing(candidateCount, data.batchSize);
+    runThreads(&Assembler::suppressAlignmentCandidatesThreadFunction1, threadCount);
+
+    // Prefix sum of the number of candidates kept in each batch.
+    uint64_t keptCount = 0;
+    for(uint64_t& n: data.batchKeptCount) {
+        const uint64_t batchKeptCount = n;
+        n = keptCount;
+        keptCount += batchKeptCount;
+    }
+    const uint64_t suppressCount = candidateCount - keptCount;
+
+    // Gather the candidates we keep, then copy them back.
+    data.keptCandidates.createNew(
+        largeDataName("tmp-suppressAlignmentCandidates-kept"), largeDataPageSize);
+    data.keptCandidates.reserveAndResize(keptCount);
+    // Bands that don't correspond to the alignment candidates are stale.
+    if(alignmentCandidates.bands.isOpen and alignmentCandidates.bands.size() != candidateCount) {
+        removeAlignmentCandidateBands();
+    }
+    const bool hasBands = alignmentCandidates.bands.isOpen;
+    if(hasBands) {
+        data.keptBands.createNew(
+            largeDataName("tmp-suppressAlignmentCandidates-keptBands"), largeDataPageSize);
+        data.keptBands.reserveAndResize(keptCount);
+    }
+    setupLoadBalancing(candidateCount, data.batchSize);
+    runThreads(&Assembler::suppressAlignmentCandidatesThreadFunction2, threadCount);
 
+    // Write the suppressed candidates.
+    // This must be done before the kept candidates are copied back.
+    // Don't bother scanning when nothing was suppressed.
     ofstream csv("SuppressedAlignmentCandidates.csv");
     csv << "ReadId0,ReadId1,SameStrand,Name0,Name1,MetaData0,MetaData1" << endl;
-
-    // Suppress the alignment candidates we flagged.
-    cout << "Number of alignment candidates before suppression is " << candidateCount << endl;
-    uint64_t j = 0;
-    uint64_t suppressCount = 0;
-    for(uint64_t i=0; i<candidateCount; i++) {
-        if(suppressAlignmentCandidatesData.suppress[i]) {
-            ++suppressCount;
-            const ReadId readId0 = alignmentCandidates.candidates[i].readIds[0];
-            const ReadId readId1 = alignmentCandidates.candidates[i].readIds[1];
-            csv << readId0 << "," << readId1 << ","
-                << (alignmentCandidates.candidates[i].isSameStrand ? "Yes" : "No") << ","
-                << reads->getReadName(readId0) << "," << reads->getReadName(readId1) << ","
-                << reads->getReadMetaData(readId0) << "," << reads->getReadMetaData(readId1) << endl;
-        } else {
-            alignmentCandidates.candidates[j++] =
-                alignmentCandidates.candidates[i];
+    if(suppressCount > 0) {
+        for(uint64_t i=0; i<candidateCount; i++) {
+            if(data.suppress[i]) {
+                const ReadId readId0 = alignmentCandidates.candidates[i].readIds[0];
+                const ReadId readId1 = alignmentCandidates.candidates[i].readIds[1];
+                csv << readId0 << "," << readId1 << ","
+                    << (alignmentCandidates.candidates[i].isSameStrand ? "Yes" : "No") << ","
+                    << reads->getReadName(readId0) << "," << reads->getReadName(readId1) << ","
+                    << reads->getReadMetaData(readId0) << "," << reads->getReadMetaData(readId1) << endl;
+            }
         }
     }
-    SHASTA_ASSERT(j + suppressCount == candidateCount);
-    alignmentCandidates.candidates.resize(j);
+
+    alignmentCandidates.candidates.resize(keptCount);
+    if(hasBands) {
+        alignmentCandidates.bands.resize(keptCount);
+    }
+    setupLoadBalancing(keptCount, data.batchSize);
+    runThreads(&Assembler::suppressAlignmentCandidatesThreadFunction3, threadCount);
+
+    cout << "Number of alignment candidates before suppression is " << candidateCount << endl;
     cout << "Suppressed " << suppressCount << " alignment candidates." << endl;
-    cout << "Number of alignment candidates after suppression is " << j << endl;
+    cout << "Number of alignment candidates after suppression is " << keptCount << endl;
 
 
     // Clean up.
-    suppressAlignmentCandidatesData.suppress.remove();
+    data.suppress.remove();
+    data.keptCandidates.remove();
+    if(hasBands) {
+        data.keptBands.remove();
+    }
+    data.sameChannelMetaData.remove();
+    data.batchKeptCount.clear();
+    data.batchKeptCount.shrink_to_fit();
 
     performanceLog << timestamp << "Done suppressing alignment candidates." << endl;
 }
 
 
 
-void Assembler::suppressAlignmentCandidatesThreadFunction(size_t threadId)
+// Flag the candidates to be suppressed and count the ones we keep in each batch.
+void Assembler::suppressAlignmentCandidatesThreadFunction1(size_t /* threadId */)
 {
-    const uint64_t delta = suppressAlignmentCandidatesData.delta;
+    SuppressAlignmentCandidatesData& data = suppressAlignmentCandidatesData;
+    const uint64_t delta = data.delta;
 
     // Loop over batches assigned to this thread.
     uint64_t begin, end;
     while(getNextBatch(begin, end)) {
 
         // Loop over candidate alignments in this batch.
+        uint64_t keptCount = 0;
         for(uint64_t i=begin; i!=end; i++) {
             const OrientedReadPair& p = alignmentCandidates.candidates[i];
-            // cout << "Checking " << p.readIds[0] << " " << p.readIds[1] <<  " " << int(p.isSameStrand) << endl;
-            suppressAlignmentCandidatesData.suppress[i] =
-                suppressAlignment(p.readIds[0], p.readIds[1], delta);
+            const bool suppress = suppressAlignment(p.readIds[0], p.readIds[1], delta);
+            data.suppress[i] = suppress;
+            if(not suppress) {
+                ++keptCount;
+            }
+        }
+        data.batchKeptCount[begin / data.batchSize] = keptCount;
+    }
+}
+
+
+
+// Copy the candidates we keep to keptCandidates,
+// and their bands to keptBands, if available.
+// Each batch writes to its own range of keptCandidates.
+void Assembler::suppressAlignmentCandidatesThreadFunction2(size_t /* threadId */)
+{
+    SuppressAlignmentCandidatesData& data = suppressAlignmentCandidatesData;
+    const bool hasBands = alignmentCandidates.bands.isOpen;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        uint64_t j = data.batchKeptCount[begin / data.batchSize];
+        for(uint64_t i=begin; i!=end; i++) {
+            if(not data.suppress[i]) {
+                if(hasBands) {
+                    data.keptBands[j] = alignmentCandidates.bands[i];
+                }
+                data.keptCandidates[j++] = alignmentCandidates.candidates[i];
+            }
         }
+        SHASTA_ASSERT(j == data.batchKeptCount[begin / data.batchSize + 1]);
+    }
+}
+
+
 
+// Copy keptCandidates back to alignmentCandidates.candidates,
+// and keptBands back to alignmentCandidates.bands, if available.
+void Assembler::suppressAlignmentCandidatesThreadFunction3(size_t /* threadId */)
+{
+    SuppressAlignmentCandidatesData& data = suppressAlignmentCandidatesData;
+    const bool hasBands = alignmentCandidates.bands.isOpen;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        copy(data.keptCandidates.begin() + begin, data.keptCandidates.begin() + end,
+            alignmentCandidates.candidates.begin() + begin);
+        if(hasBands) {
+            copy(data.keptBands.begin() + begin, data.keptBands.begin() + end,
+                alignmentCandidates.bands.begin() + begin);
+        }
     }
 }
 
@@ -88,10 +88,12 @@ void Assembler::alignOrientedReads1(
     bool replacementIsNeeded = false;
     const KmerId seqanGapValue = 45;
     KmerId replacementValue = seqanGapValue;
-    if(kmerTable[seqanGapValue].isMarker) {
+    const KmerChecker kmerChecker = getKmerChecker();
+    if(kmerChecker.isMarker(seqanGapValue)) {
         replacementIsNeeded = true;
-        for(uint64_t i=0; i<kmerTable.size(); i++) {
-            if(!kmerTable[i].isMarker) {
+        const uint64_t maxKmerId = (~0ULL) >> (64 - 2 * assemblerInfo->k);
+        for(uint64_t i=0; i<maxKmerId; i++) {
+            if(!kmerChecker.isMarker(KmerId(i))) {
                 replacementValue = KmerId(i);
                 break;
             }
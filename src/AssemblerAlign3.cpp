@@ -19,6 +19,9 @@ using namespace shasta;
 //    sequences for the two oriented reads.
 // 2. Use the downsampled alignment to compute a band.
 //    Then do a banded alignment using that band.
+// If a band hint is available (from the features found
+// during alignment candidate discovery), it is used as the band
+// and step 1 is skipped.
 
 void Assembler::alignOrientedReads3(
     OrientedReadId orientedReadId0,
@@ -30,7 +33,8 @@ void Assembler::alignOrientedReads3(
     int bandExtend,             // How much to extend the band computed in the first step.
     int maxBand,
     Alignment& alignment,
-    AlignmentInfo& alignmentInfo)
+    AlignmentInfo& alignmentInfo,
+    const pair<int32_t, int32_t>* bandHint)
 {
     const bool debug = false;
     if(debug) {
@@ -59,6 +63,142 @@ void Assembler::alignOrientedReads3(
     allMarkers[0] = markers[orientedReadId0.getValue()];
     allMarkers[1] = markers[orientedReadId1.getValue()];
 
+    // Compute the band, using the band hint if available,
+    // or else an alignment of downsampled markers.
+    // Note that the band could end up outside the alignment matrix.
+    // This is not a problem as SeqAn adjusts it accordingly.
+    int32_t bandMin;
+    int32_t bandMax;
+    if(bandHint) {
+        bandMin = bandHint->first;
+        bandMax = bandHint->second;
+    } else if(not computeAlignOrientedReads3Band(allMarkers,
+        matchScore, mismatchScore, gapScore,
+        downsamplingFactor, bandExtend,
+        bandMin, bandMax)) {
+
+        // The downsampled alignment is empty. Return an empty alignment.
+        alignment.clear();
+        alignmentInfo.create(
+            alignment, uint32_t(allMarkers[0].size()), uint32_t(allMarkers[1].size()));
+        return;
+    }
+    if(debug) {
+        cout << "Banded alignment will use band " << bandMin << " " << bandMax << endl;
+    }
+
+
+
+    // If the band is too wide, just return an empty alignment.
+    if((bandMax - bandMin) > maxBand) {
+        alignment.clear();
+        alignmentInfo.create(
+            alignment, uint32_t(allMarkers[0].size()), uint32_t(allMarkers[1].size()));
+        return;
+    }
+
+
+
+    // Now, do a alignment using this band and all markers.
+    array<TSequence, 2> sequences;
+    for(uint64_t i=0; i<2; i++) {
+        for(uint32_t ordinal=0; ordinal<uint32_t(allMarkers[i].size()); ordinal++) {
+            const KmerId kmerId = allMarkers[i][ordinal].kmerId;
+            appendValue(sequences[i], kmerId + 100);
+        }
+    }
+    TStringSet sequencesSet;
+    appendValue(sequencesSet, sequences[0]);
+    appendValue(sequencesSet, sequences[1]);
+    TAlignGraph graph(sequencesSet);
+    const int score = globalAlignment(
+        graph,
+        Score<int, Simple>(matchScore, mismatchScore, gapScore),
+        AlignConfig<true, true, true, true>(),
+        bandMin, bandMax,
+        LinearGaps());
+    if(debug) {
+        cout << "Full alignment score is " << score << endl;
+    }
+    if(score == seqan::MinValue<int>::VALUE) {
+        throw runtime_error("SeqAn banded alignment computation failed.");
+    }
+    TSequence align;
+    convertAlignment(graph, align);
+    const int totalAlignmentLength = int(seqan::length(align));
+    SHASTA_ASSERT((totalAlignmentLength % 2) == 0);    // Because we are aligning two sequences.
+    const int alignmentLength = totalAlignmentLength / 2;
+    if(debug) {
+        cout << "Full alignment length " << alignmentLength << endl;
+    }
+
+
+
+    // Fill in the alignment.
+    alignment.clear();
+    uint32_t ordinal0 = 0;
+    uint32_t ordinal1 = 0;
+    for(int i=0;
+        i<alignmentLength and ordinal0<allMarkers[0].size() and ordinal1<allMarkers[1].size(); i++) {
+        if( align[i] != seqanGapValue and
+            align[i + alignmentLength] != seqanGapValue and
+            allMarkers[0][ordinal0].kmerId == allMarkers[1][ordinal1].kmerId) {
+            alignment.ordinals.push_back(array<uint32_t, 2>{ordinal0, ordinal1});
+        }
+        if(align[i] != seqanGapValue) {
+            ++ordinal0;
+        }
+        if(align[i + alignmentLength] != seqanGapValue) {
+            ++ordinal1;
+        }
+    }
+
+    // Check how close to the band we got.
+    int32_t distanceToLowerDiagonal = std::numeric_limits<int32_t>::max();
+    int32_t distanceToUpperDiagonal = std::numeric_limits<int32_t>::max();
+    for(const auto& ordinals: alignment.ordinals) {
+        const int32_t offset = int32_t(ordinals[0]) - int32_t(ordinals[1]);
+        distanceToLowerDiagonal = min(distanceToLowerDiagonal, offset-bandMin);
+        distanceToUpperDiagonal = min(distanceToUpperDiagonal, bandMax-offset);
+    }
+    if(debug) {
+        cout << "Distance of alignment from band " <<
+            distanceToLowerDiagonal << " " << distanceToUpperDiagonal << endl;
+    }
+
+    // Store the alignment info.
+    alignmentInfo.create(alignment, uint32_t(allMarkers[0].size()), uint32_t(allMarkers[1].size()));
+
+}
+
+
+
+// Use an alignment of downsampled markers to compute the band
+// used by alignOrientedReads3. Returns false if the downsampled
+// alignment is empty.
+bool Assembler::computeAlignOrientedReads3Band(
+    const array<span<CompressedMarker>, 2>& allMarkers,
+    int matchScore,
+    int mismatchScore,
+    int gapScore,
+    double downsamplingFactor,  // The fraction of markers to keep.
+    int bandExtend,             // How much to extend the band computed from the downsampled alignment.
+    int32_t& bandMin,
+    int32_t& bandMax)
+{
+    const bool debug = false;
+
+    // Hide shasta::Alignment.
+    using namespace seqan;
+    using seqan::Alignment;
+    const uint32_t seqanGapValue = 45;
+
+    // SeqAn types we need.
+    using TSequence = String<KmerId>;
+    using TStringSet = StringSet<TSequence>;
+    using TDepStringSet = StringSet<TSequence, Dependent<> >;
+    using TAlignGraph = Graph<Alignment<TDepStringSet> >;
+
     // Vectors to contain downsampled markers.
     // For each of the two reads we store vectors of
     // (ordinal, KmerId).
@@ -70,10 +210,11 @@ void Assembler::alignOrientedReads3(
     // This means that we can't do k=16.
     const uint32_t hashThreshold =
         uint32_t(downsamplingFactor * double(std::numeric_limits<uint32_t>::max()));
+    const KmerChecker kmerChecker = getKmerChecker();
     for(uint64_t i=0; i<2; i++) {
         for(uint32_t ordinal=0; ordinal<uint32_t(allMarkers[i].size()); ordinal++) {
             const KmerId kmerId = allMarkers[i][ordinal].kmerId;
-             if(kmerTable[kmerId].hash < hashThreshold) {
+             if(kmerChecker.hash(kmerId) < hashThreshold) {
                 downsampledMarkers[i].push_back(make_pair(ordinal, kmerId));
                 appendValue(downsampledSequences[i], kmerId + 100);
             }
@@ -98,11 +239,8 @@ void Assembler::alignOrientedReads3(
     }
 
     if (downsampledMarkers[0].empty() or downsampledMarkers[1].empty()) {
-        // One of the downsampled sequences is empty. Return an empty alignment.
-        alignment.clear();
-        alignmentInfo.create(
-            alignment, uint32_t(allMarkers[0].size()), uint32_t(allMarkers[1].size()));
-        return;
+        // One of the downsampled sequences is empty.
+        return false;
     }
 
     // Use SeqAn to compute an alignment of the downsampled markers, free at both ends.
@@ -181,13 +319,10 @@ void Assembler::alignOrientedReads3(
 
 
 
-    // If the downsampled alignment is empty, just return an empty alignment.
+    // Check if the downsampled alignment is empty.
     if(uint64_t(downsampledAlignmentLength) ==
         downsampledMarkers[0].size() + downsampledMarkers[1].size()) {
-        alignment.clear();
-        alignmentInfo.create(
-            alignment, uint32_t(allMarkers[0].size()), uint32_t(allMarkers[1].size()));
-        return;
+        return false;
     }
 
 
@@ -219,96 +354,11 @@ void Assembler::alignOrientedReads3(
             ++i1;
         }
     }
-    const int32_t bandMin = offsetMin - bandExtend;
-    const int32_t bandMax = offsetMax + bandExtend;
-    // Note that the above band could end up outside the alignment matrix.
-    // This is not a problem as SeqAn adjusts it accordingly.
+    bandMin = offsetMin - bandExtend;
+    bandMax = offsetMax + bandExtend;
     if(debug) {
         cout << "Offset range " << offsetMin << " " << offsetMax << endl;
-        cout << "Banded alignment will use band " << bandMin << " " << bandMax << endl;
-    }
-
-
-
-    // If the band is too wide, just return an empty alignment.
-    if((bandMax - bandMin) > maxBand) {
-        alignment.clear();
-        alignmentInfo.create(
-            alignment, uint32_t(allMarkers[0].size()), uint32_t(allMarkers[1].size()));
-        return;
-    }
-
-
-
-    // Now, do a alignment using this band and all markers.
-    array<TSequence, 2> sequences;
-    for(uint64_t i=0; i<2; i++) {
-        for(uint32_t ordinal=0; ordinal<uint32_t(allMarkers[i].size()); ordinal++) {
-            const KmerId kmerId = allMarkers[i][ordinal].kmerId;
-            appendValue(sequences[i], kmerId + 100);
-        }
-    }
-    TStringSet sequencesSet;
-    appendValue(sequencesSet, sequences[0]);
-    appendValue(sequencesSet, sequences[1]);
-    TAlignGraph graph(sequencesSet);
-    const int score = globalAlignment(
-        graph,
-        Score<int, Simple>(matchScore, mismatchScore, gapScore),
-        AlignConfig<true, true, true, true>(),
-        bandMin, bandMax,
-        LinearGaps());
-    if(debug) {
-        cout << "Full alignment score is " << score << endl;
-    }
-    if(score == seqan::MinValue<int>::VALUE) {
-        throw runtime_error("SeqAn banded alignment computation failed.");
-    }
-    TSequence align;
-    convertAlignment(graph, align);
-    const int totalAlignmentLength = int(seqan::length(align));
-    SHASTA_ASSERT((totalAlignmentLength % 2) == 0);    // Because we are aligning two sequences.
-    const int alignmentLength = totalAlignmentLength / 2;
-    if(debug) {
-        cout << "Full alignment length " << alignmentLength << endl;
     }
 
-
-
-    // Fill in the alignment.
-    alignment.clear();
-    uint32_t ordinal0 = 0;
-    uint32_t ordinal1 = 0;
-    for(int i=0;
-        i<alignmentLength and ordinal0<allMarkers[0].size() and ordinal1<allMarkers[1].size(); i++) {
-        if( align[i] != seqanGapValue and
-            align[i + alignmentLength] != seqanGapValue and
-            allMarkers[0][ordinal0].kmerId == allMarkers[1][ordinal1].kmerId) {
-            alignment.ordinals.push_back(array<uint32_t, 2>{ordinal0, ordinal1});
-        }
-        if(align[i] != seqanGapValue) {
-            ++ordinal0;
-        }
-        if(align[i + alignmentLength] != seqanGapValue) {
-            ++ordinal1;
-        }
-    }
-
-    // Check how close to the band we got.
-    int32_t distanceToLowerDiagonal = std::numeric_limits<int32_t>::max();
-    int32_t distanceToUpperDiagonal = std::numeric_limits<int32_t>::max();
-    for(const auto& ordinals: alignment.ordinals) {
-        const int32_t offset = int32_t(ordinals[0]) - int32_t(ordinals[1]);
-        distanceToLowerDiagonal = min(distanceToLowerDiagonal, offset-bandMin);
-        distanceToUpperDiagonal = min(distanceToUpperDiagonal, bandMax-offset);
-    }
-    if(debug) {
-        cout << "Distance of alignment from band " <<
-            distanceToLowerDiagonal << " " << distanceToUpperDiagonal << endl;
-    }
-
-    // Store the alignment info.
-    alignmentInfo.create(alignment, uint32_t(allMarkers[0].size()), uint32_t(allMarkers[1].size()));
-
+    return true;
 }
-
@@ -122,7 +122,8 @@ void Assembler::alignOrientedReads4(
     MemoryMapped::ByteAllocator& byteAllocator,
     Alignment& alignment,
     AlignmentInfo& alignmentInfo,
-    bool debug) const
+    bool debug,
+    const pair<int32_t, int32_t>* bandHint) const
 {
     // Access the markers for the two oriented reads.
     array<span<const CompressedMarker>, 2> orientedReadMarkers;
@@ -181,7 +182,7 @@ void Assembler::alignOrientedReads4(
 
     // Compute the alignment.
     Align4::align(orientedReadMarkers, orientedReadSortedMarkersSpans,
-        options, byteAllocator, alignment, alignmentInfo, debug);
+        options, byteAllocator, alignment, alignmentInfo, debug, bandHint);
 }
 
 
@@ -0,0 +1,199 @@
+// Computation of alignments in shards.
+
+// computeAlignments can only use the threads of a single process.
+// To spread the computation of alignments across several processes,
+// possibly on different machines sharing a filesystem,
+// the alignment candidates can be split in N contiguous shards.
+// Each shard is computed by computeAlignmentShard,
+// using --Align.shard i/N, and stored in its own directory,
+// independent of the binary data of the assembly.
+// When all shards are available, mergeAlignmentShards
+// concatenates them into alignmentData and compressedAlignments,
+// then creates the alignmentTable.
+
+// Because computeAlignments stores alignments in the order
+// of the alignment candidates, the result of the merge is
+// identical to what computeAlignments creates in a single process.
+
+// Shasta.
+#include "Assembler.hpp"
+#include "AssemblerOptions.hpp"
+#include "performanceLog.hpp"
+#include "Reads.hpp"
+#include "timestamp.hpp"
+using namespace shasta;
+
+// Standard library.
+#include <filesystem>
+
+
+
+string Assembler::alignmentShardDirectory(
+    const string& shardsDirectory,
+    uint64_t shardIndex,
+    uint64_t shardCount)
+{
+    return shardsDirectory + "/Shard-" + to_string(shardIndex) + "-of-" + to_string(shardCount);
+}
+
+
+
+void Assembler::computeAlignmentShard(
+    const AlignOptions& alignOptions,
+    const string& shardsDirectory,
+    size_t threadCount)
+{
+    uint64_t shardIndex;
+    uint64_t shardCount;
+    if(not alignOptions.getShard(shardIndex, shardCount)) {
+        throw runtime_error("computeAlignmentShard requires --Align.shard.");
+    }
+
+    // Check that we have what we need.
+    reads->checkReadsAreOpen();
+    checkKmersAreOpen();
+    checkMarkersAreOpen();
+    checkAlignmentCandidatesAreOpen();
+
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    // Contiguous shards, so merging them preserves the order of the alignment candidates.
+    const uint64_t candidateCount = alignmentCandidates.candidates.size();
+    const uint64_t candidateBegin = (candidateCount * shardIndex) / shardCount;
+    const uint64_t candidateEnd = (candidateCount * (shardIndex + 1)) / shardCount;
+    performanceLog << timestamp << "Computing alignments for shard " << shardIndex <<
+        " of " << shardCount << ", alignment candidates " << candidateBegin <<
+        " to " << candidateEnd << " of " << candidateCount << "." << endl;
+
+    // Create the shard directory.
+    const string directory = alignmentShardDirectory(shardsDirectory, shardIndex, shardCount);
+    std::filesystem::create_directories(directory);
+
+    // For alignment method 4, use the sorted markers if they were
+    // already computed (for example using ComputeSortedMarkers.py).
+    // Otherwise they are computed for each alignment.
+    // We cannot compute them here because other shards
+    // may be using the same binary data at the same time.
+    if(alignOptions.alignMethod == 4) {
+        if(not sortedMarkers.isOpen()) {
+            if(not accessSortedMarkers()) {
+                cout << "Sorted markers are not available and will be "
+                    "computed for each alignment." << endl;
+            }
+        }
+    }
+
+    // Store the shard information first, marked as incomplete.
+    const size_t pageSize = 4096;
+    MemoryMapped::Object<AlignmentShardInfo> info;
+    info.createNew(directory + "/ShardInfo", pageSize);
+    info->shardIndex = shardIndex;
+    info->shardCount = shardCount;
+    info->candidateCount = candidateCount;
+    info->candidateBegin = candidateBegin;
+    info->candidateEnd = candidateEnd;
+    info->alignmentCount = 0;
+    info->isComplete = false;
+
+    // Compute the alignments.
+    computeAlignmentsData.shardDirectory = directory;
+    computeAlignments(alignOptions,
+        candidateBegin, candidateEnd,
+        directory + "/AlignmentData",
+        directory + "/CompressedAlignments",
+        pageSize,
+        threadCount);
+    computeAlignmentsData.shardDirectory.clear();
+    const uint64_t alignmentCount = alignmentData.size();
+    info->alignmentCount = alignmentCount;
+    alignmentData.close();
+    compressedAlignments.close();
+
+    // Now the shard is complete.
+    info->isComplete = true;
+    info.close();
+
+    cout << "Found and stored " << alignmentCount << " good alignments in " <<
+        directory << endl;
+    performanceLog << timestamp << "Done computing alignments for shard " << shardIndex <<
+        " of " << shardCount << "." << endl;
+}
+
+
+
+void Assembler::mergeAlignmentShards(
+    const string& shardsDirectory,
+    uint64_t shardCount)
+{
+    performanceLog << timestamp << "Merging " << shardCount << " alignment shards." << endl;
+    checkAlignmentCandidatesAreOpen();
+    const uint64_t candidateCount = alignmentCandidates.candidates.size();
+    if(shardCount == 0) {
+        throw runtime_error("Invalid number of alignment shards.");
+    }
+
+    // Check that the shards exist, are complete, and cover
+    // all alignment candidates with no gaps or overlaps.
+    uint64_t alignmentCount = 0;
+    uint64_t expectedCandidateBegin = 0;
+    for(uint64_t shardIndex=0; shardIndex<shardCount; shardIndex++) {
+        const string directory = alignmentShardDirectory(shardsDirectory, shardIndex, shardCount);
+        MemoryMapped::Object<AlignmentShardInfo> info;
+        try {
+            info.accessExistingReadOnly(directory + "/ShardInfo");
+        } catch(const exception&) {
+            throw runtime_error("Alignment shard " + directory + " is not available.");
+        }
+        if(not info->isComplete) {
+            throw runtime_error("Alignment shard " + directory + " is not complete.");
+        }
+        if(info->shardIndex != shardIndex or
+            info->shardCount != shardCount or
+            info->candidateCount != candidateCount or
+            info->candidateBegin != expectedCandidateBegin or
+            info->candidateEnd < info->candidateBegin or
+            info->candidateEnd > candidateCount) {
+            throw runtime_error("Alignment shard " + directory +
+                " is not consistent with the current alignment candidates.");
+        }
+        expectedCandidateBegin = info->candidateEnd;
+        alignmentCount += info->alignmentCount;
+    }
+    if(expectedCandidateBegin != candidateCount) {
+        throw runtime_error("Alignment shards in " + shardsDirectory +
+            " don't cover all alignment candidates.");
+    }
+
+    // Concatenate the shards.
+    alignmentData.createNew(largeDataName("AlignmentData"), largeDataPageSize);
+    compressedAlignments.createNew(largeDataName("CompressedAlignments"), largeDataPageSize);
+    alignmentData.reserve(alignmentCount);
+    for(uint64_t shardIndex=0; shardIndex<shardCount; shardIndex++) {
+        const string directory = alignmentShardDirectory(shardsDirectory, shardIndex, shardCount);
+
+        MemoryMapped::Vector<AlignmentData> shardAlignmentData;
+        shardAlignmentData.accessExistingReadOnly(directory + "/AlignmentData");
+        MemoryMapped::VectorOfVectors<char, uint64_t> shardCompressedAlignments;
+        shardCompressedAlignments.accessExistingReadOnly(directory + "/CompressedAlignments");
+        SHASTA_ASSERT(shardAlignmentData.size() == shardCompressedAlignments.size());
+
+        for(uint64_t i=0; i<shardAlignmentData.size(); i++) {
+            alignmentData.push_back(shardAlignmentData[i]);
+            compressedAlignments.appendVector(
+                shardCompressedAlignments.begin(i),
+                shardCompressedAlignments.end(i));
+        }
+    }
+    SHASTA_ASSERT(alignmentData.size() == alignmentCount);
+    alignmentData.unreserve();
+    compressedAlignments.unreserve();
+
+    cout << "Merged " << alignmentCount << " good alignments from " <<
+        shardCount << " shards." << endl;
+    performanceLog << timestamp << "Creating alignment table." << endl;
+    computeAlignmentTable();
+    performanceLog << timestamp << "Done merging alignment shards." << endl;
+}
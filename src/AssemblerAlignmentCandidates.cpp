@@ -376,73 +376,123 @@ bool Assembler::createLocalAlignmentCandidateGraph(
 
 
 
-void Assembler::computeCandidateTable()
+// Compute the candidateTable from alignmentCandidates.
+// This uses the two-pass multithreaded construction of the VectorOfVectors,
+// followed by a multithreaded sort of each section of the candidate table.
+void Assembler::computeCandidateTable(size_t threadCount)
 {
-    alignmentCandidates.computeCandidateTable(reads->readCount(),
-                                              largeDataName("CandidateTable"),
-                                              largeDataPageSize);
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    AlignmentCandidates& a = alignmentCandidates;
+    const ReadId readCount = reads->readCount();
+    const uint64_t candidateCount = a.candidates.size();
+    const uint64_t batchSize = 10000;
+
+    a.candidateTable.createNew(largeDataName("CandidateTable"), largeDataPageSize);
+
+    // Pass 1: count the candidates for each oriented read.
+    a.candidateTable.beginPass1(2 * uint64_t(readCount));
+    setupLoadBalancing(candidateCount, batchSize);
+    runThreads(&Assembler::computeCandidateTableThreadFunction1, threadCount);
+
+    // Pass 2: store the candidate indexes.
+    a.candidateTable.beginPass2();
+    setupLoadBalancing(candidateCount, batchSize);
+    runThreads(&Assembler::computeCandidateTableThreadFunction2, threadCount);
+    a.candidateTable.endPass2();
+
+    // Sort each section of the candidate table by OrientedReadId.
+    setupLoadBalancing(readCount, 1000);
+    runThreads(&Assembler::computeCandidateTableThreadFunction3, threadCount);
+
+    a.candidateTable.unreserve();
 }
 
-// Compute candidateTable from alignmentCandidates.
-// This could be made multithreaded if it becomes a bottleneck.
-void AlignmentCandidates::computeCandidateTable(ReadId readCount, string largeDataName, size_t largeDataPageSize)
+
+
+// Pass 1 of computeCandidateTable.
+void Assembler::computeCandidateTableThreadFunction1(size_t /* threadId */)
 {
-    candidateTable.createNew(largeDataName, largeDataPageSize);
-    candidateTable.beginPass1(ReadId(2 * readCount));
-    for(const OrientedReadPair& pair: candidates) {
-        OrientedReadId orientedReadId0(pair.readIds[0], 0);
-        OrientedReadId orientedReadId1(pair.readIds[1], pair.isSameStrand ? 0 : 1);
-        candidateTable.incrementCount(orientedReadId0.getValue());
-        candidateTable.incrementCount(orientedReadId1.getValue());
-        orientedReadId0.flipStrand();
-        orientedReadId1.flipStrand();
-        candidateTable.incrementCount(orientedReadId0.getValue());
-        candidateTable.incrementCount(orientedReadId1.getValue());
+    auto& candidateTable = alignmentCandidates.candidateTable;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(uint64_t i=begin; i!=end; i++) {
+            const OrientedReadPair& pair = alignmentCandidates.candidates[i];
+            OrientedReadId orientedReadId0(pair.readIds[0], 0);
+            OrientedReadId orientedReadId1(pair.readIds[1], pair.isSameStrand ? 0 : 1);
+            candidateTable.incrementCountMultithreaded(orientedReadId0.getValue());
+            candidateTable.incrementCountMultithreaded(orientedReadId1.getValue());
+            orientedReadId0.flipStrand();
+            orientedReadId1.flipStrand();
+            candidateTable.incrementCountMultithreaded(orientedReadId0.getValue());
+            candidateTable.incrementCountMultithreaded(orientedReadId1.getValue());
+        }
     }
-    candidateTable.beginPass2();
-    for(uint64_t i=0; i<candidates.size(); i++) {
-        const OrientedReadPair& pair = candidates[i];
-        OrientedReadId orientedReadId0(pair.readIds[0], 0);
-        OrientedReadId orientedReadId1(pair.readIds[1], pair.isSameStrand ? 0 : 1);
-        candidateTable.store(orientedReadId0.getValue(), i);
-        candidateTable.store(orientedReadId1.getValue(), i);
-        orientedReadId0.flipStrand();
-        orientedReadId1.flipStrand();
-        candidateTable.store(orientedReadId0.getValue(), i);
-        candidateTable.store(orientedReadId1.getValue(), i);
+}
+
+
+
+// Pass 2 of computeCandidateTable.
+void Assembler::computeCandidateTableThreadFunction2(size_t /* threadId */)
+{
+    auto& candidateTable = alignmentCandidates.candidateTable;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(uint64_t i=begin; i!=end; i++) {
+            const OrientedReadPair& pair = alignmentCandidates.candidates[i];
+            OrientedReadId orientedReadId0(pair.readIds[0], 0);
+            OrientedReadId orientedReadId1(pair.readIds[1], pair.isSameStrand ? 0 : 1);
+            candidateTable.storeMultithreaded(orientedReadId0.getValue(), i);
+            candidateTable.storeMultithreaded(orientedReadId1.getValue(), i);
+            orientedReadId0.flipStrand();
+            orientedReadId1.flipStrand();
+            candidateTable.storeMultithreaded(orientedReadId0.getValue(), i);
+            candidateTable.storeMultithreaded(orientedReadId1.getValue(), i);
+        }
     }
-    candidateTable.endPass2();
+}
 
 
 
-    // Sort each section of the candidate table by OrientedReadId.
-    vector< pair<OrientedReadId, uint32_t> > v;
-    for(ReadId readId0=0; readId0<readCount; readId0++) {
-        for(Strand strand0=0; strand0<2; strand0++) {
-            const OrientedReadId orientedReadId0(readId0, strand0);
-
-            // Access the section of the candidate table for this oriented read.
-            const span<uint64_t> candidateTableSection =
-                    candidateTable[orientedReadId0.getValue()];
-
-            // Store pairs(OrientedReadId, candidateIndex).
-            v.clear();
-            for(uint64_t candidateIndex: candidateTableSection) {
-                const OrientedReadPair& pair = candidates[candidateIndex];
-                const OrientedReadId orientedReadId1 = pair.getOther(orientedReadId0);
-                v.push_back(make_pair(orientedReadId1, candidateIndex));
-            }
+// Sort each section of the candidate table by OrientedReadId.
+// Because pass 2 stores in a non-deterministic order,
+// ties are broken by candidate index.
+void Assembler::computeCandidateTableThreadFunction3(size_t /* threadId */)
+{
+    auto& candidateTable = alignmentCandidates.candidateTable;
+    vector< pair<OrientedReadId, uint64_t> > v;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(ReadId readId0=ReadId(begin); readId0!=ReadId(end); readId0++) {
+            for(Strand strand0=0; strand0<2; strand0++) {
+                const OrientedReadId orientedReadId0(readId0, strand0);
+
+                // Access the section of the candidate table for this oriented read.
+                const span<uint64_t> candidateTableSection =
+                        candidateTable[orientedReadId0.getValue()];
+
+                // Store pairs(OrientedReadId, candidateIndex).
+                v.clear();
+                for(uint64_t candidateIndex: candidateTableSection) {
+                    const OrientedReadPair& pair = alignmentCandidates.candidates[candidateIndex];
+                    const OrientedReadId orientedReadId1 = pair.getOther(orientedReadId0);
+                    v.push_back(make_pair(orientedReadId1, candidateIndex));
+                }
 
-            // Sort.
-            sort(v.begin(), v.end());
+                // Sort.
+                sort(v.begin(), v.end());
 
-            // Store the sorted candidateIndex.
-            for(uint64_t i=0; i<v.size(); i++) {
-                candidateTableSection[i] = v[i].second;
+                // Store the sorted candidateIndex.
+                for(uint64_t i=0; i<v.size(); i++) {
+                    candidateTableSection[i] = v[i].second;
+                }
             }
         }
     }
-
-    candidateTable.unreserve();
-
 }
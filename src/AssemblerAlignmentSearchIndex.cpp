@@ -0,0 +1,223 @@
+// Indexed search used by the http server to compute
+// all alignments of an oriented read.
+
+// Assembler::computeAllAlignments and Assembler::assessAlignments
+// used to align the query oriented read against every other
+// oriented read. Here we use an inverted index of features
+// (pairs of consecutive markers) to find the oriented reads
+// that share at least minSharedFeatureCount features
+// with the query oriented read. Only those oriented reads are aligned.
+// Setting minSharedFeatureCount to 0 restores the exhaustive search.
+
+// Shasta.
+#include "Assembler.hpp"
+#include "MurmurHash2.hpp"
+#include "Reads.hpp"
+using namespace shasta;
+
+// Standard library.
+#include "array.hpp"
+#include "chrono.hpp"
+
+
+
+// Get the parameters of the indexed search from the request.
+void Assembler::getAllAlignmentsSearchParameters(const vector<string>& request)
+{
+    computeAllAlignmentsData.minSharedFeatureCount = 5;
+    getParameterValue(request, "minSharedFeatureCount", computeAllAlignmentsData.minSharedFeatureCount);
+    computeAllAlignmentsData.maxBucketSize = 1000;
+    getParameterValue(request, "maxBucketSize", computeAllAlignmentsData.maxBucketSize);
+}
+
+
+
+void Assembler::writeAllAlignmentsSearchForm(ostream& html) const
+{
+    html <<
+        "<p><table>"
+        "<tr><th class=left>[Search]<th class=center>Value<th class=left>Description"
+
+        "<tr><th class=left>minSharedFeatureCount"
+        "<td class=centered>"
+        "<input type=text style='text-align:center;border:none' name=minSharedFeatureCount size=16 value=" <<
+        computeAllAlignmentsData.minSharedFeatureCount << ">"
+        "<td class=smaller>Only align with oriented reads that share at least this number of "
+        "features (pairs of consecutive markers) with the query oriented read. "
+        "Lower values are more sensitive but slower. "
+        "If 0, align with all oriented reads (exhaustive search, can be very slow)."
+
+        "<tr><th class=left>maxBucketSize"
+        "<td class=centered>"
+        "<input type=text style='text-align:center;border:none' name=maxBucketSize size=16 value=" <<
+        computeAllAlignmentsData.maxBucketSize << ">"
+        "<td class=smaller>Ignore index buckets containing more than this number of reads "
+        "(usually features in repeats). 0 means no limit."
+
+        "</table>";
+}
+
+
+
+// Fill computeAllAlignmentsData.orientedReadIds1 with the
+// oriented reads to be aligned with orientedReadId0.
+void Assembler::findAllAlignmentsCandidates(OrientedReadId orientedReadId0)
+{
+    vector<OrientedReadId>& orientedReadIds1 = computeAllAlignmentsData.orientedReadIds1;
+    orientedReadIds1.clear();
+
+    // Exhaustive search.
+    // Skip alignment with self in the same orientation.
+    // Allow alignment with self reverse complemented.
+    const uint64_t minSharedFeatureCount = computeAllAlignmentsData.minSharedFeatureCount;
+    if(minSharedFeatureCount == 0) {
+        for(ReadId readId1=0; readId1<reads->readCount(); readId1++) {
+            for(Strand strand1=0; strand1<2; strand1++) {
+                const OrientedReadId orientedReadId1(readId1, strand1);
+                if(orientedReadId1 != orientedReadId0) {
+                    orientedReadIds1.push_back(orientedReadId1);
+                }
+            }
+        }
+        return;
+    }
+
+    createAlignmentSearchIndex();
+    auto& index = alignmentSearchIndexData.index;
+    auto& sharedFeatureCount = alignmentSearchIndexData.sharedFeatureCount;
+    auto& touched = alignmentSearchIndexData.touched;
+    sharedFeatureCount.resize(2 * uint64_t(reads->readCount()), 0);
+    touched.clear();
+    const uint64_t maxBucketSize = computeAllAlignmentsData.maxBucketSize;
+
+    // The index only contains features on strand 0.
+    // A feature of orientedReadId0 found in read readId1
+    // is shared with (readId1, 0).
+    // A feature of the reverse complement of orientedReadId0
+    // found in read readId1 is shared with (readId1, 1).
+    for(Strand strand1=0; strand1<2; strand1++) {
+        OrientedReadId query = orientedReadId0;
+        if(strand1 == 1) {
+            query.flipStrand();
+        }
+        const auto queryMarkers = markers[query.getValue()];
+        for(uint64_t i=1; i<queryMarkers.size(); i++) {
+            const uint64_t bucket = getAlignmentSearchBucket(
+                queryMarkers[i-1].kmerId, queryMarkers[i].kmerId);
+            const auto readIds1 = index[bucket];
+            if(maxBucketSize > 0 and readIds1.size() > maxBucketSize) {
+                continue;
+            }
+            for(const ReadId readId1: readIds1) {
+                const OrientedReadId orientedReadId1(readId1, strand1);
+                uint64_t& n = sharedFeatureCount[orientedReadId1.getValue()];
+                if(n == 0) {
+                    touched.push_back(orientedReadId1);
+                }
+                ++n;
+            }
+        }
+    }
+
+    // Keep the oriented reads with enough shared features and reset the counts.
+    for(const OrientedReadId orientedReadId1: touched) {
+        uint64_t& n = sharedFeatureCount[orientedReadId1.getValue()];
+        if(n >= minSharedFeatureCount and orientedReadId1 != orientedReadId0) {
+            orientedReadIds1.push_back(orientedReadId1);
+        }
+        n = 0;
+    }
+    touched.clear();
+    sort(orientedReadIds1.begin(), orientedReadIds1.end());
+}
+
+
+
+uint64_t Assembler::getAlignmentSearchBucket(KmerId kmerId0, KmerId kmerId1) const
+{
+    const array<KmerId, 2> feature = {kmerId0, kmerId1};
+    return MurmurHash64A(feature.data(), sizeof(feature), 1241) &
+        alignmentSearchIndexData.bucketMask;
+}
+
+
+
+// Create the index, if not already done.
+void Assembler::createAlignmentSearchIndex()
+{
+    auto& index = alignmentSearchIndexData.index;
+    if(index.isOpen()) {
+        return;
+    }
+    const auto t0 = std::chrono::steady_clock::now();
+
+    // Use a number of buckets equal to a power of 2 close to
+    // 1/8 of the number of features on strand 0.
+    uint64_t featureCount = 0;
+    for(ReadId readId=0; readId<reads->readCount(); readId++) {
+        const uint64_t markerCount = markers.size(OrientedReadId(readId, 0).getValue());
+        if(markerCount > 1) {
+            featureCount += markerCount - 1;
+        }
+    }
+    uint64_t bucketCount = 1024;
+    while(8 * bucketCount < featureCount) {
+        bucketCount *= 2;
+    }
+    alignmentSearchIndexData.bucketMask = bucketCount - 1;
+
+    // The index is anonymous because it is not part of the assembly.
+    const size_t threadCount = std::thread::hardware_concurrency();
+    const uint64_t batchSize = 1000;
+    index.createNew("", 4096);
+    index.beginPass1(bucketCount);
+    setupLoadBalancing(reads->readCount(), batchSize);
+    runThreads(&Assembler::createAlignmentSearchIndexThreadFunction1, threadCount);
+    index.beginPass2();
+    setupLoadBalancing(reads->readCount(), batchSize);
+    runThreads(&Assembler::createAlignmentSearchIndexThreadFunction2, threadCount);
+    index.endPass2();
+
+    const auto t1 = std::chrono::steady_clock::now();
+    cout << "Created the alignment search index with " << featureCount <<
+        " features in " << bucketCount << " buckets in " <<
+        1.e-9 * double((std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)).count()) <<
+        " s." << endl;
+}
+
+
+
+void Assembler::createAlignmentSearchIndexThreadFunction1(size_t /* threadId */)
+{
+    auto& index = alignmentSearchIndexData.index;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(ReadId readId=ReadId(begin); readId!=ReadId(end); readId++) {
+            const auto readMarkers = markers[OrientedReadId(readId, 0).getValue()];
+            for(uint64_t i=1; i<readMarkers.size(); i++) {
+                index.incrementCountMultithreaded(
+                    getAlignmentSearchBucket(readMarkers[i-1].kmerId, readMarkers[i].kmerId));
+            }
+        }
+    }
+}
+
+
+
+void Assembler::createAlignmentSearchIndexThreadFunction2(size_t /* threadId */)
+{
+    auto& index = alignmentSearchIndexData.index;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(ReadId readId=ReadId(begin); readId!=ReadId(end); readId++) {
+            const auto readMarkers = markers[OrientedReadId(readId, 0).getValue()];
+            for(uint64_t i=1; i<readMarkers.size(); i++) {
+                index.storeMultithreaded(
+                    getAlignmentSearchBucket(readMarkers[i-1].kmerId, readMarkers[i].kmerId),
+                    readId);
+            }
+        }
+    }
+}
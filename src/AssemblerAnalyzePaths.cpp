@@ -1,10 +1,9 @@
 // Shasta.
 #include "Assembler.hpp"
+#include "alignLinearGaps.hpp"
 #include "AssemblyGraph.hpp"
 #include "deduplicate.hpp"
 #include "orderPairs.hpp"
-// Shasta.
-#include "seqan.hpp"
 using namespace shasta;
 
 // Standard library.
@@ -27,9 +26,6 @@ void Assembler::computePseudoPath(
     // The pseudo-path computed by this function.
     PseudoPath& pseudoPath) const
 {
-    const AssemblyGraph& assemblyGraph = *assemblyGraphPointer;
-    using SegmentId = AssemblyGraphEdgeId;
-
     // Compute the marker graph path.
     const uint64_t markerCount = markers.size(orientedReadId.getValue());
     if(markerCount < 2) {
@@ -43,10 +39,23 @@ void Assembler::computePseudoPath(
         SHASTA_ASSERT(path.size() == pathOrdinals.size());
     }
 
+    // Now compute the pseudo-path.
+    computePseudoPath(path, pathOrdinals, pseudoPath);
+}
 
 
-    // Now compute the pseudo-path.
-    pseudoPath.clear();
+
+// Compute the pseudo-path of an oriented read using its marker graph path,
+// which was already computed using computeOrientedReadMarkerGraphPath.
+void Assembler::computePseudoPath(
+    const vector<MarkerGraph::EdgeId>& path,
+    const vector< pair<uint32_t, uint32_t> >& pathOrdinals,
+    PseudoPath& pseudoPath) const
+{
+    const AssemblyGraph& assemblyGraph = *assemblyGraphPointer;
+    using SegmentId = AssemblyGraphEdgeId;
+    SHASTA_ASSERT(path.size() == pathOrdinals.size());
+
     pseudoPath.clear();
     PseudoPathEntry pseudoPathEntry;
     pseudoPathEntry.segmentId = std::numeric_limits<SegmentId>::max();
@@ -175,15 +184,18 @@ void Assembler::alignPseudoPaths(
     }
 
     // Align them.
+    // This uses the same alignment function used by createReadGraphUsingPseudoPaths.
     vector< pair<bool, bool> > alignment;
-    const uint64_t alignmentScore = shasta::seqanAlign(
-        pseudoPathSegments[0].begin(), pseudoPathSegments[0].end(),
-        pseudoPathSegments[1].begin(), pseudoPathSegments[1].end(),
+    LinearGapAlignerWorkArea alignerWorkArea;
+    const int64_t alignmentScore = alignLinearGaps(
+        pseudoPathSegments[0],
+        pseudoPathSegments[1],
         matchScore,
         mismatchScore,
         gapScore,
         true, true,
-        alignment);
+        alignment,
+        alignerWorkArea);
     cout << "Alignment score " << alignmentScore << endl;
     cout << "Alignment length " << alignment.size() << endl;
 
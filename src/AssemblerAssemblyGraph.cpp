@@ -81,7 +81,10 @@ void Assembler::createAssemblyGraphEdges()
 
     // Main loop over all edges of the marker graph.
     // At each iteration we find a new linear chain of edges.
-    for(EdgeId startEdgeId=0; startEdgeId<edgeCount; startEdgeId++) {
+    // Edges that are not part of the cleaned up marker graph are skipped.
+    for(EdgeId startEdgeId=markerGraph.findNextNonRemovedEdge(0);
+        startEdgeId<edgeCount;
+        startEdgeId=markerGraph.findNextNonRemovedEdge(startEdgeId+1)) {
         const auto& startEdge = edges[startEdgeId];
 
         if(debug) {
@@ -89,14 +92,6 @@ void Assembler::createAssemblyGraphEdges()
             cout << " " << startEdge.source << "->" << startEdge.target << endl;
         }
 
-        // If this edge is not part of cleaned up marker graph, skip it.
-        if(startEdge.wasRemoved()) {
-            if(debug) {
-                cout << "Start edge was removed." << endl;
-            }
-            continue;
-        }
-
         // If we already found this edge, skip it.
         // It is part of a chain we already found.
         if(wasFound[startEdgeId]) {
@@ -222,8 +217,7 @@ void Assembler::createAssemblyGraphEdges()
     // Check that only and all edges of the cleaned up marker graph
     // were found.
     for(EdgeId edgeId=0; edgeId<edgeCount; edgeId++) {
-        const auto& edge = markerGraph.edges[edgeId];
-        if(edge.wasRemoved()) {
+        if(markerGraph.edgeWasRemoved(edgeId)) {
             SHASTA_ASSERT(!wasFound[edgeId]);
         } else {
             SHASTA_ASSERT(wasFound[edgeId]);
@@ -515,7 +509,7 @@ void Assembler::removeLowCoverageCrossEdges(uint32_t crossEdgeCoverageThreshold)
 
             // Mark the corresponding marker graph edges.
             for(const MarkerGraph::EdgeId markerGraphEdgeId: assemblyGraph.edgeLists[edgeId]) {
-                markerGraph.edges[markerGraphEdgeId].isLowCoverageCrossEdge = 1;
+                markerGraph.setEdgeFlag(markerGraphEdgeId, MarkerGraph::EdgeFlag::isLowCoverageCrossEdge, true);
                 if(debug) {
                     out << markerGraphEdgeId << "\n";
                 }
@@ -570,7 +564,7 @@ void Assembler::pruneAssemblyGraph(uint64_t pruneLength)
 
             // Mark the corresponding marker graph edges.
             for(const MarkerGraph::EdgeId markerGraphEdgeId: assemblyGraph.edgeLists[edgeId]) {
-                markerGraph.edges[markerGraphEdgeId].wasPruned = 1;
+                markerGraph.setEdgeFlag(markerGraphEdgeId, MarkerGraph::EdgeFlag::wasPruned, true);
                 ++removedMarkerGraphEdgeCount;
             }
 
@@ -1,9 +1,9 @@
 // Shasta.
 #include "Assembler.hpp"
+#include "alignLinearGaps.hpp"
 #include "AssemblyGraph.hpp"
 #include "orderPairs.hpp"
 #include "Reads.hpp"
-#include "seqan.hpp"
 #include "timestamp.hpp"
 using namespace shasta;
 
@@ -163,10 +163,17 @@ void Assembler::createReadGraphUsingPseudoPaths(
 
 
 // Thread function used to compute pseudoPaths.
+// The marker graph path of each read is computed once, on strand 0,
+// and kept while computing the pseudo-paths on both strands.
+// The marker graph path on strand 1 is obtained from the one on strand 0
+// using the reverse complement marker graph edges,
+// which is much faster than computing it from scratch.
 void Assembler::createReadGraphUsingPseudoPathsThreadFunction1(size_t threadId)
 {
     vector<MarkerGraph::EdgeId> path;
     vector< pair<uint32_t, uint32_t> > pathOrdinals;
+    vector<MarkerGraph::EdgeId> reverseComplementedPath;
+    vector< pair<uint32_t, uint32_t> > reverseComplementedPathOrdinals;
     PseudoPath pseudoPath;
     using SegmentId = AssemblyGraphEdgeId;
     vector< vector<SegmentId> >& pseudoPaths =
@@ -178,11 +185,19 @@ void Assembler::createReadGraphUsingPseudoPathsThreadFunction1(size_t threadId)
 
         // Loop over all reads in this batch.
         for(ReadId readId=ReadId(begin); readId!=ReadId(end); readId++) {
-            for(Strand strand=0; strand<2; strand++) {
-                const OrientedReadId orientedReadId(readId, strand);
-                computePseudoPath(orientedReadId, path, pathOrdinals, pseudoPath);
-                getPseudoPathSegments(pseudoPath, pseudoPaths[orientedReadId.getValue()]);
-            }
+
+            // Strand 0. This also computes the marker graph path.
+            const OrientedReadId orientedReadId0(readId, 0);
+            computePseudoPath(orientedReadId0, path, pathOrdinals, pseudoPath);
+            getPseudoPathSegments(pseudoPath, pseudoPaths[orientedReadId0.getValue()]);
+
+            // Strand 1. Reuse the marker graph path of strand 0.
+            const OrientedReadId orientedReadId1(readId, 1);
+            reverseComplementOrientedReadMarkerGraphPath(
+                orientedReadId0, path, pathOrdinals,
+                reverseComplementedPath, reverseComplementedPathOrdinals);
+            computePseudoPath(reverseComplementedPath, reverseComplementedPathOrdinals, pseudoPath);
+            getPseudoPathSegments(pseudoPath, pseudoPaths[orientedReadId1.getValue()]);
         }
     }
 }
@@ -206,6 +221,7 @@ void Assembler::createReadGraphUsingPseudoPathsThreadFunction2(size_t threadId)
     auto& infos = createReadGraphUsingPseudoPathsData.alignmentInfos;
 
     vector< pair<bool, bool> > alignment;
+    LinearGapAlignerWorkArea alignerWorkArea;
 
     // Loop over all batches assigned to this thread.
     uint64_t begin, end;
@@ -239,14 +255,15 @@ void Assembler::createReadGraphUsingPseudoPathsThreadFunction2(size_t threadId)
             }
 
             // Align them.
-            shasta::seqanAlign(
-                pseudoPathSegments0.begin(), pseudoPathSegments0.end(),
-                pseudoPathSegments1.begin(), pseudoPathSegments1.end(),
+            alignLinearGaps(
+                pseudoPathSegments0,
+                pseudoPathSegments1,
                 matchScore,
                 mismatchScore,
                 gapScore,
                 true, true,
-                alignment);
+                alignment,
+                alignerWorkArea);
 
             // Analyze the alignment of the two pseudo-paths.
             uint64_t position0 = 0;
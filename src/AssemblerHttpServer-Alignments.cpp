@@ -1197,7 +1197,9 @@ void Assembler::exploreAlignment(
         const bool debug = false;
         alignOrientedReads(
             markersSortedByKmerId,
-            maxSkip, maxDrift, maxMarkerFrequency, debug, graph, alignment, alignmentInfo);
+            maxSkip, maxDrift, maxMarkerFrequency,
+            httpServerData.assemblerOptions->alignOptions.method0DynamicProgramming, debug,
+            graph, alignment, alignmentInfo);
 
         if(alignment.ordinals.empty()) {
             html << "<p>The alignment is empty (it has no markers).";
@@ -1928,6 +1930,9 @@ void Assembler::computeAllAlignments(
     computeAllAlignmentsData.align4MaxDistanceFromBoundary = httpServerData.assemblerOptions->alignOptions.align4MaxDistanceFromBoundary;
     getParameterValue(request, "align4MaxDistanceFromBoundary", computeAllAlignmentsData.align4MaxDistanceFromBoundary);
 
+    // Parameters of the indexed search.
+    getAllAlignmentsSearchParameters(request);
+
 
     // Write the form.
     html <<
@@ -1960,6 +1965,7 @@ void Assembler::computeAllAlignments(
         computeAllAlignmentsData.align4MaxDistanceFromBoundary,
         html
     );
+    writeAllAlignmentsSearchForm(html);
 
     html << "</form>";
 
@@ -1977,13 +1983,20 @@ void Assembler::computeAllAlignments(
     getMarkersSortedByKmerId(orientedReadId0, markers0SortedByKmerId);
 
 
+    // Find the oriented reads to align with.
+    const auto tIndex = std::chrono::steady_clock::now();
+    findAllAlignmentsCandidates(orientedReadId0);
+    const auto t0 = std::chrono::steady_clock::now();
+    html << "<p>Found " << computeAllAlignmentsData.orientedReadIds1.size() <<
+        " oriented reads to align with in " <<
+        1.e-9 * double((std::chrono::duration_cast<std::chrono::nanoseconds>(t0 - tIndex)).count()) << "s.";
+
     // Compute the alignments in parallel.
     computeAllAlignmentsData.orientedReadId0 = orientedReadId0;
     const size_t threadCount =std::thread::hardware_concurrency();
     computeAllAlignmentsData.threadAlignments.resize(threadCount);
     const size_t batchSize = 1;
-    setupLoadBalancing(reads->readCount(), batchSize);
-    const auto t0 = std::chrono::steady_clock::now();
+    setupLoadBalancing(computeAllAlignmentsData.orientedReadIds1.size(), batchSize);
     runThreads(&Assembler::computeAllAlignmentsThreadFunction, threadCount);
     const auto t1 = std::chrono::steady_clock::now();
     html << "<p>Alignment computation using " << threadCount << " threads took " <<
@@ -2386,6 +2399,9 @@ void Assembler::assessAlignments(
     computeAllAlignmentsData. align4MaxDistanceFromBoundary = httpServerData.assemblerOptions->alignOptions.align4MaxDistanceFromBoundary;
     getParameterValue(request, "align4MaxDistanceFromBoundary", computeAllAlignmentsData.align4MaxDistanceFromBoundary);
 
+    // Parameters of the indexed search.
+    getAllAlignmentsSearchParameters(request);
+
 
 
     html << "<h1>Alignment statistics</h1>";
@@ -2447,6 +2463,7 @@ void Assembler::assessAlignments(
             computeAllAlignmentsData.align4MaxDistanceFromBoundary,
             html
     );
+    writeAllAlignmentsSearchForm(html);
 
 
     html << "<br>";
@@ -2573,8 +2590,9 @@ void Assembler::assessAlignments(
         const uint64_t threadCount = std::thread::hardware_concurrency();
         computeAllAlignmentsData.threadAlignments.resize(threadCount);
         const uint64_t batchSize = 1;
-        setupLoadBalancing(reads->readCount(), batchSize);
         const auto t0 = std::chrono::steady_clock::now();
+        findAllAlignmentsCandidates(orientedReadId);
+        setupLoadBalancing(computeAllAlignmentsData.orientedReadIds1.size(), batchSize);
         runThreads(&Assembler::computeAllAlignmentsThreadFunction, threadCount);
         const auto t1 = std::chrono::steady_clock::now();
 
@@ -2715,8 +2733,6 @@ void Assembler::computeAllAlignmentsThreadFunction(size_t threadId)
 {
     // Get the first oriented read.
     const OrientedReadId orientedReadId0 = computeAllAlignmentsData.orientedReadId0;
-    const ReadId readId0 = orientedReadId0.getReadId();
-    const Strand strand0 = orientedReadId0.getStrand();
 
     // Get parameters for alignment computation.
     const size_t minMarkerCount = computeAllAlignmentsData.minMarkerCount;
@@ -2777,86 +2793,80 @@ void Assembler::computeAllAlignmentsThreadFunction(size_t threadId)
     uint64_t begin, end;
     while(getNextBatch(begin, end)) {
 
-        // Loop over reads assigned to this batch.
-        for(ReadId readId1=ReadId(begin); readId1!=ReadId(end); ++readId1) {
+        // Loop over oriented reads assigned to this batch.
+        // They were found by findAllAlignmentsCandidates,
+        // which already excluded orientedReadId0.
+        for(uint64_t i=begin; i!=end; ++i) {
+            const OrientedReadId orientedReadId1 = computeAllAlignmentsData.orientedReadIds1[i];
 
-            // Loop over strands.
-            for(Strand strand1=0; strand1<2; strand1++) {
-
-                // Skip alignments with self in the same orientation.
-                // Allow alignment with self reverse complemented.
-                if(readId0==readId1 && strand0==strand1) {
-                    continue;
-                }
+            // If this read has less than the required number of markers, skip.
+            if(markers[orientedReadId1.getValue()].size() < minMarkerCount) {
+                continue;
+            }
 
-                // If this read has less than the required number of markers, skip.
-                const OrientedReadId orientedReadId1(readId1, strand1);
-                if(markers[orientedReadId1.getValue()].size() < minMarkerCount) {
-                    continue;
-                }
+            // Get markers sorted by kmer id.
+            getMarkersSortedByKmerId(orientedReadId1, markersSortedByKmerId[1]);
 
-                // Get markers sorted by kmer id.
-                getMarkersSortedByKmerId(orientedReadId1, markersSortedByKmerId[1]);
-
-                // Compute the alignment.
-                try {
-                    if (method == 0) {
-                        const bool debug = false;
-                        alignOrientedReads(
-                            markersSortedByKmerId,
-                            maxSkip, maxDrift, maxMarkerFrequency, debug, graph, alignment, alignmentInfo);
-                    } else if (method == 1) {
-                        alignOrientedReads1(
-                            orientedReadId0, orientedReadId1,
-                            matchScore, mismatchScore, gapScore, alignment, alignmentInfo);
-                    } else if (method == 3) {
-                        alignOrientedReads3(
-                            orientedReadId0, orientedReadId1,
-                            matchScore, mismatchScore, gapScore,
-                            downsamplingFactor, bandExtend, maxBand,
-                            alignment, alignmentInfo);
-                    } else if(method == 4) {
-                        alignOrientedReads4(orientedReadId0, orientedReadId1,
-                            align4Options,
-                            byteAllocator,
-                            alignment, alignmentInfo,
-                            false);
-                        SHASTA_ASSERT(byteAllocator.isEmpty());
-                    } else {
-                        SHASTA_ASSERT(0);
-                    }
-                } catch (const std::exception& e) {
-                    cout << e.what() << " for reads " << orientedReadId0 << " and " << orientedReadId1 << endl;
-                    continue;
-                } catch (...) {
-                    cout << "An error occurred while computing a marker alignment "
-                        " of oriented reads " << orientedReadId0 << " and " << orientedReadId1 <<
-                        "." << endl;
-                    continue;
+            // Compute the alignment.
+            try {
+                if (method == 0) {
+                    const bool debug = false;
+                    alignOrientedReads(
+                        markersSortedByKmerId,
+                        maxSkip, maxDrift, maxMarkerFrequency,
+                        httpServerData.assemblerOptions->alignOptions.method0DynamicProgramming, debug,
+                        graph, alignment, alignmentInfo);
+                } else if (method == 1) {
+                    alignOrientedReads1(
+                        orientedReadId0, orientedReadId1,
+                        matchScore, mismatchScore, gapScore, alignment, alignmentInfo);
+                } else if (method == 3) {
+                    alignOrientedReads3(
+                        orientedReadId0, orientedReadId1,
+                        matchScore, mismatchScore, gapScore,
+                        downsamplingFactor, bandExtend, maxBand,
+                        alignment, alignmentInfo);
+                } else if(method == 4) {
+                    alignOrientedReads4(orientedReadId0, orientedReadId1,
+                        align4Options,
+                        byteAllocator,
+                        alignment, alignmentInfo,
+                        false);
+                    SHASTA_ASSERT(byteAllocator.isEmpty());
+                } else {
+                    SHASTA_ASSERT(0);
                 }
+            } catch (const std::exception& e) {
+                cout << e.what() << " for reads " << orientedReadId0 << " and " << orientedReadId1 << endl;
+                continue;
+            } catch (...) {
+                cout << "An error occurred while computing a marker alignment "
+                    " of oriented reads " << orientedReadId0 << " and " << orientedReadId1 <<
+                    "." << endl;
+                continue;
+            }
 
 
-                // If the alignment is poor, skip it.
-                if ((alignment.ordinals.size() < minAlignedMarkerCount) ||
-                    (alignmentInfo.minAlignedFraction() < minAlignedFraction)) {
-                    continue;
-                }
-
-                // If the alignment has too much trim, skip it.
-                uint32_t leftTrim;
-                uint32_t rightTrim;
-                tie(leftTrim, rightTrim) = alignmentInfo.computeTrim();
-                if(leftTrim>maxTrim || rightTrim>maxTrim) {
-                    continue;
-                }
+            // If the alignment is poor, skip it.
+            if ((alignment.ordinals.size() < minAlignedMarkerCount) ||
+                (alignmentInfo.minAlignedFraction() < minAlignedFraction)) {
+                continue;
+            }
 
-                // Dont store alignments that exceeded the max number of markers for drift and skip
-                if (alignmentInfo.maxDrift > maxDrift or alignmentInfo.maxSkip > maxSkip){
-                    continue;
-                }
+            // If the alignment has too much trim, skip it.
+            uint32_t leftTrim;
+            uint32_t rightTrim;
+            tie(leftTrim, rightTrim) = alignmentInfo.computeTrim();
+            if(leftTrim>maxTrim || rightTrim>maxTrim) {
+                continue;
+            }
 
-                alignments.push_back({orientedReadId1, alignmentInfo});
+            // Dont store alignments that exceeded the max number of markers for drift and skip
+            if (alignmentInfo.maxDrift > maxDrift or alignmentInfo.maxSkip > maxSkip){
+                continue;
             }
+
+            alignments.push_back({orientedReadId1, alignmentInfo});
         }
     }
 }
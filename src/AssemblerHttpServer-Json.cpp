@@ -0,0 +1,602 @@
+// Machine-readable JSON endpoints of the http server.
+// Each endpoint returns a page of items of one type,
+// read directly from the memory-mapped data structures.
+
+// All endpoints accept the following optional parameters:
+// begin: the index of the first item to return (default 0).
+// count: the maximum number of items to return (default 100).
+// fields: a comma-separated list of the fields to return for each item.
+//         If missing, all fields are returned except for
+//         fields that can be large (marked "detail" below),
+//         which are only returned if explicitly requested.
+
+// The response has the form:
+// {"entity": "...", "total": N, "begin": B, "end": E, "items": [...]}
+// where items contains the items with indexes in [B, E).
+// If an error occurs, the response is {"error": "..."}.
+
+// Shasta.
+#include "Assembler.hpp"
+#include "AssemblyGraph.hpp"
+#include "mode3.hpp"
+#include "Reads.hpp"
+using namespace shasta;
+
+// Boost libraries.
+#include <boost/algorithm/string.hpp>
+
+// Standard library.
+#include "algorithm.hpp"
+#include <iomanip>
+#include "iostream.hpp"
+#include <exception>
+#include <set>
+#include <sstream>
+
+
+
+namespace shasta {
+    class JsonQuery;
+}
+
+
+
+// Write a string, with escapes, in JSON format.
+void shasta::writeJsonString(ostream& json, const span<const char>& s)
+{
+    json << '"';
+    for(const char c: s) {
+        switch(c) {
+        case '"':
+            json << "\\\"";
+            break;
+        case '\\':
+            json << "\\\\";
+            break;
+        case '\n':
+            json << "\\n";
+            break;
+        case '\r':
+            json << "\\r";
+            break;
+        case '\t':
+            json << "\\t";
+            break;
+        default:
+            if(uint8_t(c) < 0x20) {
+                json << "\\u" << std::hex << std::setw(4) << std::setfill('0') <<
+                    int(c) << std::dec << std::setfill(' ');
+            } else {
+                json << c;
+            }
+        }
+    }
+    json << '"';
+}
+
+
+
+// Class used to handle pagination and field selection
+// and to write the response for a JSON request.
+// The response is accumulated in json and only written to
+// the output stream by the destructor, and only if no exception
+// is being thrown. This way, if an exception occurs,
+// the only response is the error object written by processRequest.
+class shasta::JsonQuery {
+public:
+
+    JsonQuery(
+        const vector<string>& request,
+        ostream& out,
+        const string& entity,
+        uint64_t totalCount) :
+        json(buffer),
+        out(out),
+        uncaughtExceptionCount(std::uncaught_exceptions())
+    {
+        HttpServer::getParameterValue(request, "begin", begin);
+        uint64_t count = 100;
+        HttpServer::getParameterValue(request, "count", count);
+        count = min(count, maxCount);
+        begin = min(begin, totalCount);
+        end = min(begin + count, totalCount);
+
+        string fieldsString;
+        HttpServer::getParameterValue(request, "fields", fieldsString);
+        if(not fieldsString.empty()) {
+            vector<string> fields;
+            boost::algorithm::split(fields, fieldsString, boost::algorithm::is_any_of(","));
+            selectedFields.insert(fields.begin(), fields.end());
+        }
+
+        json <<
+            "{\"entity\": \"" << entity << "\", "
+            "\"total\": " << totalCount << ", "
+            "\"begin\": " << begin << ", "
+            "\"end\": " << end << ", "
+            "\"items\": [";
+    }
+
+    ~JsonQuery()
+    {
+        if(std::uncaught_exceptions() == uncaughtExceptionCount) {
+            json << "]}\n";
+            out << buffer.rdbuf();
+        }
+    }
+
+    uint64_t begin = 0;
+    uint64_t end = 0;
+
+    // Return true if a field should be written.
+    bool isSelected(const char* name) const
+    {
+        return selectedFields.empty() or selectedFields.contains(name);
+    }
+
+    // Return true if a detail field should be written.
+    // Detail fields are only written if explicitly requested.
+    bool isDetailSelected(const char* name) const
+    {
+        return selectedFields.contains(name);
+    }
+
+    void beginItem()
+    {
+        if(itemCount > 0) {
+            json << ",";
+        }
+        json << "\n{";
+        fieldCount = 0;
+    }
+    void endItem()
+    {
+        json << "}";
+        ++itemCount;
+    }
+
+    // Write a numeric or boolean field, if selected.
+    template<class T> void field(const char* name, const T& value)
+    {
+        if(isSelected(name)) {
+            writeName(name);
+            json << value;
+        }
+    }
+    void field(const char* name, bool value)
+    {
+        if(isSelected(name)) {
+            writeName(name);
+            json << (value ? "true" : "false");
+        }
+    }
+    void stringField(const char* name, const span<const char>& value)
+    {
+        if(isSelected(name)) {
+            writeName(name);
+            writeJsonString(json, value);
+        }
+    }
+
+    // Write the name of a field and leave the stream ready to
+    // receive its value. Used for fields with structured values.
+    void writeName(const char* name)
+    {
+        if(fieldCount > 0) {
+            json << ", ";
+        }
+        json << '"' << name << "\": ";
+        ++fieldCount;
+    }
+
+    // Items and their fields are written here.
+    ostream& json;
+
+private:
+    std::ostringstream buffer;
+    ostream& out;
+    const int uncaughtExceptionCount;
+    std::set<string> selectedFields;
+    uint64_t itemCount = 0;
+    uint64_t fieldCount = 0;
+    static const uint64_t maxCount = 1000000;
+};
+
+
+
+// Write an oriented read as an object with readId and strand.
+namespace shasta {
+    inline void writeJsonOrientedReadId(ostream& json, OrientedReadId orientedReadId)
+    {
+        json << "{\"readId\": " << orientedReadId.getReadId() <<
+            ", \"strand\": " << orientedReadId.getStrand() << "}";
+    }
+}
+
+
+
+// Get the oriented read specified in a request.
+// Throws if it is missing or invalid.
+OrientedReadId Assembler::getJsonOrientedReadId(const vector<string>& request) const
+{
+    ReadId readId = 0;
+    if(not getParameterValue(request, "readId", readId)) {
+        throw runtime_error("Missing readId.");
+    }
+    if(readId >= reads->readCount()) {
+        throw runtime_error("Invalid readId " + to_string(readId) +
+            ". Must be less than " + to_string(reads->readCount()) + ".");
+    }
+    Strand strand = 0;
+    getParameterValue(request, "strand", strand);
+    if(strand > 1) {
+        throw runtime_error("Invalid strand " + to_string(strand) + ". Must be 0 or 1.");
+    }
+    return OrientedReadId(readId, strand);
+}
+
+
+
+// Return a list of the available endpoints.
+void Assembler::jsonIndex(const vector<string>&, ostream& json)
+{
+    json << "{\"endpoints\": [";
+    bool isFirst = true;
+    for(const auto& p: httpServerData.functionTable) {
+        if(p.first.starts_with("/json/")) {
+            if(not isFirst) {
+                json << ", ";
+            }
+            json << "\"" << p.first << "\"";
+            isFirst = false;
+        }
+    }
+    json << "]}\n";
+}
+
+
+
+// Reads.
+// Fields: readId, name, rawLength, markerCount, isPalindromic, isChimeric.
+// Detail fields: metaData.
+void Assembler::jsonReads(const vector<string>& request, ostream& json)
+{
+    reads->checkReadsAreOpen();
+    reads->checkReadNamesAreOpen();
+    reads->checkReadFlagsAreOpen();
+
+    JsonQuery query(request, json, "reads", reads->readCount());
+    for(ReadId readId=ReadId(query.begin); readId<query.end; readId++) {
+        const ReadFlags& flags = reads->getFlags(readId);
+        query.beginItem();
+        query.field("readId", readId);
+        query.stringField("name", reads->getReadName(readId));
+        query.field("rawLength", reads->getReadRawSequenceLength(readId));
+        if(markers.isOpen()) {
+            query.field("markerCount", markers.size(OrientedReadId(readId, 0).getValue()));
+        }
+        query.field("isPalindromic", bool(flags.isPalindromic));
+        query.field("isChimeric", bool(flags.isChimeric));
+        if(query.isDetailSelected("metaData")) {
+            query.writeName("metaData");
+            writeJsonString(query.json, reads->getReadMetaData(readId));
+        }
+        query.endItem();
+    }
+}
+
+
+
+// Stored alignments involving an oriented read.
+// Parameters: readId, strand, inReadGraphOnly (on/off).
+// Fields: readId, strand, markerCount, minOrdinalOffset, maxOrdinalOffset,
+// averageOrdinalOffset, maxSkip, maxDrift, leftTrim, rightTrim, range,
+// alignedFraction, isInReadGraph.
+// leftTrim, rightTrim, range, alignedFraction are
+// arrays of two values, one for each of the two oriented reads.
+void Assembler::jsonAlignments(const vector<string>& request, ostream& json)
+{
+    checkMarkersAreOpen();
+    checkAlignmentDataAreOpen();
+    const OrientedReadId orientedReadId0 = getJsonOrientedReadId(request);
+    string inReadGraphOnlyString;
+    getParameterValue(request, "inReadGraphOnly", inReadGraphOnlyString);
+
+    const vector< pair<OrientedReadId, AlignmentInfo> > alignments =
+        findOrientedAlignments(orientedReadId0, inReadGraphOnlyString == "on");
+
+    JsonQuery query(request, json, "alignments", alignments.size());
+    for(uint64_t i=query.begin; i<query.end; i++) {
+        const OrientedReadId orientedReadId1 = alignments[i].first;
+        const AlignmentInfo& info = alignments[i].second;
+        query.beginItem();
+        query.field("readId", orientedReadId1.getReadId());
+        query.field("strand", orientedReadId1.getStrand());
+        query.field("markerCount", info.markerCount);
+        query.field("minOrdinalOffset", info.minOrdinalOffset);
+        query.field("maxOrdinalOffset", info.maxOrdinalOffset);
+        query.field("averageOrdinalOffset", info.averageOrdinalOffset);
+        query.field("maxSkip", info.maxSkip);
+        query.field("maxDrift", info.maxDrift);
+        if(query.isSelected("leftTrim")) {
+            query.writeName("leftTrim");
+            query.json << "[" << info.leftTrim(0) << ", " << info.leftTrim(1) << "]";
+        }
+        if(query.isSelected("rightTrim")) {
+            query.writeName("rightTrim");
+            query.json << "[" << info.rightTrim(0) << ", " << info.rightTrim(1) << "]";
+        }
+        if(query.isSelected("range")) {
+            query.writeName("range");
+            query.json << "[" << info.range(0) << ", " << info.range(1) << "]";
+        }
+        if(query.isSelected("alignedFraction")) {
+            query.writeName("alignedFraction");
+            query.json << "[" << info.alignedFraction(0) << ", " << info.alignedFraction(1) << "]";
+        }
+        query.field("isInReadGraph", bool(info.isInReadGraph));
+        query.endItem();
+    }
+}
+
+
+
+// Read graph neighbors of an oriented read.
+// Parameters: readId, strand.
+// Fields: edgeId, readId, strand, alignmentId, crossesStrands, hasInconsistentAlignment.
+void Assembler::jsonReadGraphNeighbors(const vector<string>& request, ostream& json)
+{
+    checkReadGraphIsOpen();
+    const OrientedReadId orientedReadId0 = getJsonOrientedReadId(request);
+    const span<const uint32_t> edgeIds = readGraph.connectivity[orientedReadId0.getValue()];
+
+    JsonQuery query(request, json, "readGraphNeighbors", edgeIds.size());
+    for(uint64_t i=query.begin; i<query.end; i++) {
+        const uint32_t edgeId = edgeIds[i];
+        const ReadGraphEdge& edge = readGraph.edges[edgeId];
+        const OrientedReadId orientedReadId1 = edge.getOther(orientedReadId0);
+        query.beginItem();
+        query.field("edgeId", edgeId);
+        query.field("readId", orientedReadId1.getReadId());
+        query.field("strand", orientedReadId1.getStrand());
+        query.field("alignmentId", uint64_t(edge.alignmentId));
+        query.field("crossesStrands", bool(edge.crossesStrands));
+        query.field("hasInconsistentAlignment", bool(edge.hasInconsistentAlignment));
+        query.endItem();
+    }
+}
+
+
+
+// Marker graph vertices.
+// Fields: vertexId, coverage, reverseComplementVertex, inDegree, outDegree.
+// Detail fields: markers (array of {readId, strand, ordinal}).
+void Assembler::jsonMarkerGraphVertices(const vector<string>& request, ostream& json)
+{
+    checkMarkerGraphVerticesAreAvailable();
+    const bool edgesAreAvailable =
+        markerGraph.edgesBySource.isOpen() and markerGraph.edgesByTarget.isOpen();
+
+    JsonQuery query(request, json, "markerGraphVertices", markerGraph.vertexCount());
+    for(MarkerGraph::VertexId vertexId=query.begin; vertexId<query.end; vertexId++) {
+        query.beginItem();
+        query.field("vertexId", vertexId);
+        query.field("coverage", markerGraph.vertexCoverage(vertexId));
+        if(markerGraph.reverseComplementVertex.isOpen) {
+            query.field("reverseComplementVertex", markerGraph.reverseComplementVertex[vertexId]);
+        }
+        if(edgesAreAvailable) {
+            query.field("inDegree", markerGraph.inDegree(vertexId));
+            query.field("outDegree", markerGraph.outDegree(vertexId));
+        }
+        if(query.isDetailSelected("markers")) {
+            query.writeName("markers");
+            query.json << "[";
+            const span<const MarkerId> markerIds = markerGraph.getVertexMarkerIds(vertexId);
+            for(uint64_t i=0; i<markerIds.size(); i++) {
+                OrientedReadId orientedReadId;
+                uint32_t ordinal;
+                tie(orientedReadId, ordinal) = findMarkerId(markerIds[i]);
+                if(i > 0) {
+                    query.json << ", ";
+                }
+                query.json << "{\"readId\": " << orientedReadId.getReadId() <<
+                    ", \"strand\": " << orientedReadId.getStrand() <<
+                    ", \"ordinal\": " << ordinal << "}";
+            }
+            query.json << "]";
+        }
+        query.endItem();
+    }
+}
+
+
+
+// Marker graph edges.
+// Fields: edgeId, source, target, coverage, reverseComplementEdge, wasRemoved,
+// wasRemovedByTransitiveReduction, wasPruned, isSuperBubbleEdge,
+// isLowCoverageCrossEdge, wasAssembled, isSecondary,
+// wasRemovedWhileSplittingSecondaryEdges.
+// Detail fields: markerIntervals (array of {readId, strand, ordinals}).
+void Assembler::jsonMarkerGraphEdges(const vector<string>& request, ostream& json)
+{
+    checkMarkerGraphEdgesIsOpen();
+
+    JsonQuery query(request, json, "markerGraphEdges", markerGraph.edges.size());
+    for(MarkerGraph::EdgeId edgeId=query.begin; edgeId<query.end; edgeId++) {
+        const MarkerGraph::Edge& edge = markerGraph.edges[edgeId];
+        query.beginItem();
+        query.field("edgeId", edgeId);
+        query.field("source", MarkerGraph::VertexId(edge.source));
+        query.field("target", MarkerGraph::VertexId(edge.target));
+        query.field("coverage", markerGraph.edgeCoverage(edgeId));
+        if(markerGraph.reverseComplementEdge.isOpen) {
+            query.field("reverseComplementEdge", markerGraph.reverseComplementEdge[edgeId]);
+        }
+        query.field("wasRemoved", edge.wasRemoved());
+        query.field("wasRemovedByTransitiveReduction", bool(edge.wasRemovedByTransitiveReduction));
+        query.field("wasPruned", bool(edge.wasPruned));
+        query.field("isSuperBubbleEdge", bool(edge.isSuperBubbleEdge));
+        query.field("isLowCoverageCrossEdge", bool(edge.isLowCoverageCrossEdge));
+        query.field("wasAssembled", bool(edge.wasAssembled));
+        query.field("isSecondary", bool(edge.isSecondary));
+        query.field("wasRemovedWhileSplittingSecondaryEdges",
+            bool(edge.wasRemovedWhileSplittingSecondaryEdges));
+        if(query.isDetailSelected("markerIntervals")) {
+            query.writeName("markerIntervals");
+            query.json << "[";
+            const span<const MarkerInterval> markerIntervals = markerGraph.edgeMarkerIntervals[edgeId];
+            for(uint64_t i=0; i<markerIntervals.size(); i++) {
+                const MarkerInterval& markerInterval = markerIntervals[i];
+                if(i > 0) {
+                    query.json << ", ";
+                }
+                query.json << "{\"readId\": " << markerInterval.orientedReadId.getReadId() <<
+                    ", \"strand\": " << markerInterval.orientedReadId.getStrand() <<
+                    ", \"ordinals\": [" << markerInterval.ordinals[0] <<
+                    ", " << markerInterval.ordinals[1] << "]}";
+            }
+            query.json << "]";
+        }
+        query.endItem();
+    }
+}
+
+
+
+// Assembly graph segments (assembly mode 0).
+// Fields: segmentId, source, target, reverseComplementSegment, wasRemoved,
+// isAssembled, markerGraphEdgeCount, minVertexCoverage, averageVertexCoverage,
+// maxVertexCoverage, minEdgeCoverage, averageEdgeCoverage, maxEdgeCoverage.
+// Detail fields: markerGraphEdges (array of marker graph edge ids).
+void Assembler::jsonAssemblyGraphSegments(const vector<string>& request, ostream& json)
+{
+    if(not assemblyGraphPointer) {
+        throw runtime_error("The assembly graph is not available.");
+    }
+    const AssemblyGraph& assemblyGraph = *assemblyGraphPointer;
+
+    JsonQuery query(request, json, "assemblyGraphSegments", assemblyGraph.edges.size());
+    for(AssemblyGraph::EdgeId edgeId=query.begin; edgeId<query.end; edgeId++) {
+        const AssemblyGraph::Edge& edge = assemblyGraph.edges[edgeId];
+        query.beginItem();
+        query.field("segmentId", edgeId);
+        query.field("source", edge.source);
+        query.field("target", edge.target);
+        query.field("reverseComplementSegment", assemblyGraph.reverseComplementEdge[edgeId]);
+        query.field("wasRemoved", edge.wasRemoved());
+        query.field("isAssembled", assemblyGraph.isAssembledEdge(edgeId));
+        query.field("markerGraphEdgeCount", assemblyGraph.edgeLists.size(edgeId));
+        query.field("minVertexCoverage", edge.minVertexCoverage);
+        query.field("averageVertexCoverage", edge.averageVertexCoverage);
+        query.field("maxVertexCoverage", edge.maxVertexCoverage);
+        query.field("minEdgeCoverage", edge.minEdgeCoverage);
+        query.field("averageEdgeCoverage", edge.averageEdgeCoverage);
+        query.field("maxEdgeCoverage", edge.maxEdgeCoverage);
+        if(query.isDetailSelected("markerGraphEdges")) {
+            query.writeName("markerGraphEdges");
+            query.json << "[";
+            const span<const AssemblyGraph::EdgeId> markerGraphEdges = assemblyGraph.edgeLists[edgeId];
+            for(uint64_t i=0; i<markerGraphEdges.size(); i++) {
+                if(i > 0) {
+                    query.json << ", ";
+                }
+                query.json << markerGraphEdges[i];
+            }
+            query.json << "]";
+        }
+        query.endItem();
+    }
+}
+
+
+
+// Mode 3 assembly graph segments.
+// Fields: segmentId, markerGraphEdgeCount, averageEdgeCoverage,
+// orientedReadCount, isBackSegment, incomingLinks, outgoingLinks.
+// Detail fields: markerGraphEdges (array of marker graph edge ids).
+void Assembler::jsonMode3Segments(const vector<string>& request, ostream& json)
+{
+    if(not assemblyGraph3Pointer) {
+        throw runtime_error("The mode 3 assembly graph is not available.");
+    }
+    const mode3::AssemblyGraph& assemblyGraph = *assemblyGraph3Pointer;
+
+    JsonQuery query(request, json, "mode3Segments", assemblyGraph.markerGraphPaths.size());
+    for(uint64_t segmentId=query.begin; segmentId<query.end; segmentId++) {
+        query.beginItem();
+        query.field("segmentId", segmentId);
+        query.field("markerGraphEdgeCount", assemblyGraph.markerGraphPaths.size(segmentId));
+        query.field("averageEdgeCoverage", assemblyGraph.segmentCoverage[segmentId]);
+        query.field("orientedReadCount", assemblyGraph.coverage(segmentId));
+        if(assemblyGraph.isBackSegment.isOpen) {
+            query.field("isBackSegment", bool(assemblyGraph.isBackSegment[segmentId]));
+        }
+        if(query.isSelected("incomingLinks")) {
+            query.writeName("incomingLinks");
+            query.json << "[";
+            const span<const uint64_t> linkIds = assemblyGraph.linksByTarget[segmentId];
+            for(uint64_t i=0; i<linkIds.size(); i++) {
+                query.json << (i ? ", " : "") << linkIds[i];
+            }
+            query.json << "]";
+        }
+        if(query.isSelected("outgoingLinks")) {
+            query.writeName("outgoingLinks");
+            query.json << "[";
+            const span<const uint64_t> linkIds = assemblyGraph.linksBySource[segmentId];
+            for(uint64_t i=0; i<linkIds.size(); i++) {
+                query.json << (i ? ", " : "") << linkIds[i];
+            }
+            query.json << "]";
+        }
+        if(query.isDetailSelected("markerGraphEdges")) {
+            query.writeName("markerGraphEdges");
+            query.json << "[";
+            const span<const MarkerGraphEdgeId> markerGraphEdges = assemblyGraph.markerGraphPaths[segmentId];
+            for(uint64_t i=0; i<markerGraphEdges.size(); i++) {
+                query.json << (i ? ", " : "") << markerGraphEdges[i];
+            }
+            query.json << "]";
+        }
+        query.endItem();
+    }
+}
+
+
+
+// Mode 3 assembly graph links.
+// Fields: linkId, segmentId0, segmentId1, segmentsAreAdjacent, separation, coverage.
+// Detail fields: orientedReads (array of {readId, strand}).
+void Assembler::jsonMode3Links(const vector<string>& request, ostream& json)
+{
+    if(not assemblyGraph3Pointer) {
+        throw runtime_error("The mode 3 assembly graph is not available.");
+    }
+    const mode3::AssemblyGraph& assemblyGraph = *assemblyGraph3Pointer;
+
+    JsonQuery query(request, json, "mode3Links", assemblyGraph.links.size());
+    for(uint64_t linkId=query.begin; linkId<query.end; linkId++) {
+        const mode3::AssemblyGraph::Link& link = assemblyGraph.links[linkId];
+        query.beginItem();
+        query.field("linkId", linkId);
+        query.field("segmentId0", link.segmentId0);
+        query.field("segmentId1", link.segmentId1);
+        query.field("segmentsAreAdjacent", link.segmentsAreAdjacent);
+        query.field("separation", link.separation);
+        query.field("coverage", assemblyGraph.linkCoverage(linkId));
+        if(query.isDetailSelected("orientedReads")) {
+            query.writeName("orientedReads");
+            query.json << "[";
+            const auto transitions = assemblyGraph.transitions[linkId];
+            for(uint64_t i=0; i<transitions.size(); i++) {
+                if(i > 0) {
+                    query.json << ", ";
+                }
+                writeJsonOrientedReadId(query.json, transitions[i].first);
+            }
+            query.json << "]";
+        }
+        query.endItem();
+    }
+}
@@ -4,6 +4,7 @@
 #include "compressAlignment.hpp"
 #include "ConsensusCaller.hpp"
 #include "Coverage.hpp"
+#include "deduplicate.hpp"
 #include "hsv.hpp"
 #include "InducedAlignment.hpp"
 #include "LocalMarkerGraph.hpp"
@@ -1689,7 +1690,6 @@ void Assembler::exploreMarkerGraphInducedAlignment(
      const OrientedReadId orientedReadId1(readId1, strand1);
      InducedAlignment inducedAlignment;
      computeInducedAlignment(orientedReadId0, orientedReadId1, inducedAlignment);
-     fillCompressedOrdinals(orientedReadId0, orientedReadId1, inducedAlignment);
      html << "The induced alignment has " << inducedAlignment.data.size() <<
          " marker pairs.";
 
@@ -1749,6 +1749,89 @@ void Assembler::exploreMarkerGraphInducedAlignment(
 
 
 
+// Induced alignments of an oriented read with all of its neighbors in the read graph.
+// This uses the batched computation of induced alignments.
+void Assembler::exploreMarkerGraphInducedAlignments(
+    const vector<string>& request,
+    ostream& html)
+{
+    html <<
+        "<h1>Induced alignments of an oriented read with its read graph neighbors</h1>"
+        "<p>For each neighbor of the given oriented read in the read graph, "
+        "this shows the number of marker pairs in the alignment "
+        "induced by the marker graph between the two oriented reads. "
+        "Follow the links to display each induced alignment matrix.";
+
+    // Get the parameters from the request.
+    ReadId readId = 0;
+    const bool readIdIsPresent = getParameterValue(request, "readId", readId);
+    Strand strand = 0;
+    const bool strandIsPresent = getParameterValue(request, "strand", strand);
+
+    // Write the form.
+    html <<
+        "<p><form>"
+        "<input type=text name=readId required size=8 " <<
+        (readIdIsPresent ? "value="+to_string(readId) : "") <<
+        " title='Enter a read id between 0 and " << reads->readCount()-1 << "'>"
+        " on strand ";
+    writeStrandSelection(html, "strand", strandIsPresent && strand==0, strandIsPresent && strand==1);
+    html << "<p><input type=submit value='Display induced alignments'></form>";
+
+    // If the readId or strand are missing, stop here.
+    if(!readIdIsPresent || !strandIsPresent) {
+        return;
+    }
+    if(readId >= reads->readCount()) {
+        html << "<p>Invalid read id.";
+        return;
+    }
+    if(not readGraph.connectivity.isOpen()) {
+        html << "<p>The read graph is not available.";
+        return;
+    }
+    const OrientedReadId orientedReadId0(readId, strand);
+
+    // Gather the read graph neighbors.
+    vector<OrientedReadId> orientedReadIds1;
+    for(const uint32_t edgeId: readGraph.connectivity[orientedReadId0.getValue()]) {
+        orientedReadIds1.push_back(readGraph.edges[edgeId].getOther(orientedReadId0));
+    }
+    deduplicate(orientedReadIds1);
+
+    // Compute the induced alignments.
+    vector<InducedAlignment> inducedAlignments;
+    computeInducedAlignments(orientedReadId0, orientedReadIds1, inducedAlignments);
+
+    // Write them out.
+    html <<
+        "<p>" << orientedReadId0 << " has " << orientedReadIds1.size() <<
+        " neighbors in the read graph."
+        "<p><table><tr>"
+        "<th>Oriented<br>read"
+        "<th>Markers<br>on vertices<br>in " << orientedReadId0 <<
+        "<th>Markers<br>on vertices<br>in other<br>oriented read"
+        "<th>Marker<br>pairs<br>in induced<br>alignment";
+    for(uint64_t i=0; i<orientedReadIds1.size(); i++) {
+        const OrientedReadId orientedReadId1 = orientedReadIds1[i];
+        const InducedAlignment& inducedAlignment = inducedAlignments[i];
+        html <<
+            "<tr><td class=centered>"
+            "<a href='exploreMarkerGraphInducedAlignment"
+            "?readId0=" << orientedReadId0.getReadId() <<
+            "&strand0=" << orientedReadId0.getStrand() <<
+            "&readId1=" << orientedReadId1.getReadId() <<
+            "&strand1=" << orientedReadId1.getStrand() <<
+            "&ordinalType=ordinals'>" << orientedReadId1 << "</a>"
+            "<td class=centered>" << inducedAlignment.compressedMarkerCount[0] <<
+            "<td class=centered>" << inducedAlignment.compressedMarkerCount[1] <<
+            "<td class=centered>" << inducedAlignment.data.size();
+    }
+    html << "</table>";
+}
+
+
+
 void Assembler::exploreMarkerCoverage(
     const vector<string>& request,
     ostream&html)
@@ -5,6 +5,7 @@
 #include "filesystem.hpp"
 #include "Coverage.hpp"
 #include "buildId.hpp"
+#include "MurmurHash2.hpp"
 #include "platformDependent.hpp"
 #include "Reads.hpp"
 using namespace shasta;
@@ -17,6 +18,7 @@ using namespace shasta;
 
 // Standard library.
 #include <filesystem>
+#include <set>
 #include "fstream.hpp"
 
 
@@ -207,6 +209,7 @@ namespace shasta {
 
 
 #define SHASTA_ADD_TO_FUNCTION_TABLE(name) httpServerData.functionTable[string("/") + #name ] = &Assembler::name
+#define SHASTA_ADD_TO_JSON_FUNCTION_TABLE(name, function) httpServerData.functionTable[string("/json/") + #name ] = &Assembler::function
 
 
 
@@ -235,6 +238,7 @@ void Assembler::fillServerFunctionTable()
     SHASTA_ADD_TO_FUNCTION_TABLE(exploreMarkerGraphEdge);
     SHASTA_ADD_TO_FUNCTION_TABLE(exploreMarkerCoverage);
     SHASTA_ADD_TO_FUNCTION_TABLE(exploreMarkerGraphInducedAlignment);
+    SHASTA_ADD_TO_FUNCTION_TABLE(exploreMarkerGraphInducedAlignments);
     SHASTA_ADD_TO_FUNCTION_TABLE(followReadInMarkerGraph);
     SHASTA_ADD_TO_FUNCTION_TABLE(exploreMarkerConnectivity);
     SHASTA_ADD_TO_FUNCTION_TABLE(exploreAssemblyGraph);
@@ -248,9 +252,22 @@ void Assembler::fillServerFunctionTable()
     SHASTA_ADD_TO_FUNCTION_TABLE(exploreMode3MetaAlignment);
     SHASTA_ADD_TO_FUNCTION_TABLE(exploreMode3AssemblyPath);
     SHASTA_ADD_TO_FUNCTION_TABLE(exploreMode3LinkAssembly);
+    SHASTA_ADD_TO_FUNCTION_TABLE(exploreHttpResponseCache);
+
+    // JSON endpoints.
+    httpServerData.functionTable["/json"] = &Assembler::jsonIndex;
+    SHASTA_ADD_TO_JSON_FUNCTION_TABLE(reads, jsonReads);
+    SHASTA_ADD_TO_JSON_FUNCTION_TABLE(alignments, jsonAlignments);
+    SHASTA_ADD_TO_JSON_FUNCTION_TABLE(readGraphNeighbors, jsonReadGraphNeighbors);
+    SHASTA_ADD_TO_JSON_FUNCTION_TABLE(markerGraphVertices, jsonMarkerGraphVertices);
+    SHASTA_ADD_TO_JSON_FUNCTION_TABLE(markerGraphEdges, jsonMarkerGraphEdges);
+    SHASTA_ADD_TO_JSON_FUNCTION_TABLE(assemblyGraphSegments, jsonAssemblyGraphSegments);
+    SHASTA_ADD_TO_JSON_FUNCTION_TABLE(mode3Segments, jsonMode3Segments);
+    SHASTA_ADD_TO_JSON_FUNCTION_TABLE(mode3Links, jsonMode3Links);
 
 }
 #undef SHASTA_ADD_TO_FUNCTION_TABLE
+#undef SHASTA_ADD_TO_JSON_FUNCTION_TABLE
 
 
 
@@ -293,6 +310,29 @@ void Assembler::processRequest(
 
 
 
+    // Process a JSON request.
+    // The processing function is responsible for writing the entire body.
+    if(keyword == "/json" or keyword.starts_with("/json/")) {
+        html << "Content-Type: application/json\r\n\r\n";
+        const auto it = httpServerData.functionTable.find(keyword);
+        if(it == httpServerData.functionTable.end()) {
+            html << "{\"error\": \"Unsupported keyword " << keyword << "\"}\n";
+            return;
+        }
+        try {
+            const auto function = it->second;
+            (this->*function)(request, html);
+        } catch(const std::exception& e) {
+            doNotCacheResponse();
+            html << "{\"error\": ";
+            writeJsonString(html, span<const char>(e.what(), e.what() + strlen(e.what())));
+            html << "}\n";
+        }
+        return;
+    }
+
+
+
     // Look up the keyword to find the function that will process this request.
     // Note that the keyword includes the initial "/".
     const auto it = httpServerData.functionTable.find(keyword);
@@ -313,6 +353,7 @@ void Assembler::processRequest(
         const auto function = it->second;
         (this->*function)(request, html);
     } catch(const std::exception& e) {
+        doNotCacheResponse();
         html << "<br><br><span style='color:purple'>" << e.what() << "</span>";
     }
     writeHtmlEnd(html);
@@ -320,6 +361,136 @@ void Assembler::processRequest(
 
 
 
+// Only responses that are completely determined by the request
+// and by the binary data, which don't change while the http server
+// is running, can be cached.
+// This excludes pages that use random sampling (assessAlignments),
+// pages that run external programs or use files outside
+// the binary data, and the page that shows cache statistics.
+// Responses generated after an exception are never cached
+// (see processRequest).
+bool Assembler::isCacheable(const vector<string>& request) const
+{
+    static const std::set<string> cacheableKeywords = {
+        "",
+        "/",
+        "/index",
+        "/exploreSummary",
+        "/exploreRead",
+        "/exploreAlignments",
+        "/exploreAlignmentCoverage",
+        "/exploreAlignment",
+        "/exploreAlignmentGraph",
+        "/exploreReadGraph",
+        "/exploreMarkerGraph",
+        "/exploreMarkerGraphVertex",
+        "/exploreMarkerGraphEdge",
+        "/exploreMarkerCoverage",
+        "/exploreMarkerGraphInducedAlignment",
+        "/exploreMarkerGraphInducedAlignments",
+        "/followReadInMarkerGraph",
+        "/exploreMarkerConnectivity",
+        "/exploreAssemblyGraph",
+        "/exploreAssemblyGraphEdge",
+        "/exploreAssemblyGraphEdgesSupport",
+        "/exploreCompressedAssemblyGraph",
+        "/exploreMode3AssemblyGraph",
+        "/exploreMode3AssemblyGraphSegment",
+        "/exploreMode3AssemblyGraphSegmentPair",
+        "/exploreMode3AssemblyGraphLink",
+        "/exploreMode3MetaAlignment",
+        "/exploreMode3AssemblyPath",
+        "/exploreMode3LinkAssembly",
+        "/json",
+        "/json/reads",
+        "/json/alignments",
+        "/json/readGraphNeighbors",
+        "/json/markerGraphVertices",
+        "/json/markerGraphEdges",
+        "/json/assemblyGraphSegments",
+        "/json/mode3Segments",
+        "/json/mode3Links"
+    };
+    return cacheableKeywords.contains(request.front());
+}
+
+
+
+// Enable the http response cache.
+// The fingerprint used to validate cached responses
+// is computed from the build id, the contents of AssemblerInfo,
+// which includes sizes and statistics for all phases of the assembly,
+// and the names, sizes, and modification times of the binary data files.
+// This way, recomputing any of the binary data (for example with
+// setMarkerGraphEdgeFlags from Python) invalidates responses
+// stored on disk by previous invocations.
+void Assembler::setupHttpResponseCache(uint64_t maxByteCount, const string& directory)
+{
+    const AssemblerInfo& info = assemblerInfo.object();
+    const uint64_t hash = MurmurHash64A(&info, int(sizeof(info)), 3517);
+    std::ostringstream fingerprint;
+    fingerprint << buildId() << " " << std::hex << hash;
+
+    // Add the binary data files, in sorted order.
+    if(not largeDataFileNamePrefix.empty()) {
+        const std::filesystem::path prefix(largeDataFileNamePrefix);
+        const string dataDirectory =
+            prefix.has_parent_path() ? prefix.parent_path().string() : string(".");
+        const string namePrefix = prefix.filename().string();
+        vector<string> dataFiles = filesystem::directoryContents(dataDirectory);
+        sort(dataFiles.begin(), dataFiles.end());
+
+        std::ostringstream dataFilesDescription;
+        for(const string& dataFile: dataFiles) {
+            const std::filesystem::path path(dataFile);
+            if(not path.filename().string().starts_with(namePrefix)) {
+                continue;
+            }
+            std::error_code errorCode;
+            const uint64_t size = std::filesystem::file_size(path, errorCode);
+            if(errorCode) {
+                continue;
+            }
+            const auto modificationTime = std::filesystem::last_write_time(path, errorCode);
+            if(errorCode) {
+                continue;
+            }
+            dataFilesDescription << path.filename().string() << " " << size << " " <<
+                modificationTime.time_since_epoch().count() << "\n";
+        }
+        const string dataFilesString = dataFilesDescription.str();
+        const uint64_t dataFilesHash =
+            MurmurHash64A(dataFilesString.data(), int(dataFilesString.size()), 3517);
+        fingerprint << " " << dataFilesHash;
+    }
+
+    setupResponseCache(maxByteCount, directory, fingerprint.str());
+
+    if(responseCache.isEnabled()) {
+        cout << "Http response cache is enabled with a maximum of " <<
+            maxByteCount << " bytes in memory";
+        if(not directory.empty()) {
+            cout << " and on-disk storage in " << directory;
+        }
+        cout << "." << endl;
+    }
+}
+
+
+
+void Assembler::exploreHttpResponseCache(const vector<string>&, ostream& html)
+{
+    html << "<h1>Http response cache</h1>";
+    if(not responseCache.isEnabled()) {
+        html << "The http response cache is not enabled. "
+            "Use --exploreCacheSize or --exploreCacheDirectory to enable it.";
+        return;
+    }
+    responseCache.writeStatistics(html);
+}
+
+
+
 void Assembler::writeMakeAllTablesCopyable(ostream& html) const
 {
     html << R"###(
@@ -448,6 +619,7 @@ void Assembler::writeNavigation(ostream& html) const
         {"Marker graph edges", "exploreMarkerGraphEdge"},
         {"Marker coverage", "exploreMarkerCoverage"},
         {"Induced alignments", "exploreMarkerGraphInducedAlignment"},
+        {"Induced alignments with read graph neighbors", "exploreMarkerGraphInducedAlignments"},
         {"Follow a read in the marker graph", "followReadInMarkerGraph"},
         {"Marker connectivity", "exploreMarkerConnectivity"},
         });
@@ -476,6 +648,10 @@ void Assembler::writeNavigation(ostream& html) const
             });
     }
 
+    writeNavigation(html, "Server", {
+        {"Response cache", "exploreHttpResponseCache"},
+        });
+
     html << "</ul>";
 }
 
@@ -910,16 +1086,9 @@ void Assembler::writeAssemblySummaryBody(ostream& html)
 
 
     // Compute the number of run-length k-mers used as markers.
-    uint64_t totalRleKmerCount = 0;
-    uint64_t markerRleKmerCount = 0;
-    for(const auto& tableEntry: kmerTable) {
-        if(tableEntry.isRleKmer) {
-            ++totalRleKmerCount;
-            if(tableEntry.isMarker) {
-                ++markerRleKmerCount;
-            }
-        }
-    }
+    uint64_t totalRleKmerCount;
+    uint64_t markerRleKmerCount;
+    countRleMarkerKmers(totalRleKmerCount, markerRleKmerCount);
 
     const uint64_t totalDiscardedReadCount =
         assemblerInfo->discardedInvalidBaseReadCount +
@@ -1243,16 +1412,9 @@ void Assembler::writeAssemblySummaryJson(ostream& json)
 
 
     // Compute the number of run-length k-mers used as markers.
-    uint64_t totalRleKmerCount = 0;
-    uint64_t markerRleKmerCount = 0;
-    for(const auto& tableEntry: kmerTable) {
-        if(tableEntry.isRleKmer) {
-            ++totalRleKmerCount;
-            if(tableEntry.isMarker) {
-                ++markerRleKmerCount;
-            }
-        }
-    }
+    uint64_t totalRleKmerCount;
+    uint64_t markerRleKmerCount;
+    countRleMarkerKmers(totalRleKmerCount, markerRleKmerCount);
 
     const uint64_t totalDiscardedReadCount =
         assemblerInfo->discardedInvalidBaseReadCount +
@@ -1,8 +1,6 @@
 // Shasta.
 #include "Assembler.hpp"
-#include "deduplicate.hpp"
 #include "InducedAlignment.hpp"
-#include "orderPairs.hpp"
 using namespace shasta;
 
 
@@ -14,84 +12,11 @@ void Assembler::computeInducedAlignment(
     OrientedReadId orientedReadId0,
     OrientedReadId orientedReadId1,
     InducedAlignment& inducedAlignment
-)
+) const
 {
-    // Get the Marker graph vertices for the two oriented reads.
-    using VertexId = MarkerGraph::VertexId;
-    vector< pair<uint32_t, VertexId> > vertices0;
-    vector< pair<uint32_t, VertexId> > vertices1;
-    getMarkerGraphVertices(orientedReadId0, vertices0);
-    getMarkerGraphVertices(orientedReadId1, vertices1);
-
-    // Sort them by vertex id.
-    sort(vertices0.begin(), vertices0.end(),
-        OrderPairsBySecondOnly<uint32_t, VertexId>());
-    sort(vertices1.begin(), vertices1.end(),
-        OrderPairsBySecondOnly<uint32_t, VertexId>());
-
-    // Some iterators we need below.
-    using Iterator =  vector< pair<uint32_t, VertexId> >::iterator;
-    const Iterator begin0 = vertices0.begin();
-    const Iterator begin1 = vertices1.begin();
-    const Iterator end0 = vertices0.end();
-    const Iterator end1 = vertices1.end();
-
-
-
-    // Gather the vertices of the induced alignments.
-    inducedAlignment.data.clear();
-    Iterator it0 = begin0;
-    Iterator it1 = begin1;
-    while(it0 not_eq end0 and it1 not_eq end1) {
-        const VertexId vertexId0 = it0->second;
-        const VertexId vertexId1 = it1->second;
-        if(vertexId0 < vertexId1) {
-            ++it0;
-            continue;
-        }
-        if(vertexId1 < vertexId0) {
-            ++it1;
-            continue;
-        }
-
-        // If getting here, we found a common vertex.
-        SHASTA_ASSERT(vertexId0 == vertexId1);
-        const VertexId vertexId = vertexId0;
-
-
-        // See if there are more markers from these reads on these vertices.
-        Iterator it0Begin = it0;
-        Iterator it1Begin = it1;
-        Iterator it0End = it0Begin;
-        Iterator it1End = it1Begin;
-        while(it0End!=end0 and it0End->second==vertexId) {
-            ++it0End;
-        }
-        while(it1End!=end1 and it1End->second==vertexId) {
-            ++it1End;
-        }
-
-        // When generating marker graph vertices, we don't allow two
-        // markers from the same oriented read on a vertex.
-        // So both streaks should have size 1.
-        // However the code below does not make this assumption.
-        SHASTA_ASSERT(it0End - it0Begin == 1);
-        SHASTA_ASSERT(it1End - it1Begin == 1);
-
-        // Loop over pairs in the streaks.
-        for(Iterator jt0=it0Begin; jt0!=it0End; ++jt0) {
-            for(Iterator jt1=it1Begin; jt1!=it1End; ++jt1) {
-                inducedAlignment.data.push_back(
-                    InducedAlignmentData(vertexId, jt0->first, jt1->first));
-            }
-        }
-
-       // Position at the end of these streaks to continue processing.
-        it0 = it0End;
-        it1 = it1End;
-    }
-
-    inducedAlignment.sort();
+    InducedAlignmentWorkArea workArea;
+    setInducedAlignmentAnchor(orientedReadId0, workArea);
+    computeInducedAlignment(workArea, orientedReadId1, inducedAlignment);
 }
 
 
@@ -102,84 +27,129 @@ void Assembler::computeInducedAlignments(
     OrientedReadId orientedReadId0,
     const vector<OrientedReadId>& orientedReadIds1,
     vector<InducedAlignment>& inducedAlignments
-)
+) const
 {
-    // Initialize one induced alignment for each
-    // OrientedReadId in orientedReadIds1.
-    inducedAlignments.clear();
-    inducedAlignments.resize(orientedReadIds1.size());
+    // Check that orientedReadIds1 is sorted.
+    SHASTA_ASSERT(std::is_sorted(orientedReadIds1.begin(), orientedReadIds1.end()));
 
-    // Fast exit if orientedReadIds1 is empty.
+    inducedAlignments.resize(orientedReadIds1.size());
     if(orientedReadIds1.empty()) {
         return;
     }
 
-    // Check that orientedReadIds1 is sorted.
-    SHASTA_ASSERT(std::is_sorted(orientedReadIds1.begin(), orientedReadIds1.end()));
+    InducedAlignmentWorkArea workArea;
+    setInducedAlignmentAnchor(orientedReadId0, workArea);
+    for(uint64_t i=0; i<orientedReadIds1.size(); i++) {
+        computeInducedAlignment(workArea, orientedReadIds1[i], inducedAlignments[i]);
+    }
+}
 
 
 
-    // Main loop over markers in orientedReadId0.
-    const MarkerId firstMarkerId = markers.begin(orientedReadId0.getValue()) - markers.begin();
-    const uint32_t markerCount = uint32_t(markers.size(orientedReadId0.getValue()));
-    for(uint32_t ordinal0=0; ordinal0<markerCount; ordinal0++) {
-        const MarkerId markerId0 = firstMarkerId + ordinal0;
+// Get the markers of an oriented read that are on a marker graph vertex,
+// sorted by vertex id.
+// The compressed ordinal is the index of each of these markers
+// before sorting.
+static void getInducedAlignmentVertices(
+    OrientedReadId orientedReadId,
+    const MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t>& markers,
+    const MarkerGraph& markerGraph,
+    vector<InducedAlignmentWorkArea::Vertex>& vertices)
+{
+    const MarkerId firstMarkerId = markers.begin(orientedReadId.getValue()) - markers.begin();
+    const uint32_t markerCount = uint32_t(markers.size(orientedReadId.getValue()));
 
-        // Find the vertex that this marker is on.
+    vertices.clear();
+    uint32_t compressedOrdinal = 0;
+    for(uint32_t ordinal=0; ordinal<markerCount; ordinal++) {
         const MarkerGraph::CompressedVertexId compressedVertexId =
-            markerGraph.vertexTable[markerId0];
+            markerGraph.vertexTable[firstMarkerId + ordinal];
+        if(compressedVertexId != MarkerGraph::invalidCompressedVertexId) {
+            vertices.push_back({MarkerGraph::VertexId(compressedVertexId), ordinal, compressedOrdinal++});
+        }
+    }
+    sort(vertices.begin(), vertices.end());
+}
+
+
+
+void Assembler::setInducedAlignmentAnchor(
+    OrientedReadId orientedReadId0,
+    InducedAlignmentWorkArea& workArea) const
+{
+    workArea.orientedReadId0 = orientedReadId0;
+    getInducedAlignmentVertices(orientedReadId0, markers, markerGraph, workArea.vertices0);
+}
+
 
-        // If this marker is not on a marker graph vertex, skip.
-        if(compressedVertexId == MarkerGraph::invalidCompressedVertexId) {
+
+// Compute the induced alignment between the anchor oriented read
+// of the work area and orientedReadId1, using a linear merge
+// of the vertices of the two oriented reads.
+// This also fills in the compressed ordinals.
+void Assembler::computeInducedAlignment(
+    InducedAlignmentWorkArea& workArea,
+    OrientedReadId orientedReadId1,
+    InducedAlignment& inducedAlignment) const
+{
+    using VertexId = MarkerGraph::VertexId;
+    using Vertex = InducedAlignmentWorkArea::Vertex;
+    using Iterator = vector<Vertex>::const_iterator;
+
+    const vector<Vertex>& vertices0 = workArea.vertices0;
+    vector<Vertex>& vertices1 = workArea.vertices1;
+    getInducedAlignmentVertices(orientedReadId1, markers, markerGraph, vertices1);
+
+    inducedAlignment.data.clear();
+    inducedAlignment.compressedMarkerCount = {uint32_t(vertices0.size()), uint32_t(vertices1.size())};
+
+    const Iterator end0 = vertices0.end();
+    const Iterator end1 = vertices1.end();
+    Iterator it0 = vertices0.begin();
+    Iterator it1 = vertices1.begin();
+    while(it0 != end0 and it1 != end1) {
+        const VertexId vertexId0 = it0->vertexId;
+        const VertexId vertexId1 = it1->vertexId;
+        if(vertexId0 < vertexId1) {
+            ++it0;
+            continue;
+        }
+        if(vertexId1 < vertexId0) {
+            ++it1;
             continue;
         }
 
-        // Loop over all markers on this vertex.
-        const span<MarkerId> vertexMarkers =
-            markerGraph.getVertexMarkerIds(compressedVertexId);
-        for(const MarkerId markerId1: vertexMarkers) {
+        // If getting here, we found a common vertex.
+        const VertexId vertexId = vertexId0;
 
-            // Skip the marker that we started from.
-            if(markerId1 == markerId0) {
-                continue;
-            }
+        // Find the streaks of markers on this vertex.
+        // When duplicate markers are not allowed in the marker graph,
+        // both streaks have size 1, but we don't make this assumption.
+        Iterator it0End = it0;
+        Iterator it1End = it1;
+        while(it0End != end0 and it0End->vertexId == vertexId) {
+            ++it0End;
+        }
+        while(it1End != end1 and it1End->vertexId == vertexId) {
+            ++it1End;
+        }
 
-            // Find the oriented read on this marker.
-            OrientedReadId orientedReadId1;
-            uint32_t ordinal1;
-            tie(orientedReadId1, ordinal1) = findMarkerId(markerId1);
-
-            // Look for orientedReadId1 in the orientedReadIds1 vector.
-            const vector<OrientedReadId>::const_iterator it =
-                std::lower_bound(
-                    orientedReadIds1.begin(),
-                    orientedReadIds1.end(),
-                    orientedReadId1);
-            if((it == orientedReadIds1.end()) or (*it != orientedReadId1)) {
-                continue;
+        // Loop over pairs in the streaks.
+        for(Iterator jt0=it0; jt0!=it0End; ++jt0) {
+            for(Iterator jt1=it1; jt1!=it1End; ++jt1) {
+                InducedAlignmentData d(vertexId, jt0->ordinal, jt1->ordinal);
+                d.compressedOrdinal0 = jt0->compressedOrdinal;
+                d.compressedOrdinal1 = jt1->compressedOrdinal;
+                inducedAlignment.data.push_back(d);
             }
-
-            // Add this marker to the corresponding induced alignment.
-            const uint64_t index1 = it -orientedReadIds1.begin();
-            const MarkerGraph::VertexId vertexId = compressedVertexId;
-            inducedAlignments[index1].data.push_back(
-                InducedAlignmentData(vertexId, ordinal0, ordinal1));
         }
-    }
 
-    // Sort the induced alignments.
-    for(InducedAlignment& inducedAlignment: inducedAlignments) {
-        inducedAlignment.sort();
-    }
-
-    // Fill in the compressed ordinals.
-    SHASTA_ASSERT(orientedReadIds1.size() == inducedAlignments.size());
-    for(uint64_t i=0; i<orientedReadIds1.size(); i++){
-        const OrientedReadId orientedReadId1 = orientedReadIds1[i];
-        InducedAlignment& inducedAlignment = inducedAlignments[i];
-        fillCompressedOrdinals(orientedReadId0, orientedReadId1, inducedAlignment);
+        // Position at the end of these streaks to continue processing.
+        it0 = it0End;
+        it1 = it1End;
     }
 
+    inducedAlignment.sort();
 }
 
 
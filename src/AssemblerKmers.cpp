@@ -8,23 +8,80 @@ using namespace shasta;
 
 // Standard library.
 #include "fstream.hpp"
+#include <cmath>
+#include <limits>
 #include <random>
 
 
 
 void Assembler::accessKmers()
 {
+#ifdef SHASTA_LONG_KMERS
+    // There is no k-mer table. Everything we need is in assemblerInfo.
+    checkKmersAreOpen();
+#else
     kmerTable.accessExistingReadOnly(largeDataName("Kmers"));
     if(kmerTable.size() != (1ULL<< (2*assemblerInfo->k))) {
         throw runtime_error("Size of k-mer vector is inconsistent with stored value of k.");
     }
+#endif
 }
 
 void Assembler::checkKmersAreOpen()const
 {
+#ifdef SHASTA_LONG_KMERS
+    if(assemblerInfo->kmerHashThreshold == 0) {
+        throw runtime_error("Kmers are not accessible.");
+    }
+#else
     if(!kmerTable.isOpen) {
         throw runtime_error("Kmers are not accessible.");
     }
+#endif
+}
+
+
+
+KmerChecker Assembler::getKmerChecker() const
+{
+    checkKmersAreOpen();
+#ifdef SHASTA_LONG_KMERS
+    return KmerChecker(assemblerInfo->k, assemblerInfo->kmerHashThreshold, assemblerInfo->kmerHashSeed);
+#else
+    return KmerChecker(kmerTable);
+#endif
+}
+
+
+
+void Assembler::countRleMarkerKmers(
+    uint64_t& totalRleKmerCount,
+    uint64_t& markerRleKmerCount) const
+{
+    checkKmersAreOpen();
+
+#ifdef SHASTA_LONG_KMERS
+    // There are 4 * 3^(k-1) RLE k-mers, and each is a marker
+    // with probability kmerHashThreshold / 2^64.
+    double rleKmerCount = 4.;
+    for(uint64_t i=1; i<assemblerInfo->k; i++) {
+        rleKmerCount *= 3.;
+    }
+    const double markerFraction = std::ldexp(double(assemblerInfo->kmerHashThreshold), -64);
+    totalRleKmerCount = uint64_t(rleKmerCount);
+    markerRleKmerCount = uint64_t(std::round(markerFraction * rleKmerCount));
+#else
+    totalRleKmerCount = 0;
+    markerRleKmerCount = 0;
+    for(const auto& tableEntry: kmerTable) {
+        if(tableEntry.isRleKmer) {
+            ++totalRleKmerCount;
+            if(tableEntry.isMarker) {
+                ++markerRleKmerCount;
+            }
+        }
+    }
+#endif
 }
 
 
@@ -57,6 +114,26 @@ void Assembler::randomlySelectKmers(
 
 
 
+#ifdef SHASTA_LONG_KMERS
+    // There is no k-mer table. A k-mer and its reverse complement are
+    // markers if the hash of the canonical KmerId is less than a threshold
+    // (see KmerChecker.hpp). The fraction of k-mers selected as markers
+    // equals the fraction of hash values below the threshold.
+    if(probability == 0.) {
+        throw runtime_error("Invalid k-mer probability " +
+            to_string(probability) + " requested.");
+    }
+    assemblerInfo->kmerHashSeed = uint64_t(seed);
+    assemblerInfo->kmerHashThreshold = (probability == 1.) ?
+        std::numeric_limits<uint64_t>::max() :
+        uint64_t(std::ldexp(probability, 64));
+    cout << "K-mers of length " << k << " will be selected as markers using a hash, "
+        "with probability " << probability << "." << endl;
+    return;
+#endif
+
+
+
     // Fill in the fields of the k-mer table
     // that depends only on k.
     initializeKmerTable();
@@ -146,6 +223,12 @@ void Assembler::randomlySelectKmers(
 
 void Assembler::initializeKmerTable()
 {
+#ifdef SHASTA_LONG_KMERS
+    throw runtime_error("This k-mer generation method requires a table of all k-mers "
+        "and is not supported in builds with long k-mers. "
+        "Use --Kmers.generationMethod 0.");
+#endif
+
     // Create the kmer table with the necessary size.
     kmerTable.createNew(largeDataName("Kmers"), largeDataPageSize);
     const size_t k = assemblerInfo->k;
@@ -192,6 +275,9 @@ void Assembler::initializeKmerTable()
 void Assembler::writeKmers(const string& fileName) const
 {
     checkKmersAreOpen();
+#ifdef SHASTA_LONG_KMERS
+    throw runtime_error("writeKmers is not available in builds with long k-mers.");
+#endif
 
     // Get the k-mer length.
     const size_t k = assemblerInfo->k;
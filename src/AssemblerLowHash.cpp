@@ -1,6 +1,7 @@
 #include "Assembler.hpp"
 #include "LowHash0.hpp"
 #include "LowHash1.hpp"
+#include "LowHash2.hpp"
 using namespace shasta;
 
 
@@ -28,6 +29,9 @@ void Assembler::findAlignmentCandidatesLowHash0(
     const ReadId readCount = ReadId(markers.size() / 2);
     SHASTA_ASSERT(readCount > 0);
 
+    // LowHash0 does not create alignment candidate bands.
+    removeAlignmentCandidateBands();
+
     // Create the alignment candidates.
     alignmentCandidates.candidates.createNew(largeDataName("AlignmentCandidates"), largeDataPageSize);
     readLowHashStatistics.createNew(largeDataName("ReadLowHashStatistics"), largeDataPageSize);
@@ -59,6 +63,20 @@ void Assembler::findAlignmentCandidatesLowHash0(
 void Assembler::accessAlignmentCandidates()
 {
     alignmentCandidates.candidates.accessExistingReadOnly(largeDataName("AlignmentCandidates"));
+
+    // The bands are only available when using LowHash1 or LowHash2.
+    // Don't use them if they don't correspond to the alignment candidates.
+    try {
+        alignmentCandidates.bands.accessExistingReadOnly(largeDataName("AlignmentCandidateBands"));
+    } catch(exception&) {
+        // Leave them closed.
+        return;
+    }
+    if(alignmentCandidates.bands.size() != alignmentCandidates.candidates.size()) {
+        cout << "Alignment candidate bands are not consistent with the "
+            "alignment candidates and will not be used." << endl;
+        alignmentCandidates.bands.close();
+    }
 }
 
 void Assembler::accessAlignmentCandidateTable()
@@ -174,6 +192,125 @@ void Assembler::findAlignmentCandidatesLowHash1(
         largeDataPageSize);
     
     alignmentCandidates.unreserve();
+    computeAlignmentCandidateBands(threadCount);
+}
+
+
+
+// Single pass version that chains common features with consistent offsets.
+// It also stores alignmentCandidates.featureOrdinals.
+void Assembler::findAlignmentCandidatesLowHash2(
+    size_t m,                       // Number of consecutive k-mers that define a feature.
+    double hashFraction,            // Low hash threshold.
+    size_t minBucketSize,           // The minimum frequency for a feature to be used.
+    size_t maxBucketSize,           // The maximum frequency for a feature to be used.
+    size_t minFrequency,            // Minimum number of chained common features for a pair to become a candidate.
+    size_t maxDrift,                // Maximum offset difference between chained common features.
+    size_t threadCount)
+{
+    // Check that we have what we need.
+    checkKmersAreOpen();
+    checkMarkersAreOpen();
+    const ReadId readCount = ReadId(markers.size() / 2);
+    SHASTA_ASSERT(readCount > 0);
+
+    // Prepare storage.
+    alignmentCandidates.candidates.createNew(
+        largeDataName("AlignmentCandidates"), largeDataPageSize);
+    alignmentCandidates.featureOrdinals.createNew(
+        largeDataName("AlignmentCandidatesFeatureOrdinale"), largeDataPageSize);
+
+    // Do the computation.
+    LowHash2 lowHash2(
+        m,
+        hashFraction,
+        minBucketSize,
+        maxBucketSize,
+        minFrequency,
+        maxDrift,
+        threadCount,
+        getReads(),
+        markers,
+        alignmentCandidates,
+        largeDataFileNamePrefix,
+        largeDataPageSize);
+
+    alignmentCandidates.unreserve();
+    computeAlignmentCandidateBands(threadCount);
+}
+
+
+
+// Compute alignmentCandidates.bands from alignmentCandidates.featureOrdinals.
+// For each candidate, this stores the median offset (ordinal1 - ordinal0)
+// of its features and the maximum distance of a feature offset from the median.
+// The alignment can then be restricted to a band around that median
+// instead of searching the entire alignment matrix.
+void Assembler::computeAlignmentCandidateBands(size_t threadCount)
+{
+    SHASTA_ASSERT(alignmentCandidates.featureOrdinals.isOpen());
+    const uint64_t candidateCount = alignmentCandidates.candidates.size();
+    SHASTA_ASSERT(alignmentCandidates.featureOrdinals.size() == candidateCount);
+
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    removeAlignmentCandidateBands();
+    alignmentCandidates.bands.createNew(
+        largeDataName("AlignmentCandidateBands"), largeDataPageSize);
+    alignmentCandidates.bands.reserveAndResize(candidateCount);
+    setupLoadBalancing(candidateCount, 10000);
+    runThreads(&Assembler::computeAlignmentCandidateBandsThreadFunction, threadCount);
+}
+
+
+
+void Assembler::removeAlignmentCandidateBands()
+{
+    if(not alignmentCandidates.bands.isOpen) {
+        try {
+            alignmentCandidates.bands.accessExistingReadWrite(largeDataName("AlignmentCandidateBands"));
+        } catch(exception&) {
+            // There is nothing to remove.
+            return;
+        }
+    }
+    alignmentCandidates.bands.remove();
+}
+
+
+
+void Assembler::computeAlignmentCandidateBandsThreadFunction(size_t /* threadId */)
+{
+    vector<int32_t> offsets;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(uint64_t i=begin; i!=end; i++) {
+            AlignmentCandidateBand& band = alignmentCandidates.bands[i];
+
+            // A candidate without features gives no information.
+            // Make its band too wide to be used.
+            const auto features = alignmentCandidates.featureOrdinals[i];
+            if(features.empty()) {
+                band.offset = 0;
+                band.spread = std::numeric_limits<uint32_t>::max();
+                continue;
+            }
+
+            offsets.clear();
+            for(const auto& feature: features) {
+                offsets.push_back(int32_t(feature[1]) - int32_t(feature[0]));
+            }
+            const auto median = offsets.begin() + offsets.size() / 2;
+            std::nth_element(offsets.begin(), median, offsets.end());
+            band.offset = *median;
+            const auto [offsetMin, offsetMax] = std::minmax_element(offsets.begin(), offsets.end());
+            band.spread = uint32_t(max(band.offset - *offsetMin, *offsetMax - band.offset));
+        }
+    }
 }
 
 
@@ -311,6 +448,9 @@ void Assembler::writeAlignmentCandidates(bool useReadName, bool verbose) const
 // This marks all pairs as alignment candidates.
 void Assembler::markAlignmentCandidatesAllPairs()
 {
+    // No alignment candidate bands are created in this case.
+    removeAlignmentCandidateBands();
+
     // Create the alignment candidates.
     alignmentCandidates.candidates.createNew(largeDataName("AlignmentCandidates"), largeDataPageSize);
 
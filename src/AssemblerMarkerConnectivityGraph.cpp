@@ -1,5 +1,6 @@
 // Shasta.
 #include "Assembler.hpp"
+#include "deduplicate.hpp"
 #include "MarkerConnectivityGraph.hpp"
 using namespace shasta;
 
@@ -7,6 +8,7 @@ using namespace shasta;
 #include <boost/graph/iteration_macros.hpp>
 
 // Standard library.
+#include "algorithm.hpp"
 #include <map>
 #include <queue>
 
@@ -82,3 +84,65 @@ void Assembler::createMarkerConnectivityGraph(
     }
 
 }
+
+
+
+void Assembler::createMarkerConnectivityGraphFlat(
+    const vector<MarkerDescriptor>& markerDescriptors,
+    bool useReadGraphAlignmentsOnly,
+    vector< pair<uint64_t, uint64_t> >& edges,
+    vector<bool>& isReached) const
+{
+    const uint64_t markerCount = markerDescriptors.size();
+    SHASTA_ASSERT(markerCount > 0);
+    SHASTA_ASSERT(std::is_sorted(markerDescriptors.begin(), markerDescriptors.end()));
+
+    edges.clear();
+    isReached.clear();
+    isReached.resize(markerCount, false);
+
+    // Initialize a BFS in the space of aligned markers.
+    // The queue is a vector of indexes into markerDescriptors.
+    vector<uint64_t> q;
+    q.reserve(markerCount);
+    q.push_back(0);
+    isReached[0] = true;
+
+
+
+    // BFS loop.
+    vector<MarkerDescriptor> alignedMarkers;
+    for(uint64_t queueIndex=0; queueIndex<q.size(); queueIndex++) {
+        const uint64_t i0 = q[queueIndex];
+        const MarkerDescriptor& markerDescriptor0 = markerDescriptors[i0];
+
+        // Find aligned markers for this marker.
+        findAlignedMarkers(markerDescriptor0.first, markerDescriptor0.second,
+            useReadGraphAlignmentsOnly, alignedMarkers);
+
+        for(const MarkerDescriptor& markerDescriptor1: alignedMarkers) {
+
+            // Locate markerDescriptor1. It must be one of the given markers.
+            const auto it1 = std::lower_bound(
+                markerDescriptors.begin(), markerDescriptors.end(), markerDescriptor1);
+            SHASTA_ASSERT(it1 != markerDescriptors.end() and *it1 == markerDescriptor1);
+            const uint64_t i1 = it1 - markerDescriptors.begin();
+
+            // If not already reached, enqueue it.
+            if(not isReached[i1]) {
+                isReached[i1] = true;
+                q.push_back(i1);
+            }
+
+            // Store the edge.
+            if(i0 < i1) {
+                edges.push_back(make_pair(i0, i1));
+            } else if(i1 < i0) {
+                edges.push_back(make_pair(i1, i0));
+            }
+        }
+    }
+
+    // Each edge was found from both sides.
+    deduplicate(edges);
+}
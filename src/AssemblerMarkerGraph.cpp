@@ -9,6 +9,7 @@
 #include "PeakFinder.hpp"
 #include "performanceLog.hpp"
 #include "LocalMarkerGraph.hpp"
+#include "LocalMarkerGraphFlat.hpp"
 #include "Reads.hpp"
 #include "timestamp.hpp"
 using namespace shasta;
@@ -96,77 +97,20 @@ void Assembler::createMarkerGraphVertices(
     // Initialize computation of the global marker graph.
     data.orientedMarkerCount = markers.totalSize();
 
-    data.disjointSetTable.createNew(
-        largeDataName("tmp-DisjointSetTable"),
-        largeDataPageSize);
-    // DisjointSets data structure needs an additional 64 bits per entry, in order to implement
-    // a lock-free, union-find operation. You can find more information in dset64-gccatomic.hpp.
-    // Once the set representatives have been found, we have no need for these extra 64 bits per entry.
-    //
-    // We allocate twice as much space in data.disjointSetTable so that the underlying memory
-    // can be used as an array of 128 bit integers of size data.orientedMarkerCount. This allows
-    // us to compact the data in-place, there by reducing memory usage.
-    data.disjointSetTable.reserveAndResize(data.orientedMarkerCount * 2);
-
-    // Have DisjointSets use the memory allocated in and managed by data.disjointSetTable.
-    data.disjointSetsPointer = std::make_shared<DisjointSets>(
-        reinterpret_cast<DisjointSets::Aint*>(data.disjointSetTable.begin()),
-        data.orientedMarkerCount
-    );
-
-
-
-    // Update the disjoint set data structure for each alignment
-    // in the read graph.
-    performanceLog << timestamp << "Disjoint set computation begins." << endl;
-    size_t batchSize = 10000;
-    setupLoadBalancing(readGraph.edges.size(), batchSize);
-    runThreads(&Assembler::createMarkerGraphVerticesThreadFunction1, threadCount);
-    performanceLog << timestamp << "Disjoint set computation completed." << endl;
-
-
-
-    // Find the disjoint set that each oriented marker was assigned to.
-    // Iterate till each marker has its set representative populated in the parent (lower 64 bits)
-    uint64_t pass = 1;
-    do {
-        (data.disjointSetsPointer)->parentUpdated = 0;
-        performanceLog << "    " << timestamp << " Iteration  " << pass << endl;
-        setupLoadBalancing(data.orientedMarkerCount, batchSize);
-        runThreads(&Assembler::createMarkerGraphVerticesThreadFunction2, threadCount);
-        performanceLog << "    " << timestamp << " Updated parent of - " << (data.disjointSetsPointer)->parentUpdated << " entries." << endl;
-        pass++;
-    } while ((data.disjointSetsPointer)->parentUpdated > 0 && pass <= 10);
-
-    if (pass > 10) {
-        // This should never happen. Even in a highly parallel environment (128 threads), convergence happens
-        // in 2 or 3 passes. It's definitely worth investigating if this ever happens.
-        string errorMsg = "DisjointSets parent information did not converge in " + to_string(pass) + " iterations.";
-        throw runtime_error(errorMsg);
+    // Compute the disjoint set that each oriented marker belongs to,
+    // storing it in data.disjointSetTable.
+    // In iterative assembly, if requested, this is done by updating
+    // the disjoint sets computed during the previous iteration.
+    // See AssemblerMarkerGraphIncremental.cpp.
+    if(incrementalMarkerGraphData.canUpdate(data.orientedMarkerCount, alignmentData.size())) {
+        updateMarkerGraphDisjointSets(threadCount);
+    } else {
+        computeMarkerGraphDisjointSets(threadCount);
     }
-
-
-    performanceLog << timestamp << "Verifying convergence of parent information." << endl;
-    setupLoadBalancing(data.orientedMarkerCount, batchSize);
-    runThreads(&Assembler::createMarkerGraphVerticesThreadFunction21, threadCount);
-    performanceLog << timestamp << "Done verifying convergence of parent information." << endl;
-
-
-    // data.disjointSetTable now has the correct set representative for entry N at location 2*N.
-    // That's because DisjointSets stores parent information in the lower 64 bits of the 128 bits
-    // it uses for each entry. Since we only care about these bits, we can compact data.disjointSetTable
-    // and free up half the memory.
-    // This bit seems tricky to parallelize. It's not worth the effort as this is pretty fast as is.
-    performanceLog << timestamp << "Compacting the Disjoint Set data-structure." << endl;
-    for(uint64_t i=0; i<data.orientedMarkerCount; i++) {
-        data.disjointSetTable[i] = data.disjointSetTable[2*i];
+    if(incrementalMarkerGraphData.isEnabled) {
+        storeMarkerGraphDisjointSets();
     }
-    data.disjointSetTable.resize(data.orientedMarkerCount);
-    data.disjointSetTable.unreserve();
-    performanceLog << timestamp << "Done compacting the Disjoint Set data-structure." << endl;
-
-    // Don't need the DisjointSets data-structure any more.
-    data.disjointSetsPointer = 0;
+    const size_t batchSize = 10000;
 
 
 
@@ -208,6 +152,7 @@ void Assembler::createMarkerGraphVertices(
     // At this point, data.workArea contains the number of oriented markers in
     // each disjoint set.
     // Compute a histogram of this distribution and write it to a csv file.
+    const bool minCoverageWasSelectedAutomatically = (minCoverage == 0);
     {
         vector<uint64_t> histogram;
         for(MarkerGraph::VertexId i=0; i<data.orientedMarkerCount; i++) {
@@ -249,6 +194,13 @@ void Assembler::createMarkerGraphVertices(
                     "Using MarkerGraph.minCoverage = " << minCoverage << endl;
             }
         }
+
+        // If an estimate of this histogram is available, compare.
+        // See estimateMarkerGraphCoverageHistogram.
+        if(markerGraphCoverageEstimateData.isValid) {
+            compareMarkerGraphCoverageHistogramEstimate(histogram,
+                minCoverage, maxCoverage, minCoverageWasSelectedAutomatically);
+        }
     }
     // Store the value of minCoverage actually used.
     assemblerInfo->markerGraphMinCoverageUsed = minCoverage;
@@ -519,6 +471,88 @@ void Assembler::createMarkerGraphVertices(
 
 
 
+// Compute the disjoint set that each oriented marker belongs to,
+// using all the alignments in the read graph,
+// and store it in createMarkerGraphVerticesData.disjointSetTable.
+void Assembler::computeMarkerGraphDisjointSets(size_t threadCount)
+{
+    auto& data = createMarkerGraphVerticesData;
+
+    data.disjointSetTable.createNew(
+        largeDataName("tmp-DisjointSetTable"),
+        largeDataPageSize);
+    // DisjointSets data structure needs an additional 64 bits per entry, in order to implement
+    // a lock-free, union-find operation. You can find more information in dset64-gccatomic.hpp.
+    // Once the set representatives have been found, we have no need for these extra 64 bits per entry.
+    //
+    // We allocate twice as much space in data.disjointSetTable so that the underlying memory
+    // can be used as an array of 128 bit integers of size data.orientedMarkerCount. This allows
+    // us to compact the data in-place, there by reducing memory usage.
+    data.disjointSetTable.reserveAndResize(data.orientedMarkerCount * 2);
+
+    // Have DisjointSets use the memory allocated in and managed by data.disjointSetTable.
+    data.disjointSetsPointer = std::make_shared<DisjointSets>(
+        reinterpret_cast<DisjointSets::Aint*>(data.disjointSetTable.begin()),
+        data.orientedMarkerCount
+    );
+
+
+
+    // Update the disjoint set data structure for each alignment
+    // in the read graph.
+    performanceLog << timestamp << "Disjoint set computation begins." << endl;
+    size_t batchSize = 10000;
+    setupLoadBalancing(readGraph.edges.size(), batchSize);
+    runThreads(&Assembler::createMarkerGraphVerticesThreadFunction1, threadCount);
+    performanceLog << timestamp << "Disjoint set computation completed." << endl;
+
+
+
+    // Find the disjoint set that each oriented marker was assigned to.
+    // Iterate till each marker has its set representative populated in the parent (lower 64 bits)
+    uint64_t pass = 1;
+    do {
+        (data.disjointSetsPointer)->parentUpdated = 0;
+        performanceLog << "    " << timestamp << " Iteration  " << pass << endl;
+        setupLoadBalancing(data.orientedMarkerCount, batchSize);
+        runThreads(&Assembler::createMarkerGraphVerticesThreadFunction2, threadCount);
+        performanceLog << "    " << timestamp << " Updated parent of - " << (data.disjointSetsPointer)->parentUpdated << " entries." << endl;
+        pass++;
+    } while ((data.disjointSetsPointer)->parentUpdated > 0 && pass <= 10);
+
+    if (pass > 10) {
+        // This should never happen. Even in a highly parallel environment (128 threads), convergence happens
+        // in 2 or 3 passes. It's definitely worth investigating if this ever happens.
+        string errorMsg = "DisjointSets parent information did not converge in " + to_string(pass) + " iterations.";
+        throw runtime_error(errorMsg);
+    }
+
+
+    performanceLog << timestamp << "Verifying convergence of parent information." << endl;
+    setupLoadBalancing(data.orientedMarkerCount, batchSize);
+    runThreads(&Assembler::createMarkerGraphVerticesThreadFunction21, threadCount);
+    performanceLog << timestamp << "Done verifying convergence of parent information." << endl;
+
+
+    // data.disjointSetTable now has the correct set representative for entry N at location 2*N.
+    // That's because DisjointSets stores parent information in the lower 64 bits of the 128 bits
+    // it uses for each entry. Since we only care about these bits, we can compact data.disjointSetTable
+    // and free up half the memory.
+    // This bit seems tricky to parallelize. It's not worth the effort as this is pretty fast as is.
+    performanceLog << timestamp << "Compacting the Disjoint Set data-structure." << endl;
+    for(uint64_t i=0; i<data.orientedMarkerCount; i++) {
+        data.disjointSetTable[i] = data.disjointSetTable[2*i];
+    }
+    data.disjointSetTable.resize(data.orientedMarkerCount);
+    data.disjointSetTable.unreserve();
+    performanceLog << timestamp << "Done compacting the Disjoint Set data-structure." << endl;
+
+    // Don't need the DisjointSets data-structure any more.
+    data.disjointSetsPointer = 0;
+}
+
+
+
 void Assembler::createMarkerGraphVerticesThreadFunction1(size_t threadId)
 {
 
@@ -558,25 +592,16 @@ void Assembler::createMarkerGraphVerticesThreadFunction1(size_t threadId)
                 SHASTA_ASSERT(nextEdgeOrientedReadIds == readGraphEdge.orientedReadIds);
             }
 
-            // If the edge is flagged as crossing strands, skip it.
-            if(readGraphEdge.crossesStrands) {
-                continue;
-            }
-
-            // If the edge has an alignment flagged as inconsistent, skip it.
-            if(readGraphEdge.hasInconsistentAlignment) {
+            // Skip edges that are flagged as crossing strands,
+            // have an alignment flagged as inconsistent,
+            // or involve a read flagged as chimeric.
+            if(not isReadGraphEdgeUsedForMarkerGraphVertices(readGraphEdge)) {
                 continue;
             }
 
             orientedReadIds = readGraphEdge.orientedReadIds;
             SHASTA_ASSERT(orientedReadIds[0] < orientedReadIds[1]);
 
-            // If either of the reads is flagged chimeric, skip it.
-            if( reads->getFlags(orientedReadIds[0].getReadId()).isChimeric ||
-                reads->getFlags(orientedReadIds[1].getReadId()).isChimeric) {
-                continue;
-            }
-
             // Sanity check.
             SHASTA_ASSERT(alignmentData[alignmentId].info.isInReadGraph);
 
@@ -1625,6 +1650,9 @@ void Assembler::vertexCoverageStatisticsByKmerId() const
     checkKmersAreOpen();
     checkMarkersAreOpen();
     checkMarkerGraphVerticesAreAvailable();
+#ifdef SHASTA_LONG_KMERS
+    throw runtime_error("vertexCoverageStatisticsByKmerId is not available in builds with long k-mers.");
+#endif
 
     const uint64_t k = assemblerInfo->k;
 
@@ -1761,218 +1789,75 @@ bool Assembler::extractLocalMarkerGraph(
     LocalMarkerGraph& graph
     )
 {
-    // Sanity check.
-    checkMarkerGraphEdgesIsOpen();
-
     // Some shorthands.
     AssemblyGraph& assemblyGraph = *assemblyGraphPointer;
     using vertex_descriptor = LocalMarkerGraph::vertex_descriptor;
     using edge_descriptor = LocalMarkerGraph::edge_descriptor;
 
-    // Start a timer.
-    const auto startTime = steady_clock::now();
-
-    // Add the start vertex, without regards to coverage.
-    if(startVertexId == MarkerGraph::invalidCompressedVertexId) {
-        return true;    // Because no timeout occurred.
+    // Extract the local marker graph in flat form.
+    if(not localMarkerGraphFlatPointer) {
+        localMarkerGraphFlatPointer = make_shared<LocalMarkerGraphFlat>();
     }
-    const vertex_descriptor vStart = graph.addVertex(startVertexId, 0, markerGraph.getVertexMarkerIds(startVertexId));
-
-    // Some vectors used inside the BFS.
-    // Define them here to reduce memory allocation activity.
-    vector<MarkerInterval> markerIntervals;
-
-
-    // Do the BFS to generate the vertices.
-    // Edges will be created later.
-    std::queue<vertex_descriptor> q;
-    if(distance > 0) {
-        q.push(vStart);
+    LocalMarkerGraphFlat& flatGraph = *localMarkerGraphFlatPointer;
+    if(not extractLocalMarkerGraphFlat(
+        startVertexId, distance, timeout,
+        minVertexCoverage,
+        minEdgeCoverage,
+        useWeakEdges,
+        usePrunedEdges,
+        useSuperBubbleEdges,
+        useLowCoverageCrossEdges,
+        useRemovedSecondaryEdges,
+        flatGraph)) {
+        graph.clear();
+        return false;
     }
-    while(!q.empty()) {
 
-        // See if we exceeded the timeout.
-        if(timeout>0. && seconds(steady_clock::now() - startTime) > timeout) {
-            graph.clear();
-            return false;
-        }
 
-        // Dequeue a vertex.
-        const vertex_descriptor v0 = q.front();
-        q.pop();
-        const LocalMarkerGraphVertex& vertex0 = graph[v0];
-        const MarkerGraph::VertexId vertexId0 = vertex0.vertexId;
-        const uint64_t distance0 = vertex0.distance;
-        const uint64_t distance1 = distance0 + 1;
-
-        // Loop over the children.
-        const auto childEdges = markerGraph.edgesBySource[vertexId0];
-        for(uint64_t edgeId: childEdges) {
-            const auto& edge = markerGraph.edges[edgeId];
 
-            // Skip this edge if the arguments require it.
-            if(markerGraph.edgeMarkerIntervals[edgeId].size() < minEdgeCoverage) {
-                continue;
-            }
-            if(edge.wasRemovedByTransitiveReduction && !useWeakEdges) {
-                continue;
-            }
-            if(edge.wasPruned && !usePrunedEdges) {
-                continue;
-            }
-            if(edge.isSuperBubbleEdge && !useSuperBubbleEdges) {
-                continue;
-            }
-            if(edge.isLowCoverageCrossEdge && !useLowCoverageCrossEdges) {
-                continue;
-            }
-            if(edge.wasRemovedWhileSplittingSecondaryEdges && !useRemovedSecondaryEdges) {
-                continue;
-            }
-
-            const MarkerGraph::VertexId vertexId1 = edge.target;
-            SHASTA_ASSERT(edge.source == vertexId0);
-            SHASTA_ASSERT(vertexId1 < markerGraph.vertexCount());
-
-            // If vertex coverage is too low, skip it.
-            if(markerGraph.vertexCoverage(vertexId1) < minVertexCoverage) {
-                continue;
-            }
-
-            // Find the vertex corresponding to this child, creating it if necessary.
-            bool vertexExists;
-            vertex_descriptor v1;
-            tie(vertexExists, v1) = graph.findVertex(vertexId1);
-            if(!vertexExists) {
-                v1 = graph.addVertex(
-                    vertexId1, distance1, markerGraph.getVertexMarkerIds(vertexId1));
-                if(distance1 < distance) {
-                    q.push(v1);
-                }
-            }
-        }
-
-        // Loop over the parents.
-        const auto parentEdges = markerGraph.edgesByTarget[vertexId0];
-        for(uint64_t edgeId: parentEdges) {
-            const auto& edge = markerGraph.edges[edgeId];
-
-            // Skip this edge if the arguments require it.
-            if(markerGraph.edgeMarkerIntervals[edgeId].size() < minEdgeCoverage) {
-                continue;
-            }
-            if(edge.wasRemovedByTransitiveReduction && !useWeakEdges) {
-                continue;
-            }
-            if(edge.wasPruned && !usePrunedEdges) {
-                continue;
-            }
-            if(edge.isSuperBubbleEdge && !useSuperBubbleEdges) {
-                continue;
-            }
-            if(edge.isLowCoverageCrossEdge && !useLowCoverageCrossEdges) {
-                continue;
-            }
-            if(edge.wasRemovedWhileSplittingSecondaryEdges && !useRemovedSecondaryEdges) {
-                continue;
-            }
-
-            const MarkerGraph::VertexId vertexId1 = edge.source;
-            SHASTA_ASSERT(edge.target == vertexId0);
-            SHASTA_ASSERT(vertexId1 < markerGraph.vertexCount());
-
-            // If vertex coverage is too low, skip it.
-            if(markerGraph.vertexCoverage(vertexId1) < minVertexCoverage) {
-                continue;
-            }
-
-            // Find the vertex corresponding to this child, creating it if necessary.
-            bool vertexExists;
-            vertex_descriptor v1;
-            tie(vertexExists, v1) = graph.findVertex(vertexId1);
-            if(!vertexExists) {
-                v1 = graph.addVertex(
-                    vertexId1, distance1, markerGraph.getVertexMarkerIds(vertexId1));
-                if(distance1 < distance) {
-                    q.push(v1);
-                }
-            }
-        }
+    // Convert it to a LocalMarkerGraph.
+    // Create the vertices.
+    vector<vertex_descriptor> vertexDescriptors;
+    vertexDescriptors.reserve(flatGraph.vertices.size());
+    for(const LocalMarkerGraphFlat::Vertex& vertex: flatGraph.vertices) {
+        vertexDescriptors.push_back(graph.addVertex(
+            vertex.vertexId, vertex.distance, markerGraph.getVertexMarkerIds(vertex.vertexId)));
     }
 
-
-
-    // Create edges.
-    BGL_FORALL_VERTICES(v0, graph, LocalMarkerGraph) {
-        const LocalMarkerGraphVertex& vertex0 = graph[v0];
-        const MarkerGraph::VertexId vertexId0 = vertex0.vertexId;
-
-        // Loop over the children that exist in the local marker graph
-        // and are also at maximum distance.
-        const auto childEdges = markerGraph.edgesBySource[vertexId0];
-        for(uint64_t edgeId: childEdges) {
-            const auto& edge = markerGraph.edges[edgeId];
-
-            // Skip this edge if the arguments require it.
-            if(markerGraph.edgeMarkerIntervals[edgeId].size() < minEdgeCoverage) {
-                continue;
-            }
-            if(edge.wasRemovedByTransitiveReduction && !useWeakEdges) {
-                continue;
-            }
-            if(edge.wasPruned && !usePrunedEdges) {
-                continue;
-            }
-            if(edge.isSuperBubbleEdge && !useSuperBubbleEdges) {
-                continue;
-            }
-            if(edge.isLowCoverageCrossEdge && !useLowCoverageCrossEdges) {
-                continue;
-            }
-            if(edge.wasRemovedWhileSplittingSecondaryEdges && !useRemovedSecondaryEdges) {
-                continue;
-            }
-
-            const MarkerGraph::VertexId vertexId1 = edge.target;
-            SHASTA_ASSERT(edge.source == vertexId0);
-            SHASTA_ASSERT(vertexId1 < markerGraph.vertexCount());
-
-            // See if we have a vertex for this global vertex id.
-            bool vertexExists;
-            vertex_descriptor v1;
-            tie(vertexExists, v1) = graph.findVertex(vertexId1);
-
-            // If it does not exist in the local marker graph, skip.
-            if(!vertexExists) {
-                continue;
-            }
-
-            // Add the edge.
-            edge_descriptor e;
-            bool edgeWasAdded = false;
-            tie(e, edgeWasAdded) = boost::add_edge(v0, v1, graph);
-            SHASTA_ASSERT(edgeWasAdded);
-
-            // Fill in edge information.
-            const auto storedMarkerIntervals = markerGraph.edgeMarkerIntervals[edgeId];
-            markerIntervals.resize(storedMarkerIntervals.size());
-            copy(storedMarkerIntervals.begin(), storedMarkerIntervals.end(), markerIntervals.begin());
-            graph.storeEdgeInfo(e, markerIntervals);
-            graph[e].edgeId = edgeId;
-            graph[e].wasRemovedByTransitiveReduction = markerGraph.edges[edgeId].wasRemovedByTransitiveReduction;
-            graph[e].wasPruned = markerGraph.edges[edgeId].wasPruned;
-            graph[e].isSuperBubbleEdge = markerGraph.edges[edgeId].isSuperBubbleEdge;
-            graph[e].isLowCoverageCrossEdge = markerGraph.edges[edgeId].isLowCoverageCrossEdge;
-            graph[e].wasAssembled = markerGraph.edges[edgeId].wasAssembled;
-            graph[e].isSecondary = markerGraph.edges[edgeId].isSecondary;
-            graph[e].wasRemovedWhileSplittingSecondaryEdges = markerGraph.edges[edgeId].wasRemovedWhileSplittingSecondaryEdges;
-
-            // Link to assembly graph vertex.
-            if(assemblyGraphPointer and assemblyGraph.markerToAssemblyTable.isOpen()) {
-                const auto& locations = assemblyGraph.markerToAssemblyTable[edgeId];
-                copy(locations.begin(), locations.end(),
-                    back_inserter(graph[e].assemblyGraphLocations));
-            }
+    // Create the edges.
+    vector<MarkerInterval> markerIntervals;
+    for(const LocalMarkerGraphFlat::Edge& flatEdge: flatGraph.edges) {
+        const MarkerGraph::EdgeId edgeId = flatEdge.edgeId;
+        const MarkerGraph::Edge& globalEdge = markerGraph.edges[edgeId];
+
+        // Add the edge.
+        edge_descriptor e;
+        bool edgeWasAdded = false;
+        tie(e, edgeWasAdded) = boost::add_edge(
+            vertexDescriptors[flatEdge.source],
+            vertexDescriptors[flatEdge.target],
+            graph);
+        SHASTA_ASSERT(edgeWasAdded);
+
+        // Fill in edge information.
+        const auto storedMarkerIntervals = markerGraph.edgeMarkerIntervals[edgeId];
+        markerIntervals.resize(storedMarkerIntervals.size());
+        copy(storedMarkerIntervals.begin(), storedMarkerIntervals.end(), markerIntervals.begin());
+        graph.storeEdgeInfo(e, markerIntervals);
+        graph[e].edgeId = edgeId;
+        graph[e].wasRemovedByTransitiveReduction = globalEdge.wasRemovedByTransitiveReduction;
+        graph[e].wasPruned = globalEdge.wasPruned;
+        graph[e].isSuperBubbleEdge = globalEdge.isSuperBubbleEdge;
+        graph[e].isLowCoverageCrossEdge = globalEdge.isLowCoverageCrossEdge;
+        graph[e].wasAssembled = globalEdge.wasAssembled;
+        graph[e].isSecondary = globalEdge.isSecondary;
+        graph[e].wasRemovedWhileSplittingSecondaryEdges = globalEdge.wasRemovedWhileSplittingSecondaryEdges;
+
+        // Link to assembly graph vertex.
+        if(assemblyGraphPointer and assemblyGraph.markerToAssemblyTable.isOpen()) {
+            const auto& locations = assemblyGraph.markerToAssemblyTable[edgeId];
+            copy(locations.begin(), locations.end(),
+                back_inserter(graph[e].assemblyGraphLocations));
         }
     }
 
@@ -2024,6 +1909,141 @@ bool Assembler::extractLocalMarkerGraph(
 
 
 
+// Flat version of extractLocalMarkerGraph.
+// It generates the same vertices and edges, in the same order.
+bool Assembler::extractLocalMarkerGraphFlat(
+    MarkerGraph::VertexId startVertexId,
+    uint64_t distance,
+    int timeout,                 // Or 0 for no timeout.
+    uint64_t minVertexCoverage,
+    uint64_t minEdgeCoverage,
+    bool useWeakEdges,
+    bool usePrunedEdges,
+    bool useSuperBubbleEdges,
+    bool useLowCoverageCrossEdges,
+    bool useRemovedSecondaryEdges,
+    LocalMarkerGraphFlat& graph
+    ) const
+{
+    // Sanity check.
+    checkMarkerGraphEdgesIsOpen();
+
+    // Start a timer.
+    const auto startTime = steady_clock::now();
+
+    graph.clear(markerGraph.vertexCount());
+
+    // Add the start vertex, without regards to coverage.
+    if(startVertexId == MarkerGraph::invalidCompressedVertexId) {
+        return true;    // Because no timeout occurred.
+    }
+    graph.addVertex(startVertexId, 0);
+
+    // Function that returns true if an edge should be used,
+    // given the arguments.
+    auto useEdge = [&](MarkerGraph::EdgeId edgeId)
+    {
+        const MarkerGraph::Edge& edge = markerGraph.edges[edgeId];
+        if(markerGraph.edgeMarkerIntervals.size(edgeId) < minEdgeCoverage) {
+            return false;
+        }
+        if(edge.wasRemovedByTransitiveReduction && !useWeakEdges) {
+            return false;
+        }
+        if(edge.wasPruned && !usePrunedEdges) {
+            return false;
+        }
+        if(edge.isSuperBubbleEdge && !useSuperBubbleEdges) {
+            return false;
+        }
+        if(edge.isLowCoverageCrossEdge && !useLowCoverageCrossEdges) {
+            return false;
+        }
+        if(edge.wasRemovedWhileSplittingSecondaryEdges && !useRemovedSecondaryEdges) {
+            return false;
+        }
+        return true;
+    };
+
+    // Function to add a neighbor found during the BFS,
+    // if it does not already exist and has sufficient coverage.
+    // The vertices vector of the graph is also used as the BFS queue.
+    auto addNeighbor = [&](MarkerGraph::VertexId vertexId1, uint64_t distance1)
+    {
+        SHASTA_ASSERT(vertexId1 < markerGraph.vertexCount());
+        if(markerGraph.vertexCoverage(vertexId1) < minVertexCoverage) {
+            return;
+        }
+        if(graph.getLocalVertexId(vertexId1) == LocalMarkerGraphFlat::invalidLocalVertexId) {
+            graph.addVertex(vertexId1, distance1);
+        }
+    };
+
+
+
+    // Do the BFS to generate the vertices.
+    // Edges will be created later.
+    for(uint64_t v0=0; v0<graph.vertices.size(); v0++) {
+        const MarkerGraph::VertexId vertexId0 = graph.vertices[v0].vertexId;
+        const uint64_t distance0 = graph.vertices[v0].distance;
+        if(distance0 >= distance) {
+            // Vertices are in order of increasing distance, so we are done.
+            break;
+        }
+        const uint64_t distance1 = distance0 + 1;
+
+        // See if we exceeded the timeout.
+        if(timeout>0. && seconds(steady_clock::now() - startTime) > timeout) {
+            graph.clear(markerGraph.vertexCount());
+            return false;
+        }
+
+        // Loop over the children.
+        for(const Uint40 edgeId: markerGraph.edgesBySource[vertexId0]) {
+            if(useEdge(edgeId)) {
+                const MarkerGraph::Edge& edge = markerGraph.edges[edgeId];
+                SHASTA_ASSERT(edge.source == vertexId0);
+                addNeighbor(edge.target, distance1);
+            }
+        }
+
+        // Loop over the parents.
+        for(const Uint40 edgeId: markerGraph.edgesByTarget[vertexId0]) {
+            if(useEdge(edgeId)) {
+                const MarkerGraph::Edge& edge = markerGraph.edges[edgeId];
+                SHASTA_ASSERT(edge.target == vertexId0);
+                addNeighbor(edge.source, distance1);
+            }
+        }
+    }
+
+
+
+    // Create edges.
+    for(uint64_t v0=0; v0<graph.vertices.size(); v0++) {
+        const MarkerGraph::VertexId vertexId0 = graph.vertices[v0].vertexId;
+        for(const Uint40 edgeId: markerGraph.edgesBySource[vertexId0]) {
+            if(not useEdge(edgeId)) {
+                continue;
+            }
+            const MarkerGraph::Edge& edge = markerGraph.edges[edgeId];
+            SHASTA_ASSERT(edge.source == vertexId0);
+
+            // If the target is not in the local marker graph, skip.
+            const uint64_t v1 = graph.getLocalVertexId(edge.target);
+            if(v1 == LocalMarkerGraphFlat::invalidLocalVertexId) {
+                continue;
+            }
+
+            graph.edges.push_back({v0, v1, edgeId});
+        }
+    }
+
+    return true;
+}
+
+
+
 // Compute edges of the global marker graph.
 void Assembler::createMarkerGraphEdges(size_t threadCount)
 {
@@ -2081,6 +2101,7 @@ void Assembler::createMarkerGraphEdges(size_t threadCount)
 
     // Now we need to create edgesBySource and edgesByTarget.
     createMarkerGraphEdgesBySourceAndTarget(threadCount);
+    markerGraph.createEdgeFlagBitsets(threadCount);
     performanceLog << timestamp << "createMarkerGraphEdges ends." << endl;
 }
 
@@ -2240,6 +2261,9 @@ void Assembler::accessMarkerGraphEdges(
         markerGraph.edgesByTarget.accessExistingReadOnly(
             largeDataName("GlobalMarkerGraphEdgesByTarget"));
     }
+
+    // The edge flag bitsets are not persistent.
+    markerGraph.createEdgeFlagBitsets();
 }
 
 
@@ -2296,10 +2320,10 @@ void Assembler::transitiveReduction(
     // Initially flag all edges as not removed by transitive reduction.
     // To facilitate debugging, also clear the other flags, which are
     // set later in the normal assembly process.
-    for(auto& edge: edges) {
-        edge.wasRemovedByTransitiveReduction = 0;
-        edge.wasPruned = 0;
-        edge.isSuperBubbleEdge = 0;
+    for(EdgeId edgeId=0; edgeId<edges.size(); edgeId++) {
+        markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, false);
+        markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasPruned, false);
+        markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::isSuperBubbleEdge, false);
     }
 
     // Gather edges for each coverage less than highCoverageThreshold.
@@ -2358,8 +2382,8 @@ void Assembler::transitiveReduction(
                 << coverage << "." << endl;
         }
         for(const EdgeId edgeId: edgesWithThisCoverage) {
-            edges[edgeId].wasRemovedByTransitiveReduction = 1;
-            edges[markerGraph.reverseComplementEdge[edgeId]].wasRemovedByTransitiveReduction = 1;
+            markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, true);
+            markerGraph.setEdgeFlag(markerGraph.reverseComplementEdge[edgeId], MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, true);
         }
     }
 
@@ -2379,8 +2403,8 @@ void Assembler::transitiveReduction(
         const uint32_t skip = markerInterval.ordinals[1] - markerInterval.ordinals[0];
         if(skip > edgeMarkerSkipThreshold) {
             if(edges[edgeId].wasRemovedByTransitiveReduction == 0) {
-                edges[edgeId].wasRemovedByTransitiveReduction = 1;
-                edges[markerGraph.reverseComplementEdge[edgeId]].wasRemovedByTransitiveReduction = 1;
+                markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, true);
+                markerGraph.setEdgeFlag(markerGraph.reverseComplementEdge[edgeId], MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, true);
                 coverage1HighSkipCount += 2;
             }
         }
@@ -2452,8 +2476,8 @@ void Assembler::transitiveReduction(
             }
 
             if(found) {
-                edges[edgeId].wasRemovedByTransitiveReduction = 1;
-                edges[markerGraph.reverseComplementEdge[edgeId]].wasRemovedByTransitiveReduction = 1;
+                markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, true);
+                markerGraph.setEdgeFlag(markerGraph.reverseComplementEdge[edgeId], MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, true);
                 count += 2;
             }
 
@@ -2483,12 +2507,8 @@ void Assembler::transitiveReduction(
 
 
     // Count the number of edges that were flagged as weak.
-    uint64_t weakEdgeCount = 0;;
-    for(const auto& edge: markerGraph.edges) {
-        if(edge.wasRemovedByTransitiveReduction) {
-            ++weakEdgeCount;
-        }
-    }
+    const uint64_t weakEdgeCount =
+        markerGraph.countEdgesWithFlag(MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction);
     cout << "Transitive reduction removed " << weakEdgeCount << " marker graph edges out of ";
     cout << markerGraph.edges.size() << " total." << endl;
 
@@ -2637,8 +2657,8 @@ void Assembler::reverseTransitiveReduction(
             }
 
             if(found) {
-                edges[edgeId].wasRemovedByTransitiveReduction = 1;
-                edges[markerGraph.reverseComplementEdge[edgeId]].wasRemovedByTransitiveReduction = 1;
+                markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, true);
+                markerGraph.setEdgeFlag(markerGraph.reverseComplementEdge[edgeId], MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction, true);
                 count += 2;
             }
 
@@ -2863,8 +2883,8 @@ void Assembler::pruneMarkerGraphStrongSubgraph(size_t iterationCount)
     fill(edgesToBePruned.begin(), edgesToBePruned.end(), false);
 
     // Clear the wasPruned flag of all edges.
-    for(MarkerGraph::Edge& edge: edges) {
-        edge.wasPruned = 0;
+    for(EdgeId edgeId=0; edgeId<edgeCount; edgeId++) {
+        markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasPruned, false);
     }
 
 
@@ -2896,7 +2916,7 @@ void Assembler::pruneMarkerGraphStrongSubgraph(size_t iterationCount)
         EdgeId count = 0;
         for(EdgeId edgeId=0; edgeId<edgeCount; edgeId++) {
             if(edgesToBePruned[edgeId]) {
-                edges[edgeId].wasPruned = 1;
+                markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasPruned, true);
                 ++count;
                 edgesToBePruned[edgeId] = false;    // For next iteration.
             }
@@ -2909,12 +2929,11 @@ void Assembler::pruneMarkerGraphStrongSubgraph(size_t iterationCount)
 
 
     // Count the number of surviving edges in the pruned strong subgraph.
-    size_t count = 0;
-    for(MarkerGraph::Edge& edge: edges) {
-        if(!edge.wasRemovedByTransitiveReduction && !edge.wasPruned) {
-            ++count;
-        }
-    }
+    // Edges removed by transitive reduction are never pruned,
+    // so the two flags are never set for the same edge.
+    const size_t count = edgeCount -
+        markerGraph.countEdgesWithFlag(MarkerGraph::EdgeFlag::wasRemovedByTransitiveReduction) -
+        markerGraph.countEdgesWithFlag(MarkerGraph::EdgeFlag::wasPruned);
     cout << "The original marker graph had " << markerGraph.vertexCount();
     cout << " vertices and " << edgeCount << " edges." << endl;
     cout << "The number of surviving edges is " << count << "." << endl;
@@ -2980,11 +2999,10 @@ MarkerGraph::EdgeId Assembler::nextEdgeInMarkerGraphPrunedStrongSubgraphChain(
     // Loop over all edges following it.
     EdgeId nextEdgeId = MarkerGraph::invalidEdgeId;
     for(const EdgeId edgeId1: markerGraph.edgesBySource[edge0.target]) {
-        const Edge& edge1 = edges[edgeId1];
 
         // Skip the edge if it is not part of the
         // pruned strong subgraph of the marker graph.
-        if(edge1.wasRemoved()) {
+        if(markerGraph.edgeWasRemoved(edgeId1)) {
             continue;
         }
 
@@ -3043,7 +3061,7 @@ MarkerGraph::EdgeId Assembler::previousEdgeInMarkerGraphPrunedStrongSubgraphChai
 
         // Skip the edge if it is not part of the
         // pruned strong subgraph of the marker graph.
-        if(edge1.wasRemoved()) {
+        if(markerGraph.edgeWasRemoved(edgeId1)) {
             if(debug) {
                 cout << "Edge was removed." << endl;
             }
@@ -3079,26 +3097,12 @@ MarkerGraph::EdgeId Assembler::previousEdgeInMarkerGraphPrunedStrongSubgraphChai
 size_t Assembler::markerGraphPrunedStrongSubgraphOutDegree(
     MarkerGraph::VertexId vertexId) const
 {
-    size_t outDegree = 0;
-    for(const auto edgeId: markerGraph.edgesBySource[vertexId]) {
-        const auto& edge = markerGraph.edges[edgeId];
-        if(!edge.wasRemoved()) {
-            ++outDegree;
-        }
-    }
-    return outDegree;
+    return markerGraph.outDegree(vertexId);
 }
 size_t Assembler::markerGraphPrunedStrongSubgraphInDegree(
     MarkerGraph::VertexId vertexId) const
 {
-    size_t inDegree = 0;
-    for(const auto edgeId: markerGraph.edgesByTarget[vertexId]) {
-        const auto& edge = markerGraph.edges[edgeId];
-        if(!edge.wasRemoved()) {
-            ++inDegree;
-        }
-    }
-    return inDegree;
+    return markerGraph.inDegree(vertexId);
 }
 
 
@@ -3708,8 +3712,8 @@ void Assembler::simplifyMarkerGraph(
     bool debug)
 {
     // Clear the superbubble flag for all edges.
-    for(MarkerGraph::Edge& edge: markerGraph.edges) {
-        edge.isSuperBubbleEdge = 0;
+    for(MarkerGraph::EdgeId edgeId=0; edgeId<markerGraph.edges.size(); edgeId++) {
+        markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::isSuperBubbleEdge, false);
     }
 
 
@@ -3734,16 +3738,14 @@ void Assembler::simplifyMarkerGraph(
     for(MarkerGraph::VertexId v=0; v!=markerGraph.vertexCount(); v++) {
         bool isIsolated = true;
         for(const MarkerGraph::EdgeId edgeId: markerGraph.edgesBySource[v]) {
-            const MarkerGraph::Edge& edge = markerGraph.edges[edgeId];
-            if(!edge.wasRemoved()) {
+            if(!markerGraph.edgeWasRemoved(edgeId)) {
                 isIsolated = false;
                 break;
             }
         }
         if(isIsolated) {
             for(const MarkerGraph::EdgeId edgeId: markerGraph.edgesByTarget[v]) {
-                const MarkerGraph::Edge& edge = markerGraph.edges[edgeId];
-                if(!edge.wasRemoved()) {
+                if(!markerGraph.edgeWasRemoved(edgeId)) {
                     isIsolated = false;
                     break;
                 }
@@ -3759,12 +3761,8 @@ void Assembler::simplifyMarkerGraph(
 
 
     // Count the marker graph edges that were not removed.
-    size_t markerGraphEdgesNotRemovedCount = 0;
-    for(const MarkerGraph::Edge& edge: markerGraph.edges) {
-        if(!edge.wasRemoved()) {
-            ++markerGraphEdgesNotRemovedCount;
-        }
-    }
+    const size_t markerGraphEdgesNotRemovedCount =
+        markerGraph.edges.size() - markerGraph.countRemovedEdges();
     assemblerInfo->markerGraphEdgesNotRemovedCount = markerGraphEdgesNotRemovedCount;
 }
 
@@ -3865,8 +3863,8 @@ void Assembler::simplifyMarkerGraphIterationPart1(
 
         const span<MarkerGraph::EdgeId> markerGraphEdges = assemblyGraph.edgeLists[assemblyGraphEdgeId];
         for(const MarkerGraph::EdgeId markerGraphEdgeId: markerGraphEdges) {
-            markerGraph.edges[markerGraphEdgeId].isSuperBubbleEdge = 1;
-            markerGraph.edges[markerGraph.reverseComplementEdge[markerGraphEdgeId]].isSuperBubbleEdge = 1;
+            markerGraph.setEdgeFlag(markerGraphEdgeId, MarkerGraph::EdgeFlag::isSuperBubbleEdge, true);
+            markerGraph.setEdgeFlag(markerGraph.reverseComplementEdge[markerGraphEdgeId], MarkerGraph::EdgeFlag::isSuperBubbleEdge, true);
         }
     }
 
@@ -4464,7 +4462,7 @@ void Assembler::simplifyMarkerGraphIterationPart2(
 
         const span<MarkerGraph::EdgeId> markerGraphEdges = assemblyGraph.edgeLists[assemblyGraphEdgeId];
         for(const MarkerGraph::EdgeId markerGraphEdgeId: markerGraphEdges) {
-            markerGraph.edges[markerGraphEdgeId].isSuperBubbleEdge = 1;
+            markerGraph.setEdgeFlag(markerGraphEdgeId, MarkerGraph::EdgeFlag::isSuperBubbleEdge, true);
         }
     }
 
@@ -4922,7 +4920,7 @@ void Assembler::assembleMarkerGraphEdgesThreadFunction(size_t threadId)
             // Figure out if we need to assemble this edge.
             bool shouldAssemble = true;
             if(not assembleAllEdges) {
-                if(markerGraph.edges[edgeId].wasRemoved()) {
+                if(markerGraph.edgeWasRemoved(edgeId)) {
                     // The marker graph edge was removed.
                     shouldAssemble = false;
                 } else {
@@ -4943,12 +4941,12 @@ void Assembler::assembleMarkerGraphEdgesThreadFunction(size_t threadId)
 
             // Compute the consensus, if necessary.
             if(!shouldAssemble) {
-                markerGraph.edges[edgeId].wasAssembled = 0;
+                markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasAssembled, false);
                 sequence.clear();
                 repeatCounts.clear();
                 overlappingBaseCount = 0;
             } else {
-                markerGraph.edges[edgeId].wasAssembled = 1;
+                markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasAssembled, true);
                 try {
                     ComputeMarkerGraphEdgeConsensusSequenceUsingSpoaDetail detail;
                     computeMarkerGraphEdgeConsensusSequenceUsingSpoa(
@@ -5027,7 +5025,7 @@ void Assembler::computeMarkerGraphCoverageHistogram()
         bool isIsolated = true;
         // Look at the out-edges.
         for(const MarkerGraph::EdgeId edgeId: markerGraph.edgesBySource[vertexId]) {
-            if(!markerGraph.edges[edgeId].wasRemoved()) {
+            if(!markerGraph.edgeWasRemoved(edgeId)) {
                 isIsolated = false;
                 break;
             }
@@ -5035,7 +5033,7 @@ void Assembler::computeMarkerGraphCoverageHistogram()
         if(isIsolated) {
             // We did not find any out-edges. Look at the in-edges.
             for(const MarkerGraph::EdgeId edgeId: markerGraph.edgesByTarget[vertexId]) {
-                if(!markerGraph.edges[edgeId].wasRemoved()) {
+                if(!markerGraph.edgeWasRemoved(edgeId)) {
                     isIsolated = false;
                     break;
                 }
@@ -5064,16 +5062,14 @@ void Assembler::computeMarkerGraphCoverageHistogram()
 
 
     // Edges.
+    // Removed edges are skipped.
     vector<uint64_t> edgeCoverageHistogram;
-    for(const MarkerGraph::Edge& edge: markerGraph.edges) {
-
-        // If this edge was removed, skip it.
-        if(edge.wasRemoved()) {
-            continue;
-        }
+    for(MarkerGraph::EdgeId edgeId=markerGraph.findNextNonRemovedEdge(0);
+        edgeId<markerGraph.edges.size();
+        edgeId=markerGraph.findNextNonRemovedEdge(edgeId+1)) {
 
         // Increment the histogram.
-        const size_t coverage = edge.coverage;
+        const size_t coverage = markerGraph.edges[edgeId].coverage;
         if(coverage >= edgeCoverageHistogram.size()) {
             edgeCoverageHistogram.resize(coverage+1, 0);
         }
@@ -5118,31 +5114,20 @@ void Assembler::setMarkerGraphEdgeFlags(
     cout << "isLowCoverageCrossEdge  " << int(isLowCoverageCrossEdge) << endl;
     cout << "wasAssembled " << int(wasAssembled) << endl;
 
-    for(MarkerGraph::Edge& edge: markerGraph.edges) {
-        if(wasRemovedByTransitiveReduction == 0) {
-            edge.wasRemovedByTransitiveReduction = 0;
-        } else if(wasRemovedByTransitiveReduction == 1) {
-            edge.wasRemovedByTransitiveReduction = 1;
-        }
-        if(wasPruned == 0) {
-            edge.wasPruned = 0;
-        } else if(wasPruned == 1) {
-            edge.wasPruned = 1;
-        }
-        if(isSuperBubbleEdge == 0) {
-            edge.isSuperBubbleEdge = 0;
-        } else if(isSuperBubbleEdge == 1) {
-            edge.isSuperBubbleEdge = 1;
-        }
-        if(isLowCoverageCrossEdge == 0) {
-            edge.isLowCoverageCrossEdge = 0;
-        } else if(isLowCoverageCrossEdge == 1) {
-            edge.isLowCoverageCrossEdge = 1;
-        }
-        if(wasAssembled == 0) {
-            edge.wasAssembled = 0;
-        } else if(wasAssembled == 1) {
-            edge.wasAssembled = 1;
+    // Use setEdgeFlag so the edge flag bitsets stay in sync.
+    using EdgeFlag = MarkerGraph::EdgeFlag;
+    const array<pair<EdgeFlag, uint8_t>, 5> flagValues = {
+        make_pair(EdgeFlag::wasRemovedByTransitiveReduction, wasRemovedByTransitiveReduction),
+        make_pair(EdgeFlag::wasPruned, wasPruned),
+        make_pair(EdgeFlag::isSuperBubbleEdge, isSuperBubbleEdge),
+        make_pair(EdgeFlag::isLowCoverageCrossEdge, isLowCoverageCrossEdge),
+        make_pair(EdgeFlag::wasAssembled, wasAssembled)
+    };
+    for(MarkerGraph::EdgeId edgeId=0; edgeId<markerGraph.edges.size(); edgeId++) {
+        for(const auto& p: flagValues) {
+            if(p.second == 0 or p.second == 1) {
+                markerGraph.setEdgeFlag(edgeId, p.first, p.second == 1);
+            }
         }
     }
     cout << timestamp << "Done." << endl;
@@ -5269,6 +5254,38 @@ void Assembler::computeOrientedReadMarkerGraphPath(
 
 
 
+// Given the marker graph path of an oriented read over its entire
+// ordinal range, as computed by computeOrientedReadMarkerGraphPath,
+// compute the marker graph path of the reverse complemented oriented read.
+// Marker ordinal i on the oriented read corresponds to
+// ordinal markerCount-1-i on the reverse complemented oriented read,
+// so the reverse complemented path visits the reverse complement
+// edges in reverse order.
+void Assembler::reverseComplementOrientedReadMarkerGraphPath(
+    OrientedReadId orientedReadId,
+    const vector<MarkerGraph::EdgeId>& path,
+    const vector< pair<uint32_t, uint32_t> >& pathOrdinals,
+    vector<MarkerGraph::EdgeId>& reverseComplementedPath,
+    vector< pair<uint32_t, uint32_t> >& reverseComplementedPathOrdinals
+    ) const
+{
+    SHASTA_ASSERT(path.size() == pathOrdinals.size());
+    SHASTA_ASSERT(markerGraph.reverseComplementEdge.isOpen);
+    const uint32_t lastOrdinal = uint32_t(markers.size(orientedReadId.getValue()) - 1);
+
+    const uint64_t n = path.size();
+    reverseComplementedPath.resize(n);
+    reverseComplementedPathOrdinals.resize(n);
+    for(uint64_t i=0; i<n; i++) {
+        const uint64_t j = n - 1 - i;
+        reverseComplementedPath[i] = markerGraph.reverseComplementEdge[path[j]];
+        const pair<uint32_t, uint32_t>& ordinals = pathOrdinals[j];
+        reverseComplementedPathOrdinals[i] =
+            make_pair(lastOrdinal - ordinals.second, lastOrdinal - ordinals.first);
+    }
+}
+
+
 void Assembler::test()
 {
     accessAllSoft();
@@ -1,15 +1,15 @@
 // Shasta.
 #include "Assembler.hpp"
-#include "MarkerConnectivityGraph.hpp"
 #include "timestamp.hpp"
 using namespace shasta;
 
 // Boost libraries.
-#include <boost/graph/connected_components.hpp>
-#include <boost/graph/iteration_macros.hpp>
+#include <boost/pending/disjoint_sets.hpp>
 
 // Standard library.
+#include "algorithm.hpp"
 #include "fstream.hpp"
+#include <map>
 
 
 
@@ -391,9 +391,6 @@ void Assembler::cleanupDuplicateMarkersPattern2(
     bool debug,
     ostream& out)
 {
-    using vertex_descriptor = MarkerConnectivityGraph::vertex_descriptor;
-    using edge_descriptor = MarkerConnectivityGraph::edge_descriptor;
-
     if(debug) {
         out << "Processing pattern 2 vertex " << vertexId << endl;
     }
@@ -402,69 +399,51 @@ void Assembler::cleanupDuplicateMarkersPattern2(
     SHASTA_ASSERT(isDuplicateOrientedReadId.size() == markerCount);
 
     // Create the marker connectivity graph for this vertex.
-    MarkerConnectivityGraph graph;
-    MarkerConnectivityGraphVertexMap vertexMap;
-    createMarkerConnectivityGraph(
-        markerDescriptors.front().first, markerDescriptors.front().second, true, graph, vertexMap);
-    SHASTA_ASSERT(num_vertices(graph) == markerCount);
+    // We use the flat version, in which vertices are indexes into markerDescriptors.
+    vector< pair<uint64_t, uint64_t> > edges;
+    vector<bool> isReached;
+    createMarkerConnectivityGraphFlat(markerDescriptors, true, edges, isReached);
+    SHASTA_ASSERT(std::count(isReached.begin(), isReached.end(), true) == int64_t(markerCount));
 
     if(debug) {
         out << "The initial marker connectivity graph has " <<
-            num_vertices(graph) << " vertices and " <<
-            num_edges(graph) << " edges." << endl;
+            markerCount << " vertices and " <<
+            edges.size() << " edges." << endl;
     }
 
-    // Find the vertices that correspond to duplicate markers.
-    std::set<vertex_descriptor> duplicateMarkerVertices;
+    // Compute connected components, only using edges between duplicate markers.
+    vector<uint64_t> rank(markerCount);
+    vector<uint64_t> parent(markerCount);
+    boost::disjoint_sets<uint64_t*, uint64_t*> disjointSets(&rank[0], &parent[0]);
     for(uint64_t i=0; i<markerCount; i++) {
-        if(isDuplicateOrientedReadId[i]) {
-            const MarkerDescriptor markerDescriptor = markerDescriptors[i];
-            const auto it = vertexMap.find(markerDescriptor);
-            SHASTA_ASSERT(it != vertexMap.end());
-            const vertex_descriptor v = it->second;
-            duplicateMarkerVertices.insert(v);
-        }
+        disjointSets.make_set(i);
     }
-
-    // Only keep edges between duplicate markers.
-    vector<edge_descriptor> edgesToBeRemoved;
-    BGL_FORALL_EDGES(e, graph, MarkerConnectivityGraph) {
-        const vertex_descriptor v0 = source(e, graph);
-        const vertex_descriptor v1 = target(e, graph);
-        if(
-            (duplicateMarkerVertices.find(v0) == duplicateMarkerVertices.end()) or
-            (duplicateMarkerVertices.find(v1) == duplicateMarkerVertices.end())) {
-            edgesToBeRemoved.push_back(e);
+    uint64_t duplicateEdgeCount = 0;
+    for(const auto& edge: edges) {
+        const uint64_t i0 = edge.first;
+        const uint64_t i1 = edge.second;
+        if(isDuplicateOrientedReadId[i0] and isDuplicateOrientedReadId[i1]) {
+            disjointSets.union_set(i0, i1);
+            ++duplicateEdgeCount;
         }
     }
-    for(const edge_descriptor e: edgesToBeRemoved) {
-        remove_edge(e, graph);
-    }
 
     if(debug) {
         out << "After edges involving non-duplicate vertices, the  marker connectivity graph has " <<
-            num_vertices(graph) << " vertices and " <<
-            num_edges(graph) << " edges." << endl;
+            markerCount << " vertices and " <<
+            duplicateEdgeCount << " edges." << endl;
     }
 
-    // Compute connected components of the graph with the remaining edges.
-    vector<uint64_t> component(markerCount);
-    boost::connected_components(graph, &component[0]);
-    std::map<uint64_t, vector<vertex_descriptor> > components;
-    BGL_FORALL_VERTICES(v, graph, MarkerConnectivityGraph) {
-        components[component[v]].push_back(v);
+    // Gather the markers in each connected component.
+    // Because the markerDescriptors are sorted, so are the ones in each component.
+    std::map<uint64_t, vector<MarkerDescriptor> > components;
+    for(uint64_t i=0; i<markerCount; i++) {
+        components[disjointSets.find_set(i)].push_back(markerDescriptors[i]);
     }
 
     // Process the connected components one at a time.
-    for(auto& p: components) {
-        vector<vertex_descriptor>& component = p.second;
-
-        // Get marker descriptors for this connected component and sort them.
-        vector<MarkerDescriptor> componentDescriptors;
-        for(const vertex_descriptor v: component) {
-            componentDescriptors.push_back(graph[v]);
-        }
-        sort(componentDescriptors.begin(), componentDescriptors.end());
+    for(const auto& p: components) {
+        const vector<MarkerDescriptor>& componentDescriptors = p.second;
 
         if(debug) {
             out << "Found a connected component with " << componentDescriptors.size() << " markers:" << endl;
@@ -0,0 +1,356 @@
+// Estimate of the marker graph coverage histogram using a sample of reads.
+
+// createMarkerGraphVertices computes the disjoint sets of aligned markers
+// for all alignments in the read graph, then uses the histogram
+// of their sizes (DisjointSetsHistogram.csv) to select minCoverage
+// automatically, using PeakFinder. That histogram is only
+// available after the expensive disjoint set computation.
+
+// Here we estimate the same histogram using a random sample of reads.
+// For each sampled read, we find the disjoint set that contains
+// each of its markers on strand 0. This is done by a search in the space
+// of aligned markers, using the same read graph alignments used by
+// createMarkerGraphVertices. This only requires decompressing
+// the alignments of the reads encountered during the search,
+// usually the read graph neighbors of the sampled read.
+
+// A disjoint set of size s is encountered on average f*s times,
+// where f is the fraction of reads sampled. Giving weight 1/(f*s)
+// to each marker of the sampled reads that belongs to a
+// disjoint set of size s gives an unbiased estimate of the number
+// of disjoint sets of size s. Because the disjoint sets are invariant
+// under reverse complementing, only markers on strand 0 are used,
+// with double weight.
+
+// Disjoint sets with more than maxCoverage markers are not explored
+// in full and are only counted in aggregate.
+
+// Shasta.
+#include "Assembler.hpp"
+#include "compressAlignment.hpp"
+#include "PeakFinder.hpp"
+#include "performanceLog.hpp"
+#include "Reads.hpp"
+#include "timestamp.hpp"
+using namespace shasta;
+
+// Standard library.
+#include "algorithm.hpp"
+#include "chrono.hpp"
+#include <cmath>
+#include "fstream.hpp"
+#include <map>
+#include <random>
+
+
+
+void Assembler::estimateMarkerGraphCoverageHistogram(
+    uint64_t sampleReadCount,
+    uint64_t maxCoverage,
+    double peakFinderMinAreaFraction,
+    uint64_t peakFinderAreaStartIndex,
+    size_t threadCount)
+{
+    const auto tBegin = steady_clock::now();
+    cout << timestamp << "Estimating the marker graph coverage histogram." << endl;
+
+    // Check that we have what we need.
+    reads->checkReadsAreOpen();
+    reads->checkReadFlagsAreOpen();
+    checkMarkersAreOpen();
+    checkAlignmentDataAreOpen();
+    SHASTA_ASSERT(compressedAlignments.isOpen());
+    SHASTA_ASSERT(readGraph.edges.isOpen);
+    SHASTA_ASSERT(readGraph.connectivity.isOpen());
+
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    auto& data = markerGraphCoverageEstimateData;
+    data.isValid = false;
+    data.maxCoverage = maxCoverage;
+
+    // Choose the reads to sample.
+    // Use a fixed seed so the estimate is reproducible.
+    const ReadId readCount = reads->readCount();
+    sampleReadCount = min(sampleReadCount, uint64_t(readCount));
+    data.sampledReadIds.resize(readCount);
+    for(ReadId readId=0; readId<readCount; readId++) {
+        data.sampledReadIds[readId] = readId;
+    }
+    std::mt19937 randomSource(231);
+    std::shuffle(data.sampledReadIds.begin(), data.sampledReadIds.end(), randomSource);
+    data.sampledReadIds.resize(sampleReadCount);
+    sort(data.sampledReadIds.begin(), data.sampledReadIds.end());
+
+    // Compute the contributions of the sampled reads in parallel.
+    data.threadHistograms.clear();
+    data.threadHistograms.resize(threadCount);
+    const uint64_t batchSize = 1;
+    setupLoadBalancing(sampleReadCount, batchSize);
+    runThreads(&Assembler::estimateMarkerGraphCoverageHistogramThreadFunction, threadCount);
+
+    // Combine them and normalize.
+    // The factor of 2 accounts for markers on strand 1.
+    const double factor = (sampleReadCount == 0) ? 0. : 2. * double(readCount) / double(sampleReadCount);
+    data.histogram.clear();
+    data.histogram.resize(maxCoverage + 2, 0.);
+    for(const vector<double>& threadHistogram: data.threadHistograms) {
+        for(uint64_t coverage=0; coverage<threadHistogram.size(); coverage++) {
+            data.histogram[coverage] += factor * threadHistogram[coverage];
+        }
+    }
+    data.threadHistograms.clear();
+    data.sampledReadIds.clear();
+    data.sampledReadIds.shrink_to_fit();
+
+
+
+    // Write it out.
+    {
+        ofstream csv("DisjointSetsHistogramEstimate.csv");
+        csv << "Coverage,EstimatedFrequency\n";
+        for(uint64_t coverage=1; coverage<=maxCoverage; coverage++) {
+            csv << coverage << "," << uint64_t(std::round(data.histogram[coverage])) << "\n";
+        }
+        csv << ">" << maxCoverage << "," << uint64_t(std::round(data.histogram[maxCoverage + 1])) << "\n";
+    }
+
+
+
+    // Use the estimated histogram to predict the value of minCoverage
+    // that would be selected automatically.
+    vector<uint64_t> roundedHistogram(maxCoverage + 1);
+    for(uint64_t coverage=0; coverage<=maxCoverage; coverage++) {
+        roundedHistogram[coverage] = uint64_t(std::round(data.histogram[coverage]));
+    }
+    data.minCoverage = 0;
+    try {
+        shasta::PeakFinder p;
+        p.findPeaks(roundedHistogram);
+        data.minCoverage = p.findXCutoff(roundedHistogram, peakFinderMinAreaFraction, peakFinderAreaStartIndex);
+        cout << "Estimated automatic value of MarkerGraph.minCoverage is " << data.minCoverage << endl;
+    }
+    catch (PeakFinderException&) {
+        cout << "No significant cutoff found in the estimated disjoint sets size distribution." << endl;
+    }
+
+    // Estimate the number of marker graph vertices and the number
+    // of markers they contain. This ignores vertices that will
+    // later be removed because of duplicate markers or minCoveragePerStrand.
+    if(data.minCoverage > 0) {
+        double vertexCount = 0.;
+        double markerCount = 0.;
+        for(uint64_t coverage=data.minCoverage; coverage<=maxCoverage; coverage++) {
+            vertexCount += data.histogram[coverage];
+            markerCount += double(coverage) * data.histogram[coverage];
+        }
+        cout << "Estimated number of marker graph vertices " << uint64_t(std::round(vertexCount)) <<
+            ", containing " << uint64_t(std::round(markerCount)) << " markers." << endl;
+    }
+
+    data.isValid = true;
+    const auto tEnd = steady_clock::now();
+    const double tTotal = seconds(tEnd - tBegin);
+    cout << timestamp << "Estimation of the marker graph coverage histogram "
+        "using " << sampleReadCount << " reads completed in " << tTotal << " s." << endl;
+}
+
+
+
+void Assembler::estimateMarkerGraphCoverageHistogramThreadFunction(size_t threadId)
+{
+    auto& data = markerGraphCoverageEstimateData;
+    vector<double>& histogram = data.threadHistograms[threadId];
+    histogram.resize(data.maxCoverage + 2, 0.);
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(uint64_t i=begin; i!=end; i++) {
+            estimateMarkerGraphCoverageForRead(data.sampledReadIds[i], data.maxCoverage, histogram);
+        }
+    }
+}
+
+
+
+// For each marker on strand 0 of the given read, find the size
+// of the disjoint set it belongs to, and increment the histogram
+// by 1/size. If the disjoint set has more than maxCoverage markers,
+// increment histogram[maxCoverage+1] by 1/size instead.
+// Each disjoint set is searched only once, starting from the first
+// of its markers on this read, even if the search is stopped early.
+void Assembler::estimateMarkerGraphCoverageForRead(
+    ReadId readId,
+    uint64_t maxCoverage,
+    vector<double>& histogram) const
+{
+    SHASTA_ASSERT(histogram.size() == maxCoverage + 2);
+
+    // For each oriented read encountered, the markers aligned to each
+    // of its markers, and a flag that tells which markers were already reached.
+    class OrientedReadData {
+    public:
+        vector< vector<MarkerDescriptor> > alignedMarkers;
+        vector<bool> isReached;
+    };
+    std::map<OrientedReadId, OrientedReadData> orientedReadDataMap;
+    Alignment alignment;
+
+    // Function to get the OrientedReadData for an oriented read,
+    // creating it if necessary.
+    auto getOrientedReadData = [&](OrientedReadId orientedReadId) -> OrientedReadData&
+    {
+        auto it = orientedReadDataMap.find(orientedReadId);
+        if(it != orientedReadDataMap.end()) {
+            return it->second;
+        }
+        OrientedReadData& orientedReadData = orientedReadDataMap[orientedReadId];
+        const uint64_t markerCount = markers.size(orientedReadId.getValue());
+        orientedReadData.alignedMarkers.resize(markerCount);
+        orientedReadData.isReached.resize(markerCount, false);
+
+        // Loop over the read graph edges of this oriented read that
+        // are used by createMarkerGraphVertices.
+        for(const uint32_t edgeId: readGraph.connectivity[orientedReadId.getValue()]) {
+            const ReadGraphEdge& readGraphEdge = readGraph.edges[edgeId];
+            if(not isReadGraphEdgeUsedForMarkerGraphVertices(readGraphEdge)) {
+                continue;
+            }
+
+            // The alignment is stored in the orientation
+            // of the first edge of each reverse complemented pair.
+            const ReadGraphEdge& readGraphEdge0 = readGraph.edges[edgeId & ~uint32_t(1)];
+            const bool isReverseComplemented = (edgeId % 2) == 1;
+            array<OrientedReadId, 2> orientedReadIds = readGraphEdge0.orientedReadIds;
+            if(isReverseComplemented) {
+                orientedReadIds[0].flipStrand();
+                orientedReadIds[1].flipStrand();
+            }
+            const uint64_t side = (orientedReadIds[0] == orientedReadId) ? 0 : 1;
+            SHASTA_ASSERT(orientedReadIds[side] == orientedReadId);
+            const OrientedReadId otherOrientedReadId = orientedReadIds[1 - side];
+            const uint32_t markerCount0 = uint32_t(markers.size(orientedReadIds[0].getValue()));
+            const uint32_t markerCount1 = uint32_t(markers.size(orientedReadIds[1].getValue()));
+
+            shasta::decompress(compressedAlignments[readGraphEdge0.alignmentId], alignment);
+            for(const auto& p: alignment.ordinals) {
+                array<uint32_t, 2> ordinals = {p[0], p[1]};
+                if(isReverseComplemented) {
+                    ordinals[0] = markerCount0 - 1 - ordinals[0];
+                    ordinals[1] = markerCount1 - 1 - ordinals[1];
+                }
+                orientedReadData.alignedMarkers[ordinals[side]].push_back(
+                    MarkerDescriptor(otherOrientedReadId, ordinals[1 - side]));
+            }
+        }
+        return orientedReadData;
+    };
+
+
+
+    // Function to add to the search queue q the unreached markers
+    // aligned with a given marker, marking them as reached.
+    vector<MarkerDescriptor> q;
+    auto visit = [&](const MarkerDescriptor& markerDescriptor)
+    {
+        // References to elements of a std::map remain valid
+        // when getOrientedReadData adds elements to it.
+        const vector<MarkerDescriptor>& alignedMarkers =
+            getOrientedReadData(markerDescriptor.first).alignedMarkers[markerDescriptor.second];
+        for(const MarkerDescriptor& alignedMarker: alignedMarkers) {
+            OrientedReadData& orientedReadData1 = getOrientedReadData(alignedMarker.first);
+            if(not orientedReadData1.isReached[alignedMarker.second]) {
+                orientedReadData1.isReached[alignedMarker.second] = true;
+                q.push_back(alignedMarker);
+            }
+        }
+    };
+
+
+
+    // Loop over markers of this read on strand 0.
+    const OrientedReadId orientedReadId0(readId, 0);
+    const uint32_t markerCount = uint32_t(markers.size(orientedReadId0.getValue()));
+    for(uint32_t ordinal=0; ordinal<markerCount; ordinal++) {
+        OrientedReadData& orientedReadData0 = getOrientedReadData(orientedReadId0);
+        if(orientedReadData0.isReached[ordinal]) {
+            continue;
+        }
+
+        // Search the disjoint set that contains this marker,
+        // stopping if it has more than maxCoverage markers.
+        // Count the number of markers of orientedReadId0 that we encounter.
+        q.clear();
+        q.push_back(MarkerDescriptor(orientedReadId0, ordinal));
+        orientedReadData0.isReached[ordinal] = true;
+        uint64_t sampledMarkerCount = 0;
+        uint64_t queueIndex = 0;
+        for(; queueIndex<q.size() and q.size()<=maxCoverage; queueIndex++) {
+            const MarkerDescriptor markerDescriptor = q[queueIndex];
+            if(markerDescriptor.first == orientedReadId0) {
+                ++sampledMarkerCount;
+            }
+            visit(markerDescriptor);
+        }
+
+        // Update the histogram.
+        if(q.size() <= maxCoverage) {
+            histogram[q.size()] += double(sampledMarkerCount) / double(q.size());
+        } else {
+
+            // We stopped early. Finish the search without counting,
+            // only to mark all markers of this disjoint set as reached. Otherwise, later searches starting
+            // at its remaining markers of orientedReadId0 would only see
+            // fragments of it, and add weight to lower coverage values.
+            for(; queueIndex<q.size(); queueIndex++) {
+                visit(q[queueIndex]);
+            }
+
+            // All markers of orientedReadId0 in this disjoint set
+            // are now reached, so they all contribute to the last bin.
+            sampledMarkerCount = 0;
+            for(const MarkerDescriptor& markerDescriptor: q) {
+                if(markerDescriptor.first == orientedReadId0) {
+                    ++sampledMarkerCount;
+                }
+            }
+            histogram[maxCoverage + 1] += double(sampledMarkerCount) / double(q.size());
+        }
+    }
+}
+
+
+
+// Compare the estimated histogram with the exact histogram
+// computed by createMarkerGraphVertices.
+void Assembler::compareMarkerGraphCoverageHistogramEstimate(
+    const vector<uint64_t>& histogram,
+    uint64_t minCoverage,
+    uint64_t maxCoverage,
+    bool minCoverageWasSelectedAutomatically)
+{
+    const auto& data = markerGraphCoverageEstimateData;
+    SHASTA_ASSERT(data.isValid);
+
+    // Number of disjoint sets with coverage between minCoverage and maxCoverage,
+    // exact and estimated.
+    uint64_t exactCount = 0;
+    double estimatedCount = 0.;
+    for(uint64_t coverage=minCoverage; coverage<=min(maxCoverage, data.maxCoverage); coverage++) {
+        if(coverage < histogram.size()) {
+            exactCount += histogram[coverage];
+        }
+        estimatedCount += data.histogram[coverage];
+    }
+    cout << "Number of disjoint sets with coverage between " << minCoverage <<
+        " and " << maxCoverage << ": exact " << exactCount <<
+        ", estimated " << uint64_t(std::round(estimatedCount)) << "." << endl;
+
+    if(minCoverageWasSelectedAutomatically) {
+        cout << "Automatic value of MarkerGraph.minCoverage: exact " << minCoverage <<
+            ", estimated " << data.minCoverage << "." << endl;
+    }
+}
@@ -112,6 +112,7 @@ void Assembler::createMarkerGraphEdgesStrict(
 
     // Now we need to create edgesBySource and edgesByTarget.
     createMarkerGraphEdgesBySourceAndTarget(threadCount);
+    markerGraph.createEdgeFlagBitsets(threadCount);
 
     performanceLog << timestamp << "createMarkerGraphEdgesStrict ends." << endl;
 }
@@ -426,21 +427,14 @@ void Assembler::writeParallelMarkerGraphEdges() const
 // Function createMarkerGraphSecondaryEdges can be called after createMarkerGraphEdgesStrict
 // to create a minimal amount of additional non-strict edges (secondary edges)
 // sufficient to restore contiguity.
-// This is a low performance version for testing:
-// - It is not multithreaded.
-// - It uses standard containers instead of the classes in
-//   namespace shasta::MemoryMapped.
+// It runs a non-aggressive pass followed by an aggressive pass.
+// The search for secondary edges is multithreaded, and the new edges
+// are appended in a single batch for each pass.
+// edgesBySource, edgesByTarget, and reverseComplementEdge are
+// only recreated once, at the end.
 void Assembler::createMarkerGraphSecondaryEdges(
     uint32_t secondaryEdgeMaxSkip,
     size_t threadCount)
-{
-    createMarkerGraphSecondaryEdges(secondaryEdgeMaxSkip, false, threadCount);
-    createMarkerGraphSecondaryEdges(secondaryEdgeMaxSkip, true, threadCount);
-}
-void Assembler::createMarkerGraphSecondaryEdges(
-    uint32_t secondaryEdgeMaxSkip,
-    bool aggressive,
-    size_t threadCount)
 {
     using VertexId = MarkerGraph::VertexId;
 
@@ -457,118 +451,138 @@ void Assembler::createMarkerGraphSecondaryEdges(
         threadCount = std::thread::hardware_concurrency();
     }
 
-
     const VertexId vertexCount = markerGraph.vertexCount();
     performanceLog << timestamp << "createMarkerGraphSecondaryEdges begins." << endl;
     cout << "The initial marker graph has " << vertexCount <<
         " vertices and " << markerGraph.edges.size() << " edges." << endl;
 
+    // Initialize the flags that tell us which vertices have
+    // outgoing/incoming edges. The two passes keep them up to date,
+    // so we don't need edgesBySource and edgesByTarget between passes.
+    auto& data = createMarkerGraphSecondaryEdgesData;
+    data.hasOutEdges.clear();
+    data.hasInEdges.clear();
+    data.hasOutEdges.resize(vertexCount, false);
+    data.hasInEdges.resize(vertexCount, false);
+    for(VertexId v=0; v!=vertexCount; v++) {
+        data.hasOutEdges[v] = (markerGraph.outDegree(v) > 0);
+        data.hasInEdges[v] = (markerGraph.inDegree(v) > 0);
+    }
 
+    createMarkerGraphSecondaryEdges(secondaryEdgeMaxSkip, false, threadCount);
+    createMarkerGraphSecondaryEdges(secondaryEdgeMaxSkip, true, threadCount);
 
-    // Vector to contain the dead end pairs.
-    // A forward dead end is a vertex with out-degree 0.
-    // A backward dead end is a vertex with in-degree 0.
-    // Each dead end pair consists of a vertex with zero out-degree
-    // (a forward dead end) and its reverse complement,
-    // which has zero in-degree and is a backward dead end.
-    vector< array<VertexId, 2> > deadEndPairs;
+    data.hasOutEdges.clear();
+    data.hasOutEdges.shrink_to_fit();
+    data.hasInEdges.clear();
+    data.hasInEdges.shrink_to_fit();
 
-    // Also create a table to contains the forward/backward deadEndId for each vertex.
-    // Index by VertexId.
-    const uint64_t noDeadEnd = std::numeric_limits<uint64_t>::max();
-    vector< array<uint64_t, 2> > deadEndTable(vertexCount, {noDeadEnd, noDeadEnd});
 
-    // Gather the dead end pairs.
-    for(VertexId v=0; v!=vertexCount; v++) {
-        if(markerGraph.outDegree(v) == 0) {
-            const VertexId vRc = markerGraph.reverseComplementVertex[v];
-            SHASTA_ASSERT(markerGraph.inDegree(vRc) == 0);
-            const uint64_t deadEndPairId = deadEndPairs.size();
-            deadEndTable[v][0] = deadEndPairId;
-            deadEndTable[vRc][1] = deadEndPairId;
-            deadEndPairs.push_back({v, vRc});
-        }
+
+    // We need to recreate edgesBySource and edgesByTarget.
+    if(markerGraph.edgesBySource.isOpen()) {
+        markerGraph.edgesBySource.close();
+    }
+    if(markerGraph.edgesByTarget.isOpen()) {
+        markerGraph.edgesByTarget.close();
     }
-    cout << "Found " << deadEndPairs.size() << " dead end pairs." << endl;
+    createMarkerGraphEdgesBySourceAndTarget(threadCount);
 
+    // Edges were added, so the edge flag bitsets have to be recreated.
+    markerGraph.createEdgeFlagBitsets(threadCount);
 
+    // We also need to recompute reverse complement marker graph edges.
+    if(markerGraph.reverseComplementEdge.isOpen) {
+        markerGraph.reverseComplementEdge.close();
+    }
+    findMarkerGraphReverseComplementEdges(threadCount);
 
-    // Look for secondary edges. Loop over forward dead ends.
-    vector< array<VertexId, 2> > secondaryEdges;
-    vector<MarkerGraph::VertexId> nextVertices;
-    vector<MarkerGraph::VertexId> v1Candidates;
-    vector<uint64_t> v1Count;
-    for(uint64_t deadEndId0=0; deadEndId0<deadEndPairs.size(); deadEndId0++) {
-        const VertexId v0 = deadEndPairs[deadEndId0][0];
 
-        // Find the next vertex for each marker / oriented read on this vertex.
-        findNextMarkerGraphVertices(v0, secondaryEdgeMaxSkip, nextVertices);
+    cout << "After adding secondary edges, the marker graph has " <<
+        markerGraph.vertices().size() << " vertices and " <<
+        markerGraph.edges.size() << " edges." << endl;
+    performanceLog << timestamp << "createMarkerGraphSecondaryEdges ends." << endl;
+}
 
-        // Loop over the markers in this vertex.
-        // For each marker there is an OrientedReadId and a next vertex.
-        v1Candidates.clear();
-        for(uint64_t j=0; j<nextVertices.size(); j++) {
-            const MarkerGraph::VertexId v1 = nextVertices[j];
 
-            // Disregard secondary edges to self.
-            if(v1 == v0) {
-                continue;
-            }
 
-            // If there is no next vertex for this marker, skip.
-            if(v1 == MarkerGraph::invalidVertexId) {
-                continue;
-            }
+// This does one pass of secondary edge creation.
+// It uses the hasOutEdges and hasInEdges flags in
+// createMarkerGraphSecondaryEdgesData instead of edgesBySource
+// and edgesByTarget, which are not updated.
+void Assembler::createMarkerGraphSecondaryEdges(
+    uint32_t secondaryEdgeMaxSkip,
+    bool aggressive,
+    size_t threadCount)
+{
+    using VertexId = MarkerGraph::VertexId;
+    const VertexId vertexCount = markerGraph.vertexCount();
 
-            // If not in aggressive mode and this is not a backward dead end, skip.
-            // In aggressive mode we accept everything, which gives better
-            // contiguity but can also create more artifacts.
-            if(not aggressive) {
-                const uint64_t deadEnd1 = deadEndTable[v1][1];
-                if(deadEnd1 == noDeadEnd) {
-                    continue;
-                }
-            }
+    // Store parameters so all threads can see them.
+    auto& data = createMarkerGraphSecondaryEdgesData;
+    data.secondaryEdgeMaxSkip = secondaryEdgeMaxSkip;
+    data.aggressive = aggressive;
+    SHASTA_ASSERT(data.hasOutEdges.size() == vertexCount);
+    SHASTA_ASSERT(data.hasInEdges.size() == vertexCount);
 
-            v1Candidates.push_back(v1);
-        }
-        if(v1Candidates.empty()) {
-            continue;
-        }
 
-        // Count how many times each possible v1 appeared.
-        deduplicateAndCount(v1Candidates, v1Count);
-        const uint64_t v1CountMax = *std::max_element(v1Count.begin(), v1Count.end());
-
-        for(uint64_t i=0; i<v1Candidates.size(); i++) {
-            if(v1Count[i] == v1CountMax) {
-                const VertexId v1 = v1Candidates[i];
-                const VertexId v0Rc = markerGraph.reverseComplementVertex[v0];
-                const VertexId v1Rc = markerGraph.reverseComplementVertex[v1];
-                SHASTA_ASSERT(v0 != v1);
-                SHASTA_ASSERT(v0Rc != v1Rc);
-                secondaryEdges.push_back({v0, v1});
-                secondaryEdges.push_back({v1Rc, v0Rc});
-                break;
-            }
+
+    // Gather the forward dead ends.
+    // A forward dead end is a vertex with out-degree 0.
+    // A backward dead end is a vertex with in-degree 0.
+    // The reverse complement of a forward dead end
+    // is a backward dead end and vice versa, so there is no need
+    // to store the backward dead ends.
+    data.forwardDeadEnds.clear();
+    for(VertexId v=0; v!=vertexCount; v++) {
+        if(not data.hasOutEdges[v]) {
+            const VertexId vRc = markerGraph.reverseComplementVertex[v];
+            SHASTA_ASSERT(not data.hasInEdges[vRc]);
+            data.forwardDeadEnds.push_back(v);
         }
     }
-    cout << "Found " << secondaryEdges.size() << " secondary edges." << endl;
-    deduplicate(secondaryEdges);
-    cout << "After deduplicating, there are " << secondaryEdges.size() << " secondary edges." << endl;
+    cout << "Found " << data.forwardDeadEnds.size() << " dead end pairs." << endl;
+
+
+
+    // Look for secondary edges. This is done in parallel over forward dead ends,
+    // with each thread storing the secondary edges it finds.
+    data.threadSecondaryEdges.clear();
+    data.threadSecondaryEdges.resize(threadCount);
+    setupLoadBalancing(data.forwardDeadEnds.size(), 1000);
+    runThreads(&Assembler::createMarkerGraphSecondaryEdgesThreadFunction1, threadCount);
+
+    // Gather the secondary edges found by all threads.
+    data.secondaryEdges.clear();
+    for(auto& threadSecondaryEdges: data.threadSecondaryEdges) {
+        data.secondaryEdges.insert(data.secondaryEdges.end(),
+            threadSecondaryEdges.begin(), threadSecondaryEdges.end());
+    }
+    data.threadSecondaryEdges.clear();
+    data.threadSecondaryEdges.shrink_to_fit();
+    data.forwardDeadEnds.clear();
+    data.forwardDeadEnds.shrink_to_fit();
+    cout << "Found " << data.secondaryEdges.size() << " secondary edges." << endl;
+    deduplicate(data.secondaryEdges);
+    cout << "After deduplicating, there are " << data.secondaryEdges.size() << " secondary edges." << endl;
+
+
 
+    // Compute the marker intervals of the secondary edges, also in parallel.
+    data.secondaryEdgesMarkerIntervals.clear();
+    data.secondaryEdgesMarkerIntervals.resize(data.secondaryEdges.size());
+    setupLoadBalancing(data.secondaryEdges.size(), 100);
+    runThreads(&Assembler::createMarkerGraphSecondaryEdgesThreadFunction2, threadCount);
 
 
-    // Add the edges we found.
-    vector<MarkerInterval> markerIntervals;
-    for(const array<VertexId, 2>& secondaryEdge: secondaryEdges) {
-        const VertexId v0 = secondaryEdge[0];
-        const VertexId v1 = secondaryEdge[1];
-        SHASTA_ASSERT(v0 != v1);
 
-        getMarkerIntervals(v0, v1, markerIntervals);
+    // Add the edges we found in a single batch.
+    markerGraph.edges.reserve(markerGraph.edges.size() + data.secondaryEdges.size());
+    for(uint64_t i=0; i<data.secondaryEdges.size(); i++) {
+        const VertexId v0 = data.secondaryEdges[i][0];
+        const VertexId v1 = data.secondaryEdges[i][1];
+        const vector<MarkerInterval>& markerIntervals = data.secondaryEdgesMarkerIntervals[i];
 
-        // Add the edge.
         MarkerGraph::Edge edge;
         edge.source = v0;
         edge.target = v1;
@@ -581,31 +595,111 @@ void Assembler::createMarkerGraphSecondaryEdges(
         edge.isSecondary = 1;
         markerGraph.edges.push_back(edge);
         markerGraph.edgeMarkerIntervals.appendVector(markerIntervals);
+
+        data.hasOutEdges[v0] = true;
+        data.hasInEdges[v1] = true;
     }
 
+    data.secondaryEdges.clear();
+    data.secondaryEdges.shrink_to_fit();
+    data.secondaryEdgesMarkerIntervals.clear();
+    data.secondaryEdgesMarkerIntervals.shrink_to_fit();
+}
 
 
-    // We need to recreate edgesBySource and edgesByTarget.
-    if(markerGraph.edgesBySource.isOpen()) {
-        markerGraph.edgesBySource.close();
-    }
-    if(markerGraph.edgesByTarget.isOpen()) {
-        markerGraph.edgesByTarget.close();
-    }
-    createMarkerGraphEdgesBySourceAndTarget(threadCount);
 
-    // We also need to recompute reverse complement marker graph edges.
-    if(markerGraph.reverseComplementEdge.isOpen) {
-        markerGraph.reverseComplementEdge.close();
+void Assembler::createMarkerGraphSecondaryEdgesThreadFunction1(size_t threadId)
+{
+    using VertexId = MarkerGraph::VertexId;
+
+    auto& data = createMarkerGraphSecondaryEdgesData;
+    const uint32_t secondaryEdgeMaxSkip = data.secondaryEdgeMaxSkip;
+    const bool aggressive = data.aggressive;
+    vector< array<VertexId, 2> >& secondaryEdges = data.threadSecondaryEdges[threadId];
+
+    vector<MarkerGraph::VertexId> nextVertices;
+    vector<MarkerGraph::VertexId> v1Candidates;
+    vector<uint64_t> v1Count;
+
+    // Loop over batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // Loop over forward dead ends assigned to this batch.
+        for(uint64_t i=begin; i!=end; i++) {
+            const VertexId v0 = data.forwardDeadEnds[i];
+
+            // Find the next vertex for each marker / oriented read on this vertex.
+            findNextMarkerGraphVertices(v0, secondaryEdgeMaxSkip, nextVertices);
+
+            // Loop over the markers in this vertex.
+            // For each marker there is an OrientedReadId and a next vertex.
+            v1Candidates.clear();
+            for(uint64_t j=0; j<nextVertices.size(); j++) {
+                const MarkerGraph::VertexId v1 = nextVertices[j];
+
+                // Disregard secondary edges to self.
+                if(v1 == v0) {
+                    continue;
+                }
+
+                // If there is no next vertex for this marker, skip.
+                if(v1 == MarkerGraph::invalidVertexId) {
+                    continue;
+                }
+
+                // If not in aggressive mode and this is not a backward dead end, skip.
+                // In aggressive mode we accept everything, which gives better
+                // contiguity but can also create more artifacts.
+                if(not aggressive) {
+                    if(data.hasInEdges[v1]) {
+                        continue;
+                    }
+                }
+
+                v1Candidates.push_back(v1);
+            }
+            if(v1Candidates.empty()) {
+                continue;
+            }
+
+            // Count how many times each possible v1 appeared.
+            deduplicateAndCount(v1Candidates, v1Count);
+            const uint64_t v1CountMax = *std::max_element(v1Count.begin(), v1Count.end());
+
+            for(uint64_t k=0; k<v1Candidates.size(); k++) {
+                if(v1Count[k] == v1CountMax) {
+                    const VertexId v1 = v1Candidates[k];
+                    const VertexId v0Rc = markerGraph.reverseComplementVertex[v0];
+                    const VertexId v1Rc = markerGraph.reverseComplementVertex[v1];
+                    SHASTA_ASSERT(v0 != v1);
+                    SHASTA_ASSERT(v0Rc != v1Rc);
+                    secondaryEdges.push_back({v0, v1});
+                    secondaryEdges.push_back({v1Rc, v0Rc});
+                    break;
+                }
+            }
+        }
     }
-    findMarkerGraphReverseComplementEdges(threadCount);
+}
 
 
-    cout << "After adding secondary edges, the marker graph has " <<
-        markerGraph.vertices().size() << " vertices and " <<
-        markerGraph.edges.size() << " edges." << endl;
 
+void Assembler::createMarkerGraphSecondaryEdgesThreadFunction2(size_t threadId)
+{
+    auto& data = createMarkerGraphSecondaryEdgesData;
 
+    // Loop over batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // Loop over secondary edges assigned to this batch.
+        for(uint64_t i=begin; i!=end; i++) {
+            const auto& secondaryEdge = data.secondaryEdges[i];
+            SHASTA_ASSERT(secondaryEdge[0] != secondaryEdge[1]);
+            getMarkerIntervals(secondaryEdge[0], secondaryEdge[1], data.secondaryEdgesMarkerIntervals[i]);
+        }
+    }
 }
 
 
@@ -835,6 +929,9 @@ void Assembler::splitMarkerGraphSecondaryEdges(
     }
     createMarkerGraphEdgesBySourceAndTarget(threadCount);
 
+    // Edges were added, so the edge flag bitsets have to be recreated.
+    markerGraph.createEdgeFlagBitsets(threadCount);
+
     // We also need to recompute reverse complement marker graph edges.
     if(markerGraph.reverseComplementEdge.isOpen) {
         markerGraph.reverseComplementEdge.close();
@@ -876,8 +973,8 @@ void Assembler::splitMarkerGraphSecondaryEdgesThreadFunction(size_t threadId)
             MarkerGraph::Edge& edgeRc = markerGraph.edges[edgeIdRc];
 
             // Mark both of them as not removed due to splitting.
-            edge.wasRemovedWhileSplittingSecondaryEdges = 0;
-            edgeRc.wasRemovedWhileSplittingSecondaryEdges = 0;
+            markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasRemovedWhileSplittingSecondaryEdges, false);
+            markerGraph.setEdgeFlag(edgeIdRc, MarkerGraph::EdgeFlag::wasRemovedWhileSplittingSecondaryEdges, false);
 
             // If these are not secondary edges, do nothing.
             SHASTA_ASSERT(edge.isSecondary == edgeRc.isSecondary);
@@ -909,8 +1006,8 @@ void Assembler::splitMarkerGraphSecondaryEdgesThreadFunction(size_t threadId)
 
             // We will split this edge and its reverse complement.
             splitCount += 2;
-            edge.wasRemovedWhileSplittingSecondaryEdges = 1;
-            edgeRc.wasRemovedWhileSplittingSecondaryEdges = 1;
+            markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasRemovedWhileSplittingSecondaryEdges, true);
+            markerGraph.setEdgeFlag(edgeIdRc, MarkerGraph::EdgeFlag::wasRemovedWhileSplittingSecondaryEdges, true);
 
             // Each cluster generates a new edge,
             // if it is big enough. But always generate at least one.
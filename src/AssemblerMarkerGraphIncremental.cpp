@@ -0,0 +1,413 @@
+// Incremental computation of the marker graph disjoint sets,
+// used in iterative assembly.
+
+// In iterative assembly, the marker graph is recreated at each iteration
+// from a new read graph. Most read graph edges don't change between
+// iterations, and so most disjoint sets of aligned markers
+// computed by createMarkerGraphVertices also don't change.
+// When incremental computation is enabled, createMarkerGraphVertices
+// stores the disjoint sets it computes, together with the set of
+// alignments used to compute them. The next call to createMarkerGraphVertices
+// then only recomputes the disjoint sets affected by alignments
+// that were added or removed:
+
+// - The affected disjoint sets are the ones that contain at least one
+//   marker of a read involved in an alignment that was added or removed.
+//   Because the disjoint sets are invariant under reverse complementing,
+//   this includes the reverse complement of each affected disjoint set.
+// - Markers of the affected disjoint sets are reset to singletons.
+// - All alignments used for the new read graph that involve at least
+//   one read with affected markers are decompressed again, and
+//   pairs of aligned affected markers are merged.
+//   Pairs of aligned markers in which one marker is affected
+//   always have the other marker also affected.
+// - Markers not in affected disjoint sets keep their disjoint set.
+
+// The updated disjoint sets are identical to the ones that would be
+// obtained from a full computation, except for the choice
+// of the representative of each disjoint set, which is arbitrary anyway.
+
+// Shasta.
+#include "Assembler.hpp"
+#include "compressAlignment.hpp"
+#include "performanceLog.hpp"
+#include "Reads.hpp"
+#include "timestamp.hpp"
+using namespace shasta;
+
+// Standard library.
+#include "algorithm.hpp"
+#include "chrono.hpp"
+#include <limits>
+#include "stdexcept.hpp"
+
+
+
+void Assembler::enableIncrementalMarkerGraphVertices(bool verify)
+{
+    auto& incremental = incrementalMarkerGraphData;
+    incremental.isEnabled = true;
+    incremental.verify = verify;
+    incremental.isValid = false;
+}
+
+
+
+void Assembler::disableIncrementalMarkerGraphVertices()
+{
+    auto& incremental = incrementalMarkerGraphData;
+    incremental.isEnabled = false;
+    incremental.verify = false;
+    incremental.isValid = false;
+    if(incremental.disjointSetTable.isOpen) {
+        incremental.disjointSetTable.remove();
+    }
+    incremental.alignmentWasUsed.clear();
+    incremental.alignmentWasUsed.shrink_to_fit();
+}
+
+
+
+// Return true if the alignment corresponding to a read graph edge
+// is used by createMarkerGraphVertices to merge markers.
+bool Assembler::isReadGraphEdgeUsedForMarkerGraphVertices(const ReadGraphEdge& readGraphEdge) const
+{
+    // If the edge is flagged as crossing strands, skip it.
+    if(readGraphEdge.crossesStrands) {
+        return false;
+    }
+
+    // If the edge has an alignment flagged as inconsistent, skip it.
+    if(readGraphEdge.hasInconsistentAlignment) {
+        return false;
+    }
+
+    // If either of the reads is flagged chimeric, skip it.
+    if( reads->getFlags(readGraphEdge.orientedReadIds[0].getReadId()).isChimeric ||
+        reads->getFlags(readGraphEdge.orientedReadIds[1].getReadId()).isChimeric) {
+        return false;
+    }
+
+    return true;
+}
+
+
+
+// Flag the alignments used by createMarkerGraphVertices to merge markers.
+// The vector is indexed by alignmentId.
+void Assembler::getAlignmentsUsedForMarkerGraphVertices(vector<bool>& alignmentIsUsed) const
+{
+    alignmentIsUsed.clear();
+    alignmentIsUsed.resize(alignmentData.size(), false);
+
+    // Read graph edges come in reverse complemented pairs,
+    // and both edges in a pair use the same alignment.
+    for(uint64_t i=0; i<readGraph.edges.size(); i+=2) {
+        const ReadGraphEdge& readGraphEdge = readGraph.edges[i];
+        if(isReadGraphEdgeUsedForMarkerGraphVertices(readGraphEdge)) {
+            alignmentIsUsed[readGraphEdge.alignmentId] = true;
+        }
+    }
+}
+
+
+
+// Store the disjoint sets just computed by createMarkerGraphVertices,
+// so the next call can update them incrementally.
+void Assembler::storeMarkerGraphDisjointSets()
+{
+    const auto& data = createMarkerGraphVerticesData;
+    auto& incremental = incrementalMarkerGraphData;
+    SHASTA_ASSERT(incremental.isEnabled);
+    SHASTA_ASSERT(data.disjointSetTable.size() == data.orientedMarkerCount);
+
+    if(incremental.disjointSetTable.isOpen) {
+        incremental.disjointSetTable.remove();
+    }
+    incremental.disjointSetTable.createNew(
+        largeDataName("tmp-IncrementalDisjointSetTable"),
+        largeDataPageSize);
+    incremental.disjointSetTable.reserveAndResize(data.orientedMarkerCount);
+    copy(data.disjointSetTable.begin(), data.disjointSetTable.end(),
+        incremental.disjointSetTable.begin());
+
+    getAlignmentsUsedForMarkerGraphVertices(incremental.alignmentWasUsed);
+    incremental.isValid = true;
+}
+
+
+
+// Update the disjoint sets stored by the previous call to
+// createMarkerGraphVertices and store them in
+// createMarkerGraphVerticesData.disjointSetTable.
+// See the beginning of this file for more information.
+void Assembler::updateMarkerGraphDisjointSets(size_t threadCount)
+{
+    auto& data = createMarkerGraphVerticesData;
+    auto& incremental = incrementalMarkerGraphData;
+    const uint64_t orientedMarkerCount = data.orientedMarkerCount;
+    const ReadId readCount = reads->readCount();
+    SHASTA_ASSERT(incremental.canUpdate(orientedMarkerCount, alignmentData.size()));
+
+    const auto tBegin = steady_clock::now();
+    performanceLog << timestamp << "Incremental update of marker graph disjoint sets begins." << endl;
+
+
+
+    // Find the alignments that were added or removed, and flag the reads involved.
+    vector<bool> alignmentIsUsed;
+    getAlignmentsUsedForMarkerGraphVertices(alignmentIsUsed);
+    vector<bool> isChangedRead(readCount, false);
+    uint64_t addedAlignmentCount = 0;
+    uint64_t removedAlignmentCount = 0;
+    for(uint64_t alignmentId=0; alignmentId<alignmentData.size(); alignmentId++) {
+        const bool isUsed = alignmentIsUsed[alignmentId];
+        const bool wasUsed = incremental.alignmentWasUsed[alignmentId];
+        if(isUsed == wasUsed) {
+            continue;
+        }
+        if(isUsed) {
+            ++addedAlignmentCount;
+        } else {
+            ++removedAlignmentCount;
+        }
+        const AlignmentData& ad = alignmentData[alignmentId];
+        isChangedRead[ad.readIds[0]] = true;
+        isChangedRead[ad.readIds[1]] = true;
+    }
+    cout << timestamp << "Since the last marker graph creation, " <<
+        addedAlignmentCount << " alignments were added and " <<
+        removedAlignmentCount << " alignments were removed." << endl;
+
+
+
+    // Start with the disjoint sets computed last time.
+    data.disjointSetTable.createNew(
+        largeDataName("tmp-DisjointSetTable"),
+        largeDataPageSize);
+    data.disjointSetTable.reserveAndResize(orientedMarkerCount);
+    MarkerGraph::VertexId* disjointSetTable = data.disjointSetTable.begin();
+    copy(incremental.disjointSetTable.begin(), incremental.disjointSetTable.end(),
+        disjointSetTable);
+
+
+
+    // Flag the affected disjoint sets.
+    // Disjoint set ids are MarkerIds, so we can use a vector of size orientedMarkerCount.
+    vector<bool> isAffectedDisjointSet(orientedMarkerCount, false);
+    for(ReadId readId=0; readId<readCount; readId++) {
+        if(not isChangedRead[readId]) {
+            continue;
+        }
+        for(Strand strand=0; strand<2; strand++) {
+            const OrientedReadId orientedReadId(readId, strand);
+            const MarkerId firstMarkerId = getMarkerId(orientedReadId, 0);
+            const uint64_t markerCount = markers.size(orientedReadId.getValue());
+            for(MarkerId markerId=firstMarkerId; markerId<firstMarkerId+markerCount; markerId++) {
+                isAffectedDisjointSet[disjointSetTable[markerId]] = true;
+            }
+        }
+    }
+
+
+
+    // Flag the markers in the affected disjoint sets.
+    incremental.isAffectedMarker.clear();
+    incremental.isAffectedMarker.resize(orientedMarkerCount, false);
+    uint64_t affectedMarkerCount = 0;
+    for(MarkerId markerId=0; markerId<orientedMarkerCount; markerId++) {
+        if(isAffectedDisjointSet[disjointSetTable[markerId]]) {
+            incremental.isAffectedMarker[markerId] = true;
+            ++affectedMarkerCount;
+        }
+    }
+    isAffectedDisjointSet.clear();
+    isAffectedDisjointSet.shrink_to_fit();
+    cout << timestamp << affectedMarkerCount << " markers out of " << orientedMarkerCount <<
+        " are in disjoint sets that need to be recomputed." << endl;
+
+    // If most markers are affected, a full computation is faster.
+    if(affectedMarkerCount > orientedMarkerCount / 2) {
+        cout << "Doing a full computation of the marker graph disjoint sets instead." << endl;
+        incremental.isAffectedMarker.clear();
+        incremental.isAffectedMarker.shrink_to_fit();
+        data.disjointSetTable.remove();
+        computeMarkerGraphDisjointSets(threadCount);
+        return;
+    }
+
+
+
+    // Flag the reads that have at least one affected marker.
+    incremental.isAffectedRead.clear();
+    incremental.isAffectedRead.resize(readCount, false);
+    for(ReadId readId=0; readId<readCount; readId++) {
+        const OrientedReadId orientedReadId(readId, 0);
+        const MarkerId firstMarkerId = getMarkerId(orientedReadId, 0);
+        const uint64_t markerCount = markers.size(orientedReadId.getValue());
+        for(MarkerId markerId=firstMarkerId; markerId<firstMarkerId+markerCount; markerId++) {
+            if(incremental.isAffectedMarker[markerId]) {
+                incremental.isAffectedRead[readId] = true;
+                break;
+            }
+        }
+    }
+
+
+
+    // In parallel, find pairs of aligned affected markers.
+    incremental.threadMarkerPairs.clear();
+    incremental.threadMarkerPairs.resize(threadCount);
+    const uint64_t batchSize = 10000;
+    setupLoadBalancing(readGraph.edges.size(), batchSize);
+    runThreads(&Assembler::updateMarkerGraphDisjointSetsThreadFunction, threadCount);
+
+
+
+    // Recompute the affected disjoint sets, using disjointSetTable
+    // to store the parent of each affected marker.
+    // The representative of each recomputed disjoint set is its lowest MarkerId.
+    for(MarkerId markerId=0; markerId<orientedMarkerCount; markerId++) {
+        if(incremental.isAffectedMarker[markerId]) {
+            disjointSetTable[markerId] = markerId;
+        }
+    }
+    auto find = [disjointSetTable](MarkerId markerId)
+    {
+        while(disjointSetTable[markerId] != markerId) {
+            disjointSetTable[markerId] = disjointSetTable[disjointSetTable[markerId]];
+            markerId = disjointSetTable[markerId];
+        }
+        return markerId;
+    };
+    auto unite = [&find, disjointSetTable](MarkerId markerId0, MarkerId markerId1)
+    {
+        markerId0 = find(markerId0);
+        markerId1 = find(markerId1);
+        if(markerId0 < markerId1) {
+            disjointSetTable[markerId1] = markerId0;
+        } else if(markerId1 < markerId0) {
+            disjointSetTable[markerId0] = markerId1;
+        }
+    };
+    for(vector< pair<MarkerId, MarkerId> >& markerPairs: incremental.threadMarkerPairs) {
+        for(const auto& p: markerPairs) {
+            unite(p.first, p.second);
+
+            // Also merge the reverse complemented markers.
+            // This guarantees that the marker graph remains invariant
+            // under strand swap.
+            const MarkerId markerId0 = findReverseComplement(p.first);
+            const MarkerId markerId1 = findReverseComplement(p.second);
+            SHASTA_ASSERT(incremental.isAffectedMarker[markerId0]);
+            SHASTA_ASSERT(incremental.isAffectedMarker[markerId1]);
+            unite(markerId0, markerId1);
+        }
+        markerPairs.clear();
+        markerPairs.shrink_to_fit();
+    }
+    for(MarkerId markerId=0; markerId<orientedMarkerCount; markerId++) {
+        if(incremental.isAffectedMarker[markerId]) {
+            disjointSetTable[markerId] = find(markerId);
+        }
+    }
+    incremental.threadMarkerPairs.clear();
+    incremental.isAffectedMarker.clear();
+    incremental.isAffectedMarker.shrink_to_fit();
+    incremental.isAffectedRead.clear();
+    incremental.isAffectedRead.shrink_to_fit();
+
+    const auto tEnd = steady_clock::now();
+    const double tTotal = seconds(tEnd - tBegin);
+    performanceLog << timestamp << "Incremental update of marker graph disjoint sets "
+        "completed in " << tTotal << " s." << endl;
+
+
+
+    // If requested, verify that we get the same disjoint sets as a full computation.
+    // To compare, replace each disjoint set id with the lowest MarkerId
+    // in the disjoint set.
+    if(incremental.verify) {
+        cout << timestamp << "Verifying the incremental update of marker graph disjoint sets." << endl;
+        const MarkerId invalidMarkerId = std::numeric_limits<MarkerId>::max();
+        vector<MarkerId> lowestMarkerId(orientedMarkerCount, invalidMarkerId);
+
+        vector<MarkerId> updatedDisjointSetTable(orientedMarkerCount);
+        for(MarkerId markerId=0; markerId<orientedMarkerCount; markerId++) {
+            MarkerId& m = lowestMarkerId[disjointSetTable[markerId]];
+            m = min(m, markerId);
+        }
+        for(MarkerId markerId=0; markerId<orientedMarkerCount; markerId++) {
+            updatedDisjointSetTable[markerId] = lowestMarkerId[disjointSetTable[markerId]];
+        }
+
+        data.disjointSetTable.remove();
+        computeMarkerGraphDisjointSets(threadCount);
+        const MarkerGraph::VertexId* fullDisjointSetTable = data.disjointSetTable.begin();
+        fill(lowestMarkerId.begin(), lowestMarkerId.end(), invalidMarkerId);
+        for(MarkerId markerId=0; markerId<orientedMarkerCount; markerId++) {
+            MarkerId& m = lowestMarkerId[fullDisjointSetTable[markerId]];
+            m = min(m, markerId);
+        }
+        uint64_t discrepancyCount = 0;
+        for(MarkerId markerId=0; markerId<orientedMarkerCount; markerId++) {
+            if(updatedDisjointSetTable[markerId] != lowestMarkerId[fullDisjointSetTable[markerId]]) {
+                ++discrepancyCount;
+            }
+        }
+        if(discrepancyCount) {
+            throw runtime_error("Incremental update of marker graph disjoint sets "
+                "does not agree with a full computation for " + to_string(discrepancyCount) +
+                " markers.");
+        }
+        cout << timestamp << "Incremental update of marker graph disjoint sets "
+            "agrees with a full computation." << endl;
+    }
+}
+
+
+
+// Thread function used by updateMarkerGraphDisjointSets
+// to find pairs of aligned affected markers.
+void Assembler::updateMarkerGraphDisjointSetsThreadFunction(size_t threadId)
+{
+    const auto& incremental = incrementalMarkerGraphData;
+    vector< pair<MarkerId, MarkerId> >& markerPairs = incrementalMarkerGraphData.threadMarkerPairs[threadId];
+    Alignment alignment;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // We process read graph edges in pairs.
+        // In each pair, the second edge is the reverse complement of the first.
+        SHASTA_ASSERT((begin%2) == 0);
+        SHASTA_ASSERT((end%2) == 0);
+
+        for(uint64_t i=begin; i!=end; i+=2) {
+            const ReadGraphEdge& readGraphEdge = readGraph.edges[i];
+            if(not isReadGraphEdgeUsedForMarkerGraphVertices(readGraphEdge)) {
+                continue;
+            }
+
+            // If neither read has affected markers, skip it.
+            const array<OrientedReadId, 2>& orientedReadIds = readGraphEdge.orientedReadIds;
+            if(not (
+                incremental.isAffectedRead[orientedReadIds[0].getReadId()] or
+                incremental.isAffectedRead[orientedReadIds[1].getReadId()])) {
+                continue;
+            }
+
+            // Decompress this alignment and store pairs of aligned affected markers.
+            shasta::decompress(compressedAlignments[readGraphEdge.alignmentId], alignment);
+            for(const auto& p: alignment.ordinals) {
+                const MarkerId markerId0 = getMarkerId(orientedReadIds[0], p[0]);
+                const MarkerId markerId1 = getMarkerId(orientedReadIds[1], p[1]);
+                const bool isAffected = incremental.isAffectedMarker[markerId0];
+                SHASTA_ASSERT(incremental.isAffectedMarker[markerId1] == isAffected);
+                if(isAffected) {
+                    markerPairs.push_back(make_pair(markerId0, markerId1));
+                }
+            }
+        }
+    }
+}
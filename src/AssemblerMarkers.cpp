@@ -14,9 +14,10 @@ void Assembler::findMarkers(size_t threadCount)
     checkKmersAreOpen();
 
     markers.createNew(largeDataName("Markers"), largeDataPageSize);
+    const KmerChecker kmerChecker = getKmerChecker();
     MarkerFinder markerFinder(
         assemblerInfo->k,
-        kmerTable,
+        kmerChecker,
         getReads(),
         markers,
         threadCount);
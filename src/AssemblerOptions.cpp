@@ -158,7 +158,8 @@ void AssemblerOptions::addCommandLineOnlyOptions()
         value<string>(&commandLineOnlyOptions.command)->
         default_value("assemble"),
         "Command to run. Must be one of: "
-        "assemble, saveBinaryData, cleanupBinaryData, explore, createBashCompletionScript")
+        "assemble, saveBinaryData, cleanupBinaryData, explore, createBashCompletionScript, "
+        "estimateResources")
 
         ("memoryMode",
         value<string>(&commandLineOnlyOptions.memoryMode)->
@@ -206,6 +207,29 @@ void AssemblerOptions::addCommandLineOnlyOptions()
         "a reference. Only used for --command explore, for display of the alignment "
         "candidate graph. Experimental."
         )
+
+        ("exploreCacheSize",
+        value<uint64_t>(&commandLineOnlyOptions.exploreCacheSize)->
+        default_value(256),
+        "Maximum size, in MB, of the in-memory cache of http responses "
+        "used by --command explore. Specify 0 to turn off the in-memory cache.")
+
+        ("exploreCacheDirectory",
+        value<string>(&commandLineOnlyOptions.exploreCacheDirectory)->
+        default_value(""),
+        "If not empty, http responses generated by --command explore are also "
+        "stored in this directory and reused by later invocations on the same assembly.")
+
+        ("calibrationDirectory",
+        value< vector<string> >(&commandLineOnlyOptions.calibrationDirectories)->multitoken(),
+        "Assembly directories of past assemblies used by --command estimateResources "
+        "to calibrate its estimates. Each must contain a PerformancePhases.csv file.")
+
+        ("genomeSize",
+        value<uint64_t>(&commandLineOnlyOptions.genomeSize)->
+        default_value(0),
+        "Approximate genome size, used by --command estimateResources "
+        "to estimate the size of the marker graph. 0 if not known.")
         ;
 
 }
@@ -327,8 +351,9 @@ void AssemblerOptions::addConfigurableOptions()
         ("MinHash.version",
         value<int>(&minHashOptions.version)->
         default_value(0),
-        "Controls the version of the LowHash algorithm to use. Can be 0 (default) "
-        "or 1.(experimental).")
+        "Controls the version of the LowHash algorithm to use. Can be 0 (default), "
+        "1 (experimental), or 2 (experimental, single pass with chaining "
+        "of common features).")
 
         ("MinHash.m",
         value<int>(&minHashOptions.m)->
@@ -370,6 +395,13 @@ void AssemblerOptions::addConfigurableOptions()
         "The minimum number of times a pair of reads must be found by the MinHash/LowHash algorithm "
         "in order to be considered a candidate alignment.")
 
+        ("MinHash.maxDrift",
+        value<int>(&minHashOptions.maxDrift)->
+        default_value(20),
+        "Only used with --MinHash.version 2. The maximum difference, in markers, "
+        "between the offsets of common features chained together "
+        "for a pair of reads.")
+
         ("MinHash.allPairs",
         bool_switch(&minHashOptions.allPairs)->
         default_value(false),
@@ -446,7 +478,15 @@ void AssemblerOptions::addConfigurableOptions()
         value<int>(&alignOptions.maxBand)->
         default_value(1000),
         "Maximum alignment band "
-        "(only used for alignment method 3).")
+        "(only used for alignment methods 3 and 4).")
+
+        ("Align.bandHintExtend",
+        value<int>(&alignOptions.bandHintExtend)->
+        default_value(-1),
+        "Amount to extend the band estimated from the features "
+        "found during alignment candidate discovery "
+        "(only used for alignment methods 3 and 4 with --MinHash.version 1 or 2). "
+        "Negative (the default) to not use these band estimates.")
 
         ("Align.sameChannelReadAlignment.suppressDeltaThreshold",
         value<int>(&alignOptions.sameChannelReadAlignmentSuppressDeltaThreshold)->
@@ -468,6 +508,15 @@ void AssemblerOptions::addConfigurableOptions()
         "one read is entirely contained in another read, "
         "except possibly for up to maxTrim markers at the beginning and end.")
 
+        ("Align.method0DynamicProgramming",
+        bool_switch(&alignOptions.method0DynamicProgramming)->
+        default_value(false),
+        "For alignment method 0, find the alignment by dynamic programming "
+        "instead of a shortest path search on the alignment graph. "
+        "The alignment never goes backwards or uses a marker twice, "
+        "but when there is more than one optimal alignment "
+        "a different one can be chosen.")
+
         ("Align.align4.deltaX",
         value<uint64_t>(&alignOptions.align4DeltaX)->
         default_value(200),
@@ -488,6 +537,13 @@ void AssemblerOptions::addConfigurableOptions()
         default_value(100),
         "Only used for alignment method 4 (experimental).")
 
+        ("Align.shard",
+        value<string>(&alignOptions.shard)->
+        default_value(""),
+        "Shard of the alignment candidates to compute, in the form i/N. "
+        "Only used when computing alignments in shards "
+        "using Python scripts ComputeAlignmentShard.py and MergeAlignmentShards.py.")
+
         ("ReadGraph.creationMethod",
         value<int>(&readGraphOptions.creationMethod)->
         default_value(0),
@@ -684,6 +740,14 @@ void AssemblerOptions::addConfigurableOptions()
         "Used in the automatic selection of --MarkerGraph.minCoverage when "
         "--MarkerGraph.minCoverage is set to 0.")
 
+        ("MarkerGraph.coverageEstimate.sampleReadCount",
+        value<uint64_t>(&markerGraphOptions.coverageEstimateSampleReadCount)->
+        default_value(0),
+        "If not zero, estimate the marker graph coverage histogram and "
+        "the automatic value of --MarkerGraph.minCoverage "
+        "from this number of randomly chosen reads, "
+        "before creating marker graph vertices.")
+
         ("MarkerGraph.secondaryEdges.maxSkip",
         value<uint64_t>(&markerGraphOptions.secondaryEdgesMaxSkip)->
         default_value(1000000),
@@ -738,6 +802,13 @@ void AssemblerOptions::addConfigurableOptions()
         default_value(false),
         "Used to request writing the reads that contributed to assembling each segment.")
 
+        ("Assembly.writeReadPlacements",
+        bool_switch(&assemblyOptions.writeReadPlacements)->
+        default_value(false),
+        "Used to request writing placements of reads on assembled segments in PAF format, "
+        "obtained from the marker graph path of each read "
+        "(only used for --Assembly.mode 0).")
+
         ("Assembly.pruneLength",
         value<uint64_t>(&assemblyOptions.pruneLength)->
         default_value(0),
@@ -821,6 +892,18 @@ void AssemblerOptions::addConfigurableOptions()
         default_value(2),
         "Maximum distance for read graph bridge removal for iterative assembly (experimental).")
 
+        ("Assembly.iterative.incrementalMarkerGraph",
+        bool_switch(&assemblyOptions.iterativeIncrementalMarkerGraph)->
+        default_value(false),
+        "Compute marker graph disjoint sets incrementally between iterations "
+        "of iterative assembly (experimental).")
+
+        ("Assembly.iterative.verifyIncrementalMarkerGraph",
+        bool_switch(&assemblyOptions.iterativeVerifyIncrementalMarkerGraph)->
+        default_value(false),
+        "Verify the incremental computation of marker graph disjoint sets "
+        "against a full computation. Slow, for testing only (experimental).")
+
         ("Assembly.mode2.strongBranchThreshold",
         value<uint64_t>(&assemblyOptions.mode2Options.strongBranchThreshold)->
         default_value(2),
@@ -979,6 +1062,7 @@ void MinHashOptions::write(ostream& s) const
     s << "minBucketSize = " << minBucketSize << "\n";
     s << "maxBucketSize = " << maxBucketSize << "\n";
     s << "minFrequency = " << minFrequency << "\n";
+    s << "maxDrift = " << maxDrift << "\n";
     s << "allPairs = " <<
         convertBoolToPythonString(allPairs) << "\n";
 }
@@ -1001,14 +1085,52 @@ void AlignOptions::write(ostream& s) const
     s << "downsamplingFactor = " << downsamplingFactor << "\n";
     s << "bandExtend = " << bandExtend << "\n";
     s << "maxBand = " << maxBand << "\n";
+    s << "bandHintExtend = " << bandHintExtend << "\n";
     s << "sameChannelReadAlignment.suppressDeltaThreshold = " <<
         sameChannelReadAlignmentSuppressDeltaThreshold << "\n";
     s << "suppressContainments = " <<
         convertBoolToPythonString(suppressContainments) << "\n";
+    s << "method0DynamicProgramming = " <<
+        convertBoolToPythonString(method0DynamicProgramming) << "\n";
     s << "align4.deltaX = " << align4DeltaX << "\n";
     s << "align4.deltaY = " << align4DeltaY << "\n";
     s << "align4.minEntryCountPerCell = " << align4MinEntryCountPerCell << "\n";
     s << "align4.maxDistanceFromBoundary = " << align4MaxDistanceFromBoundary << "\n";
+    s << "shard = " << shard << "\n";
+}
+
+
+
+// Parse the shard option. Returns false if it is empty,
+// and throws an exception if it is not valid.
+bool AlignOptions::getShard(uint64_t& shardIndex, uint64_t& shardCount) const
+{
+    if(shard.empty()) {
+        return false;
+    }
+
+    const string message = "Invalid value \"" + shard +
+        "\" for --Align.shard. Use i/N with 0 <= i < N.";
+    const size_t slashPosition = shard.find('/');
+    if(slashPosition == string::npos) {
+        throw runtime_error(message);
+    }
+    try {
+        size_t n0, n1;
+        const string s0 = shard.substr(0, slashPosition);
+        const string s1 = shard.substr(slashPosition + 1);
+        shardIndex = std::stoull(s0, &n0);
+        shardCount = std::stoull(s1, &n1);
+        if(n0 != s0.size() or n1 != s1.size()) {
+            throw runtime_error(message);
+        }
+    } catch(const std::logic_error&) {
+        throw runtime_error(message);
+    }
+    if(shardIndex >= shardCount) {
+        throw runtime_error(message);
+    }
+    return true;
 }
 
 
@@ -1064,6 +1186,7 @@ void MarkerGraphOptions::write(ostream& s) const
         convertBoolToPythonString(reverseTransitiveReduction) << "\n";
     s << "peakFinder.minAreaFraction = " << peakFinderMinAreaFraction << "\n";
     s << "peakFinder.areaStartIndex = " << peakFinderAreaStartIndex << "\n";
+    s << "coverageEstimate.sampleReadCount = " << coverageEstimateSampleReadCount << "\n";
 
     s << "secondaryEdges.maxSkip = " << secondaryEdgesMaxSkip << "\n";
     s << "secondaryEdges.split.errorRateThreshold = " << secondaryEdgesSplitErrorRateThreshold << "\n";
@@ -1087,6 +1210,8 @@ void AssemblyOptions::write(ostream& s) const
         storeCoverageDataCsvLengthThreshold << "\n";
     s << "writeReadsByAssembledSegment = " <<
         convertBoolToPythonString(writeReadsByAssembledSegment) << "\n";
+    s << "writeReadPlacements = " <<
+        convertBoolToPythonString(writeReadPlacements) << "\n";
     s << "pruneLength = " << pruneLength << "\n";
     s << "detangleMethod = " << detangleMethod << "\n";
     s << "detangle.diagonalReadCountMin = " << detangleDiagonalReadCountMin << "\n";
@@ -1103,6 +1228,10 @@ void AssemblyOptions::write(ostream& s) const
     s << "iterative.maxAlignmentCount = " << iterativeMaxAlignmentCount << "\n";
     s << "iterative.bridgeRemovalIterationCount = " << iterativeBridgeRemovalIterationCount << "\n";
     s << "iterative.bridgeRemovalMaxDistance = " << iterativeBridgeRemovalMaxDistance << "\n";
+    s << "iterative.incrementalMarkerGraph = " <<
+        convertBoolToPythonString(iterativeIncrementalMarkerGraph) << "\n";
+    s << "iterative.verifyIncrementalMarkerGraph = " <<
+        convertBoolToPythonString(iterativeVerifyIncrementalMarkerGraph) << "\n";
 
     mode2Options.write(s);
 }
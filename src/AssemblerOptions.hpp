@@ -101,6 +101,10 @@ public:
     string exploreAccess;
     uint16_t port;
     string alignmentsPafFile;
+    uint64_t exploreCacheSize;
+    string exploreCacheDirectory;
+    vector<string> calibrationDirectories;
+    uint64_t genomeSize;
 };
 
 
@@ -165,6 +169,7 @@ public:
     int minBucketSize;
     int maxBucketSize;
     int minFrequency;
+    int maxDrift;
     bool allPairs;
     void write(ostream&) const;
 };
@@ -189,12 +194,23 @@ public:
     double downsamplingFactor;
     int bandExtend;
     int maxBand;
+    int bandHintExtend = -1;
     int sameChannelReadAlignmentSuppressDeltaThreshold;
     bool suppressContainments;
+    bool method0DynamicProgramming = false;
     uint64_t align4DeltaX;
     uint64_t align4DeltaY;
     uint64_t align4MinEntryCountPerCell;
     uint64_t align4MaxDistanceFromBoundary;
+
+    // Shard to compute, in the form i/N, or empty if not using shards.
+    // Only used by Assembler::computeAlignmentShard.
+    string shard;
+
+    // Parse the shard option. Returns false if it is empty,
+    // and throws an exception if it is not valid.
+    bool getShard(uint64_t& shardIndex, uint64_t& shardCount) const;
+
     void write(ostream&) const;
 };
 
@@ -249,6 +265,7 @@ public:
     bool reverseTransitiveReduction;
     double peakFinderMinAreaFraction;
     uint64_t peakFinderAreaStartIndex;
+    uint64_t coverageEstimateSampleReadCount;
 
     // Options that control secondary edges (assembly mode 2 only).
     uint64_t secondaryEdgesMaxSkip;
@@ -320,6 +337,7 @@ public:
     bool storeCoverageData;
     int storeCoverageDataCsvLengthThreshold;
     bool writeReadsByAssembledSegment;
+    bool writeReadPlacements;
     uint64_t pruneLength;
 
     // Options that control detangling.
@@ -339,6 +357,8 @@ public:
     uint64_t iterativeMaxAlignmentCount;
     uint64_t iterativeBridgeRemovalIterationCount;
     uint64_t iterativeBridgeRemovalMaxDistance;
+    bool iterativeIncrementalMarkerGraph;
+    bool iterativeVerifyIncrementalMarkerGraph;
 
     // Mode 2 assembly options.
     Mode2AssemblyOptions mode2Options;
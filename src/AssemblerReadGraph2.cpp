@@ -179,6 +179,10 @@ void Assembler::setReadGraph2Criteria(
 }
 
 
+// This selects alignments using only the AlignmentInfo computed
+// by computeAlignments. It runs before the marker graph is created,
+// so alignments induced by the marker graph
+// (see computeInducedAlignment) are not available here.
 void Assembler::createReadGraph2(
     uint32_t maxAlignmentCount,
     double markerCountPercentile,
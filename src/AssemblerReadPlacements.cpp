@@ -0,0 +1,244 @@
+// Placements of reads on assembled segments.
+
+// Each oriented read corresponds to a path in the marker graph,
+// which can be computed using computeOrientedReadMarkerGraphPath.
+// Using the markerToAssemblyTable, each marker graph edge
+// of the path is mapped to a position in an assembly graph edge.
+// Consecutive marker graph edges of the path that map to the same
+// assembled segment, in the same orientation, generate a placement
+// of the read on that segment.
+// This gives placements of all reads on the assembly
+// without running an external long read mapper.
+
+// Coordinates on the read are computed from the positions of the
+// markers at the two ends of the placement.
+// Coordinates on the segment are approximate: they are obtained by
+// assuming that the marker graph edges of an assembly graph edge
+// are uniformly spaced along the assembled sequence.
+
+// Shasta.
+#include "Assembler.hpp"
+#include "AssemblyGraph.hpp"
+#include "performanceLog.hpp"
+#include "Reads.hpp"
+#include "timestamp.hpp"
+using namespace shasta;
+
+// Standard library.
+#include "chrono.hpp"
+#include "fstream.hpp"
+#include <sstream>
+
+
+
+void Assembler::writeReadPlacements(const string& fileName, size_t threadCount)
+{
+    performanceLog << timestamp << "Writing read placements." << endl;
+    const auto t0 = steady_clock::now();
+
+    // Check that we have what we need.
+    reads->checkReadsAreOpen();
+    checkMarkersAreOpen();
+    checkMarkerGraphVerticesAreAvailable();
+    checkMarkerGraphEdgesIsOpen();
+    SHASTA_ASSERT(assemblyGraphPointer);
+    const AssemblyGraph& assemblyGraph = *assemblyGraphPointer;
+    SHASTA_ASSERT(assemblyGraph.markerToAssemblyTable.isOpen());
+
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    // Compute the raw length of each assembled segment.
+    // Only one of each pair of reverse complemented edges is output
+    // (see writeFasta), and only those get a non-zero length.
+    WriteReadPlacementsData& data = writeReadPlacementsData;
+    data.segmentLengths.clear();
+    data.segmentLengths.resize(assemblyGraph.edges.size(), 0);
+    for(AssemblyGraph::EdgeId edgeId=0; edgeId<assemblyGraph.repeatCounts.size(); edgeId++) {
+        if(assemblyGraph.edges[edgeId].wasRemoved() or not assemblyGraph.isAssembledEdge(edgeId)) {
+            continue;
+        }
+        uint64_t length = 0;
+        for(const uint8_t repeatCount: assemblyGraph.repeatCounts[edgeId]) {
+            length += repeatCount;
+        }
+        data.segmentLengths[edgeId] = length;
+    }
+
+    // Process the reads in chunks, so we don't have to keep
+    // the PAF lines for all reads in memory at the same time.
+    // The output is in order of increasing ReadId.
+    ofstream paf(fileName);
+    const ReadId readCount = reads->readCount();
+    const ReadId chunkSize = 100000;
+    for(ReadId readBegin=0; readBegin<readCount; readBegin+=chunkSize) {
+        const ReadId readEnd = min(readCount, readBegin + chunkSize);
+        data.readBegin = readBegin;
+        data.lines.clear();
+        data.lines.resize(readEnd - readBegin);
+        setupLoadBalancing(readEnd - readBegin, 100);
+        runThreads(&Assembler::writeReadPlacementsThreadFunction, threadCount);
+        for(const string& lines: data.lines) {
+            paf << lines;
+        }
+    }
+    data.lines.clear();
+    data.lines.shrink_to_fit();
+    data.segmentLengths.clear();
+    data.segmentLengths.shrink_to_fit();
+
+    const auto t1 = steady_clock::now();
+    performanceLog << timestamp << "Writing read placements took " << seconds(t1-t0) << " s." << endl;
+    cout << "Read placements on assembled segments written to " << fileName << endl;
+}
+
+
+
+void Assembler::writeReadPlacementsThreadFunction(size_t /* threadId */)
+{
+    const AssemblyGraph& assemblyGraph = *assemblyGraphPointer;
+    WriteReadPlacementsData& data = writeReadPlacementsData;
+    const uint64_t k = assemblerInfo->k;
+    const bool useRle = (assemblerInfo->readRepresentation == 1);
+
+    vector<MarkerGraph::EdgeId> path;
+    vector< pair<uint32_t, uint32_t> > pathOrdinals;
+    vector<uint32_t> rawPositions;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(ReadId readId=data.readBegin+ReadId(begin); readId!=data.readBegin+ReadId(end); readId++) {
+            const OrientedReadId orientedReadId(readId, 0);
+            const auto orientedReadMarkers = markers[orientedReadId.getValue()];
+            const uint64_t markerCount = orientedReadMarkers.size();
+            if(markerCount < 2) {
+                continue;
+            }
+            computeOrientedReadMarkerGraphPath(
+                orientedReadId,
+                0, uint32_t(markerCount - 1),
+                path, pathOrdinals);
+            if(path.empty()) {
+                continue;
+            }
+
+            // For the RLE representation, marker positions are in RLE coordinates
+            // and need to be converted to raw coordinates.
+            const uint64_t readLength = reads->getReadRawSequenceLength(readId);
+            if(useRle) {
+                rawPositions = reads->getRawPositions(orientedReadId);
+            }
+            auto getRawPosition = [&](uint64_t position)
+            {
+                if(not useRle) {
+                    return position;
+                }
+                return (position < rawPositions.size()) ? uint64_t(rawPositions[position]) : readLength;
+            };
+
+            const span<const char> readName = reads->getReadName(readId);
+            std::ostringstream s;
+
+            // The current placement.
+            bool isOpen = false;
+            AssemblyGraph::EdgeId segmentId = 0;
+            bool isReverseComplement = false;
+            uint64_t firstIndex = 0;        // In the edge list of the output segment.
+            uint64_t lastIndex = 0;
+            uint32_t firstOrdinal = 0;
+            uint32_t lastOrdinal = 0;
+            uint64_t markerGraphEdgeCount = 0;
+
+            // Write the current placement in PAF format.
+            // The number of matching bases is not known and is approximated
+            // using the shortest of the two aligned ranges.
+            auto writePlacement = [&]()
+            {
+                const uint64_t readBegin = getRawPosition(orientedReadMarkers[firstOrdinal].position);
+                const uint64_t readEnd = getRawPosition(orientedReadMarkers[lastOrdinal].position + k);
+                const uint64_t segmentLength = data.segmentLengths[segmentId];
+                const uint64_t n = assemblyGraph.edgeLists.size(segmentId);
+                const uint64_t segmentBegin = (segmentLength * min(firstIndex, lastIndex)) / n;
+                const uint64_t segmentEnd = (segmentLength * (max(firstIndex, lastIndex) + 1)) / n;
+                const uint64_t readRangeLength = readEnd - readBegin;
+                const uint64_t segmentRangeLength = segmentEnd - segmentBegin;
+                s.write(readName.data(), readName.size());
+                s << "\t" << readLength << "\t" << readBegin << "\t" << readEnd << "\t" <<
+                    (isReverseComplement ? '-' : '+') << "\t" <<
+                    segmentId << "\t" << segmentLength << "\t" <<
+                    segmentBegin << "\t" << segmentEnd << "\t" <<
+                    min(readRangeLength, segmentRangeLength) << "\t" <<
+                    max(readRangeLength, segmentRangeLength) << "\t255\t" <<
+                    "cm:i:" << markerGraphEdgeCount << "\n";
+            };
+
+            for(uint64_t i=0; i<path.size(); i++) {
+                const span<const pair<AssemblyGraph::EdgeId, uint32_t> > locations =
+                    assemblyGraph.markerToAssemblyTable[path[i]];
+                if(locations.empty()) {
+                    continue;
+                }
+
+                // After detangling, a marker graph edge can appear in more than
+                // one assembly graph edge. If possible, use the one that
+                // continues the current placement.
+                pair<AssemblyGraph::EdgeId, uint32_t> location = locations.front();
+                if(isOpen) {
+                    for(const auto& p: locations) {
+                        if(p.first == segmentId or
+                            assemblyGraph.reverseComplementEdge[p.first] == segmentId) {
+                            location = p;
+                            break;
+                        }
+                    }
+                }
+
+                // Map to the assembly graph edge that is output.
+                AssemblyGraph::EdgeId edgeId = location.first;
+                uint64_t index = location.second;
+                bool isReverseComplementLocation = false;
+                if(not assemblyGraph.isAssembledEdge(edgeId)) {
+                    index = assemblyGraph.edgeLists.size(edgeId) - 1 - index;
+                    edgeId = assemblyGraph.reverseComplementEdge[edgeId];
+                    isReverseComplementLocation = true;
+                }
+                if(data.segmentLengths[edgeId] == 0) {
+                    continue;
+                }
+
+                // If this continues the current placement, extend it.
+                // On the reverse complemented segment, the index in the
+                // segment decreases as we move forward on the read.
+                if(isOpen and
+                    edgeId == segmentId and
+                    isReverseComplementLocation == isReverseComplement and
+                    (isReverseComplement ? (index < lastIndex) : (index > lastIndex))) {
+                    lastIndex = index;
+                    lastOrdinal = pathOrdinals[i].second;
+                    ++markerGraphEdgeCount;
+                    continue;
+                }
+
+                // Otherwise, write the current placement and start a new one.
+                if(isOpen) {
+                    writePlacement();
+                }
+                isOpen = true;
+                segmentId = edgeId;
+                isReverseComplement = isReverseComplementLocation;
+                firstIndex = index;
+                lastIndex = index;
+                firstOrdinal = pathOrdinals[i].first;
+                lastOrdinal = pathOrdinals[i].second;
+                markerGraphEdgeCount = 1;
+            }
+            if(isOpen) {
+                writePlacement();
+            }
+
+            data.lines[readId - data.readBegin] = s.str();
+        }
+    }
+}
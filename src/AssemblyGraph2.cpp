@@ -33,6 +33,7 @@ using namespace shasta;
 #include <limits>
 #include <map>
 #include <numeric>
+#include <sstream>
 
 #include "MultithreadedObject.tpp"
 template class MultithreadedObject<AssemblyGraph2>;
@@ -58,7 +59,8 @@ AssemblyGraph2::AssemblyGraph2(
     k(k),
     readFlags(readFlags),
     markers(markers),
-    markerGraph(markerGraph)
+    markerGraph(markerGraph),
+    threadCount(threadCount)
 {
 
 
@@ -258,10 +260,10 @@ void AssemblyGraph2::create()
 
     // Main loop over all edges of the marker graph.
     // At each iteration we find a new linear path of edges.
-    for(MarkerGraph::EdgeId startEdgeId=0; startEdgeId<edgeCount; startEdgeId++) {
-        if(markerGraph.edges[startEdgeId].wasRemoved()) {
-            continue;
-        }
+    // Removed edges are skipped.
+    for(MarkerGraph::EdgeId startEdgeId=markerGraph.findNextNonRemovedEdge(0);
+        startEdgeId<edgeCount;
+        startEdgeId=markerGraph.findNextNonRemovedEdge(startEdgeId+1)) {
         if(debug) {
             const MarkerGraph::Edge& startEdge = markerGraph.edges[startEdgeId];
             debugOut << "Starting a new path at edge " << startEdgeId << " " <<
@@ -395,7 +397,7 @@ void AssemblyGraph2::create()
 
     // Check that all edges of the marker graph were found.
     for(MarkerGraph::EdgeId edgeId=0; edgeId<edgeCount; edgeId++) {
-        SHASTA_ASSERT(wasFound[edgeId] or markerGraph.edges[edgeId].wasRemoved());
+        SHASTA_ASSERT(wasFound[edgeId] or markerGraph.edgeWasRemoved(edgeId));
     }
 
     performanceLog << timestamp << "AssemblyGraph2::create ends." << endl;
@@ -963,7 +965,7 @@ void AssemblyGraph2::writeDetailed(
     bool writeSequenceLengthInMarkers,
     bool writeCsv,
     bool writeGfa,
-    bool writeFasta) const
+    bool writeFasta)
 {
     performanceLog << timestamp << "AssemblyGraph2::writeDetailed begins." << endl;
 
@@ -998,103 +1000,71 @@ void AssemblyGraph2::writeDetailed(
         fasta.open(baseName + ".fasta");
     }
 
-    // Create a GFA with a segment for each branch, then write it out.
-    GfaAssemblyGraph<vertex_descriptor> gfa;
+    // Store a vector of edge descriptors for all edges.
+    // The edges are written out in this order.
+    WriteDetailedData& data = writeDetailedData;
+    data.writeSequence = writeSequence;
+    data.writeSequenceLengthInMarkers = writeSequenceLengthInMarkers;
+    data.writeCsv = writeCsv;
+    data.writeFasta = writeFasta;
+    data.allEdges.clear();
     BGL_FORALL_EDGES(e, g, G) {
-        const E& edge = g[e];
-        const vertex_descriptor v0 = source(e, g);
-        const vertex_descriptor v1 = target(e, g);
+        data.allEdges.push_back(e);
+    }
 
-        for(uint64_t branchId=0; branchId<edge.ploidy(); branchId++) {
-            const E::Branch& branch = edge.branches[branchId];
+    // Create a GFA with a segment for each branch, then write it out.
+    // The FASTA and csv output is prepared in parallel,
+    // one block of edges at a time, then written out in order.
+    GfaAssemblyGraph<vertex_descriptor> gfa;
+    const uint64_t edgeCount = data.allEdges.size();
+    for(uint64_t edgeBegin=0; edgeBegin<edgeCount; edgeBegin+=writeDetailedBlockSize) {
+        const uint64_t edgeEnd = min(edgeCount, edgeBegin + writeDetailedBlockSize);
+
+        if(writeCsv or writeFasta) {
+            data.edgeBegin = edgeBegin;
+            data.fastaBuffers.clear();
+            data.fastaBuffers.resize(edgeEnd - edgeBegin);
+            data.csvBuffers.clear();
+            data.csvBuffers.resize(edgeEnd - edgeBegin);
+            const uint64_t batchSize = 100;
+            setupLoadBalancing(edgeEnd - edgeBegin, batchSize);
+            runThreads(&AssemblyGraph2::writeDetailedThreadFunction, threadCount);
+        }
+
+        for(uint64_t i=edgeBegin; i!=edgeEnd; i++) {
+            const edge_descriptor e = data.allEdges[i];
+            const E& edge = g[e];
+            const vertex_descriptor v0 = source(e, g);
+            const vertex_descriptor v1 = target(e, g);
 
             if(writeGfa) {
-                if(writeSequence) {
-                    gfa.addSegment(edge.pathId(branchId), v0, v1, branch.gfaSequence);
-                } else {
-                    if(writeSequenceLengthInMarkers) {
-                        gfa.addSegment(edge.pathId(branchId), v0, v1, branch.path.size());
+                for(uint64_t branchId=0; branchId<edge.ploidy(); branchId++) {
+                    const E::Branch& branch = edge.branches[branchId];
+                    if(writeSequence) {
+                        gfa.addSegment(edge.pathId(branchId), v0, v1, branch.gfaSequence);
                     } else {
-                        gfa.addSegment(edge.pathId(branchId), v0, v1, branch.gfaSequence.size());
+                        if(writeSequenceLengthInMarkers) {
+                            gfa.addSegment(edge.pathId(branchId), v0, v1, branch.path.size());
+                        } else {
+                            gfa.addSegment(edge.pathId(branchId), v0, v1, branch.gfaSequence.size());
+                        }
                     }
                 }
             }
 
             if(writeFasta) {
-                fasta << ">" << edge.pathId(branchId) << " " << branch.gfaSequence.size() << "\n";
-                copy(branch.gfaSequence.begin(), branch.gfaSequence.end(), ostream_iterator<Base>(fasta));
-                fasta << "\n";
+                fasta << data.fastaBuffers[i - edgeBegin];
             }
-
-
-
-            // Write a line for this segment to the csv file.
             if(writeCsv) {
-
-                // Get some information we need below.
-                const uint64_t lengthInMarkers = branch.path.size();
-                SHASTA_ASSERT(lengthInMarkers > 0);
-                const MarkerGraphEdgeId firstMarkerGraphEdgeId = branch.path.front();
-                const MarkerGraphEdgeId lastMarkerGraphEdgeId = branch.path.back();
-                const MarkerGraphVertexId firstMarkerGraphVertexId = markerGraph.edges[firstMarkerGraphEdgeId].source;
-                const MarkerGraphVertexId lastMarkerGraphVertexId = markerGraph.edges[lastMarkerGraphEdgeId].target;
-                const string color = edge.color(branchId);
-
-                csv <<
-                    edge.pathId(branchId) << ",";
-                if(edge.componentId != std::numeric_limits<uint64_t>::max()) {
-                    csv << edge.componentId;
-                }
-                csv << ",";
-
-                if(edge.phase != std::numeric_limits<uint64_t>::max()) {
-                    csv << (branchId == edge.phase ? 0 : 1);
-                }
-                csv << ",";
-
-                if(edge.isBubble() and (edge.isBad or edge.phase == std::numeric_limits<uint64_t>::max())) {
-                    if(branchId == edge.getStrongestBranchId()) {
-                        csv << "Strong";
-                    } else {
-                        csv << "Weak";
-                    }
-                }
-                csv << ",";
-
-                csv <<
-                    color << "," <<
-                    firstMarkerGraphVertexId << "," <<
-                    lastMarkerGraphVertexId << "," <<
-                    firstMarkerGraphEdgeId << "," <<
-                    lastMarkerGraphEdgeId << "," <<
-                    lengthInMarkers << ",";
-
-                if(writeSequence or (not writeSequenceLengthInMarkers)) {
-                    csv << branch.gfaSequence.size();
-                }
-                csv << ",";
-
-                csv <<
-                    (branch.containsSecondaryEdges ? "S" : "") << "," <<
-                    (edge.period ? to_string(edge.period) : string()) << "," <<
-                    branch.minimumCoverage << "," <<
-                    branch.averageCoverage() << "," <<
-                    branch.orientedReadIds.size() << ",";
-                if(writeSequence) {
-                    if(branch.gfaSequence.size() == 0) {
-                        csv << "-";
-                    } else if(branch.gfaSequence.size() <= 6) {
-                        copy(branch.gfaSequence.begin(), branch.gfaSequence.end(),
-                            ostream_iterator<Base>(csv));
-                    } else {
-                        csv << "...";
-                    }
-                    csv << ",";
-                }
-                csv << "\n";
+                csv << data.csvBuffers[i - edgeBegin];
             }
         }
     }
+    data.allEdges.clear();
+    data.fastaBuffers.clear();
+    data.fastaBuffers.shrink_to_fit();
+    data.csvBuffers.clear();
+    data.csvBuffers.shrink_to_fit();
 
 
 
@@ -1175,6 +1145,114 @@ void AssemblyGraph2::writeDetailed(
 
 
 
+// Prepare the FASTA and csv output of writeDetailed
+// for the edges of the current block.
+void AssemblyGraph2::writeDetailedThreadFunction(size_t /* threadId */)
+{
+    const G& g = *this;
+    WriteDetailedData& data = writeDetailedData;
+    const bool writeSequence = data.writeSequence;
+    const bool writeSequenceLengthInMarkers = data.writeSequenceLengthInMarkers;
+    const bool writeCsv = data.writeCsv;
+    const bool writeFasta = data.writeFasta;
+
+    // Loop over all batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // Loop over all edges in this batch.
+        for(uint64_t i=begin; i!=end; i++) {
+            const edge_descriptor e = data.allEdges[data.edgeBegin + i];
+            const E& edge = g[e];
+            std::ostringstream fasta;
+            std::ostringstream csv;
+
+            for(uint64_t branchId=0; branchId<edge.ploidy(); branchId++) {
+                const E::Branch& branch = edge.branches[branchId];
+
+                if(writeFasta) {
+                    fasta << ">" << edge.pathId(branchId) << " " << branch.gfaSequence.size() << "\n";
+                    copy(branch.gfaSequence.begin(), branch.gfaSequence.end(), ostream_iterator<Base>(fasta));
+                    fasta << "\n";
+                }
+
+
+
+                // Write a line for this segment to the csv file.
+                if(writeCsv) {
+
+                    // Get some information we need below.
+                    const uint64_t lengthInMarkers = branch.path.size();
+                    SHASTA_ASSERT(lengthInMarkers > 0);
+                    const MarkerGraphEdgeId firstMarkerGraphEdgeId = branch.path.front();
+                    const MarkerGraphEdgeId lastMarkerGraphEdgeId = branch.path.back();
+                    const MarkerGraphVertexId firstMarkerGraphVertexId = markerGraph.edges[firstMarkerGraphEdgeId].source;
+                    const MarkerGraphVertexId lastMarkerGraphVertexId = markerGraph.edges[lastMarkerGraphEdgeId].target;
+                    const string color = edge.color(branchId);
+
+                    csv <<
+                        edge.pathId(branchId) << ",";
+                    if(edge.componentId != std::numeric_limits<uint64_t>::max()) {
+                        csv << edge.componentId;
+                    }
+                    csv << ",";
+
+                    if(edge.phase != std::numeric_limits<uint64_t>::max()) {
+                        csv << (branchId == edge.phase ? 0 : 1);
+                    }
+                    csv << ",";
+
+                    if(edge.isBubble() and (edge.isBad or edge.phase == std::numeric_limits<uint64_t>::max())) {
+                        if(branchId == edge.getStrongestBranchId()) {
+                            csv << "Strong";
+                        } else {
+                            csv << "Weak";
+                        }
+                    }
+                    csv << ",";
+
+                    csv <<
+                        color << "," <<
+                        firstMarkerGraphVertexId << "," <<
+                        lastMarkerGraphVertexId << "," <<
+                        firstMarkerGraphEdgeId << "," <<
+                        lastMarkerGraphEdgeId << "," <<
+                        lengthInMarkers << ",";
+
+                    if(writeSequence or (not writeSequenceLengthInMarkers)) {
+                        csv << branch.gfaSequence.size();
+                    }
+                    csv << ",";
+
+                    csv <<
+                        (branch.containsSecondaryEdges ? "S" : "") << "," <<
+                        (edge.period ? to_string(edge.period) : string()) << "," <<
+                        branch.minimumCoverage << "," <<
+                        branch.averageCoverage() << "," <<
+                        branch.orientedReadIds.size() << ",";
+                    if(writeSequence) {
+                        if(branch.gfaSequence.size() == 0) {
+                            csv << "-";
+                        } else if(branch.gfaSequence.size() <= 6) {
+                            copy(branch.gfaSequence.begin(), branch.gfaSequence.end(),
+                                ostream_iterator<Base>(csv));
+                        } else {
+                            csv << "...";
+                        }
+                        csv << ",";
+                    }
+                    csv << "\n";
+                }
+            }
+
+            data.fastaBuffers[i] = fasta.str();
+            data.csvBuffers[i] = csv.str();
+        }
+    }
+}
+
+
+
 void AssemblyGraph2::writeDetailedEarly(const string& baseName)
 {
     const bool writeSequence = false;
@@ -1195,7 +1273,7 @@ void AssemblyGraph2::writeHaploid(
     bool writeCsv,
     bool writeGfa,
     bool writeFasta,
-    AssemblyGraph2Statistics* statistics) const
+    AssemblyGraph2Statistics* statistics)
 {
     performanceLog << timestamp << "AssemblyGraph2::writeHaploid begins." << endl;
     const G& g = *this;
@@ -1244,31 +1322,41 @@ void AssemblyGraph2::writeHaploid(
 
 
     // Add a segment for each bubble chain.
-    for(uint64_t bubbleChainId=0; bubbleChainId<uint64_t(bubbleChains.size()); bubbleChainId++) {
-        const BubbleChain& bubbleChain = bubbleChains[bubbleChainId];
-        const vertex_descriptor v0 = source(bubbleChain.edges.front(), g);
-        const vertex_descriptor v1 = target(bubbleChain.edges.back(), g);
+    // The sequences are computed in parallel, one block of bubble chains at a time.
+    const uint64_t bubbleChainCount = bubbleChains.size();
+    for(uint64_t bubbleChainBegin=0; bubbleChainBegin<bubbleChainCount;
+        bubbleChainBegin+=bubbleChainBlockSize) {
+        const uint64_t bubbleChainEnd = min(bubbleChainCount, bubbleChainBegin + bubbleChainBlockSize);
+        computeBubbleChainSequences(bubbleChainBegin, bubbleChainEnd, false);
+
+        for(uint64_t bubbleChainId=bubbleChainBegin; bubbleChainId<bubbleChainEnd; bubbleChainId++) {
+            const BubbleChain& bubbleChain = bubbleChains[bubbleChainId];
+            const vertex_descriptor v0 = source(bubbleChain.edges.front(), g);
+            const vertex_descriptor v1 = target(bubbleChain.edges.back(), g);
 
-        vector<Base> sequence;
-        computeBubbleChainGfaSequence(bubbleChain, sequence);
-        bubbleChainLengths.push_back(uint64_t(sequence.size()));
+            const vector<Base>& sequence =
+                bubbleChainSequencesData.sequences[bubbleChainId - bubbleChainBegin].front();
+            bubbleChainLengths.push_back(uint64_t(sequence.size()));
 
-        const string idString = "BC." + to_string(bubbleChainId);
+            const string idString = "BC." + to_string(bubbleChainId);
 
-        if(writeGfa) {
-            if(writeSequence) {
-                gfa.addSegment(idString, v0, v1, sequence);
-            } else {
-                gfa.addSegment(idString, v0, v1, sequence.size());
+            if(writeGfa) {
+                if(writeSequence) {
+                    gfa.addSegment(idString, v0, v1, sequence);
+                } else {
+                    gfa.addSegment(idString, v0, v1, sequence.size());
+                }
             }
-        }
 
-        if(writeFasta) {
-            fasta << ">" << idString << " " << sequence.size() << "\n";
-            copy(sequence.begin(), sequence.end(), ostream_iterator<Base>(fasta));
-            fasta << "\n";
+            if(writeFasta) {
+                fasta << ">" << idString << " " << sequence.size() << "\n";
+                copy(sequence.begin(), sequence.end(), ostream_iterator<Base>(fasta));
+                fasta << "\n";
+            }
         }
     }
+    bubbleChainSequencesData.sequences.clear();
+    bubbleChainSequencesData.sequences.shrink_to_fit();
 
 
 
@@ -1363,7 +1451,7 @@ void AssemblyGraph2::writePhased(
     bool writeCsv,
     bool writeGfa,
     bool writeFasta,
-    AssemblyGraph2Statistics* statistics) const
+    AssemblyGraph2Statistics* statistics)
 {
     performanceLog << timestamp << "AssemblyGraph2::writePhased begins." << endl;
     const G& g = *this;
@@ -1432,126 +1520,140 @@ void AssemblyGraph2::writePhased(
 
     // Add one or two segments, depending on ploidy, for each phasing region
     // of each bubble chain.
+    // The sequences are computed in parallel, one block of bubble chains at a time,
+    // in the order in which they are used here.
     vector<Base> sequence;
-    for(uint64_t bubbleChainId=0; bubbleChainId<uint64_t(bubbleChains.size()); bubbleChainId++) {
-        const BubbleChain& bubbleChain = bubbleChains[bubbleChainId];
-        for(uint64_t phasingRegionId=0;
-            phasingRegionId<uint64_t(bubbleChain.phasingRegions.size()); phasingRegionId++) {
-            const auto& phasingRegion = bubbleChain.phasingRegions[phasingRegionId];
+    const uint64_t bubbleChainCount = bubbleChains.size();
+    for(uint64_t bubbleChainBegin=0; bubbleChainBegin<bubbleChainCount;
+        bubbleChainBegin+=bubbleChainBlockSize) {
+        const uint64_t bubbleChainEnd = min(bubbleChainCount, bubbleChainBegin + bubbleChainBlockSize);
+        computeBubbleChainSequences(bubbleChainBegin, bubbleChainEnd, true);
 
-            const vertex_descriptor v0 = source(bubbleChain.edges[phasingRegion.firstPosition], g);
-            const vertex_descriptor v1 = target(bubbleChain.edges[phasingRegion.lastPosition], g);
+        for(uint64_t bubbleChainId=bubbleChainBegin; bubbleChainId<bubbleChainEnd; bubbleChainId++) {
+            const BubbleChain& bubbleChain = bubbleChains[bubbleChainId];
+            vector< vector<Base> >& chainSequences =
+                bubbleChainSequencesData.sequences[bubbleChainId - bubbleChainBegin];
+            uint64_t sequenceIndex = 0;
+            for(uint64_t phasingRegionId=0;
+                phasingRegionId<uint64_t(bubbleChain.phasingRegions.size()); phasingRegionId++) {
+                const auto& phasingRegion = bubbleChain.phasingRegions[phasingRegionId];
 
-            if(phasingRegion.isPhased) {
+                const vertex_descriptor v0 = source(bubbleChain.edges[phasingRegion.firstPosition], g);
+                const vertex_descriptor v1 = target(bubbleChain.edges[phasingRegion.lastPosition], g);
 
-                const string namePrefix =
-                    "PR." +
-                    to_string(bubbleChainId) + "." +
-                    to_string(phasingRegionId) + "." +
-                    to_string(phasingRegion.componentId) + ".";
+                if(phasingRegion.isPhased) {
 
-                const string name0 = namePrefix + "0";
-                computePhasedRegionGfaSequence(bubbleChain, phasingRegion, 0, sequence);
+                    const string namePrefix =
+                        "PR." +
+                        to_string(bubbleChainId) + "." +
+                        to_string(phasingRegionId) + "." +
+                        to_string(phasingRegion.componentId) + ".";
 
-                if(writeGfa) {
-                    if(writeSequence) {
-                        gfa.addSegment(name0, v0, v1, sequence);
-                    } else {
-                        gfa.addSegment(name0, v0, v1, sequence.size());
+                    const string name0 = namePrefix + "0";
+                    sequence.swap(chainSequences[sequenceIndex++]);
+
+                    if(writeGfa) {
+                        if(writeSequence) {
+                            gfa.addSegment(name0, v0, v1, sequence);
+                        } else {
+                            gfa.addSegment(name0, v0, v1, sequence.size());
+                        }
                     }
-                }
 
-                if(writeFasta) {
-                    fasta << ">" << name0 << " " << sequence.size() << "\n";
-                    copy(sequence.begin(), sequence.end(), ostream_iterator<Base>(fasta));
-                    fasta << "\n";
-                }
+                    if(writeFasta) {
+                        fasta << ">" << name0 << " " << sequence.size() << "\n";
+                        copy(sequence.begin(), sequence.end(), ostream_iterator<Base>(fasta));
+                        fasta << "\n";
+                    }
 
-                totalDiploidBases += uint64_t(sequence.size());
-                diploidLengths.push_back(uint64_t(sequence.size()));
+                    totalDiploidBases += uint64_t(sequence.size());
+                    diploidLengths.push_back(uint64_t(sequence.size()));
+
+                    if(writeCsv) {
+                        csv <<
+                            name0 << "," <<
+                            phasingRegionId << "," <<
+                            "2," <<
+                            bubbleChainId << "," <<
+                            phasingRegion.componentId << "," <<
+                            "0," <<
+                            sequence.size() << ","
+                            "Green\n";
+                    }
 
-                if(writeCsv) {
-                    csv <<
-                        name0 << "," <<
-                        phasingRegionId << "," <<
-                        "2," <<
-                        bubbleChainId << "," <<
-                        phasingRegion.componentId << "," <<
-                        "0," <<
-                        sequence.size() << ","
-                        "Green\n";
-                }
+                    const string name1 = namePrefix + "1";
+                    sequence.swap(chainSequences[sequenceIndex++]);
 
-                const string name1 = namePrefix + "1";
-                computePhasedRegionGfaSequence(bubbleChain, phasingRegion, 1, sequence);
+                    if(writeGfa) {
+                        if(writeSequence) {
+                            gfa.addSegment(name1, v0, v1, sequence);
+                        } else {
+                            gfa.addSegment(name1, v0, v1, sequence.size());
+                        }
+                    }
 
-                if(writeGfa) {
-                    if(writeSequence) {
-                        gfa.addSegment(name1, v0, v1, sequence);
-                    } else {
-                        gfa.addSegment(name1, v0, v1, sequence.size());
+                    if(writeFasta) {
+                        fasta << ">" << name1 << " " << sequence.size() << "\n";
+                        copy(sequence.begin(), sequence.end(), ostream_iterator<Base>(fasta));
+                        fasta << "\n";
                     }
-                }
 
-                if(writeFasta) {
-                    fasta << ">" << name1 << " " << sequence.size() << "\n";
-                    copy(sequence.begin(), sequence.end(), ostream_iterator<Base>(fasta));
-                    fasta << "\n";
-                }
+                    totalDiploidBases += uint64_t(sequence.size());
+                    diploidLengths.push_back(uint64_t(sequence.size()));
+
+                    if(writeCsv) {
+                        csv <<
+                            name1 << "," <<
+                            phasingRegionId << "," <<
+                            "2," <<
+                            bubbleChainId << "," <<
+                            phasingRegion.componentId << "," <<
+                            "1," <<
+                            sequence.size() << ","
+                            "Green\n";
+                    }
 
-                totalDiploidBases += uint64_t(sequence.size());
-                diploidLengths.push_back(uint64_t(sequence.size()));
+                } else {
 
-                if(writeCsv) {
-                    csv <<
-                        name1 << "," <<
-                        phasingRegionId << "," <<
-                        "2," <<
-                        bubbleChainId << "," <<
-                        phasingRegion.componentId << "," <<
-                        "1," <<
-                        sequence.size() << ","
-                        "Green\n";
-                }
+                    sequence.swap(chainSequences[sequenceIndex++]);
+                    const string name = "UR." + to_string(bubbleChainId) + "." + to_string(phasingRegionId);
 
-            } else {
+                    if(writeGfa) {
+                        if(writeSequence) {
+                            gfa.addSegment(name, v0, v1, sequence);
+                        } else {
+                            gfa.addSegment(name, v0, v1, sequence.size());
+                        }
+                    }
 
-                computeUnphasedRegionGfaSequence(bubbleChain, phasingRegion, sequence);
-                const string name = "UR." + to_string(bubbleChainId) + "." + to_string(phasingRegionId);
+                    totalHaploidBases += uint64_t(sequence.size());
+                    haploidLengths.push_back(uint64_t(sequence.size()));
 
-                if(writeGfa) {
-                    if(writeSequence) {
-                        gfa.addSegment(name, v0, v1, sequence);
-                    } else {
-                        gfa.addSegment(name, v0, v1, sequence.size());
+                    if(writeFasta) {
+                        fasta << ">" << name << " " << sequence.size() << "\n";
+                        copy(sequence.begin(), sequence.end(), ostream_iterator<Base>(fasta));
+                        fasta << "\n";
                     }
-                }
 
-                totalHaploidBases += uint64_t(sequence.size());
-                haploidLengths.push_back(uint64_t(sequence.size()));
-
-                if(writeFasta) {
-                    fasta << ">" << name << " " << sequence.size() << "\n";
-                    copy(sequence.begin(), sequence.end(), ostream_iterator<Base>(fasta));
-                    fasta << "\n";
-                }
+                    if(writeCsv) {
+                        csv <<
+                            name << "," <<
+                            phasingRegionId << "," <<
+                            "1," <<
+                            bubbleChainId << "," <<
+                            "," <<
+                            "," <<
+                            sequence.size() << ","
+                            "#eb4034\n";   // Near red.
+                    }
 
-                if(writeCsv) {
-                    csv <<
-                        name << "," <<
-                        phasingRegionId << "," <<
-                        "1," <<
-                        bubbleChainId << "," <<
-                        "," <<
-                        "," <<
-                        sequence.size() << ","
-                        "#eb4034\n";   // Near red.
                 }
 
             }
-
         }
     }
+    bubbleChainSequencesData.sequences.clear();
+    bubbleChainSequencesData.sequences.shrink_to_fit();
 
 
 
@@ -1824,6 +1926,65 @@ void AssemblyGraph2::computePhasedRegionGfaSequence(
 
 
 
+// Compute in parallel the gfa sequences of the bubble chains
+// in [bubbleChainBegin, bubbleChainEnd) and store them in
+// bubbleChainSequencesData.sequences.
+void AssemblyGraph2::computeBubbleChainSequences(
+    uint64_t bubbleChainBegin,
+    uint64_t bubbleChainEnd,
+    bool phased)
+{
+    BubbleChainSequencesData& data = bubbleChainSequencesData;
+    data.phased = phased;
+    data.bubbleChainBegin = bubbleChainBegin;
+    data.sequences.clear();
+    data.sequences.resize(bubbleChainEnd - bubbleChainBegin);
+
+    // Bubble chains vary greatly in length, so use a batch size of 1.
+    const uint64_t batchSize = 1;
+    setupLoadBalancing(bubbleChainEnd - bubbleChainBegin, batchSize);
+    runThreads(&AssemblyGraph2::computeBubbleChainSequencesThreadFunction, threadCount);
+}
+
+
+
+void AssemblyGraph2::computeBubbleChainSequencesThreadFunction(size_t /* threadId */)
+{
+    BubbleChainSequencesData& data = bubbleChainSequencesData;
+
+    // Loop over all batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // Loop over all bubble chains in this batch.
+        for(uint64_t i=begin; i!=end; i++) {
+            const BubbleChain& bubbleChain = bubbleChains[data.bubbleChainBegin + i];
+            vector< vector<Base> >& sequences = data.sequences[i];
+
+            if(not data.phased) {
+                sequences.resize(1);
+                computeBubbleChainGfaSequence(bubbleChain, sequences.front());
+                continue;
+            }
+
+            // Phased: two sequences for each phased region,
+            // one sequence for each unphased region.
+            for(const auto& phasingRegion: bubbleChain.phasingRegions) {
+                if(phasingRegion.isPhased) {
+                    sequences.resize(sequences.size() + 2);
+                    computePhasedRegionGfaSequence(bubbleChain, phasingRegion, 0, sequences[sequences.size() - 2]);
+                    computePhasedRegionGfaSequence(bubbleChain, phasingRegion, 1, sequences.back());
+                } else {
+                    sequences.resize(sequences.size() + 1);
+                    computeUnphasedRegionGfaSequence(bubbleChain, phasingRegion, sequences.back());
+                }
+            }
+        }
+    }
+}
+
+
+
 string AssemblyGraph2Edge::color(uint64_t branchId) const
 {
     if(isBubble()) {
@@ -1950,56 +2111,90 @@ void AssemblyGraph2::storeGfaSequence()
     // from each bubble edge to adjacent non-bubble edges.
     countTransferredBases();
 
+    // Store a vector of edge descriptors for all edges, to be processed in parallel.
+    // Each edge only modifies its own gfa sequence.
+    storeGfaSequenceData.allEdges.clear();
+    BGL_FORALL_EDGES(e, g, G) {
+        storeGfaSequenceData.allEdges.push_back(e);
+    }
 
+    // Process all edges in parallel.
+    const uint64_t batchSize = 100;
+    setupLoadBalancing(storeGfaSequenceData.allEdges.size(), batchSize);
+    runThreads(&AssemblyGraph2::storeGfaSequenceThreadFunction, threadCount);
+    storeGfaSequenceData.allEdges.clear();
 
-    BGL_FORALL_EDGES(e, g, G) {
-        E& edge = g[e];
-        const vertex_descriptor v0 = source(e, g);
-        const vertex_descriptor v1 = target(e, g);
+    performanceLog << timestamp << "storeGfaSequence ends." << endl;
+}
 
-        for(uint64_t branchId=0; branchId<edge.ploidy(); branchId++) {
-            E::Branch& branch = edge.branches[branchId];
-
-            branch.gfaSequence.clear();
-
-            // Add the sequence transferred forward by the preceding bubble, if appropriate.
-            if(not edge.isBubble()) {
-                if(in_degree(v0, g)==1 and out_degree(v0, g)==1) {
-                    in_edge_iterator it;
-                    tie(it, ignore) = in_edges(v0, g);
-                    const E& previousEdge = g[*it];
-                    if(previousEdge.isBubble()) {
-                        const vector<Base>& s = previousEdge.branches.front().rawSequence;
-                        copy(s.end() - previousEdge.forwardTransferCount, s.end(),
-                            back_inserter(branch.gfaSequence));
-                    }
+
+
+void AssemblyGraph2::storeGfaSequenceThreadFunction(size_t /* threadId */)
+{
+
+    // Loop over all batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // Loop over all edges in this batch.
+        for(uint64_t i=begin; i!=end; i++) {
+            storeGfaSequence(storeGfaSequenceData.allEdges[i]);
+        }
+    }
+}
+
+
+
+// Store GFA sequence in a given edge.
+// This requires the transfer counts computed by countTransferredBases.
+void AssemblyGraph2::storeGfaSequence(edge_descriptor e)
+{
+    G& g = *this;
+
+    E& edge = g[e];
+    const vertex_descriptor v0 = source(e, g);
+    const vertex_descriptor v1 = target(e, g);
+
+    for(uint64_t branchId=0; branchId<edge.ploidy(); branchId++) {
+        E::Branch& branch = edge.branches[branchId];
+
+        branch.gfaSequence.clear();
+
+        // Add the sequence transferred forward by the preceding bubble, if appropriate.
+        if(not edge.isBubble()) {
+            if(in_degree(v0, g)==1 and out_degree(v0, g)==1) {
+                in_edge_iterator it;
+                tie(it, ignore) = in_edges(v0, g);
+                const E& previousEdge = g[*it];
+                if(previousEdge.isBubble()) {
+                    const vector<Base>& s = previousEdge.branches.front().rawSequence;
+                    copy(s.end() - previousEdge.forwardTransferCount, s.end(),
+                        back_inserter(branch.gfaSequence));
                 }
             }
+        }
 
-            // Add the sequence of this branch, excluding sequence
-            // that was transferred backward or forward.
-            copy(
-                branch.rawSequence.begin() + edge.backwardTransferCount,
-                branch.rawSequence.end() - edge.forwardTransferCount,
-                back_inserter(branch.gfaSequence));
-
-            // Add the sequence transferred backward by the following bubble, if appropriate.
-            if(not edge.isBubble()) {
-                if(in_degree(v1, g)==1 and out_degree(v1, g)==1) {
-                    out_edge_iterator it;
-                    tie(it, ignore) = out_edges(v1, g);
-                    const E& nextEdge = g[*it];
-                    if(nextEdge.isBubble()) {
-                        const vector<Base>& s = nextEdge.branches.front().rawSequence;
-                        copy(s.begin(), s.begin() + nextEdge.backwardTransferCount,
-                            back_inserter(branch.gfaSequence));
-                    }
+        // Add the sequence of this branch, excluding sequence
+        // that was transferred backward or forward.
+        copy(
+            branch.rawSequence.begin() + edge.backwardTransferCount,
+            branch.rawSequence.end() - edge.forwardTransferCount,
+            back_inserter(branch.gfaSequence));
+
+        // Add the sequence transferred backward by the following bubble, if appropriate.
+        if(not edge.isBubble()) {
+            if(in_degree(v1, g)==1 and out_degree(v1, g)==1) {
+                out_edge_iterator it;
+                tie(it, ignore) = out_edges(v1, g);
+                const E& nextEdge = g[*it];
+                if(nextEdge.isBubble()) {
+                    const vector<Base>& s = nextEdge.branches.front().rawSequence;
+                    copy(s.begin(), s.begin() + nextEdge.backwardTransferCount,
+                        back_inserter(branch.gfaSequence));
                 }
             }
         }
     }
-
-    performanceLog << timestamp << "storeGfaSequence ends." << endl;
 }
 
 
@@ -4614,7 +4809,7 @@ void AssemblyGraph2::updateMarkerGraph()
 
     // First clear the flag for all marker graph edges.
     for(MarkerGraphEdgeId edgeId=0; edgeId<markerGraph.edges.size(); edgeId++) {
-        markerGraph.edges[edgeId].wasAssembled = 0;
+        markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasAssembled, false);
     }
 
     // Now set the flags for marker graph edges that appear anywhere in the assembly graph.
@@ -4623,7 +4818,7 @@ void AssemblyGraph2::updateMarkerGraph()
         const AssemblyGraph2Edge& edge = g[e];
         for(const AssemblyGraph2Edge::Branch& branch: edge.branches) {
             for(const MarkerGraphEdgeId edgeId: branch.path) {
-                markerGraph.edges[edgeId].wasAssembled = 1;
+                markerGraph.setEdgeFlag(edgeId, MarkerGraph::EdgeFlag::wasAssembled, true);
                 ++n;
             }
         }
@@ -276,13 +276,16 @@ public:
     // These must be called after storeGfaSequence,
     // but writeDetailed can be caller earlier for some combinations of flags
     // (see writeDetailedEarly).
+    // They are not const because they use multiple threads
+    // to prepare the output, which is then written out
+    // in order by the calling thread.
     void writeDetailed(
         const string& baseName,
         bool writeSequence,
         bool writeSequenceLengthInMarkers,
         bool writeCsv,
         bool writeGfa,
-        bool writeFasta) const;
+        bool writeFasta);
     void writeDetailedEarly(const string& baseName);
     void writeHaploid(
         const string& baseName,
@@ -290,14 +293,14 @@ public:
         bool writeCsv,
         bool writeGfa,
         bool writeFasta,
-        AssemblyGraph2Statistics* statistics = 0) const;
+        AssemblyGraph2Statistics* statistics = 0);
     void writePhased(
         const string& baseName,
         bool writeSequence,
         bool writeCsv,
         bool writeGfa,
         bool writeFasta,
-        AssemblyGraph2Statistics* statistics = 0) const;
+        AssemblyGraph2Statistics* statistics = 0);
     void writePhasedDetails() const;
 
     // Hide a AssemblyGraph2BaseClass::Base.
@@ -323,6 +326,9 @@ public:
 private:
     MarkerGraph& markerGraph;
 
+    // The number of threads used by the output functions.
+    size_t threadCount;
+
     // Map that gives us the vertex descriptor corresponding to
     // each marker graph vertex.
     std::map<MarkerGraph::VertexId, vertex_descriptor> vertexMap;
@@ -451,6 +457,36 @@ private:
 
     // Store GFA sequence in each edge.
     void storeGfaSequence();
+    void storeGfaSequence(edge_descriptor);
+    void storeGfaSequenceThreadFunction(size_t threadId);
+    class StoreGfaSequenceData {
+    public:
+        vector<edge_descriptor> allEdges;
+    };
+    StoreGfaSequenceData storeGfaSequenceData;
+
+    // Multithreaded preparation of the output of writeDetailed.
+    // The edges are processed in blocks. For each block,
+    // worker threads write the FASTA and csv output
+    // of each edge to a separate buffer, then the calling thread
+    // writes out the buffers in order.
+    void writeDetailedThreadFunction(size_t threadId);
+    class WriteDetailedData {
+    public:
+        bool writeSequence;
+        bool writeSequenceLengthInMarkers;
+        bool writeCsv;
+        bool writeFasta;
+        vector<edge_descriptor> allEdges;
+
+        // The FASTA and csv output for each edge of the current block,
+        // indexed by the position in allEdges minus edgeBegin.
+        uint64_t edgeBegin;
+        vector<string> fastaBuffers;
+        vector<string> csvBuffers;
+    };
+    WriteDetailedData writeDetailedData;
+    static const uint64_t writeDetailedBlockSize = 100000;
 
     void hetSnpStatistics(
         uint64_t& transitionCount,
@@ -526,6 +562,34 @@ private:
         vector<Base>&
         ) const;
 
+    // Multithreaded computation of the gfa sequence of bubble chains,
+    // used by writeHaploid and writePhased.
+    // The bubble chains are processed in blocks. For each block,
+    // worker threads compute the sequences of each bubble chain
+    // into a separate buffer, then the calling thread
+    // writes them out in order.
+    void computeBubbleChainSequences(
+        uint64_t bubbleChainBegin,
+        uint64_t bubbleChainEnd,
+        bool phased);
+    void computeBubbleChainSequencesThreadFunction(size_t threadId);
+    class BubbleChainSequencesData {
+    public:
+        bool phased;
+        uint64_t bubbleChainBegin;
+
+        // The sequences of each bubble chain of the current block,
+        // indexed by bubbleChainId minus bubbleChainBegin.
+        // If phased is false, there is one sequence for each
+        // bubble chain, computed by computeBubbleChainGfaSequence.
+        // If phased is true, there are two sequences
+        // (haplotypes 0 and 1) for each phased region and one sequence
+        // for each unphased region, in the order of the phasing regions.
+        vector< vector< vector<Base> > > sequences;
+    };
+    BubbleChainSequencesData bubbleChainSequencesData;
+    static const uint64_t bubbleChainBlockSize = 1000;
+
 
 
     // A superbubble is a subset of the AssemblyGraph2.
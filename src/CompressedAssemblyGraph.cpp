@@ -23,15 +23,27 @@ using namespace shasta;
 #include "fstream.hpp"
 #include "vector.hpp"
 
+#include "MultithreadedObject.tpp"
+template class MultithreadedObject<CompressedAssemblyGraph>;
+
 
 
 // Create the CompressedAssemblyGraph from the AssemblyGraph.
 CompressedAssemblyGraph::CompressedAssemblyGraph(
-    const Assembler& assembler)
+    const Assembler& assembler,
+    size_t threadCountArgument) :
+    MultithreadedObject<CompressedAssemblyGraph>(*this),
+    assemblerPointer(&assembler),
+    threadCount(threadCountArgument)
 {
     CompressedAssemblyGraph& graph = *this;
     const AssemblyGraph& assemblyGraph = *(assembler.assemblyGraphPointer);
 
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
     cout << "The assembly graph has " << assemblyGraph.vertices.size() <<
         " vertices and " << assemblyGraph.edges.size() << " edges." << endl;
 
@@ -53,21 +65,30 @@ CompressedAssemblyGraph::CompressedAssemblyGraph(
     // Assign an id to each edge.
     assignEdgeIds();
 
+    // The remaining passes work independently on each edge
+    // and are multithreaded over the edge table.
+    fillEdgeTable();
+
     // Fill in the assembly graph edges that go into each
     // edge of the compressed assembly graph.
-    fillContributingEdges(assemblyGraph);
+    fillContributingEdges();
 
     // Fill in minimum and maximum marker counts for each edge.
-    fillMarkerCounts(assemblyGraph);
+    fillMarkerCounts();
 
     // Find the oriented reads that appear in marker graph vertices
     // internal to each edge of the compressed assembly graph.
-    findOrientedReads(assembler);
+    findOrientedReads();
     fillOrientedReadTable(assembler);
 
     // Find edges that have at least one common oriented read
     // which each edge.
     findRelatedEdges();
+
+    // We no longer need these.
+    edgeTable.clear();
+    edgeTable.shrink_to_fit();
+    assemblerPointer = 0;
 }
 
 
@@ -178,13 +199,13 @@ void CompressedAssemblyGraph::mergeLinearChains()
     CompressedAssemblyGraph& graph = *this;
 
     // Find linear chains.
-    vector< std::list<edge_descriptor> > chains;
+    vector< vector<edge_descriptor> > chains;
     findLinearChains(graph, 0, chains);
 
 
 
     // Replace each chain with a single edge.
-    for(const std::list<edge_descriptor>& chain: chains) {
+    for(const vector<edge_descriptor>& chain: chains) {
 
         // If the chain has length 1, leave it alone.
         if(chain.size() == 1) {
@@ -201,6 +222,7 @@ void CompressedAssemblyGraph::mergeLinearChains()
         CompressedAssemblyGraphEdge& newEdge = graph[eNew];
 
         // Fill in the assembly graph vertices corresponding to this new edge.
+        newEdge.vertices.reserve(chain.size() + 1);
         newEdge.vertices.push_back(graph[v0].vertexId);
         for(const edge_descriptor e: chain) {
             const vertex_descriptor v = target(e, graph);
@@ -245,27 +267,53 @@ void CompressedAssemblyGraph::assignEdgeIds()
 
 
 
-// Fill in the assembly graph edges that go into each
-// edge of the compressed assembly graph.
-void CompressedAssemblyGraph::fillContributingEdges(
-    const AssemblyGraph& assemblyGraph)
+// Fill the edge table, which contains the edges indexed by edge id.
+void CompressedAssemblyGraph::fillEdgeTable()
 {
     CompressedAssemblyGraph& graph = *this;
 
+    edgeTable.resize(num_edges(graph));
     BGL_FORALL_EDGES(e, graph, CompressedAssemblyGraph) {
-        CompressedAssemblyGraphEdge& edge = graph[e];
-        edge.edges.resize(edge.vertices.size() - 1);
-        for(uint64_t i=0; i<edge.edges.size(); i++) {
-            const VertexId vertexId0 = edge.vertices[i];
-            const VertexId vertexId1 = edge.vertices[i+1];
-            const span<const EdgeId> edges0 = assemblyGraph.edgesBySource[vertexId0];
-            for(const EdgeId edge01: edges0) {
-                if(assemblyGraph.edges[edge01].target == vertexId1) {
-                    edge.edges[i].push_back(edge01);
+        edgeTable[graph[e].id] = e;
+    }
+}
+
+
+
+// Fill in the assembly graph edges that go into each
+// edge of the compressed assembly graph.
+void CompressedAssemblyGraph::fillContributingEdges()
+{
+    setupLoadBalancing(edgeTable.size(), 100);
+    runThreads(&CompressedAssemblyGraph::fillContributingEdgesThreadFunction, threadCount);
+}
+
+
+
+void CompressedAssemblyGraph::fillContributingEdgesThreadFunction(size_t threadId)
+{
+    CompressedAssemblyGraph& graph = *this;
+    const AssemblyGraph& assemblyGraph = *(assemblerPointer->assemblyGraphPointer);
+
+    // Loop over all batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // Loop over all edges assigned to this batch.
+        for(uint64_t edgeId=begin; edgeId!=end; edgeId++) {
+            CompressedAssemblyGraphEdge& edge = graph[edgeTable[edgeId]];
+            edge.edges.resize(edge.vertices.size() - 1);
+            for(uint64_t i=0; i<edge.edges.size(); i++) {
+                const VertexId vertexId0 = edge.vertices[i];
+                const VertexId vertexId1 = edge.vertices[i+1];
+                const span<const EdgeId> edges0 = assemblyGraph.edgesBySource[vertexId0];
+                for(const EdgeId edge01: edges0) {
+                    if(assemblyGraph.edges[edge01].target == vertexId1) {
+                        edge.edges[i].push_back(edge01);
+                    }
                 }
             }
         }
-
     }
 }
 
@@ -273,21 +321,25 @@ void CompressedAssemblyGraph::fillContributingEdges(
 
 // Find the oriented reads that appear in marker graph vertices
 // internal to each edge of the compressed assembly graph.
-void CompressedAssemblyGraph::findOrientedReads(
-    const Assembler& assembler)
+void CompressedAssemblyGraph::findOrientedReads()
+{
+    setupLoadBalancing(edgeTable.size(), 10);
+    runThreads(&CompressedAssemblyGraph::findOrientedReadsThreadFunction, threadCount);
+}
+
+
+
+void CompressedAssemblyGraph::findOrientedReadsThreadFunction(size_t threadId)
 {
     CompressedAssemblyGraph& graph = *this;
 
-    BGL_FORALL_EDGES(e, graph, CompressedAssemblyGraph) {
-        graph[e].findOrientedReads(assembler);
-    }
+    // Loop over all batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
 
-    // Fill in the oriented read table, which tells us
-    // which edges each read appears in.
-    orientedReadTable.resize(2 * assembler.getReads().readCount());
-    BGL_FORALL_EDGES(e, graph, CompressedAssemblyGraph) {
-        for(const OrientedReadId orientedReadId: graph[e].orientedReadIds) {
-            orientedReadTable[orientedReadId.getValue()].push_back(e);
+        // Loop over all edges assigned to this batch.
+        for(uint64_t edgeId=begin; edgeId!=end; edgeId++) {
+            graph[edgeTable[edgeId]].findOrientedReads(*assemblerPointer);
         }
     }
 }
@@ -358,9 +410,24 @@ void CompressedAssemblyGraphEdge::findOrientedReads(
 // which each edge.
 void CompressedAssemblyGraph::findRelatedEdges()
 {
-    CompressedAssemblyGraph& graph = *this;
-    BGL_FORALL_EDGES(e, graph, CompressedAssemblyGraph) {
-        findRelatedEdges(e);
+    setupLoadBalancing(edgeTable.size(), 10);
+    runThreads(&CompressedAssemblyGraph::findRelatedEdgesThreadFunction, threadCount);
+}
+
+
+
+void CompressedAssemblyGraph::findRelatedEdgesThreadFunction(size_t threadId)
+{
+    // Loop over all batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // Loop over all edges assigned to this batch.
+        // Each edge only modifies its own relatedEdges,
+        // and orientedReadTable is not modified.
+        for(uint64_t edgeId=begin; edgeId!=end; edgeId++) {
+            findRelatedEdges(edgeTable[edgeId]);
+        }
     }
 }
 void CompressedAssemblyGraph::findRelatedEdges(edge_descriptor e0)
@@ -602,12 +669,27 @@ void CompressedAssemblyGraph::writeCsvOrientedReads() const
 
 
 // Fill in minimum and maximum marker counts for each edge.
-void CompressedAssemblyGraph::fillMarkerCounts(const AssemblyGraph& assemblyGraph)
+void CompressedAssemblyGraph::fillMarkerCounts()
+{
+    setupLoadBalancing(edgeTable.size(), 100);
+    runThreads(&CompressedAssemblyGraph::fillMarkerCountsThreadFunction, threadCount);
+}
+
+
+
+void CompressedAssemblyGraph::fillMarkerCountsThreadFunction(size_t threadId)
 {
     CompressedAssemblyGraph& graph = *this;
+    const AssemblyGraph& assemblyGraph = *(assemblerPointer->assemblyGraphPointer);
 
-    BGL_FORALL_EDGES(e, graph, CompressedAssemblyGraph) {
-        graph[e].fillMarkerCounts(assemblyGraph);
+    // Loop over all batches assigned to this thread.
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+
+        // Loop over all edges assigned to this batch.
+        for(uint64_t edgeId=begin; edgeId!=end; edgeId++) {
+            graph[edgeTable[edgeId]].fillMarkerCounts(assemblyGraph);
+        }
     }
 }
 void CompressedAssemblyGraphEdge::fillMarkerCounts(const AssemblyGraph& assemblyGraph)
@@ -644,7 +726,8 @@ CompressedAssemblyGraph::CompressedAssemblyGraph(
     boost::bimap<vertex_descriptor, vertex_descriptor>& vertexMap,
     boost::bimap<edge_descriptor, edge_descriptor>& edgeMap,
     std::map<vertex_descriptor, uint64_t>& distanceMap
-    )
+    ) :
+    MultithreadedObject<CompressedAssemblyGraph>(*this)
 {
     CompressedAssemblyGraph& subgraph = *this;
     createLocalSubgraph(
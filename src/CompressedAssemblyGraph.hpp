@@ -9,6 +9,7 @@ in which each linear sequence of bubbles is compressed to a single edge.
 *******************************************************************************/
 
 #include "AssemblyGraph.hpp"
+#include "MultithreadedObject.hpp"
 
 #include <boost/bimap.hpp>
 #include <boost/graph/adjacency_list.hpp>
@@ -31,6 +32,8 @@ namespace shasta {
         >;
 
     class Assembler;
+
+    extern template class MultithreadedObject<CompressedAssemblyGraph>;
 }
 
 
@@ -97,14 +100,16 @@ private:
 
 
 class shasta::CompressedAssemblyGraph :
-    public CompressedAssemblyGraphBaseClass {
+    public CompressedAssemblyGraphBaseClass,
+    public MultithreadedObject<CompressedAssemblyGraph> {
 public:
     using VertexId = AssemblyGraph::VertexId;
     using EdgeId = AssemblyGraph::EdgeId;
 
 
     // Create the CompressedAssemblyGraph from the AssemblyGraph.
-    CompressedAssemblyGraph(const Assembler&);
+    // The passes that work independently on each edge are multithreaded.
+    CompressedAssemblyGraph(const Assembler&, size_t threadCount = 0);
 
     // Create a local subgraph.
     // See createLocalSubgraph for argument explanation.
@@ -193,16 +198,28 @@ private:
     // Assign an id to each edge.
     void assignEdgeIds();
 
+    // The edges, indexed by edge id. Only used during construction,
+    // to distribute the per-edge passes to threads.
+    vector<edge_descriptor> edgeTable;
+    void fillEdgeTable();
+
+    // The Assembler and thread count, only used during construction.
+    const Assembler* assemblerPointer = 0;
+    size_t threadCount = 0;
+
     // Fill in the assembly graph edges that go into each
     // edge of the compressed assembly graph.
-    void fillContributingEdges(const AssemblyGraph&);
+    void fillContributingEdges();
+    void fillContributingEdgesThreadFunction(size_t threadId);
 
     // Fill in minimum and maximum marker counts for each edge.
-    void fillMarkerCounts(const AssemblyGraph&);
+    void fillMarkerCounts();
+    void fillMarkerCountsThreadFunction(size_t threadId);
 
     // Find the oriented reads that appear in marker graph vertices
     // internal to each edge of the compressed assembly graph.
-    void findOrientedReads(const Assembler&);
+    void findOrientedReads();
+    void findOrientedReadsThreadFunction(size_t threadId);
 
     // The edges that each oriented read appears in.
     // Indexed by OrientedRead::getValue().
@@ -212,6 +229,7 @@ private:
     // Find edges that have at least one common oriented read
     // which each edge.
     void findRelatedEdges();
+    void findRelatedEdgesThreadFunction(size_t threadId);
     void findRelatedEdges(edge_descriptor);
 
 private:
@@ -0,0 +1,299 @@
+// Implementation of class HttpResponseCache - see HttpResponseCache.hpp for more information.
+
+// Shasta.
+#include "HttpResponseCache.hpp"
+#include "MurmurHash2.hpp"
+#include "SHASTA_ASSERT.hpp"
+using namespace shasta;
+
+// Standard library.
+#include "algorithm.hpp"
+#include <filesystem>
+#include "fstream.hpp"
+#include <iomanip>
+#include "iostream.hpp"
+#include <sstream>
+
+
+
+void HttpResponseCache::setup(
+    uint64_t maxByteCountArgument,
+    const string& directoryArgument,
+    const string& fingerprintArgument)
+{
+    maxByteCount = maxByteCountArgument;
+    directory = directoryArgument;
+    fingerprint = fingerprintArgument;
+
+    if(not directory.empty()) {
+        if(directory.back() != '/') {
+            directory.push_back('/');
+        }
+        std::filesystem::create_directories(directory);
+    }
+
+    // If the new limit is smaller, evict as necessary.
+    evict();
+}
+
+
+
+string HttpResponseCache::normalizeRequest(
+    const vector<string>& request,
+    const string& variant)
+{
+    SHASTA_ASSERT(not request.empty());
+
+    // Gather the name/value pairs.
+    vector< pair<string, string> > parameters;
+    for(uint64_t i=1; i+1<request.size(); i+=2) {
+        parameters.push_back(make_pair(request[i], request[i+1]));
+    }
+    if(request.size() % 2 == 0) {
+        parameters.push_back(make_pair(request.back(), string()));
+    }
+
+    // Sort them by name, keeping the order of repeated names.
+    std::stable_sort(parameters.begin(), parameters.end(),
+        [](const pair<string, string>& x, const pair<string, string>& y)
+        {
+            return x.first < y.first;
+        });
+
+    // Construct the key. Null characters are used as separators
+    // because they cannot appear in a decoded request.
+    string key = request.front();
+    for(const auto& p: parameters) {
+        key.push_back('\0');
+        key.append(p.first);
+        key.push_back('\0');
+        key.append(p.second);
+    }
+    key.push_back('\0');
+    key.append(variant);
+
+    return key;
+}
+
+
+
+string HttpResponseCache::getETag(const string& key) const
+{
+    const string s = fingerprint + '\0' + key;
+    const uint64_t hash = MurmurHash64A(s.data(), int(s.size()), 1241);
+    std::ostringstream etag;
+    etag << "\"" << std::hex << std::setfill('0') << std::setw(16) << hash << "\"";
+    return etag.str();
+}
+
+
+
+bool HttpResponseCache::find(
+    const string& keyword,
+    const string& key,
+    string& response)
+{
+    Statistics& statistics = keywordStatistics[keyword];
+    ++statistics.requestCount;
+    ++totalStatistics.requestCount;
+
+    // Look in memory first.
+    const auto it = lruMap.find(key);
+    if(it != lruMap.end()) {
+
+        // Move it to the front of the LRU list.
+        lruList.splice(lruList.begin(), lruList, it->second);
+        response = it->second->second;
+        ++statistics.memoryHitCount;
+        ++totalStatistics.memoryHitCount;
+        return true;
+    }
+
+    // Look on disk.
+    if(findOnDisk(key, response)) {
+        storeInMemory(key, response);
+        ++statistics.diskHitCount;
+        ++totalStatistics.diskHitCount;
+        return true;
+    }
+
+    return false;
+}
+
+
+
+void HttpResponseCache::store(const string& key, const string& response)
+{
+    storeInMemory(key, response);
+    storeOnDisk(key, response);
+}
+
+
+
+void HttpResponseCache::storeInMemory(const string& key, const string& response)
+{
+    // Responses larger than the cache are not stored.
+    const uint64_t entryByteCount = key.size() + response.size();
+    if(entryByteCount > maxByteCount) {
+        return;
+    }
+
+    // If already present, replace it.
+    const auto it = lruMap.find(key);
+    if(it != lruMap.end()) {
+        byteCount -= it->second->first.size() + it->second->second.size();
+        lruList.erase(it->second);
+        lruMap.erase(it);
+    }
+
+    lruList.push_front(make_pair(key, response));
+    lruMap.insert(make_pair(key, lruList.begin()));
+    byteCount += entryByteCount;
+
+    evict();
+}
+
+
+
+// Evict least recently used responses until
+// we are below the maximum number of bytes.
+void HttpResponseCache::evict()
+{
+    while(byteCount > maxByteCount) {
+        SHASTA_ASSERT(not lruList.empty());
+        const auto& p = lruList.back();
+        byteCount -= p.first.size() + p.second.size();
+        lruMap.erase(p.first);
+        lruList.pop_back();
+        ++evictionCount;
+    }
+}
+
+
+
+string HttpResponseCache::getFileName(const string& key) const
+{
+    string etag = getETag(key);
+    etag = etag.substr(1, etag.size() - 2);
+    return directory + etag;
+}
+
+
+
+// Each file on disk contains the length of the fingerprint and key,
+// followed by the fingerprint and key themselves, followed by the response.
+// The fingerprint and key are checked to guard against hash collisions
+// and responses stored for different data.
+bool HttpResponseCache::findOnDisk(const string& key, string& response) const
+{
+    if(directory.empty()) {
+        return false;
+    }
+
+    ifstream file(getFileName(key), std::ios::binary);
+    if(not file) {
+        return false;
+    }
+
+    uint64_t fingerprintSize = 0;
+    uint64_t keySize = 0;
+    file >> fingerprintSize >> keySize;
+    file.get();
+    if(not file or fingerprintSize != fingerprint.size() or keySize != key.size()) {
+        return false;
+    }
+
+    string storedFingerprint(fingerprintSize, '\0');
+    string storedKey(keySize, '\0');
+    file.read(storedFingerprint.data(), fingerprintSize);
+    file.read(storedKey.data(), keySize);
+    if(not file or storedFingerprint != fingerprint or storedKey != key) {
+        return false;
+    }
+
+    std::ostringstream s;
+    s << file.rdbuf();
+    response = s.str();
+    return true;
+}
+
+
+
+void HttpResponseCache::storeOnDisk(const string& key, const string& response) const
+{
+    if(directory.empty()) {
+        return;
+    }
+
+    // Write to a temporary file, then rename it,
+    // so an interrupted write does not leave a truncated response behind.
+    const string fileName = getFileName(key);
+    const string temporaryFileName = fileName + ".tmp";
+    {
+        ofstream file(temporaryFileName, std::ios::binary);
+        if(not file) {
+            cout << "Unable to write " << temporaryFileName << endl;
+            return;
+        }
+        file << fingerprint.size() << " " << key.size() << "\n";
+        file << fingerprint << key << response;
+    }
+    std::filesystem::rename(temporaryFileName, fileName);
+}
+
+
+
+void HttpResponseCache::countNotModified(const string& keyword)
+{
+    Statistics& statistics = keywordStatistics[keyword];
+    ++statistics.requestCount;
+    ++statistics.notModifiedCount;
+    ++totalStatistics.requestCount;
+    ++totalStatistics.notModifiedCount;
+}
+
+
+
+void HttpResponseCache::writeStatistics(ostream& html) const
+{
+    html <<
+        "<table>"
+        "<tr><th class=left>Maximum size in memory (bytes)<td class=right>" << maxByteCount <<
+        "<tr><th class=left>Current size in memory (bytes)<td class=right>" << byteCount <<
+        "<tr><th class=left>Responses in memory<td class=right>" << lruList.size() <<
+        "<tr><th class=left>Responses evicted from memory<td class=right>" << evictionCount <<
+        "<tr><th class=left>Directory for responses stored on disk<td>" <<
+        (directory.empty() ? string("None") : directory) <<
+        "</table>";
+
+    html <<
+        "<p><table>"
+        "<tr>"
+        "<th>Keyword"
+        "<th>Requests"
+        "<th>Memory hits"
+        "<th>Disk hits"
+        "<th>Not modified (304)"
+        "<th>Hit rate";
+    for(const auto& p: keywordStatistics) {
+        html << "<tr><td>" << p.first;
+        p.second.write(html);
+    }
+    html << "<tr><td><b>Total</b>";
+    totalStatistics.write(html);
+    html << "</table>";
+}
+
+
+
+void HttpResponseCache::Statistics::write(ostream& html) const
+{
+    const uint64_t hitCount = memoryHitCount + diskHitCount + notModifiedCount;
+    html <<
+        "<td class=right>" << requestCount <<
+        "<td class=right>" << memoryHitCount <<
+        "<td class=right>" << diskHitCount <<
+        "<td class=right>" << notModifiedCount <<
+        "<td class=right>" << std::fixed << std::setprecision(3) <<
+        (requestCount ? double(hitCount) / double(requestCount) : 0.);
+}
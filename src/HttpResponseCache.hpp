@@ -0,0 +1,120 @@
+#ifndef SHASTA_HTTP_RESPONSE_CACHE_HPP
+#define SHASTA_HTTP_RESPONSE_CACHE_HPP
+
+// Class HttpResponseCache is used by HttpServer to avoid
+// recomputing responses to requests it has already seen.
+// This is possible because the data being explored
+// do not change while the server is running.
+
+// Responses are keyed by the normalized request
+// (see HttpResponseCache::normalizeRequest).
+// The cache keeps the most recently used responses in memory,
+// up to a maximum number of bytes, and evicts the least recently used
+// responses when that limit is exceeded.
+// Optionally, responses can also be stored in a directory on disk.
+// Responses stored on disk are never evicted, and they survive
+// restarts of the server as long as the fingerprint of the
+// data being explored does not change.
+
+// Each cacheable request also gets an ETag which only depends on the
+// normalized request and the fingerprint. This allows the server to
+// answer conditional requests (If-None-Match) with 304 Not Modified,
+// even when the response itself was evicted from the cache.
+
+#include "cstdint.hpp"
+#include "iosfwd.hpp"
+#include <list>
+#include <map>
+#include "string.hpp"
+#include <unordered_map>
+#include "utility.hpp"
+#include "vector.hpp"
+
+namespace shasta {
+    class HttpResponseCache;
+}
+
+
+
+class shasta::HttpResponseCache {
+public:
+
+    // A maxByteCount of zero disables the in-memory cache.
+    // An empty directory disables the on-disk cache.
+    // The fingerprint should identify the data being explored.
+    // It is used to compute ETags and to validate
+    // responses stored on disk.
+    void setup(
+        uint64_t maxByteCount,
+        const string& directory,
+        const string& fingerprint);
+
+    bool isEnabled() const
+    {
+        return (maxByteCount > 0) or (not directory.empty());
+    }
+
+    // Construct the cache key for a request already parsed into tokens
+    // by HttpServer. The keyword is kept first, and the
+    // name/value pairs are sorted by name, so requests that only
+    // differ by the order of their parameters map to the same key.
+    // The relative order of repeated parameters with the same name
+    // is preserved, because it can be significant.
+    // The variant string allows the caller to distinguish responses
+    // that depend on information not contained in the request
+    // (for example, the browser that issued the request).
+    static string normalizeRequest(
+        const vector<string>& request,
+        const string& variant);
+
+    // Return the ETag for a given key, including the double quotes.
+    string getETag(const string& key) const;
+
+    // Look up a response. If found, returns true and stores it in response.
+    // The keyword is only used for statistics.
+    bool find(const string& keyword, const string& key, string& response);
+
+    // Store a response for the given key.
+    void store(const string& key, const string& response);
+
+    // Record a request that was answered with 304 Not Modified.
+    void countNotModified(const string& keyword);
+
+    // Write statistics in html format.
+    void writeStatistics(ostream& html) const;
+
+private:
+
+    // In-memory LRU storage.
+    // The list is in order of most recent use (most recently used first).
+    // The map contains iterators pointing into the list.
+    uint64_t maxByteCount = 0;
+    uint64_t byteCount = 0;
+    using List = std::list< pair<string, string> >;
+    List lruList;
+    std::unordered_map<string, List::iterator> lruMap;
+    void storeInMemory(const string& key, const string& response);
+    void evict();
+
+    // On-disk storage.
+    string directory;
+    string fingerprint;
+    string getFileName(const string& key) const;
+    bool findOnDisk(const string& key, string& response) const;
+    void storeOnDisk(const string& key, const string& response) const;
+
+    // Global and per-keyword statistics.
+    class Statistics {
+    public:
+        uint64_t requestCount = 0;
+        uint64_t memoryHitCount = 0;
+        uint64_t diskHitCount = 0;
+        uint64_t notModifiedCount = 0;
+        void write(ostream&) const;
+    };
+    Statistics totalStatistics;
+    std::map<string, Statistics> keywordStatistics;
+    uint64_t evictionCount = 0;
+};
+
+#endif
@@ -0,0 +1,318 @@
+// Implementation of class HttpResponseStreamBuffer - see HttpResponseStreamBuffer.hpp for more information.
+
+// Shasta.
+#include "HttpResponseStreamBuffer.hpp"
+#include "SHASTA_ASSERT.hpp"
+using namespace shasta;
+
+// Boost libraries.
+#include <boost/algorithm/string.hpp>
+
+// Standard library.
+#include "iostream.hpp"
+#include <sstream>
+#include "stdexcept.hpp"
+
+
+
+// Choose a content encoding given the value of the
+// Accept-Encoding header of a request.
+// We prefer gzip over deflate because some browsers
+// don't handle deflate consistently.
+// Quality values are ignored except for q=0, which
+// explicitly marks an encoding as not acceptable.
+HttpResponseStreamBuffer::ContentEncoding HttpResponseStreamBuffer::chooseContentEncoding(
+    const string& acceptEncoding)
+{
+    bool gzipIsAcceptable = false;
+    bool deflateIsAcceptable = false;
+
+    vector<string> tokens;
+    boost::algorithm::split(tokens, acceptEncoding, boost::algorithm::is_any_of(","));
+    for(string& token: tokens) {
+        vector<string> parts;
+        boost::algorithm::split(parts, token, boost::algorithm::is_any_of(";"));
+        string name = parts.front();
+        boost::algorithm::trim(name);
+        bool isAcceptable = true;
+        for(uint64_t i=1; i<parts.size(); i++) {
+            string part = parts[i];
+            boost::algorithm::erase_all(part, " ");
+            if(part == "q=0" or part == "q=0." or part == "q=0.0" or
+                part == "q=0.00" or part == "q=0.000") {
+                isAcceptable = false;
+            }
+        }
+        if(name == "gzip") {
+            gzipIsAcceptable = isAcceptable;
+        } else if(name == "deflate") {
+            deflateIsAcceptable = isAcceptable;
+        }
+    }
+
+    if(gzipIsAcceptable) {
+        return ContentEncoding::gzip;
+    } else if(deflateIsAcceptable) {
+        return ContentEncoding::deflate;
+    } else {
+        return ContentEncoding::identity;
+    }
+}
+
+
+
+string HttpResponseStreamBuffer::contentEncodingName(ContentEncoding contentEncoding)
+{
+    switch(contentEncoding) {
+    case ContentEncoding::identity:
+        return "identity";
+    case ContentEncoding::gzip:
+        return "gzip";
+    case ContentEncoding::deflate:
+        return "deflate";
+    }
+    SHASTA_ASSERT(0);
+}
+
+
+
+HttpResponseStreamBuffer::HttpResponseStreamBuffer(
+    ostream& client,
+    bool useChunkedTransferEncoding,
+    ContentEncoding contentEncoding,
+    string* copy) :
+    client(client),
+    useChunkedTransferEncoding(useChunkedTransferEncoding),
+    contentEncoding(contentEncoding),
+    copy(copy),
+    inputBuffer(16 * 1024)
+{
+    setp(inputBuffer.data(), inputBuffer.data() + inputBuffer.size());
+
+    if(contentEncoding != ContentEncoding::identity) {
+        zStream = std::make_unique<z_stream>();
+        zStream->zalloc = Z_NULL;
+        zStream->zfree = Z_NULL;
+        zStream->opaque = Z_NULL;
+
+        // Window bits 15 give the zlib format used by "deflate" content encoding.
+        // Adding 16 gives the gzip format.
+        const int windowBits = (contentEncoding == ContentEncoding::gzip) ? (15 + 16) : 15;
+
+        // Use the fastest compression level. Responses can be large
+        // and compression should not dominate response time.
+        const int status = deflateInit2(zStream.get(), Z_BEST_SPEED, Z_DEFLATED,
+            windowBits, 8, Z_DEFAULT_STRATEGY);
+        if(status != Z_OK) {
+            throw runtime_error("Error initializing zlib compression.");
+        }
+    }
+}
+
+
+
+HttpResponseStreamBuffer::~HttpResponseStreamBuffer()
+{
+    if(zStream) {
+        deflateEnd(zStream.get());
+    }
+}
+
+
+
+HttpResponseStreamBuffer::int_type HttpResponseStreamBuffer::overflow(int_type c)
+{
+    processInput();
+    if(not traits_type::eq_int_type(c, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(c);
+        pbump(1);
+    }
+    return traits_type::not_eof(c);
+}
+
+
+
+int HttpResponseStreamBuffer::sync()
+{
+    processInput();
+
+    // Only send data to the client if enough accumulated,
+    // to avoid lots of tiny chunks and loss of compression
+    // if the derived class flushes frequently.
+    if(headersAreComplete and bodyBytesSinceLastSend >= minSyncSize) {
+        if(zStream) {
+            compress(0, 0, Z_SYNC_FLUSH);
+        }
+        sendOutput();
+        client.flush();
+    }
+    return 0;
+}
+
+
+
+// Process the characters in the put area, then empty it.
+void HttpResponseStreamBuffer::processInput()
+{
+    const uint64_t n = uint64_t(pptr() - pbase());
+    if(n > 0) {
+        const char* data = pbase();
+        if(copy) {
+            copy->append(data, n);
+        }
+        if(headersAreComplete) {
+            processBody(data, n);
+        } else {
+            processHeaders(data, n);
+        }
+    }
+    setp(inputBuffer.data(), inputBuffer.data() + inputBuffer.size());
+}
+
+
+
+void HttpResponseStreamBuffer::processHeaders(const char* data, uint64_t n)
+{
+    headers.append(data, n);
+
+    // Look for the empty line that terminates the headers.
+    // The headers already written don't contain the status line,
+    // so the empty line can be at the very beginning.
+    uint64_t headersEnd = string::npos;
+    uint64_t bodyBegin = string::npos;
+    if(headers.compare(0, 2, "\r\n") == 0) {
+        headersEnd = 0;
+        bodyBegin = 2;
+    } else {
+        const uint64_t position = headers.find("\r\n\r\n");
+        if(position != string::npos) {
+            headersEnd = position + 2;
+            bodyBegin = position + 4;
+        }
+    }
+
+    if(headersEnd == string::npos) {
+
+        // If the headers are too long, something is wrong.
+        // Give up on encodings and send everything unchanged.
+        if(headers.size() > maxHeadersSize) {
+            useChunkedTransferEncoding = false;
+            contentEncoding = ContentEncoding::identity;
+            if(zStream) {
+                deflateEnd(zStream.get());
+                zStream.reset();
+            }
+            client << headers;
+            headers.clear();
+            headersAreComplete = true;
+        }
+        return;
+    }
+
+    // Write the headers, then process what is left as body.
+    writeHeaders(headersEnd);
+    headersAreComplete = true;
+    const string body = headers.substr(bodyBegin);
+    headers.clear();
+    processBody(body.data(), body.size());
+}
+
+
+
+// Write the headers, adding the ones required by the encodings in use,
+// followed by the empty line that terminates them.
+void HttpResponseStreamBuffer::writeHeaders(uint64_t headersEnd)
+{
+    client.write(headers.data(), std::streamsize(headersEnd));
+    if(useChunkedTransferEncoding) {
+        client << "Transfer-Encoding: chunked\r\n";
+    }
+    if(contentEncoding != ContentEncoding::identity) {
+        client << "Content-Encoding: " << contentEncodingName(contentEncoding) << "\r\n";
+        client << "Vary: Accept-Encoding\r\n";
+    }
+    client << "Connection: close\r\n";
+    client << "\r\n";
+}
+
+
+
+void HttpResponseStreamBuffer::processBody(const char* data, uint64_t n)
+{
+    bodyBytesSinceLastSend += n;
+    if(zStream) {
+        compress(data, n, Z_NO_FLUSH);
+    } else {
+        output.append(data, n);
+    }
+    if(output.size() >= chunkSize) {
+        sendOutput();
+    }
+}
+
+
+
+// Compress the given data, appending compressed output to the output string.
+void HttpResponseStreamBuffer::compress(const char* data, uint64_t n, int flush)
+{
+    SHASTA_ASSERT(zStream);
+    zStream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zStream->avail_in = uInt(n);
+    do {
+        const uint64_t oldSize = output.size();
+        output.resize(oldSize + chunkSize);
+        zStream->next_out = reinterpret_cast<Bytef*>(output.data() + oldSize);
+        zStream->avail_out = uInt(chunkSize);
+        const int status = deflate(zStream.get(), flush);
+        SHASTA_ASSERT(status != Z_STREAM_ERROR);
+        output.resize(output.size() - zStream->avail_out);
+    } while(zStream->avail_out == 0);
+    SHASTA_ASSERT(zStream->avail_in == 0);
+}
+
+
+
+void HttpResponseStreamBuffer::sendOutput()
+{
+    bodyBytesSinceLastSend = 0;
+    if(output.empty()) {
+        return;
+    }
+    if(useChunkedTransferEncoding) {
+        client << std::hex << output.size() << std::dec << "\r\n";
+        client << output;
+        client << "\r\n";
+    } else {
+        client << output;
+    }
+    output.clear();
+}
+
+
+
+void HttpResponseStreamBuffer::finish()
+{
+    SHASTA_ASSERT(not isFinished);
+    processInput();
+
+    // If we never saw the end of the headers, send what we have unchanged.
+    if(not headersAreComplete) {
+        client << headers;
+        headers.clear();
+        client.flush();
+        isFinished = true;
+        return;
+    }
+
+    if(zStream) {
+        compress(0, 0, Z_FINISH);
+    }
+    sendOutput();
+
+    // The last chunk has size zero.
+    if(useChunkedTransferEncoding) {
+        client << "0\r\n\r\n";
+    }
+    client.flush();
+    isFinished = true;
+}
@@ -0,0 +1,111 @@
+#ifndef SHASTA_HTTP_RESPONSE_STREAM_BUFFER_HPP
+#define SHASTA_HTTP_RESPONSE_STREAM_BUFFER_HPP
+
+// Class HttpResponseStreamBuffer is a stream buffer used by HttpServer
+// to send the response generated by the derived class.
+// It is placed between the derived class, which writes headers and body
+// of the response as usual, and the stream connected to the client.
+
+// It optionally provides:
+// - Chunked transfer encoding, so the client starts receiving
+//   the response while it is still being generated.
+// - Gzip or deflate content encoding, negotiated by HttpServer
+//   using the Accept-Encoding header of the request.
+// - A copy of the uncompressed response, which HttpServer uses
+//   to store the response in its HttpResponseCache.
+
+// The response is expected to begin after the status line,
+// with optional header lines, followed by an empty line,
+// followed by the body. The header lines required by
+// the encodings in use are inserted before the empty line.
+
+#include "cstdint.hpp"
+#include "iosfwd.hpp"
+#include <memory>
+#include <streambuf>
+#include "string.hpp"
+#include "vector.hpp"
+
+// Zlib.
+#include <zlib.h>
+
+namespace shasta {
+    class HttpResponseStreamBuffer;
+}
+
+
+
+class shasta::HttpResponseStreamBuffer : public std::streambuf {
+public:
+
+    enum class ContentEncoding {
+        identity,
+        gzip,
+        deflate
+    };
+
+    // Choose a content encoding given the value of the
+    // Accept-Encoding header of a request.
+    static ContentEncoding chooseContentEncoding(const string& acceptEncoding);
+    static string contentEncodingName(ContentEncoding);
+
+    // If copy is not null, the uncompressed response is also appended to it.
+    HttpResponseStreamBuffer(
+        ostream& client,
+        bool useChunkedTransferEncoding,
+        ContentEncoding,
+        string* copy = 0);
+    ~HttpResponseStreamBuffer();
+
+    // Flush all data and terminate the response.
+    // This must be called after the response is complete.
+    void finish();
+
+protected:
+    int_type overflow(int_type) override;
+    int sync() override;
+
+private:
+    ostream& client;
+    bool useChunkedTransferEncoding;
+    ContentEncoding contentEncoding;
+    string* copy;
+
+    // The put area used by the stream writing to this buffer.
+    vector<char> inputBuffer;
+    void processInput();
+
+    // Header lines are accumulated here until
+    // we see the empty line that terminates them.
+    // If no empty line is seen after maxHeadersSize bytes,
+    // the response is sent without any encoding.
+    bool headersAreComplete = false;
+    string headers;
+    void processHeaders(const char*, uint64_t);
+    void writeHeaders(uint64_t headersEnd);
+    static const uint64_t maxHeadersSize = 64 * 1024;
+
+    // Body bytes ready to be sent to the client
+    // (after compression, if in use).
+    string output;
+    void processBody(const char*, uint64_t);
+    void compress(const char*, uint64_t, int flush);
+
+    // Send the accumulated output to the client,
+    // as a chunk if chunked transfer encoding is in use.
+    void sendOutput();
+    static const uint64_t chunkSize = 64 * 1024;
+
+    // Zlib state, only used when compressing.
+    std::unique_ptr<z_stream> zStream;
+
+    // Calls to sync (for example, when the derived class writes
+    // std::flush or std::endl) only send data to the client
+    // if at least this many body bytes were written since the last time.
+    uint64_t bodyBytesSinceLastSend = 0;
+    static const uint64_t minSyncSize = 4 * 1024;
+
+    bool isFinished = false;
+};
+
+#endif
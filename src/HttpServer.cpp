@@ -2,6 +2,7 @@
 
 // Shasta.
 #include "HttpServer.hpp"
+#include "HttpResponseStreamBuffer.hpp"
 #include "platformDependent.hpp"
 #include "SHASTA_ASSERT.hpp"
 #include "timestamp.hpp"
@@ -208,6 +209,7 @@ template<class T> void HttpServer::processRequest(T& s)
         return;
     }
     const string& request = tokens[1];
+    const bool isHttp11 = (tokens[2].compare(0, 8, "HTTP/1.1") == 0);
     if(request.empty()) {
         s << "Empty GET request: " << requestLine;
         cout << "Empty GET request: " << requestLine;
@@ -238,10 +240,16 @@ template<class T> void HttpServer::processRequest(T& s)
 
     // Read the rest of the input from the client, but ignore it,
     // except for the User Agent string, which tells us what browser
-    // issued the request.
+    // issued the request, the If-None-Match header,
+    // used for conditional requests, and the Accept-Encoding header,
+    // used to decide whether to compress the response.
     // If we don't read all the input, the client may get a timeout.
     string line;
     const string userAgentPrefix = "User-Agent: ";
+    const string ifNoneMatchPrefix = "If-None-Match: ";
+    const string acceptEncodingPrefix = "Accept-Encoding: ";
+    string ifNoneMatch;
+    string acceptEncoding;
     BrowserInformation browserInformation;
     string originatingProcessUserName;
     string thisProcessUserName;
@@ -262,19 +270,108 @@ template<class T> void HttpServer::processRequest(T& s)
         if(line.compare(0, userAgentPrefix.size(), userAgentPrefix) == 0) {
             browserInformation.set(line);
         }
+
+        // See if this is the If-None-Match header.
+        if(line.compare(0, ifNoneMatchPrefix.size(), ifNoneMatchPrefix) == 0) {
+            ifNoneMatch = line.substr(ifNoneMatchPrefix.size());
+        }
+
+        // See if this is the Accept-Encoding header.
+        if(line.compare(0, acceptEncodingPrefix.size(), acceptEncodingPrefix) == 0) {
+            acceptEncoding = line.substr(acceptEncodingPrefix.size());
+            boost::algorithm::trim(acceptEncoding);
+        }
     }
     cout << "isFirefox=" << browserInformation.isFirefox << " ";
     cout << "isChrome=" << browserInformation.isChrome << endl;
 
 
 
-    // Write the success response.
+    // The response goes through an HttpResponseStreamBuffer,
+    // which takes care of chunked transfer encoding (HTTP/1.1 only),
+    // so the browser starts receiving the response while it is being generated,
+    // and of compression, if the browser accepts it.
+    const HttpResponseStreamBuffer::ContentEncoding contentEncoding =
+        HttpResponseStreamBuffer::chooseContentEncoding(acceptEncoding);
+
+
+
+    // If response caching is not in use, just
+    // write the success response.
     // We don't write the required empty line, so the derived class can send headers
     // if it wants to.
-    s << "HTTP/1.1 200 OK\r\n";
+    if(not (responseCache.isEnabled() and isCacheable(tokens))) {
+        s << "HTTP/1.1 200 OK\r\n";
+
+        // The derived class processes the request.
+        HttpResponseStreamBuffer responseBuffer(s, isHttp11, contentEncoding);
+        ostream response(&responseBuffer);
+        processRequest(tokens, response, browserInformation);
+        responseBuffer.finish();
+        return;
+    }
+
+
+
+    // If we get here, we are using the response cache.
+    // The cache stores uncompressed responses, but the ETag
+    // must be different for each content encoding.
+    const string& keyword = tokens.front();
+    const string key = HttpResponseCache::normalizeRequest(tokens,
+        browserInformation.getCacheVariant());
+    string etag = responseCache.getETag(key);
+    if(contentEncoding != HttpResponseStreamBuffer::ContentEncoding::identity) {
+        etag.insert(etag.size() - 1,
+            "-" + HttpResponseStreamBuffer::contentEncodingName(contentEncoding));
+    }
 
-    // The derived class processes the request.
-    processRequest(tokens, s, browserInformation);
+    // If the browser already has this response, tell it so.
+    if(not ifNoneMatch.empty() and
+        (ifNoneMatch.find(etag) != string::npos or ifNoneMatch.compare(0, 1, "*") == 0)) {
+        s << "HTTP/1.1 304 Not Modified\r\n"
+            "ETag: " << etag << "\r\n"
+            "Cache-Control: no-cache\r\n"
+            "\r\n";
+        responseCache.countNotModified(keyword);
+        cout << "Response not modified." << endl;
+        return;
+    }
+
+    // Look for it in the cache. If found, send it.
+    // Cache-Control: no-cache tells the browser
+    // to revalidate using the ETag before reusing the response.
+    string cachedResponse;
+    if(responseCache.find(keyword, key, cachedResponse)) {
+        cout << "Response found in cache." << endl;
+        s << "HTTP/1.1 200 OK\r\n"
+            "ETag: " << etag << "\r\n"
+            "Cache-Control: no-cache\r\n";
+        HttpResponseStreamBuffer responseBuffer(s, isHttp11, contentEncoding);
+        ostream response(&responseBuffer);
+        response << cachedResponse;
+        responseBuffer.finish();
+        return;
+    }
+
+    // Otherwise, ask the derived class to process the request.
+    // The response is sent to the client as it is generated,
+    // and a copy is also stored in the cache,
+    // unless the derived class called doNotCacheResponse.
+    // No ETag is sent in this case, because the derived class
+    // can still decide that the response should not be cached.
+    s << "HTTP/1.1 200 OK\r\n"
+        "Cache-Control: no-cache\r\n";
+    string responseCopy;
+    HttpResponseStreamBuffer responseBuffer(s, isHttp11, contentEncoding, &responseCopy);
+    ostream response(&responseBuffer);
+    responseIsCacheable = true;
+    processRequest(tokens, response, browserInformation);
+    responseBuffer.finish();
+    if(responseIsCacheable) {
+        responseCache.store(key, responseCopy);
+    } else {
+        cout << "Response not cached." << endl;
+    }
 }
 
 
@@ -336,6 +433,17 @@ void HttpServer::BrowserInformation::set(const string& userAgentHeader)
 
 
 
+string HttpServer::BrowserInformation::getCacheVariant() const
+{
+    string variant;
+    variant.push_back(isChrome ? 'C' : '-');
+    variant.push_back(isFirefox ? 'F' : '-');
+    variant.push_back(isEdge ? 'E' : '-');
+    return variant;
+}
+
+
+
 // Return all values assigned to a parameter.
 // For example, if the request has ...&a=xyz&a=uv,
 // when called with argument "a" returns a set containing "xyz" and "uv".
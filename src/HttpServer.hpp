@@ -6,6 +6,7 @@
 // The derived class only has to override
 // function processRequest.
 
+#include "HttpResponseCache.hpp"
 #include "span.hpp"
 
 #include "iosfwd.hpp"
@@ -82,6 +83,18 @@ public:
     {
     }
 
+    // Enable caching of responses to GET requests.
+    // See HttpResponseCache.hpp for more information.
+    // This should only be used if responses to identical
+    // requests never change while the server is running.
+    void setupResponseCache(
+        uint64_t maxByteCount,
+        const string& directory,
+        const string& fingerprint)
+    {
+        responseCache.setup(maxByteCount, directory, fingerprint);
+    }
+
 protected:
 
     // The derived class should override this.
@@ -100,6 +113,23 @@ protected:
         const PostData&,
         ostream& html);
 
+    // If response caching is enabled, the derived class can override this
+    // to prevent caching of responses to some GET requests.
+    virtual bool isCacheable(const vector<string>& /* request */) const
+    {
+        return true;
+    }
+
+    // The derived class can call this while processing a request
+    // to prevent caching of the response, for example after an error.
+    void doNotCacheResponse()
+    {
+        responseIsCacheable = false;
+    }
+    bool responseIsCacheable = true;
+
+    HttpResponseCache responseCache;
+
 
 public:
     // This function can be used to get the value of a parameter.
@@ -157,6 +187,10 @@ protected:
         bool isFirefox = false;
         bool isEdge = false;
         void set(const string& userAgentHeader);
+
+        // A short string identifying the browser,
+        // used to distinguish cached responses.
+        string getCacheVariant() const;
     };
 
 
@@ -19,6 +19,7 @@ are on the same marker graph vertex and 0 otherwise.
 
 // Shasta.
 #include "MarkerGraph.hpp"
+#include "ReadId.hpp"
 
 // Standard library.
 #include "algorithm.hpp"
@@ -31,6 +32,7 @@ are on the same marker graph vertex and 0 otherwise.
 namespace shasta {
     class InducedAlignment;
     class InducedAlignmentData;
+    class InducedAlignmentWorkArea;
 }
 
 
@@ -95,4 +97,38 @@ public:
 
 
 
+// Class used to compute induced alignments between an anchor
+// oriented read and many other oriented reads.
+// The marker graph vertices of the anchor oriented read are gathered
+// and sorted once (Assembler::setInducedAlignmentAnchor).
+// After that, each induced alignment is computed with a linear
+// merge of sorted vertices (Assembler::computeInducedAlignment).
+// The vectors are reused, so a single InducedAlignmentWorkArea
+// can be used for many anchors without memory allocation activity.
+class shasta::InducedAlignmentWorkArea {
+public:
+
+    // A marker of an oriented read that is on a marker graph vertex.
+    class Vertex {
+    public:
+        MarkerGraph::VertexId vertexId;
+        uint32_t ordinal;
+        uint32_t compressedOrdinal;
+
+        bool operator<(const Vertex& that) const
+        {
+            return tie(vertexId, ordinal) < tie(that.vertexId, that.ordinal);
+        }
+    };
+
+    // The anchor oriented read and its vertices, sorted by vertex id.
+    OrientedReadId orientedReadId0;
+    vector<Vertex> vertices0;
+
+    // The vertices of the other oriented read, sorted by vertex id.
+    vector<Vertex> vertices1;
+};
+
+
+
 #endif
@@ -10,7 +10,14 @@ namespace shasta {
     // Type used to represent a k-mer.
     // This limits the maximum k-mer length that can be used.
     // If this changes, KmerId must also be changed.
+    // Builds with long k-mers use a table-free KmerChecker
+    // (see KmerChecker.hpp) because a table of all 4^k
+    // k-mers would be too large.
+#ifdef SHASTA_LONG_KMERS
+    using Kmer = ShortBaseSequence32;
+#else
     using Kmer = ShortBaseSequence16;
+#endif
     static_assert(
         std::numeric_limits<KmerId>::digits == 2*Kmer::capacity,
         "Kmer and KmerId types are inconsistent.");
@@ -0,0 +1,115 @@
+#ifndef SHASTA_KMER_CHECKER_HPP
+#define SHASTA_KMER_CHECKER_HPP
+
+/*******************************************************************************
+
+Class KmerChecker is used to decide which k-mers are markers
+and to get the reverse complement and hash of a KmerId.
+
+It works in one of two ways:
+
+- Using the dense k-mer table of all 4^k k-mers (Assembler::kmerTable).
+  This is used in the default build, where k <= 16.
+
+- Using a hash of the canonical KmerId, with no table at all.
+  This is used in builds with long k-mers (SHASTA_LONG_KMERS), where
+  a table of all 4^k k-mers would be too large.
+  A k-mer is a marker if the hash of the smaller of its KmerId
+  and the KmerId of its reverse complement is less than
+  a threshold. This guarantees that a k-mer is a marker
+  if and only if its reverse complement is also a marker.
+
+*******************************************************************************/
+
+#include "Kmer.hpp"
+#include "MemoryMappedVector.hpp"
+#include "MurmurHash2.hpp"
+#include "SHASTA_ASSERT.hpp"
+
+#include <algorithm>
+
+namespace shasta {
+    class KmerChecker;
+}
+
+
+
+class shasta::KmerChecker {
+public:
+
+    // Use the dense k-mer table.
+    explicit KmerChecker(const MemoryMapped::Vector<KmerInfo>& kmerTable) :
+        kmerTable(&kmerTable)
+    {}
+
+    // Use a hash of the canonical KmerId.
+    KmerChecker(uint64_t k, uint64_t hashThreshold, uint64_t hashSeed) :
+        k(k),
+        hashThreshold(hashThreshold),
+        hashSeed(hashSeed)
+    {
+        SHASTA_ASSERT(k > 0 and k <= Kmer::capacity);
+    }
+
+    bool isMarker(KmerId kmerId) const
+    {
+        if(kmerTable) {
+            return (*kmerTable)[kmerId].isMarker;
+        }
+        const uint64_t canonicalKmerId = std::min(uint64_t(kmerId), uint64_t(reverseComplement(kmerId)));
+        return MurmurHash64A(&canonicalKmerId, sizeof(canonicalKmerId), hashSeed) < hashThreshold;
+    }
+
+    KmerId reverseComplement(KmerId kmerId) const
+    {
+        if(kmerTable) {
+            return (*kmerTable)[kmerId].reverseComplementedKmerId;
+        }
+
+        // The KmerId contains the least significant bits of the bases in its
+        // low k bits and the most significant bits in the next k bits,
+        // with the first base in the most significant position of each group.
+        // Complementing a base flips both of its bits, so the reverse complement
+        // is obtained by complementing and reversing each group of k bits.
+        const uint64_t mask = (k == 32) ? ~0ULL : ((1ULL << k) - 1ULL);
+        const uint64_t lsb = reverseBits(~uint64_t(kmerId) & mask);
+        const uint64_t msb = reverseBits(~(uint64_t(kmerId) >> k) & mask);
+        return KmerId((msb << k) | lsb);
+    }
+
+    // Hash function of the KmerId, used for downsampling markers
+    // for alignments using method 3.
+    // It is the same for a k-mer and its reverse complement.
+    uint32_t hash(KmerId kmerId) const
+    {
+        if(kmerTable) {
+            return (*kmerTable)[kmerId].hash;
+        }
+        const uint64_t n = uint64_t(kmerId) + uint64_t(reverseComplement(kmerId));
+        return MurmurHash2(&n, sizeof(n), 13477);
+    }
+
+private:
+
+    // If not null, the dense k-mer table is used
+    // and the remaining fields are not used.
+    const MemoryMapped::Vector<KmerInfo>* kmerTable = 0;
+
+    uint64_t k = 0;
+    uint64_t hashThreshold = 0;
+    uint64_t hashSeed = 0;
+
+    // Reverse the low k bits of x. The other bits of x must be zero.
+    uint64_t reverseBits(uint64_t x) const
+    {
+        x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+        x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+        x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+        x = ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+        x = ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+        x = (x >> 32) | (x << 32);
+        return x >> (64 - k);
+    }
+};
+
+#endif
@@ -2,7 +2,7 @@
 #include "LocalMarkerGraph.hpp"
 #include "approximateTopologicalSort.hpp"
 #include "findMarkerId.hpp"
-#include "orderPairs.hpp"
+#include "MurmurHash2.hpp"
 using namespace shasta;
 
 // Boost libraries.
@@ -182,8 +182,11 @@ void LocalMarkerGraph::storeEdgeInfo(
     LocalMarkerGraph& graph = *this;
     LocalMarkerGraphEdge& edge = graph[e];
 
-    // Map to store the oriented read ids and ordinals, grouped by sequence.
-    std::map<LocalMarkerGraphEdge::Sequence, vector<MarkerIntervalWithRepeatCounts> > sequenceTable;
+    // Hash table to store the oriented read ids and ordinals, grouped by sequence.
+    std::unordered_map<
+        LocalMarkerGraphEdge::Sequence,
+        vector<MarkerIntervalWithRepeatCounts>,
+        LocalMarkerGraphEdge::Sequence::Hash> sequenceTable;
     for(const MarkerInterval& interval: intervals) {
         const CompressedMarker& marker0 = markers.begin(interval.orientedReadId.getValue())[interval.ordinals[0]];
         const CompressedMarker& marker1 = markers.begin(interval.orientedReadId.getValue())[interval.ordinals[1]];
@@ -263,11 +266,28 @@ void LocalMarkerGraph::storeEdgeInfo(
     copy(sequenceTable.begin(), sequenceTable.end(), back_inserter(edge.infos));
 
     // Sort by decreasing size of the infos vector.
+    // Ties are broken by sequence, so the order does not depend
+    // on the order of the hash table.
     sort(edge.infos.begin(), edge.infos.end(),
-        OrderPairsBySizeOfSecondGreater<
-        LocalMarkerGraphEdge::Sequence,
-        vector<MarkerIntervalWithRepeatCounts> >());
+        [](
+            const pair<LocalMarkerGraphEdge::Sequence, vector<MarkerIntervalWithRepeatCounts> >& x,
+            const pair<LocalMarkerGraphEdge::Sequence, vector<MarkerIntervalWithRepeatCounts> >& y)
+        {
+            if(x.second.size() != y.second.size()) {
+                return x.second.size() > y.second.size();
+            }
+            return x.first < y.first;
+        });
+}
 
+
+
+uint64_t LocalMarkerGraphEdge::Sequence::Hash::operator()(const Sequence& sequence) const
+{
+    return MurmurHash64A(
+        sequence.sequence.data(),
+        int(sequence.sequence.size() * sizeof(Base)),
+        sequence.overlappingBaseCount);
 }
 
 
@@ -24,6 +24,9 @@ a group of aligned markers.
 // Boost libraries.
 #include <boost/graph/adjacency_list.hpp>
 
+// Standard library.
+#include <unordered_map>
+
 namespace shasta {
 
     class LocalMarkerGraphVertex;
@@ -133,6 +136,17 @@ public:
             return tie(overlappingBaseCount, sequence) <
                 tie(that.overlappingBaseCount, that.sequence);
         }
+        bool operator==(const Sequence& that) const
+        {
+            return tie(overlappingBaseCount, sequence) ==
+                tie(that.overlappingBaseCount, that.sequence);
+        }
+
+        // Hash function, used to group marker intervals by sequence.
+        class Hash {
+        public:
+            uint64_t operator()(const Sequence&) const;
+        };
     };
 
 
@@ -286,7 +300,7 @@ public:
 private:
 
     // Map a global vertex id to a vertex descriptor for the local graph.
-    std::map<MarkerGraph::VertexId, vertex_descriptor> vertexMap;
+    std::unordered_map<MarkerGraph::VertexId, vertex_descriptor> vertexMap;
 
     // Reads representation: 0 = raw, 1 = RLE.
     uint64_t readRepresentation;
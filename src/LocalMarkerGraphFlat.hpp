@@ -0,0 +1,122 @@
+#ifndef SHASTA_LOCAL_MARKER_GRAPH_FLAT_HPP
+#define SHASTA_LOCAL_MARKER_GRAPH_FLAT_HPP
+
+/*******************************************************************************
+
+Class LocalMarkerGraphFlat stores a local subgraph of the global marker
+graph in flat vectors, without using the Boost Graph library.
+It is filled by Assembler::extractLocalMarkerGraphFlat, and contains
+the same vertices and edges that Assembler::extractLocalMarkerGraph
+puts in a LocalMarkerGraph, in the same order.
+
+Vertices and edges are identified by their index in the vertices and
+edges vectors (local ids). The mapping from global VertexId to local id
+uses two vectors indexed by global VertexId: a "visit epoch"
+and the local id. A global vertex is in the local graph if its
+visit epoch is equal to the current epoch. Incrementing the epoch
+empties the local graph in constant time, so the same
+LocalMarkerGraphFlat object can be reused for many extractions
+without ever clearing or reallocating the vectors indexed by
+global VertexId. These vectors are only allocated at the first use.
+
+*******************************************************************************/
+
+// Shasta.
+#include "MarkerGraph.hpp"
+#include "SHASTA_ASSERT.hpp"
+
+// Standard library.
+#include "algorithm.hpp"
+#include "cstdint.hpp"
+#include <limits>
+#include "vector.hpp"
+
+namespace shasta {
+    class LocalMarkerGraphFlat;
+}
+
+
+
+class shasta::LocalMarkerGraphFlat {
+public:
+
+    class Vertex {
+    public:
+        MarkerGraph::VertexId vertexId;
+
+        // The distance from the start vertex.
+        uint64_t distance;
+    };
+    vector<Vertex> vertices;
+
+    class Edge {
+    public:
+        // Local ids of the source and target vertices.
+        uint64_t source;
+        uint64_t target;
+
+        // The global id of this edge.
+        MarkerGraph::EdgeId edgeId;
+    };
+    vector<Edge> edges;
+
+    static const uint64_t invalidLocalVertexId = std::numeric_limits<uint64_t>::max();
+
+    // Empty the local graph and prepare for a global marker graph
+    // with the given number of vertices.
+    void clear(uint64_t globalVertexCount)
+    {
+        vertices.clear();
+        edges.clear();
+
+        if(vertexEpoch.size() != globalVertexCount) {
+            vertexEpoch.clear();
+            vertexEpoch.resize(globalVertexCount, 0);
+            localVertexId.resize(globalVertexCount);
+            epoch = 0;
+        }
+
+        // Epoch 0 is never used, so a newly allocated vertexEpoch
+        // vector does not mark any vertex as present.
+        // In the unlikely event that the epoch wraps around,
+        // reset vertexEpoch.
+        ++epoch;
+        if(epoch == 0) {
+            fill(vertexEpoch.begin(), vertexEpoch.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    // Return the local id of the vertex with the given global VertexId,
+    // or invalidLocalVertexId if the vertex is not in the local graph.
+    uint64_t getLocalVertexId(MarkerGraph::VertexId vertexId) const
+    {
+        if(vertexEpoch[vertexId] == epoch) {
+            return localVertexId[vertexId];
+        } else {
+            return invalidLocalVertexId;
+        }
+    }
+
+    // Add a vertex with the given global VertexId and return its local id.
+    // The vertex must not already be in the local graph.
+    uint64_t addVertex(MarkerGraph::VertexId vertexId, uint64_t distance)
+    {
+        SHASTA_ASSERT(vertexEpoch[vertexId] != epoch);
+        const uint64_t v = vertices.size();
+        SHASTA_ASSERT(v < std::numeric_limits<uint32_t>::max());
+        vertices.push_back({vertexId, distance});
+        vertexEpoch[vertexId] = epoch;
+        localVertexId[vertexId] = uint32_t(v);
+        return v;
+    }
+
+private:
+
+    // Indexed by global VertexId.
+    vector<uint32_t> vertexEpoch;
+    vector<uint32_t> localVertexId;
+    uint32_t epoch = 0;
+};
+
+#endif
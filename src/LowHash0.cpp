@@ -1,6 +1,6 @@
 // Shasta.
 #include "LowHash0.hpp"
-#include "MurmurHash2.hpp"
+#include "featureHashes.hpp"
 #include "performanceLog.hpp"
 #include "ReadFlags.hpp"
 #include "timestamp.hpp"
@@ -313,8 +313,8 @@ void LowHash0::createKmerIds(size_t threadId)
 // and prepare the buckets for filling.
 void LowHash0::pass1ThreadFunction(size_t threadId)
 {
-    const int featureByteCount = int(m * sizeof(KmerId));
     const uint64_t seed = iteration * 37;
+    vector<uint64_t> featureHashes;
 
     // Loop over batches assigned to this thread.
     uint64_t begin, end;
@@ -339,14 +339,16 @@ void LowHash0::pass1ThreadFunction(size_t threadId)
                 }
 
 
-                // Get the markers for this oriented read.
-                KmerId* kmerIdsPointer = kmerIds.begin(orientedReadId.getValue());
+                // Hash the features of this oriented read.
+                // Features are sequences of m consecutive markers.
                 const size_t featureCount = markerCount - m + 1;
+                featureHashes.resize(featureCount);
+                computeFeatureHashes(kmerIds.begin(orientedReadId.getValue()),
+                    markerCount, m, seed, featureHashes.data());
 
-                // Loop over features of this oriented read.
-                // Features are sequences of m consecutive markers.
-                for(size_t j=0; j<featureCount; j++, kmerIdsPointer++) {
-                    const uint64_t hash = MurmurHash64A(kmerIdsPointer, featureByteCount, seed);
+                // Keep the low hashes.
+                for(size_t j=0; j<featureCount; j++) {
+                    const uint64_t hash = featureHashes[j];
                     if(hash < hashThreshold) {
                         orientedReadLowHashes.push_back(hash);
                         const uint64_t bucketId = hash & mask;
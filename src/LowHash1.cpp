@@ -1,8 +1,8 @@
 // Shasta.
 #include "LowHash1.hpp"
 #include "AlignmentCandidates.hpp"
+#include "featureHashes.hpp"
 #include "Marker.hpp"
-#include "MurmurHash2.hpp"
 using namespace shasta;
 
 // Standad library.
@@ -233,8 +233,8 @@ void LowHash1::createKmerIds(size_t threadId)
 // and count the number of entries in each bucket.
 void LowHash1::computeHashesThreadFunction(size_t threadId)
 {
-    const int featureByteCount = int(m * sizeof(KmerId));
     const uint64_t seed = iteration * 37;
+    vector<uint64_t> featureHashes;
 
     // Loop over batches assigned to this thread.
     uint64_t begin, end;
@@ -258,14 +258,16 @@ void LowHash1::computeHashesThreadFunction(size_t threadId)
                     continue;
                 }
 
-                // Get the markers for this oriented read.
-                KmerId* kmerIdsPointer = kmerIds.begin(orientedReadId.getValue());
+                // Hash the features of this oriented read.
+                // Features are sequences of m consecutive markers.
                 const size_t featureCount = markerCount - m + 1;
+                featureHashes.resize(featureCount);
+                computeFeatureHashes(kmerIds.begin(orientedReadId.getValue()),
+                    markerCount, m, seed, featureHashes.data());
 
-                // Loop over features of this oriented read.
-                // Features are sequences of m consecutive markers.
-                for(size_t j=0; j<featureCount; j++, kmerIdsPointer++) {
-                    const uint64_t hash = MurmurHash64A(kmerIdsPointer, featureByteCount, seed);
+                // Keep the low hashes.
+                for(size_t j=0; j<featureCount; j++) {
+                    const uint64_t hash = featureHashes[j];
                     if(hash < hashThreshold) {
                         orientedReadLowHashes.push_back(make_pair(hash, j));
                         const uint64_t bucketId = hash & mask;
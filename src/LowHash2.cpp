@@ -0,0 +1,372 @@
+// Shasta.
+#include "LowHash2.hpp"
+#include "AlignmentCandidates.hpp"
+#include "featureHashes.hpp"
+#include "Marker.hpp"
+#include "timestamp.hpp"
+using namespace shasta;
+
+// Standad library.
+#include "algorithm.hpp"
+#include "chrono.hpp"
+#include "fstream.hpp"
+#include "stdexcept.hpp"
+
+#include "MultithreadedObject.tpp"
+template class MultithreadedObject<LowHash2>;
+
+
+
+LowHash2::LowHash2(
+    size_t m,                       // Number of consecutive markers that define a feature.
+    double hashFraction,
+    size_t minBucketSize,           // The minimum frequency for a feature to be used.
+    size_t maxBucketSize,           // The maximum frequency for a feature to be used.
+    size_t minFrequency,            // Minimum number of chained common features for a pair to be considered a candidate.
+    size_t maxDrift,                // Maximum offset difference between chained common features.
+    size_t threadCountArgument,
+    const Reads& reads,
+    const MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t>& markers,
+    AlignmentCandidates& candidates,
+    const string& largeDataFileNamePrefix,
+    size_t largeDataPageSize
+    ) :
+    MultithreadedObject(*this),
+    m(m),
+    minBucketSize(minBucketSize),
+    maxBucketSize(maxBucketSize),
+    minFrequency(minFrequency),
+    maxDrift(maxDrift),
+    threadCount(threadCountArgument),
+    reads(reads),
+    markers(markers),
+    candidates(candidates)
+{
+    // maxDrift is compared with differences of int32_t offsets.
+    if(maxDrift > uint64_t(std::numeric_limits<int32_t>::max())) {
+        throw runtime_error("LowHash2: maxDrift " + to_string(maxDrift) + " is too large.");
+    }
+
+    cout << timestamp << "LowHash2 begins." << endl;
+    const auto tBegin = steady_clock::now();
+
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    // Compute the threshold for a hash value to be considered low.
+    hashThreshold = uint64_t(hashFraction * double(std::numeric_limits<uint64_t>::max()));
+
+    // Estimate the total number of low hash features, as in LowHash1,
+    // and use a number of buckets that gives a load factor
+    // between 1/8 and 1/4.
+    const uint64_t totalLowHashCountEstimate =
+        max(uint64_t(1), uint64_t(hashFraction * double(markers.totalSize())));
+    const uint64_t log2TotalLowHashCountEstimate = 64 - __builtin_clzl(totalLowHashCountEstimate);
+    const uint64_t log2BucketCount = 2 + log2TotalLowHashCountEstimate;
+    const uint64_t bucketCount = 1ULL << log2BucketCount;
+    mask = bucketCount - 1;
+    cout << "LowHash2 algorithm will use 2^" << log2BucketCount;
+    cout << " = " << bucketCount << " buckets. "<< endl;
+    cout << "Estimated number of low hash features " << totalLowHashCountEstimate << endl;
+
+    // The number of oriented reads, each with its own vector of markers.
+    const OrientedReadId::Int orientedReadCount = OrientedReadId::Int(markers.size());
+    const ReadId readCount = orientedReadCount / 2;
+    SHASTA_ASSERT(orientedReadCount == 2*readCount);
+
+    // Store the low hash features of all oriented reads in the buckets.
+    // This is the inverted index used to find common features.
+    cout << timestamp << "Filling the LowHash2 buckets." << endl;
+    buckets.createNew(
+        largeDataFileNamePrefix.empty() ? "" : (largeDataFileNamePrefix + "tmp-LowHash2-Buckets"),
+        largeDataPageSize);
+    buckets.beginPass1(bucketCount);
+    const size_t batchSize = 10000;
+    setupLoadBalancing(readCount, batchSize);
+    runThreads(&LowHash2::fillBucketsPass1, threadCount);
+    buckets.beginPass2();
+    setupLoadBalancing(readCount, batchSize);
+    runThreads(&LowHash2::fillBucketsPass2, threadCount);
+    buckets.endPass2(false, false);
+    cout << "Stored " << buckets.totalSize() << " low hash features. Load factor " <<
+        double(buckets.totalSize()) / double(buckets.size()) << endl;
+
+    // Find the alignment candidates.
+    // The reads are processed in chunks, and the candidates of each chunk
+    // are stored in order of increasing readId0.
+    cout << timestamp << "Finding alignment candidates using LowHash2." << endl;
+    chainLengthHistogram.clear();
+    const ReadId chunkSize = 100000;
+    for(chunkBegin=0; chunkBegin<readCount; chunkBegin+=chunkSize) {
+        const ReadId chunkEnd = min(readCount, chunkBegin + chunkSize);
+        chunkCandidates.clear();
+        chunkCandidates.resize(chunkEnd - chunkBegin);
+        setupLoadBalancing(chunkEnd - chunkBegin, 100);
+        runThreads(&LowHash2::findCandidatesThreadFunction, threadCount);
+
+        for(const vector<Candidate>& readCandidates: chunkCandidates) {
+            for(const Candidate& candidate: readCandidates) {
+                candidates.candidates.push_back(candidate.orientedReadPair);
+                candidates.featureOrdinals.appendVector(candidate.featureOrdinals);
+            }
+        }
+    }
+    chunkCandidates.clear();
+    chunkCandidates.shrink_to_fit();
+    SHASTA_ASSERT(candidates.candidates.size() == candidates.featureOrdinals.size());
+    cout << timestamp << "Found " << candidates.candidates.size() <<
+        " alignment candidates with " <<
+        candidates.featureOrdinals.totalSize() << " chained common features." << endl;
+
+    // Write the histogram of chain lengths.
+    {
+        ofstream csv("LowHash2ChainLengthHistogram.csv");
+        csv << "ChainLength,PairCount\n";
+        for(uint64_t chainLength=0; chainLength<chainLengthHistogram.size(); chainLength++) {
+            const uint64_t pairCount = chainLengthHistogram[chainLength];
+            if(pairCount) {
+                csv << chainLength << "," << pairCount << "\n";
+            }
+        }
+    }
+
+    // Clean up.
+    buckets.remove();
+
+    // Done.
+    const auto tEnd = steady_clock::now();
+    const double tTotal = seconds(tEnd - tBegin);
+    cout << timestamp << "LowHash2 completed in " << tTotal << " s." << endl;
+}
+
+
+
+// Compute the low hash features of an oriented read.
+// Features are sequences of m consecutive markers.
+void LowHash2::computeLowHashes(
+    OrientedReadId orientedReadId,
+    vector<KmerId>& kmerIds,
+    vector<uint64_t>& featureHashes,
+    vector< pair<uint64_t, uint32_t> >& lowHashes) const
+{
+    lowHashes.clear();
+
+    // Handle the pathological case where there are fewer than m markers.
+    const auto orientedReadMarkers = markers[orientedReadId.getValue()];
+    const uint64_t markerCount = orientedReadMarkers.size();
+    if(markerCount < m) {
+        return;
+    }
+
+    // Gather the k-mer ids, so we can hash them directly.
+    kmerIds.clear();
+    for(const CompressedMarker& marker: orientedReadMarkers) {
+        kmerIds.push_back(marker.kmerId);
+    }
+
+    const uint64_t seed = 0;
+    const uint64_t featureCount = markerCount - m + 1;
+    featureHashes.resize(featureCount);
+    computeFeatureHashes(kmerIds.data(), markerCount, m, seed, featureHashes.data());
+    for(uint64_t ordinal=0; ordinal<featureCount; ordinal++) {
+        const uint64_t hash = featureHashes[ordinal];
+        if(hash < hashThreshold) {
+            lowHashes.push_back(make_pair(hash, uint32_t(ordinal)));
+        }
+    }
+}
+
+
+
+void LowHash2::fillBucketsPass1(size_t /* threadId */)
+{
+    vector<KmerId> kmerIds;
+    vector<uint64_t> featureHashes;
+    vector< pair<uint64_t, uint32_t> > lowHashes;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(ReadId readId=ReadId(begin); readId!=ReadId(end); readId++) {
+            if(reads.getFlags(readId).isPalindromic) {
+                continue;
+            }
+            for(Strand strand=0; strand<2; strand++) {
+                computeLowHashes(OrientedReadId(readId, strand), kmerIds, featureHashes, lowHashes);
+                for(const auto& p: lowHashes) {
+                    buckets.incrementCountMultithreaded(p.first & mask);
+                }
+            }
+        }
+    }
+}
+
+
+
+void LowHash2::fillBucketsPass2(size_t /* threadId */)
+{
+    vector<KmerId> kmerIds;
+    vector<uint64_t> featureHashes;
+    vector< pair<uint64_t, uint32_t> > lowHashes;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(ReadId readId=ReadId(begin); readId!=ReadId(end); readId++) {
+            if(reads.getFlags(readId).isPalindromic) {
+                continue;
+            }
+            for(Strand strand=0; strand<2; strand++) {
+                const OrientedReadId orientedReadId(readId, strand);
+                computeLowHashes(orientedReadId, kmerIds, featureHashes, lowHashes);
+                for(const auto& p: lowHashes) {
+                    buckets.storeMultithreaded(p.first & mask,
+                        BucketEntry(orientedReadId, p.second, p.first));
+                }
+            }
+        }
+    }
+}
+
+
+
+void LowHash2::findCandidatesThreadFunction(size_t /* threadId */)
+{
+    vector<KmerId> kmerIds;
+    vector<uint64_t> featureHashes;
+    vector< pair<uint64_t, uint32_t> > lowHashes;
+    vector<CommonFeature> commonFeatures;
+    vector<uint64_t> threadChainLengthHistogram;
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(ReadId readId0=chunkBegin+ReadId(begin); readId0!=chunkBegin+ReadId(end); readId0++) {
+            if(reads.getFlags(readId0).isPalindromic) {
+                continue;
+            }
+
+            // Use the buckets to find the common features of (readId0, 0)
+            // with oriented reads with readId1 > readId0.
+            // Features that are too frequent or too rare are skipped.
+            computeLowHashes(OrientedReadId(readId0, 0), kmerIds, featureHashes, lowHashes);
+            commonFeatures.clear();
+            for(const auto& p: lowHashes) {
+                const uint64_t hash = p.first;
+                const uint32_t ordinal0 = p.second;
+                const uint32_t hashCheck = uint32_t(hash >> 32);
+                const auto bucket = buckets[hash & mask];
+
+                uint64_t frequency = 0;
+                for(const BucketEntry& entry: bucket) {
+                    if(entry.hashCheck == hashCheck) {
+                        ++frequency;
+                    }
+                }
+                if(frequency < minBucketSize or frequency > maxBucketSize) {
+                    continue;
+                }
+
+                for(const BucketEntry& entry: bucket) {
+                    if(entry.hashCheck != hashCheck) {
+                        continue;
+                    }
+                    const ReadId readId1 = entry.orientedReadId.getReadId();
+                    if(readId1 <= readId0) {
+                        continue;
+                    }
+                    CommonFeature commonFeature;
+                    commonFeature.readId1 = readId1;
+                    commonFeature.isSameStrand = (entry.orientedReadId.getStrand() == 0);
+                    commonFeature.offset = int32_t(entry.ordinal) - int32_t(ordinal0);
+                    commonFeature.ordinal0 = ordinal0;
+                    commonFeature.ordinal1 = entry.ordinal;
+                    commonFeatures.push_back(commonFeature);
+                }
+            }
+            sort(commonFeatures.begin(), commonFeatures.end());
+
+            // Chain the common features of each (readId1, isSameStrand).
+            vector<Candidate>& readCandidates = chunkCandidates[readId0 - chunkBegin];
+            for(auto it=commonFeatures.begin(); it!=commonFeatures.end(); /* Increment later */) {
+                auto streakEnd = it;
+                while(streakEnd != commonFeatures.end() and
+                    streakEnd->readId1 == it->readId1 and
+                    streakEnd->isSameStrand == it->isSameStrand) {
+                    ++streakEnd;
+                }
+                const uint64_t chainLength = chain(readId0, span<const CommonFeature>(it, streakEnd), readCandidates);
+                if(chainLength >= threadChainLengthHistogram.size()) {
+                    threadChainLengthHistogram.resize(chainLength + 1, 0);
+                }
+                ++threadChainLengthHistogram[chainLength];
+                it = streakEnd;
+            }
+        }
+    }
+
+    // Add this thread's histogram to the global histogram.
+    std::lock_guard<std::mutex> lock(mutex);
+    if(chainLengthHistogram.size() < threadChainLengthHistogram.size()) {
+        chainLengthHistogram.resize(threadChainLengthHistogram.size(), 0);
+    }
+    for(uint64_t i=0; i<threadChainLengthHistogram.size(); i++) {
+        chainLengthHistogram[i] += threadChainLengthHistogram[i];
+    }
+}
+
+
+
+uint64_t LowHash2::chain(
+    ReadId readId0,
+    span<const CommonFeature> commonFeatures,
+    vector<Candidate>& readCandidates) const
+{
+    SHASTA_ASSERT(not commonFeatures.empty());
+
+    // The common features are sorted by offset.
+    // Find the largest window of common features with offsets
+    // that differ by at most maxDrift.
+    uint64_t bestBegin = 0;
+    uint64_t bestEnd = 0;
+    uint64_t j = 0;
+    for(uint64_t i=0; i<commonFeatures.size(); i++) {
+        while(j<commonFeatures.size() and
+            commonFeatures[j].offset - commonFeatures[i].offset <= int32_t(maxDrift)) {
+            ++j;
+        }
+        if(j - i > bestEnd - bestBegin) {
+            bestBegin = i;
+            bestEnd = j;
+        }
+    }
+
+    // Sort the common features in the window by ordinals,
+    // then only keep the ones that are strictly increasing in both ordinals.
+    // This removes duplicates due to features repeated in one of the two reads.
+    vector< array<uint32_t, 2> > featureOrdinals;
+    for(uint64_t i=bestBegin; i!=bestEnd; i++) {
+        featureOrdinals.push_back({commonFeatures[i].ordinal0, commonFeatures[i].ordinal1});
+    }
+    sort(featureOrdinals.begin(), featureOrdinals.end());
+    uint64_t chainLength = 0;
+    for(uint64_t i=0; i<featureOrdinals.size(); i++) {
+        if(chainLength == 0 or
+            (featureOrdinals[i][0] > featureOrdinals[chainLength-1][0] and
+            featureOrdinals[i][1] > featureOrdinals[chainLength-1][1])) {
+            featureOrdinals[chainLength++] = featureOrdinals[i];
+        }
+    }
+    featureOrdinals.resize(chainLength);
+
+    // If the chain is long enough, generate an alignment candidate.
+    if(chainLength >= minFrequency) {
+        readCandidates.resize(readCandidates.size() + 1);
+        Candidate& candidate = readCandidates.back();
+        candidate.orientedReadPair = OrientedReadPair(
+            readId0,
+            commonFeatures.front().readId1,
+            commonFeatures.front().isSameStrand);
+        candidate.featureOrdinals.swap(featureOrdinals);
+    }
+    return chainLength;
+}
@@ -0,0 +1,163 @@
+#ifndef SHASTA_LOW_HASH2_HPP
+#define SHASTA_LOW_HASH2_HPP
+
+// Shasta
+#include "Kmer.hpp"
+#include "MemoryMappedVectorOfVectors.hpp"
+#include "MultithreadedObject.hpp"
+#include "OrientedReadPair.hpp"
+#include "Reads.hpp"
+
+// Standard library.
+#include "array.hpp"
+#include "span.hpp"
+#include "tuple.hpp"
+#include "vector.hpp"
+
+namespace shasta {
+    class AlignmentCandidates;
+    class LowHash2;
+    class CompressedMarker;
+
+    extern template class MultithreadedObject<LowHash2>;
+}
+
+
+
+// This class finds candidate pairs of aligned reads
+// in a single pass, without the iterations used by LowHash0 and LowHash1.
+// It is used with --MinHash.version 2.
+// As in LowHash1, features are sequences of m consecutive markers,
+// and only features with a low hash are used.
+// These sparse features of all oriented reads are stored
+// in a single inverted index.
+// Then, for each read on strand 0, the index is used to find
+// the oriented reads that share features with it,
+// together with the offset (ordinal1 - ordinal0) of each common feature.
+// Common features of two truly overlapping oriented reads have similar offsets
+// (they lie close to the same diagonal of the alignment matrix).
+// So for each pair we find the largest group of common features
+// with offsets that differ by at most maxDrift markers (a chain).
+// The pair becomes an alignment candidate if this chain
+// contains at least minFrequency common features.
+// The features of the chain are stored in alignmentCandidates.featureOrdinals,
+// and give an estimate of the offset between the two oriented reads.
+class shasta::LowHash2 :
+    public MultithreadedObject<LowHash2> {
+public:
+
+    // The constructor does all the work.
+    LowHash2(
+        size_t m,                       // Number of consecutive markers that define a feature.
+        double hashFraction,
+        size_t minBucketSize,           // The minimum frequency for a feature to be used.
+        size_t maxBucketSize,           // The maximum frequency for a feature to be used.
+        size_t minFrequency,            // Minimum number of chained common features for a pair to be considered a candidate.
+        size_t maxDrift,                // Maximum offset difference between chained common features.
+        size_t threadCount,
+        const Reads& reads,
+        const MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t>&,
+        AlignmentCandidates& candidates,
+        const string& largeDataFileNamePrefix,
+        size_t largeDataPageSize
+    );
+
+private:
+
+    // Store some of the arguments passed to the constructor.
+    size_t m;
+    size_t minBucketSize;
+    size_t maxBucketSize;
+    size_t minFrequency;
+    size_t maxDrift;
+    size_t threadCount;
+    const Reads& reads;
+    const MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t>& markers;
+    AlignmentCandidates& candidates;
+
+    // The threshold for a hash value to be considered low.
+    uint64_t hashThreshold;
+
+    // The mask used to compute the bucket corresponding to a hash value.
+    uint64_t mask;
+
+    // Compute the low hash features of an oriented read.
+    // Each is stored as a pair(hash, ordinal).
+    void computeLowHashes(
+        OrientedReadId,
+        vector<KmerId>& kmerIds,
+        vector<uint64_t>& featureHashes,
+        vector< pair<uint64_t, uint32_t> >& lowHashes) const;
+
+    // Each bucket entry describes a low hash feature.
+    // It consists of an oriented read id, the ordinal where the
+    // feature appears, and the high 32 bits of the hash, which are
+    // used to skip entries for other features in the same bucket.
+    class BucketEntry {
+    public:
+        OrientedReadId orientedReadId;
+        uint32_t ordinal;
+        uint32_t hashCheck;
+        BucketEntry(
+            OrientedReadId orientedReadId,
+            uint32_t ordinal,
+            uint64_t hash) :
+            orientedReadId(orientedReadId),
+            ordinal(ordinal),
+            hashCheck(uint32_t(hash >> 32)) {}
+        BucketEntry() {}
+    };
+    MemoryMapped::VectorOfVectors<BucketEntry, uint64_t> buckets;
+    void fillBucketsPass1(size_t threadId);
+    void fillBucketsPass2(size_t threadId);
+
+
+
+    // A common feature between (readId0, 0) and another oriented read,
+    // found using the buckets.
+    class CommonFeature {
+    public:
+        ReadId readId1;
+        bool isSameStrand;
+        int32_t offset;     // ordinal1 - ordinal0
+        uint32_t ordinal0;
+        uint32_t ordinal1;
+        bool operator<(const CommonFeature& that) const {
+            return tie(readId1, isSameStrand, offset, ordinal0) <
+                tie(that.readId1, that.isSameStrand, that.offset, that.ordinal0);
+        }
+    };
+
+    // An alignment candidate and the ordinals of its chained common features.
+    class Candidate {
+    public:
+        OrientedReadPair orientedReadPair;
+        vector< array<uint32_t, 2> > featureOrdinals;
+    };
+
+    // The reads are processed in chunks, to keep memory bounded.
+    // For each read in the current chunk, this contains the
+    // alignment candidates for which the read is readId0.
+    // They are stored in order at the end of each chunk.
+    ReadId chunkBegin;
+    vector< vector<Candidate> > chunkCandidates;
+    void findCandidatesThreadFunction(size_t threadId);
+
+    // Find the chain of common features with readId1 that is
+    // most consistent with a single offset, and use it to
+    // create an alignment candidate, if long enough.
+    // The common features must be sorted and all involve the same
+    // readId1 and isSameStrand.
+    // Returns the number of common features in the chain.
+    uint64_t chain(
+        ReadId readId0,
+        span<const CommonFeature>,
+        vector<Candidate>&) const;
+
+    // Histogram of the number of chained common features
+    // for all pairs that had at least one common feature.
+    // Each thread adds to it under the MultithreadedObject mutex.
+    vector<uint64_t> chainLengthHistogram;
+};
+
+#endif
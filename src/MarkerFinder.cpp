@@ -1,5 +1,6 @@
 // shasta.
 #include "MarkerFinder.hpp"
+#include "cpuDispatch.hpp"
 #include "LongBaseSequence.hpp"
 #include "performanceLog.hpp"
 #include "ReadId.hpp"
@@ -15,13 +16,13 @@ template class MultithreadedObject<MarkerFinder>;
 
 MarkerFinder::MarkerFinder(
     size_t k,
-    const MemoryMapped::Vector<KmerInfo>& kmerTable,
+    const KmerChecker& kmerChecker,
     const Reads& reads,
     MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t>& markers,
     size_t threadCountArgument) :
     MultithreadedObject(*this),
     k(k),
-    kmerTable(kmerTable),
+    kmerChecker(kmerChecker),
     reads(reads),
     markers(markers),
     threadCount(threadCountArgument)
@@ -57,6 +58,8 @@ MarkerFinder::MarkerFinder(
 
 void MarkerFinder::threadFunction(size_t threadId)
 {
+    // The k-mer ids of all k-mers of the current read.
+    vector<KmerId> kmerIds;
 
     // Loop over batches assigned to this thread.
     uint64_t begin, end;
@@ -77,13 +80,12 @@ void MarkerFinder::threadFunction(size_t threadId)
             if(read.baseCount >= k) {   // Avoid pathological case.
 
                 // Loop over k-mers of this read.
-                Kmer kmer;
-                for(size_t position=0; position<k; position++) {
-                    kmer.set(position, read[position]);
-                }
-                for(uint32_t position=0; /*The check is done later */; position++) {
-                    const KmerId kmerId = KmerId(kmer.id(k));
-                    if(kmerTable[kmerId].isMarker) {
+                const uint64_t kmerCount = read.baseCount - k + 1;
+                kmerIds.resize(kmerCount);
+                computeKmerIds(read, k, kmerIds.data());
+                for(uint32_t position=0; position<kmerCount; position++) {
+                    const KmerId kmerId = kmerIds[position];
+                    if(kmerChecker.isMarker(kmerId)) {
                         // This k-mer is a marker.
 
                         if(pass == 1) {
@@ -95,20 +97,12 @@ void MarkerFinder::threadFunction(size_t threadId)
                             ++markerPointerStrand0;
 
                             // Strand 1.
-                            markerPointerStrand1->kmerId = kmerTable[kmerId].reverseComplementedKmerId;
+                            markerPointerStrand1->kmerId = kmerChecker.reverseComplement(kmerId);
                             markerPointerStrand1->position = uint32_t(read.baseCount - k - position);
                             --markerPointerStrand1;
 
                         }
                     }
-
-                    if(position+k == read.baseCount) {
-                        break;
-                    }
-
-                    // Update the k-mer.
-                    kmer.shiftLeft();
-                    kmer.set(k-1, read[position+k]);
                 }
             }
 
@@ -125,3 +119,49 @@ void MarkerFinder::threadFunction(size_t threadId)
     }
 
 }
+
+
+
+// Compute the k-mer ids of all read.baseCount - k + 1 k-mers of a read.
+// This is equivalent to computing Kmer::id(k) for a Kmer that is shifted
+// along the read one base at a time, but the k-mers are instead extracted
+// directly from the two bit planes of the read (see LongBaseSequenceView).
+// The loop over the 64 positions in each block of the read uses per-position
+// shift amounts, so it is vectorized in the versions of this
+// dispatched kernel that have variable vector shifts (AVX2 and up).
+SHASTA_CPU_DISPATCH void MarkerFinder::computeKmerIds(
+    const LongBaseSequenceView& read,
+    uint64_t k,
+    KmerId* kmerIds)
+{
+    SHASTA_ASSERT(k > 0 and k <= Kmer::capacity);
+    SHASTA_ASSERT(read.baseCount >= k);
+    const uint64_t kmerCount = read.baseCount - k + 1;
+    const uint64_t blockCount = (read.baseCount + 63) / 64;
+    const uint64_t shift = 64 - k;
+
+    for(uint64_t block=0; block<blockCount; block++) {
+        const uint64_t blockBegin = block * 64;
+        if(blockBegin >= kmerCount) {
+            break;
+        }
+        const uint64_t n = min(uint64_t(64), kmerCount - blockBegin);
+
+        // The two bit planes of this block and of the next one, if any.
+        const uint64_t lsb0 = read.begin[2 * block];
+        const uint64_t msb0 = read.begin[2 * block + 1];
+        const bool isLastBlock = (block + 1 == blockCount);
+        const uint64_t lsb1 = isLastBlock ? 0 : read.begin[2 * block + 2];
+        const uint64_t msb1 = isLastBlock ? 0 : read.begin[2 * block + 3];
+
+        KmerId* blockKmerIds = kmerIds + blockBegin;
+        for(uint64_t offset=0; offset<n; offset++) {
+            // The bits starting at this position, for each of the two bit planes.
+            // (x >> 1) >> (63 - offset) is used instead of x >> (64 - offset)
+            // to avoid a shift by 64 when offset is 0.
+            const uint64_t lsb = (lsb0 << offset) | ((lsb1 >> 1) >> (63 - offset));
+            const uint64_t msb = (msb0 << offset) | ((msb1 >> 1) >> (63 - offset));
+            blockKmerIds[offset] = KmerId(((msb >> shift) << k) | (lsb >> shift));
+        }
+    }
+}
@@ -1,6 +1,7 @@
 #ifndef SHASTA_MARKER_FINDER_HPP
 #define SHASTA_MARKER_FINDER_HPP
 
+#include "KmerChecker.hpp"
 #include "Marker.hpp"
 #include "MultithreadedObject.hpp"
 #include "Reads.hpp"
@@ -26,7 +27,7 @@ public:
     // The constructor does all the work.
     MarkerFinder(
         size_t k,
-        const MemoryMapped::Vector<KmerInfo>& kmerTable,
+        const KmerChecker& kmerChecker,
         const Reads& reads,
         MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t>& markers,
         size_t threadCount);
@@ -35,13 +36,20 @@ private:
 
     // The arguments passed to the constructor.
     size_t k;
-    const MemoryMapped::Vector<KmerInfo>& kmerTable;
+    const KmerChecker& kmerChecker;
     const Reads& reads;
     MemoryMapped::VectorOfVectors<CompressedMarker, uint64_t>& markers;
     size_t threadCount;
 
     void threadFunction(size_t threadId);
 
+    // Compute the k-mer ids of all k-mers of a read.
+    // This is a runtime dispatched kernel (see cpuDispatch.hpp).
+    static void computeKmerIds(
+        const LongBaseSequenceView&,
+        uint64_t k,
+        KmerId*);
+
     // In pass 1, we count the number of markers for each
     // read and call reads->incrementCountMultithreaded.
     // In pass 2, we store the markers.
@@ -4,7 +4,9 @@
 using namespace shasta;
 
 // Standard library.
+#include <bit>
 #include "fstream.hpp"
+#include <thread>
 
 #include "MultithreadedObject.tpp"
 template class MultithreadedObject<MarkerGraph>;
@@ -35,6 +37,7 @@ void MarkerGraph::remove()
     if(edges.isOpen) {
         edges.remove();
     }
+    removeEdgeFlagBitsets();
     if(reverseComplementEdge.isOpen) {
         reverseComplementEdge.remove();
     }
@@ -94,7 +97,7 @@ uint64_t MarkerGraph::inDegree(VertexId vertexId) const
 {
     uint64_t degree = 0;
     for(const EdgeId edgeId: edgesByTarget[vertexId]) {
-        if(not edges[edgeId].wasRemoved()) {
+        if(not edgeWasRemoved(edgeId)) {
             ++degree;
         }
     }
@@ -104,7 +107,7 @@ uint64_t MarkerGraph::outDegree(VertexId vertexId) const
 {
     uint64_t degree = 0;
     for(const EdgeId edgeId: edgesBySource[vertexId]) {
-        if(not edges[edgeId].wasRemoved()) {
+        if(not edgeWasRemoved(edgeId)) {
             ++degree;
         }
     }
@@ -117,7 +120,7 @@ MarkerGraph::EdgeId MarkerGraph::getFirstNonRemovedOutEdge(
     MarkerGraph::VertexId vertexId) const
 {
     for(const EdgeId edgeId: edgesBySource[vertexId]) {
-        if(not edges[edgeId].wasRemoved()) {
+        if(not edgeWasRemoved(edgeId)) {
             return edgeId;
         }
     }
@@ -127,7 +130,7 @@ MarkerGraph::EdgeId MarkerGraph::getFirstNonRemovedInEdge(
     MarkerGraph::VertexId vertexId) const
 {
     for(const EdgeId edgeId: edgesByTarget[vertexId]) {
-        if(not edges[edgeId].wasRemoved()) {
+        if(not edgeWasRemoved(edgeId)) {
             return edgeId;
         }
     }
@@ -136,6 +139,239 @@ MarkerGraph::EdgeId MarkerGraph::getFirstNonRemovedInEdge(
 
 
 
+// Create the structure-of-arrays view of the edge flags.
+void MarkerGraph::createEdgeFlagBitsets(size_t threadCount)
+{
+    removeEdgeFlagBitsets();
+    if(not edges.isOpen) {
+        return;
+    }
+
+    // Adjust the numbers of threads, if necessary.
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    const uint64_t edgeCount = edges.size();
+    const uint64_t wordCount = (edgeCount + 63) >> 6;
+    for(vector<uint64_t>& bits: edgeFlagBitsets.flags) {
+        bits.resize(wordCount, 0);
+    }
+    edgeFlagBitsets.removed.resize(wordCount, 0);
+
+    // Each thread fills entire words, so no synchronization is necessary.
+    const uint64_t batchSize = 1024;
+    setupLoadBalancing(wordCount, batchSize);
+    runThreads(&MarkerGraph::createEdgeFlagBitsetsThreadFunction, threadCount);
+
+    // Only make the bitsets available when they are complete.
+    edgeFlagBitsets.edgeCount = edgeCount;
+}
+
+
+
+void MarkerGraph::createEdgeFlagBitsetsThreadFunction(size_t /* threadId */)
+{
+    const EdgeId edgeCount = edges.size();
+
+    uint64_t begin, end;
+    while(getNextBatch(begin, end)) {
+        for(uint64_t word=begin; word!=end; word++) {
+            array<uint64_t, edgeFlagCount> flagWords;
+            std::fill(flagWords.begin(), flagWords.end(), 0);
+            uint64_t removedWord = 0;
+
+            const EdgeId edgeIdBegin = word << 6;
+            const EdgeId edgeIdEnd = min(edgeCount, edgeIdBegin + 64);
+            for(EdgeId edgeId=edgeIdBegin; edgeId!=edgeIdEnd; edgeId++) {
+                const Edge& edge = edges[edgeId];
+                const uint64_t mask = uint64_t(1) << (edgeId & 63);
+                for(uint64_t i=0; i<edgeFlagCount; i++) {
+                    if(getEdgeFlag(edgeId, EdgeFlag(i))) {
+                        flagWords[i] |= mask;
+                    }
+                }
+                if(edge.wasRemoved()) {
+                    removedWord |= mask;
+                }
+            }
+
+            for(uint64_t i=0; i<edgeFlagCount; i++) {
+                edgeFlagBitsets.flags[i][word] = flagWords[i];
+            }
+            edgeFlagBitsets.removed[word] = removedWord;
+        }
+    }
+}
+
+
+
+void MarkerGraph::removeEdgeFlagBitsets()
+{
+    for(vector<uint64_t>& bits: edgeFlagBitsets.flags) {
+        bits.clear();
+        bits.shrink_to_fit();
+    }
+    edgeFlagBitsets.removed.clear();
+    edgeFlagBitsets.removed.shrink_to_fit();
+    edgeFlagBitsets.edgeCount = 0;
+}
+
+
+
+// Get a flag of an edge from the Edge record.
+bool MarkerGraph::getEdgeFlag(EdgeId edgeId, EdgeFlag flag) const
+{
+    const Edge& edge = edges[edgeId];
+    switch(flag) {
+    case EdgeFlag::wasRemovedByTransitiveReduction:
+        return edge.wasRemovedByTransitiveReduction;
+    case EdgeFlag::wasPruned:
+        return edge.wasPruned;
+    case EdgeFlag::isSuperBubbleEdge:
+        return edge.isSuperBubbleEdge;
+    case EdgeFlag::isLowCoverageCrossEdge:
+        return edge.isLowCoverageCrossEdge;
+    case EdgeFlag::wasRemovedWhileSplittingSecondaryEdges:
+        return edge.wasRemovedWhileSplittingSecondaryEdges;
+    case EdgeFlag::wasAssembled:
+        return edge.wasAssembled;
+    }
+    SHASTA_ASSERT(0);
+}
+
+
+
+// Set a flag of an edge in the Edge record and, if available, in the bitsets.
+void MarkerGraph::setEdgeFlag(EdgeId edgeId, EdgeFlag flag, bool value)
+{
+    Edge& edge = edges[edgeId];
+    switch(flag) {
+    case EdgeFlag::wasRemovedByTransitiveReduction:
+        edge.wasRemovedByTransitiveReduction = value;
+        break;
+    case EdgeFlag::wasPruned:
+        edge.wasPruned = value;
+        break;
+    case EdgeFlag::isSuperBubbleEdge:
+        edge.isSuperBubbleEdge = value;
+        break;
+    case EdgeFlag::isLowCoverageCrossEdge:
+        edge.isLowCoverageCrossEdge = value;
+        break;
+    case EdgeFlag::wasRemovedWhileSplittingSecondaryEdges:
+        edge.wasRemovedWhileSplittingSecondaryEdges = value;
+        break;
+    case EdgeFlag::wasAssembled:
+        edge.wasAssembled = value;
+        break;
+    }
+
+    if(not edgeFlagBitsetsAreAvailable()) {
+        return;
+    }
+
+    // Other threads can be updating other edges that share the same words,
+    // so the bitsets are updated atomically.
+    const uint64_t word = edgeId >> 6;
+    const uint64_t mask = uint64_t(1) << (edgeId & 63);
+    uint64_t& flagWord = edgeFlagBitsets.flags[uint64_t(flag)][word];
+    if(value) {
+        __sync_fetch_and_or(&flagWord, mask);
+    } else {
+        __sync_fetch_and_and(&flagWord, ~mask);
+    }
+    uint64_t& removedWord = edgeFlagBitsets.removed[word];
+    if(edge.wasRemoved()) {
+        __sync_fetch_and_or(&removedWord, mask);
+    } else {
+        __sync_fetch_and_and(&removedWord, ~mask);
+    }
+}
+
+
+
+// Return the first edge at or after the given edge that was not removed,
+// or edges.size() if there is none.
+// Using the bitsets, this skips 64 removed edges at a time.
+MarkerGraph::EdgeId MarkerGraph::findNextNonRemovedEdge(EdgeId edgeId) const
+{
+    const EdgeId edgeCount = edges.size();
+
+    if(not edgeFlagBitsetsAreAvailable()) {
+        while(edgeId < edgeCount and edges[edgeId].wasRemoved()) {
+            ++edgeId;
+        }
+        return min(edgeId, edgeCount);
+    }
+
+    const vector<uint64_t>& removed = edgeFlagBitsets.removed;
+    uint64_t word = edgeId >> 6;
+    if(word >= removed.size()) {
+        return edgeCount;
+    }
+
+    // Bits set in notRemoved correspond to edges that were not removed.
+    // Clear the bits before the starting edge in the first word.
+    uint64_t notRemoved = ~removed[word] & (~uint64_t(0) << (edgeId & 63));
+    while(notRemoved == 0) {
+        ++word;
+        if(word == removed.size()) {
+            return edgeCount;
+        }
+        notRemoved = ~removed[word];
+    }
+    return min(EdgeId((word << 6) + std::countr_zero(notRemoved)), edgeCount);
+}
+
+
+
+uint64_t MarkerGraph::countRemovedEdges() const
+{
+    if(edgeFlagBitsetsAreAvailable()) {
+        return countSetBits(edgeFlagBitsets.removed, edgeFlagBitsets.edgeCount);
+    }
+    uint64_t count = 0;
+    for(const Edge& edge: edges) {
+        if(edge.wasRemoved()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+
+
+uint64_t MarkerGraph::countEdgesWithFlag(EdgeFlag flag) const
+{
+    if(edgeFlagBitsetsAreAvailable()) {
+        return countSetBits(edgeFlagBitsets.flags[uint64_t(flag)], edgeFlagBitsets.edgeCount);
+    }
+    uint64_t count = 0;
+    for(EdgeId edgeId=0; edgeId<edges.size(); edgeId++) {
+        if(getEdgeFlag(edgeId, flag)) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+
+
+// Count the bits set in the first bitCount bits of a bitset.
+// Bits past the end are always zero, so we can count entire words.
+uint64_t MarkerGraph::countSetBits(const vector<uint64_t>& bits, uint64_t bitCount)
+{
+    SHASTA_ASSERT(bits.size() == ((bitCount + 63) >> 6));
+    uint64_t count = 0;
+    for(const uint64_t word: bits) {
+        count += std::popcount(word);
+    }
+    return count;
+}
+
+
+
 // Remove marker graph vertices and update vertices and vertexTable.
 void MarkerGraph::removeVertices(
     const MemoryMapped::Vector<VertexId>& verticesToBeKept,
@@ -7,8 +7,10 @@
 #include "shastaTypes.hpp"
 #include "Uint.hpp"
 
+#include "array.hpp"
 #include "cstdint.hpp"
 #include "memory.hpp"
+#include "vector.hpp"
 
 namespace shasta {
 
@@ -183,6 +185,8 @@ public:
         uint8_t coverage;   // (255 indicates 255 or more).
 
         // Flags used to mark the edge as removed from the marker graph.
+        // To modify the flags, use MarkerGraph::setEdgeFlag,
+        // which also keeps the edge flag bitsets up to date.
         bool wasRemoved() const
         {
             return
@@ -264,6 +268,75 @@ public:
     EdgeId getFirstNonRemovedOutEdge(VertexId) const;
     EdgeId getFirstNonRemovedInEdge(VertexId) const;
 
+
+
+    // Structure-of-arrays view of the edge flags.
+    // There is a bitset for each of the flags below, plus a combined
+    // bitset in which the bit for an edge is set if Edge::wasRemoved() is true.
+    // Passes that only need to know whether an edge was removed
+    // use these bitsets (one bit per edge) instead of
+    // loading the Edge records, and scans over all edges
+    // work one 64-bit word (64 edges) at a time.
+    // The bitsets are not persistent. They are created by createEdgeFlagBitsets,
+    // which must be called after edges are created or added.
+    // After that, setEdgeFlag keeps them in sync with the Edge records,
+    // so edge flags must always be modified using setEdgeFlag.
+    // If the bitsets are not available (for example, the number of edges
+    // changed since they were created), the functions below
+    // fall back to using the Edge records.
+    enum class EdgeFlag {
+        wasRemovedByTransitiveReduction = 0,
+        wasPruned = 1,
+        isSuperBubbleEdge = 2,
+        isLowCoverageCrossEdge = 3,
+        wasRemovedWhileSplittingSecondaryEdges = 4,
+        wasAssembled = 5
+    };
+    static const uint64_t edgeFlagCount = 6;
+    void createEdgeFlagBitsets(size_t threadCount = 0);
+    void removeEdgeFlagBitsets();
+    bool edgeFlagBitsetsAreAvailable() const
+    {
+        return edges.isOpen and (edgeFlagBitsets.edgeCount == edges.size());
+    }
+
+    // Get or set a flag of an edge.
+    // setEdgeFlag can be called by multiple threads, even for edges
+    // that share a word of the bitsets, as long as each edge
+    // is only modified by one thread.
+    bool getEdgeFlag(EdgeId, EdgeFlag) const;
+    void setEdgeFlag(EdgeId, EdgeFlag, bool);
+
+    // Return true if Edge::wasRemoved() is true for the given edge.
+    bool edgeWasRemoved(EdgeId edgeId) const
+    {
+        if(edgeFlagBitsetsAreAvailable()) {
+            return (edgeFlagBitsets.removed[edgeId >> 6] >> (edgeId & 63)) & 1;
+        } else {
+            return edges[edgeId].wasRemoved();
+        }
+    }
+
+    // Return the first edge at or after the given edge that was not removed,
+    // or edges.size() if there is none.
+    EdgeId findNextNonRemovedEdge(EdgeId) const;
+
+    // Count the edges that were removed, or that have a given flag set.
+    uint64_t countRemovedEdges() const;
+    uint64_t countEdgesWithFlag(EdgeFlag) const;
+
+private:
+    class EdgeFlagBitsets {
+    public:
+        array<vector<uint64_t>, edgeFlagCount> flags;
+        vector<uint64_t> removed;
+        uint64_t edgeCount = 0;
+    };
+    EdgeFlagBitsets edgeFlagBitsets;
+    void createEdgeFlagBitsetsThreadFunction(size_t threadId);
+    static uint64_t countSetBits(const vector<uint64_t>&, uint64_t bitCount);
+public:
+
     // The reverse complement of each edge.
     // Indexed by EdgeId.
     MemoryMapped::Vector<EdgeId> reverseComplementEdge;
@@ -301,6 +301,13 @@ public:
         return name;
     }
 
+    // Direct read-only access to the table of contents.
+    // Vector i occupies positions toc[i] to toc[i+1]-1 of the data.
+    const Vector<Int>& getToc() const
+    {
+        return toc;
+    }
+
 private:
     Vector<Int> toc;
     Vector<Int> count;
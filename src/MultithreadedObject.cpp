@@ -85,13 +85,33 @@ void shasta::MultithreadedObjectBaseClass::waitForThreads()
 
 
 
+std::mutex shasta::MultithreadedObjectBaseClass::currentMutex;
+const shasta::MultithreadedObjectBaseClass* shasta::MultithreadedObjectBaseClass::current = 0;
+
+
+
+shasta::MultithreadedObjectBaseClass::~MultithreadedObjectBaseClass()
+{
+    std::lock_guard<std::mutex> lock(currentMutex);
+    if(current == this) {
+        current = 0;
+    }
+}
+
+
+
+// n and nextBatch are accessed atomically because
+// getProgress can read them from another thread.
 void shasta::MultithreadedObjectBaseClass::setupLoadBalancing(
     uint64_t nArgument,
     uint64_t batchSizeArgument)
 {
-    n = nArgument;
+    __atomic_store_n(&n, nArgument, __ATOMIC_RELAXED);
     batchSize = batchSizeArgument;
-    nextBatch = 0;
+    __atomic_store_n(&nextBatch, 0, __ATOMIC_RELAXED);
+
+    std::lock_guard<std::mutex> lock(currentMutex);
+    current = this;
 }
 
 
@@ -111,6 +131,27 @@ bool shasta::MultithreadedObjectBaseClass::getNextBatch(
 
 
 
+pair<uint64_t, uint64_t> shasta::MultithreadedObjectBaseClass::getProgress() const
+{
+    const uint64_t totalCount = __atomic_load_n(&n, __ATOMIC_RELAXED);
+    const uint64_t assignedCount = __atomic_load_n(&nextBatch, __ATOMIC_RELAXED);
+    return make_pair(min(totalCount, assignedCount), totalCount);
+}
+
+
+
+pair<uint64_t, uint64_t> shasta::MultithreadedObjectBaseClass::getCurrentProgress()
+{
+    std::lock_guard<std::mutex> lock(currentMutex);
+    if(current) {
+        return current->getProgress();
+    } else {
+        return make_pair(0, 0);
+    }
+}
+
+
+
 void shasta::MultithreadedObjectBaseClass::killAllThreadsExceptMe(size_t me)
 {
     for(size_t threadId=0; threadId<threads.size(); threadId++) {
@@ -16,6 +16,7 @@
 #include <memory>
 #include <mutex>
 #include <thread>
+#include "utility.hpp"
 #include "vector.hpp"
 
 namespace shasta {
@@ -31,6 +32,24 @@ namespace shasta {
 
 // The base class contains code that is not templated.
 class shasta::MultithreadedObjectBaseClass {
+public:
+
+    // Return the number of items already assigned to threads
+    // and the total number of items for the loop
+    // most recently set up by setupLoadBalancing.
+    // This can be called from another thread while the loop is running
+    // and is only intended for progress reporting.
+    pair<uint64_t, uint64_t> getProgress() const;
+
+    // Same as getProgress, but for the loop most recently set up
+    // by any MultithreadedObject that still exists.
+    // This also covers loops run by helper objects
+    // (for example LowHash1) created by a long running function.
+    // Returns (0, 0) if there is no such loop.
+    static pair<uint64_t, uint64_t> getCurrentProgress();
+
+    ~MultithreadedObjectBaseClass();
+
 protected:
 
     // The running threads.
@@ -63,6 +82,11 @@ private:
     uint64_t n = 0;
     uint64_t batchSize = 0;
     uint64_t nextBatch = 0;
+
+    // The object that most recently called setupLoadBalancing,
+    // used by getCurrentProgress.
+    static std::mutex currentMutex;
+    static const MultithreadedObjectBaseClass* current;
 };
 
 
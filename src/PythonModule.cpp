@@ -1,6 +1,7 @@
 #ifdef SHASTA_PYTHON_API
 
 // Shasta.
+#include "AlignmentGraph.hpp"
 #include "AssembledSegment.hpp"
 #include "Assembler.hpp"
 #include "AssemblerOptions.hpp"
@@ -9,11 +10,15 @@
 #include "CompactUndirectedGraph.hpp"
 #include "compressAlignment.hpp"
 #include "ConfigurationTable.hpp"
+#include "Coverage.hpp"
+#include "cpuDispatch.hpp"
 #include "deduplicate.hpp"
 #include "dset64Test.hpp"
 #include "diploidBayesianPhase.hpp"
+#include "featureHashes.hpp"
 #include "shastaLapack.hpp"
 #include "LongBaseSequence.hpp"
+#include "MarkerInterval.hpp"
 #include "mappedCopy.hpp"
 #include "MedianConsensusCaller.hpp"
 #include "MemoryMappedAllocator.hpp"
@@ -33,6 +38,368 @@ using namespace shasta;
 #include <pybind11/stl.h>
 using namespace pybind11;
 
+// Standard library.
+#include "chrono.hpp"
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+
+// Functions used to create zero-copy NumPy views of memory mapped data.
+// The arrays returned point directly to the memory mapped data,
+// are flagged as read-only, and keep the owner Python object
+// (normally the Assembler) alive.
+// They become invalid if the data structure they refer to
+// is closed, removed, or recreated.
+// Integers stored with a number of bytes not supported by NumPy
+// (Uint24, Uint40) are exposed as arrays of little endian bytes.
+namespace shasta {
+    namespace python {
+
+        // A field of a structured NumPy dtype: name, NumPy format, byte offset.
+        using NumpyField = std::tuple<string, string, uint64_t>;
+        pybind11::dtype numpyStructuredDtype(const vector<NumpyField>&, uint64_t itemSize);
+
+        // Byte offset of a member in an object.
+        template<class T, class Member> uint64_t byteOffset(const T& t, const Member& member)
+        {
+            return uint64_t(
+                reinterpret_cast<const char*>(&member) - reinterpret_cast<const char*>(&t));
+        }
+
+        // Create a read-only view of n objects of type T.
+        template<class T> pybind11::array numpyView(
+            const T*, uint64_t n, const pybind11::dtype&, pybind11::handle owner);
+
+        // Same, for the entire content of a MemoryMapped::Vector.
+        template<class T> pybind11::array numpyView(
+            const MemoryMapped::Vector<T>&, const pybind11::dtype&, pybind11::handle owner);
+
+        // For a MemoryMapped::VectorOfVectors, return a tuple (offsets, data).
+        // Vector i occupies positions offsets[i] to offsets[i+1]-1 of data.
+        template<class T, class Int> pybind11::tuple numpyView(
+            const MemoryMapped::VectorOfVectors<T, Int>&,
+            const pybind11::dtype& dataDtype,
+            const pybind11::dtype& offsetsDtype,
+            pybind11::handle owner);
+
+        // The NumPy dtypes of some of the types stored in memory mapped data structures.
+        pybind11::dtype compressedMarkerDtype();
+        vector<NumpyField> alignmentInfoFields(uint64_t offset);
+        pybind11::dtype alignmentInfoDtype();
+        pybind11::dtype alignmentDataDtype();
+        pybind11::dtype readGraphEdgeDtype();
+        pybind11::dtype uint40Dtype();
+        pybind11::dtype markerGraphEdgeDtype();
+        pybind11::dtype markerIntervalDtype();
+        pybind11::dtype coverageDataDtype();
+
+
+
+        // Long running functions are called with the GIL released,
+        // so other Python threads can run while they execute.
+        // If a progress callback was set using setProgressCallback,
+        // the function runs in a separate thread and the calling thread
+        // calls the progress callback periodically, holding the GIL.
+        // The callback is called with three arguments: elapsed seconds,
+        // number of items processed and total number of items in the
+        // parallel loop currently running (as returned by
+        // MultithreadedObjectBaseClass::getCurrentProgress, so this
+        // includes loops run by helper objects such as LowHash1).
+        pybind11::object& progressCallback();
+        double& progressCallbackInterval();
+        void runReleasingGil(const std::function<void()>&);
+
+        // Return a function suitable for a pybind11 def that calls
+        // a member function of Assembler using runReleasingGil.
+        template<class... Args> auto releasingGil(void (Assembler::*f)(Args...))
+        {
+            return [f](Assembler& assembler, Args... args)
+            {
+                runReleasingGil([&]()
+                {
+                    (assembler.*f)(std::forward<Args>(args)...);
+                });
+            };
+        }
+    }
+}
+
+
+
+pybind11::dtype shasta::python::numpyStructuredDtype(
+    const vector<NumpyField>& fields,
+    uint64_t itemSize)
+{
+    pybind11::list names;
+    pybind11::list formats;
+    pybind11::list offsets;
+    for(const NumpyField& field: fields) {
+        names.append(get<0>(field));
+        formats.append(get<1>(field));
+        offsets.append(get<2>(field));
+    }
+    return pybind11::dtype(names, formats, offsets, ssize_t(itemSize));
+}
+
+
+
+template<class T> pybind11::array shasta::python::numpyView(
+    const T* begin,
+    uint64_t n,
+    const pybind11::dtype& dataType,
+    pybind11::handle owner)
+{
+    SHASTA_ASSERT(uint64_t(dataType.itemsize()) == sizeof(T));
+
+    // Because an owner is specified, the data are not copied.
+    pybind11::array a(dataType,
+        vector<ssize_t>({ssize_t(n)}),
+        vector<ssize_t>({ssize_t(sizeof(T))}),
+        begin, owner);
+    a.attr("setflags")(pybind11::arg("write") = false);
+    return a;
+}
+
+
+
+template<class T> pybind11::array shasta::python::numpyView(
+    const MemoryMapped::Vector<T>& v,
+    const pybind11::dtype& dataType,
+    pybind11::handle owner)
+{
+    if(not v.isOpen) {
+        throw runtime_error("Data are not accessible.");
+    }
+    return numpyView(v.begin(), v.size(), dataType, owner);
+}
+
+
+
+template<class T, class Int> pybind11::tuple shasta::python::numpyView(
+    const MemoryMapped::VectorOfVectors<T, Int>& v,
+    const pybind11::dtype& dataDtype,
+    const pybind11::dtype& offsetsDtype,
+    pybind11::handle owner)
+{
+    if(not v.isOpen()) {
+        throw runtime_error("Data are not accessible.");
+    }
+    return pybind11::make_tuple(
+        numpyView(v.getToc(), offsetsDtype, owner),
+        numpyView(v.begin(), v.totalSize(), dataDtype, owner));
+}
+
+
+
+// KmerId is 64 bits when building with SHASTA_LONG_KMERS.
+pybind11::dtype shasta::python::compressedMarkerDtype()
+{
+    static_assert(sizeof(KmerId) == 4 or sizeof(KmerId) == 8);
+    const string kmerIdFormat = (sizeof(KmerId) == 4) ? "<u4" : "<u8";
+    return numpyStructuredDtype({
+        {"kmerId", kmerIdFormat, offsetof(CompressedMarker, kmerId)},
+        {"position", "(3,)u1", offsetof(CompressedMarker, position)}},
+        sizeof(CompressedMarker));
+}
+
+
+
+// The fields of an AlignmentInfo stored at the given offset.
+// The flags of AlignmentInfo are bit fields stored in the byte following maxDrift.
+vector<shasta::python::NumpyField> shasta::python::alignmentInfoFields(uint64_t offset)
+{
+    AlignmentInfo info;
+    return {
+        {"markerCount0", "<u4", offset + byteOffset(info, info.data[0].markerCount)},
+        {"firstOrdinal0", "<u4", offset + byteOffset(info, info.data[0].firstOrdinal)},
+        {"lastOrdinal0", "<u4", offset + byteOffset(info, info.data[0].lastOrdinal)},
+        {"markerCount1", "<u4", offset + byteOffset(info, info.data[1].markerCount)},
+        {"firstOrdinal1", "<u4", offset + byteOffset(info, info.data[1].firstOrdinal)},
+        {"lastOrdinal1", "<u4", offset + byteOffset(info, info.data[1].lastOrdinal)},
+        {"markerCount", "<u4", offset + byteOffset(info, info.markerCount)},
+        {"minOrdinalOffset", "<i4", offset + byteOffset(info, info.minOrdinalOffset)},
+        {"maxOrdinalOffset", "<i4", offset + byteOffset(info, info.maxOrdinalOffset)},
+        {"averageOrdinalOffset", "<i4", offset + byteOffset(info, info.averageOrdinalOffset)},
+        {"maxSkip", "<u4", offset + byteOffset(info, info.maxSkip)},
+        {"maxDrift", "<u4", offset + byteOffset(info, info.maxDrift)},
+        {"flags", "u1", offset + byteOffset(info, info.maxDrift) + sizeof(info.maxDrift)}};
+}
+
+
+
+pybind11::dtype shasta::python::alignmentInfoDtype()
+{
+    return numpyStructuredDtype(alignmentInfoFields(0), sizeof(AlignmentInfo));
+}
+
+
+
+pybind11::dtype shasta::python::alignmentDataDtype()
+{
+    AlignmentData a;
+    vector<NumpyField> fields = {
+        {"readId0", "<u4", byteOffset(a, a.readIds[0])},
+        {"readId1", "<u4", byteOffset(a, a.readIds[1])},
+        {"isSameStrand", "?", byteOffset(a, a.isSameStrand)}};
+    const vector<NumpyField> infoFields = alignmentInfoFields(byteOffset(a, a.info));
+    fields.insert(fields.end(), infoFields.begin(), infoFields.end());
+    return numpyStructuredDtype(fields, sizeof(AlignmentData));
+}
+
+
+
+// The alignment id and the flags of ReadGraphEdge are bit fields
+// packed in a single 64-bit word following the oriented read ids.
+// The alignment id is in the low 62 bits.
+pybind11::dtype shasta::python::readGraphEdgeDtype()
+{
+    ReadGraphEdge edge;
+    return numpyStructuredDtype({
+        {"orientedReadId0", "<u4", byteOffset(edge, edge.orientedReadIds[0])},
+        {"orientedReadId1", "<u4", byteOffset(edge, edge.orientedReadIds[1])},
+        {"alignmentIdAndFlags", "<u8", sizeof(edge.orientedReadIds)}},
+        sizeof(ReadGraphEdge));
+}
+
+
+
+pybind11::dtype shasta::python::uint40Dtype()
+{
+    return numpyStructuredDtype({{"bytes", "(5,)u1", 0}}, sizeof(Uint40));
+}
+
+
+
+// The flags of MarkerGraph::Edge are bit fields stored in the bytes
+// following coverage and isSecondary.
+pybind11::dtype shasta::python::markerGraphEdgeDtype()
+{
+    MarkerGraph::Edge edge;
+    return numpyStructuredDtype({
+        {"source", "(5,)u1", byteOffset(edge, edge.source)},
+        {"target", "(5,)u1", byteOffset(edge, edge.target)},
+        {"coverage", "u1", byteOffset(edge, edge.coverage)},
+        {"flags", "u1", byteOffset(edge, edge.coverage) + 1},
+        {"isSecondary", "u1", byteOffset(edge, edge.isSecondary)},
+        {"flags2", "u1", byteOffset(edge, edge.isSecondary) + 1}},
+        sizeof(MarkerGraph::Edge));
+}
+
+
+
+pybind11::dtype shasta::python::markerIntervalDtype()
+{
+    MarkerInterval markerInterval;
+    return numpyStructuredDtype({
+        {"orientedReadId", "<u4", byteOffset(markerInterval, markerInterval.orientedReadId)},
+        {"ordinal0", "<u4", byteOffset(markerInterval, markerInterval.ordinals[0])},
+        {"ordinal1", "<u4", byteOffset(markerInterval, markerInterval.ordinals[1])}},
+        sizeof(MarkerInterval));
+}
+
+
+
+// The base (low 4 bits) and strand (high 4 bits) of
+// CompressedCoverageData are bit fields stored in a single byte.
+pybind11::dtype shasta::python::coverageDataDtype()
+{
+    using Pair = pair<uint32_t, CompressedCoverageData>;
+    Pair p;
+    return numpyStructuredDtype({
+        {"position", "<u4", byteOffset(p, p.first)},
+        {"baseAndStrand", "u1", byteOffset(p, p.second)},
+        {"repeatCount", "u1", byteOffset(p, p.second.repeatCount)},
+        {"frequency", "u1", byteOffset(p, p.second.frequency)}},
+        sizeof(Pair));
+}
+
+
+
+// The callback is never destroyed, to avoid Python calls
+// during destruction of static objects at exit.
+pybind11::object& shasta::python::progressCallback()
+{
+    static pybind11::object* callback = new pybind11::object(pybind11::none());
+    return *callback;
+}
+double& shasta::python::progressCallbackInterval()
+{
+    static double interval = 1.;
+    return interval;
+}
+
+
+
+void shasta::python::runReleasingGil(const std::function<void()>& f)
+{
+    // If there is no progress callback, just release the GIL while f runs.
+    const pybind11::object callback = progressCallback();
+    if(callback.is_none()) {
+        pybind11::gil_scoped_release release;
+        f();
+        return;
+    }
+
+    // Run f in a separate thread.
+    std::mutex mutex;
+    std::condition_variable conditionVariable;
+    bool done = false;
+    std::exception_ptr exception;
+    std::thread thread([&]()
+    {
+        try {
+            f();
+        } catch(...) {
+            exception = std::current_exception();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        conditionVariable.notify_all();
+    });
+
+    // Periodically call the progress callback until f completes.
+    // If the callback raises an exception, stop calling it and
+    // report the exception after f completes.
+    const auto tBegin = steady_clock::now();
+    const auto interval = std::chrono::duration<double>(progressCallbackInterval());
+    std::exception_ptr callbackException;
+    while(true) {
+        bool isDone = false;
+        {
+            pybind11::gil_scoped_release release;
+            std::unique_lock<std::mutex> lock(mutex);
+            isDone = conditionVariable.wait_for(lock, interval, [&]() {return done;});
+        }
+        if(isDone) {
+            break;
+        }
+        if(not callbackException) {
+            const auto progress = MultithreadedObjectBaseClass::getCurrentProgress();
+            const double elapsedSeconds = seconds(steady_clock::now() - tBegin);
+            try {
+                callback(elapsedSeconds, progress.first, progress.second);
+            } catch(...) {
+                callbackException = std::current_exception();
+            }
+        }
+    }
+    {
+        pybind11::gil_scoped_release release;
+        thread.join();
+    }
+
+    if(exception) {
+        std::rethrow_exception(exception);
+    }
+    if(callbackException) {
+        std::rethrow_exception(callbackException);
+    }
+}
+
 
 
 PYBIND11_MODULE(shasta, shastaModule)
@@ -97,13 +464,16 @@ PYBIND11_MODULE(shasta, shastaModule)
         .def_readwrite("downsamplingFactor", &AlignOptions::downsamplingFactor)
         .def_readwrite("bandExtend", &AlignOptions::bandExtend)
         .def_readwrite("maxBand", &AlignOptions::maxBand)
+        .def_readwrite("bandHintExtend", &AlignOptions::bandHintExtend)
         .def_readwrite("sameChannelReadAlignmentSuppressDeltaThreshold",
             &AlignOptions::sameChannelReadAlignmentSuppressDeltaThreshold)
         .def_readwrite("suppressContainments", &AlignOptions::suppressContainments)
+        .def_readwrite("method0DynamicProgramming", &AlignOptions::method0DynamicProgramming)
         .def_readwrite("align4DeltaX", &AlignOptions::align4DeltaX)
         .def_readwrite("align4DeltaY", &AlignOptions::align4DeltaY)
         .def_readwrite("align4MinEntryCountPerCell", &AlignOptions::align4MinEntryCountPerCell)
         .def_readwrite("align4MaxDistanceFromBoundary", &AlignOptions::align4MaxDistanceFromBoundary)
+        .def_readwrite("shard", &AlignOptions::shard)
         ;
 
     // Expose class Mode2AssemblyOptions to Python.
@@ -190,7 +560,7 @@ PYBIND11_MODULE(shasta, shastaModule)
         .def("accessMarkers",
             &Assembler::accessMarkers)
         .def("findMarkers",
-            &Assembler::findMarkers,
+            python::releasingGil(&Assembler::findMarkers),
             "Find markers in reads.",
             arg("threadCount") = 0)
         .def("writeMarkers",
@@ -208,7 +578,7 @@ PYBIND11_MODULE(shasta, shastaModule)
         .def("writeMarkerFrequency",
             &Assembler::writeMarkerFrequency)
         .def("computeSortedMarkers",
-            &Assembler::computeSortedMarkers,
+            python::releasingGil(&Assembler::computeSortedMarkers),
             arg("threadCount") = 0)
         .def("accessSortedMarkers",
             &Assembler::accessSortedMarkers)
@@ -216,7 +586,7 @@ PYBIND11_MODULE(shasta, shastaModule)
 
         // Alignment candidates.
         .def("findAlignmentCandidatesLowHash0",
-            &Assembler::findAlignmentCandidatesLowHash0,
+            python::releasingGil(&Assembler::findAlignmentCandidatesLowHash0),
             arg("m"),
             arg("hashFraction"),
             arg("minHashIterationCount"),
@@ -227,7 +597,7 @@ PYBIND11_MODULE(shasta, shastaModule)
             arg("minFrequency"),
             arg("threadCount") = 0)
         .def("findAlignmentCandidatesLowHash1",
-            &Assembler::findAlignmentCandidatesLowHash1,
+            python::releasingGil(&Assembler::findAlignmentCandidatesLowHash1),
             arg("m"),
             arg("hashFraction"),
             arg("minHashIterationCount"),
@@ -236,6 +606,15 @@ PYBIND11_MODULE(shasta, shastaModule)
             arg("maxBucketSize"),
             arg("minFrequency"),
             arg("threadCount") = 0)
+        .def("findAlignmentCandidatesLowHash2",
+            python::releasingGil(&Assembler::findAlignmentCandidatesLowHash2),
+            arg("m"),
+            arg("hashFraction"),
+            arg("minBucketSize"),
+            arg("maxBucketSize"),
+            arg("minFrequency"),
+            arg("maxDrift"),
+            arg("threadCount") = 0)
         .def("accessAlignmentCandidates",
             &Assembler::accessAlignmentCandidates)
         .def("accessAlignmentCandidateTable",
@@ -249,7 +628,7 @@ PYBIND11_MODULE(shasta, shastaModule)
             arg("strand"),
             arg("fileName") = "OverlappingReads.fasta")
         .def("flagPalindromicReads",
-            &Assembler::flagPalindromicReads,
+            python::releasingGil(&Assembler::flagPalindromicReads),
             arg("maxSkip"),
             arg("maxDrift"),
             arg("maxMarkerFrequency"),
@@ -342,7 +721,63 @@ PYBIND11_MODULE(shasta, shastaModule)
 
         // Compute an alignment for each alignment candidate.
         .def("computeAlignments",
-            &Assembler::computeAlignments)
+            python::releasingGil(&Assembler::computeAlignments))
+        .def("computeAlignmentShard",
+            python::releasingGil(&Assembler::computeAlignmentShard),
+            arg("alignOptions"),
+            arg("shardsDirectory") = "AlignmentShards",
+            arg("threadCount") = 0)
+        .def("mergeAlignmentShards",
+            &Assembler::mergeAlignmentShards,
+            arg("shardsDirectory"),
+            arg("shardCount"))
+        .def("alignOrientedReadPairs",
+            [](
+                Assembler& assembler,
+                pybind11::array_t<OrientedReadId::Int, pybind11::array::c_style | pybind11::array::forcecast>
+                    orientedReadIdValues,
+                const AlignOptions& alignOptions,
+                size_t threadCount)
+            {
+                if(orientedReadIdValues.ndim() != 2 or orientedReadIdValues.shape(1) != 2) {
+                    throw runtime_error("Expected an array of shape (n, 2) of oriented read ids.");
+                }
+                const uint64_t n = uint64_t(orientedReadIdValues.shape(0));
+                const auto values = orientedReadIdValues.unchecked<2>();
+                vector< std::array<OrientedReadId, 2> > orientedReadIdPairs(n);
+                for(uint64_t i=0; i<n; i++) {
+                    for(uint64_t j=0; j<2; j++) {
+                        orientedReadIdPairs[i][j] = OrientedReadId::fromValue(values(i, j));
+                    }
+                }
+
+                vector<AlignmentInfo> alignmentInfos;
+                vector<uint8_t> isGood;
+                python::runReleasingGil([&]()
+                {
+                    assembler.alignOrientedReadPairs(
+                        orientedReadIdPairs, alignOptions, threadCount,
+                        alignmentInfos, isGood);
+                });
+
+                // The data are copied into the returned arrays.
+                return pybind11::make_tuple(
+                    pybind11::array(python::alignmentInfoDtype(),
+                        vector<ssize_t>({ssize_t(n)}),
+                        vector<ssize_t>({ssize_t(sizeof(AlignmentInfo))}),
+                        alignmentInfos.data()),
+                    pybind11::array_t<bool>(
+                        vector<ssize_t>({ssize_t(n)}),
+                        reinterpret_cast<const bool*>(isGood.data())));
+            },
+            "Compute alignments for a batch of pairs of oriented reads, using multiple threads. "
+            "The oriented reads are specified as an array of shape (n, 2) of values of OrientedReadId. "
+            "Returns a tuple (alignmentInfos, isGood). isGood is set for the alignments "
+            "that satisfy the criteria used by computeAlignments. "
+            "The stored alignments are not used or modified.",
+            arg("orientedReadIds"),
+            arg("alignOptions"),
+            arg("threadCount") = 0)
         .def("accessCompressedAlignments",
             &Assembler::accessCompressedAlignments)
         .def("accessAlignmentData",
@@ -360,11 +795,11 @@ PYBIND11_MODULE(shasta, shastaModule)
 
         // Undirected read graph
         .def("createReadGraph",
-            &Assembler::createReadGraph,
+            python::releasingGil(&Assembler::createReadGraph),
             arg("maxAlignmentCount"),
             arg("maxTrim"))
         .def("createReadGraph2",
-             &Assembler::createReadGraph2,
+            python::releasingGil(&Assembler::createReadGraph2),
             arg("maxAlignmentCount"),
             arg("markerCountPercentile"),
             arg("alignedFractionPercentile"),
@@ -426,7 +861,7 @@ PYBIND11_MODULE(shasta, shastaModule)
 
         // Global marker graph.
         .def("createMarkerGraphVertices",
-            &Assembler::createMarkerGraphVertices,
+            python::releasingGil(&Assembler::createMarkerGraphVertices),
             arg("minCoverage"),
             arg("maxCoverage"),
             arg("minCoveragePerStrand"),
@@ -434,6 +869,18 @@ PYBIND11_MODULE(shasta, shastaModule)
             arg("peakFinderMinAreaFraction"),
             arg("peakFinderAreaStartIndex"),
             arg("threadCount") = 0)
+        .def("estimateMarkerGraphCoverageHistogram",
+            &Assembler::estimateMarkerGraphCoverageHistogram,
+            arg("sampleReadCount"),
+            arg("maxCoverage"),
+            arg("peakFinderMinAreaFraction"),
+            arg("peakFinderAreaStartIndex"),
+            arg("threadCount") = 0)
+        .def("enableIncrementalMarkerGraphVertices",
+            &Assembler::enableIncrementalMarkerGraphVertices,
+            arg("verify") = false)
+        .def("disableIncrementalMarkerGraphVertices",
+            &Assembler::disableIncrementalMarkerGraphVertices)
         .def("accessMarkerGraphVertices",
              &Assembler::accessMarkerGraphVertices,
              arg("readWriteAccess") = false)
@@ -454,13 +901,13 @@ PYBIND11_MODULE(shasta, shastaModule)
             &Assembler::getGlobalMarkerGraphVertexMarkers,
             arg("vertexId"))
         .def("findMarkerGraphReverseComplementVertices",
-            &Assembler::findMarkerGraphReverseComplementVertices,
+            python::releasingGil(&Assembler::findMarkerGraphReverseComplementVertices),
             arg("threadCount") = 0)
         .def("accessMarkerGraphReverseComplementVertex",
             &Assembler::accessMarkerGraphReverseComplementVertex,
             arg("readWriteAccess") = false)
         .def("findMarkerGraphReverseComplementEdges",
-            &Assembler::findMarkerGraphReverseComplementEdges,
+            python::releasingGil(&Assembler::findMarkerGraphReverseComplementEdges),
             arg("threadCount") = 0)
         .def("accessMarkerGraphReverseComplementEdge",
             &Assembler::accessMarkerGraphReverseComplementEdge)
@@ -486,10 +933,10 @@ PYBIND11_MODULE(shasta, shastaModule)
 
         // Edges of the global marker graph.
         .def("createMarkerGraphEdges",
-            &Assembler::createMarkerGraphEdges,
+            python::releasingGil(&Assembler::createMarkerGraphEdges),
             arg("threadCount") = 0)
         .def("createMarkerGraphEdgesStrict",
-            &Assembler::createMarkerGraphEdgesStrict,
+            python::releasingGil(&Assembler::createMarkerGraphEdgesStrict),
             arg("minEdgeCoverage"),
             arg("minEdgeCoveragePerStrand"),
             arg("threadCount") = 0)
@@ -529,19 +976,19 @@ PYBIND11_MODULE(shasta, shastaModule)
             &Assembler::pruneMarkerGraphStrongSubgraph,
             arg("iterationCount"))
         .def("simplifyMarkerGraph",
-            &Assembler::simplifyMarkerGraph,
+            python::releasingGil(&Assembler::simplifyMarkerGraph),
             arg("maxLength"),
             arg("debug") = false)
         .def("assembleMarkerGraphVertices",
-            &Assembler::assembleMarkerGraphVertices,
+            python::releasingGil(&Assembler::assembleMarkerGraphVertices),
             arg("threadCount") = 0)
         .def("accessMarkerGraphVertexRepeatCounts",
             &Assembler::accessMarkerGraphVertexRepeatCounts)
         .def("computeMarkerGraphVerticesCoverageData",
-            &Assembler::computeMarkerGraphVerticesCoverageData,
+            python::releasingGil(&Assembler::computeMarkerGraphVerticesCoverageData),
             arg("threadCount") = 0)
         .def("assembleMarkerGraphEdges",
-            &Assembler::assembleMarkerGraphEdges,
+            python::releasingGil(&Assembler::assembleMarkerGraphEdges),
             arg("threadCount") = 0,
             arg("markerGraphEdgeLengthThresholdForConsensus"),
             arg("storeCoverageData"),
@@ -578,7 +1025,7 @@ PYBIND11_MODULE(shasta, shastaModule)
         .def("writeAssemblyGraph",
             &Assembler::writeAssemblyGraph)
         .def("assemble",
-            &Assembler::assemble,
+            python::releasingGil(&Assembler::assemble),
             arg("threadCount") = 0,
             arg("storeCoverageDataCsvLengthThreshold") = 0)
         .def("accessAssemblyGraphSequences",
@@ -631,6 +1078,10 @@ PYBIND11_MODULE(shasta, shastaModule)
             arg("threadCount") = 0)
         .def("writeOrientedReadsByAssemblyGraphEdge",
             &Assembler::writeOrientedReadsByAssemblyGraphEdge)
+        .def("writeReadPlacements",
+            &Assembler::writeReadPlacements,
+            arg("fileName") = "ReadPlacements.paf",
+            arg("threadCount") = 0)
         .def("detangle",
             &Assembler::detangle)
         .def("detangle2",
@@ -647,7 +1098,7 @@ PYBIND11_MODULE(shasta, shastaModule)
 
         // Assembly mode 2.
         .def("createAssemblyGraph2",
-            &Assembler::createAssemblyGraph2,
+            python::releasingGil(&Assembler::createAssemblyGraph2),
             arg("pruneLength"),
             arg("mode2Options"),
             arg("threadCount") = 0,
@@ -655,7 +1106,7 @@ PYBIND11_MODULE(shasta, shastaModule)
 
         // Assembly mode 3.
         .def("mode3Assembly",
-            &Assembler::mode3Assembly,
+            python::releasingGil(&Assembler::mode3Assembly),
             arg("threadCount") = 0)
         .def("accessMode3AssemblyGraph",
             &Assembler::accessMode3AssemblyGraph)
@@ -679,6 +1130,108 @@ PYBIND11_MODULE(shasta, shastaModule)
 
 
 
+
+
+
+        // Zero-copy, read-only NumPy views of memory mapped data.
+        // The corresponding access function must be called first.
+        // Views of VectorOfVectors objects return a tuple (offsets, data).
+        .def("getMarkersNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().getCompressedMarkers(),
+                    python::compressedMarkerDtype(), dtype::of<uint64_t>(), self);
+            },
+            "Get a read-only NumPy view of the markers, "
+            "as a tuple (offsets, markers) indexed by OrientedReadId::getValue().")
+        .def("getAlignmentDataNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().getAlignmentData(),
+                    python::alignmentDataDtype(), self);
+            },
+            "Get a read-only NumPy view of the stored alignments.")
+        .def("getReadGraphEdgesNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().getReadGraph().edges,
+                    python::readGraphEdgeDtype(), self);
+            },
+            "Get a read-only NumPy view of the read graph edges.")
+        .def("getReadGraphConnectivityNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().getReadGraph().connectivity,
+                    dtype::of<uint32_t>(), dtype::of<uint32_t>(), self);
+            },
+            "Get a read-only NumPy view of the read graph connectivity, "
+            "as a tuple (offsets, edgeIds) indexed by OrientedReadId::getValue().")
+        .def("getMarkerGraphVerticesNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().markerGraph.vertices(),
+                    dtype::of<MarkerId>(), python::uint40Dtype(), self);
+            },
+            "Get a read-only NumPy view of the marker graph vertices, "
+            "as a tuple (offsets, markerIds) indexed by vertex id. "
+            "The offsets are 40-bit little endian integers.")
+        .def("getMarkerGraphVertexTableNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().markerGraph.vertexTable,
+                    python::uint40Dtype(), self);
+            },
+            "Get a read-only NumPy view of the marker graph vertex table "
+            "(the vertex id of each marker, as a 40-bit little endian integer).")
+        .def("getMarkerGraphEdgesNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().markerGraph.edges,
+                    python::markerGraphEdgeDtype(), self);
+            },
+            "Get a read-only NumPy view of the marker graph edges.")
+        .def("getMarkerGraphEdgeMarkerIntervalsNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().markerGraph.edgeMarkerIntervals,
+                    python::markerIntervalDtype(), dtype::of<uint64_t>(), self);
+            },
+            "Get a read-only NumPy view of the marker intervals of marker graph edges, "
+            "as a tuple (offsets, markerIntervals) indexed by edge id.")
+        .def("getMarkerGraphVertexCoverageDataNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().markerGraph.vertexCoverageData,
+                    python::coverageDataDtype(), dtype::of<uint64_t>(), self);
+            },
+            "Get a read-only NumPy view of marker graph vertex coverage data, "
+            "as a tuple (offsets, coverageData) indexed by vertex id.")
+        .def("getMarkerGraphEdgeCoverageDataNumpyView",
+            [](object self)
+            {
+                return python::numpyView(self.cast<const Assembler&>().markerGraph.edgeCoverageData,
+                    python::coverageDataDtype(), dtype::of<uint64_t>(), self);
+            },
+            "Get a read-only NumPy view of marker graph edge coverage data, "
+            "as a tuple (offsets, coverageData) indexed by edge id.")
+
+
+
+        // Progress of the parallel loop currently running.
+        // This can be called from another Python thread
+        // while a long running function executes.
+        // This includes loops run by helper objects
+        // created by the long running function.
+        .def("getProgress",
+            [](const Assembler&)
+            {
+                return MultithreadedObjectBaseClass::getCurrentProgress();
+            },
+            "Return a tuple (processed, total) describing progress "
+            "of the parallel loop currently running.")
+
+
+
         .def("test", &Assembler::test)
 
         // Definition of class_Assembler ends here.
@@ -715,9 +1268,27 @@ PYBIND11_MODULE(shasta, shastaModule)
 
 
     // Non-member functions exposed to Python.
+    shastaModule.def("setProgressCallback",
+        [](pybind11::object callback, double interval)
+        {
+            if(interval <= 0.) {
+                throw runtime_error("The progress callback interval must be positive.");
+            }
+            python::progressCallback() = callback;
+            python::progressCallbackInterval() = interval;
+        },
+        "Set a function to be called periodically while long running Assembler functions execute. "
+        "It is called with arguments (elapsedSeconds, processed, total). Use None to remove it.",
+        arg("callback"),
+        arg("interval") = 1.
+        );
     shastaModule.def("openPerformanceLog",
         openPerformanceLog
         );
+    shastaModule.def("cpuDispatchTarget",
+        cpuDispatchTarget,
+        "Return the version of the dispatched kernels selected for this CPU."
+        );
     shastaModule.def("testMultithreadedObject",
         testMultithreadedObject
         );
@@ -733,6 +1304,9 @@ PYBIND11_MODULE(shasta, shastaModule)
     shastaModule.def("testLongBaseSequence",
         testLongBaseSequence
         );
+    shastaModule.def("testFeatureHashes",
+        testFeatureHashes
+        );
     shastaModule.def("testSplitRange",
         testSplitRange
         );
@@ -742,6 +1316,9 @@ PYBIND11_MODULE(shasta, shastaModule)
     shastaModule.def("testCompactUndirectedGraph2",
         testCompactUndirectedGraph1
         );
+    shastaModule.def("testAlignmentGraph",
+        testAlignmentGraph
+        );
     shastaModule.def("testSpoa",
         testSpoa
         );
@@ -0,0 +1,601 @@
+// Shasta.
+#include "ResourceEstimator.hpp"
+#include "Alignment.hpp"
+#include "AlignmentCandidates.hpp"
+#include "AssemblerOptions.hpp"
+#include "dset64-gccAtomic.hpp"
+#include "filesystem.hpp"
+#include "Kmer.hpp"
+#include "Marker.hpp"
+#include "MarkerGraph.hpp"
+#include "MarkerInterval.hpp"
+#include "OrientedReadPair.hpp"
+#include "ReadFlags.hpp"
+#include "ReadGraph.hpp"
+#include "SHASTA_ASSERT.hpp"
+using namespace shasta;
+
+// Boost libraries.
+#include <boost/algorithm/string.hpp>
+
+// Standard library.
+#include "algorithm.hpp"
+#include "array.hpp"
+#include <cmath>
+#include <filesystem>
+#include "fstream.hpp"
+#include <iomanip>
+#include "iostream.hpp"
+#include "stdexcept.hpp"
+
+
+
+ResourceEstimator::ResourceEstimator(
+    const AssemblerOptions& assemblerOptions,
+    uint64_t threadCount) :
+    assemblerOptions(assemblerOptions),
+    threadCount(threadCount)
+{
+    // Sample the input files.
+    for(const string& fileName: assemblerOptions.commandLineOnlyOptions.inputFileNames) {
+        sampleInputFile(fileName);
+    }
+    if(inputStatistics.readCount == 0.) {
+        throw runtime_error("No reads with length at least " +
+            to_string(assemblerOptions.readsOptions.minReadLength) +
+            " were found in the input files.");
+    }
+
+    // If requested, the assembly will increase the read length cutoff
+    // to reduce coverage to the specified amount.
+    // This discards the shortest reads, so the reduction in read count
+    // is overestimated here, which is conservative for memory.
+    const double desiredCoverage = double(assemblerOptions.readsOptions.desiredCoverage);
+    if(desiredCoverage > 0. and inputStatistics.baseCount > desiredCoverage) {
+        const double factor = desiredCoverage / inputStatistics.baseCount;
+        inputStatistics.readCount *= factor;
+        inputStatistics.baseCount *= factor;
+        inputStatistics.rleBaseCount *= factor;
+        inputStatistics.nameAndMetaDataBytes *= factor;
+    }
+
+    // Read the calibration information from past assemblies.
+    for(const string& directory: assemblerOptions.commandLineOnlyOptions.calibrationDirectories) {
+        readCalibration(directory);
+    }
+
+    // Create the phases and the data structures they create.
+    createPhases();
+
+    // Compute memory at the end of each phase and peak memory during each phase.
+    double memoryBytes = 0.;
+    for(Phase& phase: phases) {
+        double temporaryBytes = 0.;
+        for(const Structure& structure: phase.structures) {
+            if(structure.isPersistent) {
+                memoryBytes += structure.bytes;
+            } else {
+                temporaryBytes += structure.bytes;
+            }
+        }
+        phase.memoryBytes = memoryBytes;
+        phase.peakMemoryBytes = memoryBytes + temporaryBytes;
+        peakMemoryBytes = max(peakMemoryBytes, phase.peakMemoryBytes);
+        estimateTime(phase);
+        elapsedSeconds += phase.elapsedSeconds;
+    }
+
+    // All persistent structures end up in the Data directory.
+    dataBytes = memoryBytes;
+}
+
+
+
+// Sample the reads at the beginning of an input file
+// and extrapolate to the entire file.
+void ResourceEstimator::sampleInputFile(const string& fileName)
+{
+    if(!std::filesystem::exists(fileName)) {
+        throw runtime_error("Input file not found: " + fileName);
+    }
+
+    // Use the same file extensions accepted by ReadLoader.
+    string extension;
+    try {
+        extension = filesystem::extension(fileName);
+    } catch (...) {
+        throw runtime_error("Input file " + fileName +
+            " must have an extension consistent with its format.");
+    }
+    bool isFastq = false;
+    if(extension=="fastq" || extension=="fq" || extension=="FASTQ" || extension=="FQ") {
+        isFastq = true;
+    } else if(not(extension=="fasta" || extension=="fa" || extension=="FASTA" || extension=="FA")) {
+        throw runtime_error("File extension " + extension + " is not supported. "
+            "Supported file extensions are .fasta, .fa, .FASTA, .FA, .fastq, .fq, .FASTQ, .FQ.");
+    }
+
+    ifstream file(fileName);
+    if(not file) {
+        throw runtime_error("Error opening " + fileName);
+    }
+    const uint64_t fileSize = std::filesystem::file_size(fileName);
+
+    const uint64_t minReadLength = assemblerOptions.readsOptions.minReadLength;
+    const bool useRle = (assemblerOptions.readsOptions.representation == 1);
+    uint64_t sampledBytes = 0;
+    uint64_t readCount = 0;
+    uint64_t baseCount = 0;
+    uint64_t rleBaseCount = 0;
+    uint64_t nameAndMetaDataBytes = 0;
+
+    // Process a read. The header includes the initial '>' or '@'.
+    auto processRead = [&](const string& header, const string& sequence)
+    {
+        if(sequence.size() < minReadLength) {
+            return;
+        }
+        ++readCount;
+        baseCount += sequence.size();
+        if(useRle) {
+            for(uint64_t i=0; i<sequence.size(); i++) {
+                if(i==0 or sequence[i] != sequence[i-1]) {
+                    ++rleBaseCount;
+                }
+            }
+        } else {
+            rleBaseCount += sequence.size();
+        }
+        if(not header.empty()) {
+            nameAndMetaDataBytes += header.size() - 1;
+        }
+    };
+
+    string line;
+    string header;
+    string sequence;
+    bool reachedEnd = false;
+    if(isFastq) {
+        string plusLine;
+        string qualityLine;
+        while(sampledBytes < maxSampledBytes) {
+            if(not std::getline(file, header)) {
+                reachedEnd = true;
+                break;
+            }
+            std::getline(file, sequence);
+            std::getline(file, plusLine);
+            std::getline(file, qualityLine);
+            sampledBytes += header.size() + sequence.size() + plusLine.size() + qualityLine.size() + 4;
+            processRead(header, sequence);
+        }
+    } else {
+        // A fasta sequence can span multiple lines.
+        while(true) {
+            if(not std::getline(file, line)) {
+                reachedEnd = true;
+                break;
+            }
+            if(not line.empty() and line[0] == '>') {
+                if(not header.empty()) {
+                    processRead(header, sequence);
+                }
+                if(sampledBytes >= maxSampledBytes) {
+                    break;
+                }
+                header = line;
+                sequence.clear();
+            } else {
+                sequence += line;
+            }
+            sampledBytes += line.size() + 1;
+        }
+        if(reachedEnd and not header.empty()) {
+            processRead(header, sequence);
+        }
+    }
+
+    // Extrapolate to the entire file.
+    const double factor =
+        (reachedEnd or sampledBytes == 0) ? 1. : double(fileSize) / double(sampledBytes);
+    inputStatistics.fileSize += fileSize;
+    inputStatistics.sampledBytes += sampledBytes;
+    inputStatistics.readCount += factor * double(readCount);
+    inputStatistics.baseCount += factor * double(baseCount);
+    inputStatistics.rleBaseCount += factor * double(rleBaseCount);
+    inputStatistics.nameAndMetaDataBytes += factor * double(nameAndMetaDataBytes);
+
+    cout << "Sampled " << sampledBytes << " of " << fileSize << " bytes of " << fileName <<
+        ", found " << readCount << " reads with " << baseCount << " bases usable for assembly." << endl;
+}
+
+
+
+// Read the phase log of a past assembly, as written by logPhase.
+void ResourceEstimator::readCalibration(const string& directory)
+{
+    const string fileName = directory + "/PerformancePhases.csv";
+    ifstream file(fileName);
+    if(not file) {
+        throw runtime_error("Error opening " + fileName);
+    }
+
+    string line;
+    std::getline(file, line);
+    if(line.substr(0, 6) != "Phase,") {
+        throw runtime_error("Unexpected header in " + fileName);
+    }
+
+    while(std::getline(file, line)) {
+        if(line.empty()) {
+            continue;
+        }
+        vector<string> tokens;
+        boost::algorithm::split(tokens, line, boost::algorithm::is_any_of(","));
+        if(tokens.size() != 7) {
+            throw runtime_error("Invalid line in " + fileName + ": " + line);
+        }
+        PhaseCalibration& phaseCalibration = calibration[tokens[0]];
+        try {
+            phaseCalibration.cpuSeconds += std::stod(tokens[1]) * std::stod(tokens[3]);
+            phaseCalibration.peakMemoryBytes += std::stod(tokens[2]);
+            phaseCalibration.readCount += std::stod(tokens[4]);
+            phaseCalibration.baseCount += std::stod(tokens[5]);
+            phaseCalibration.itemCount += std::stod(tokens[6]);
+        } catch(const std::exception&) {
+            throw runtime_error("Invalid line in " + fileName + ": " + line);
+        }
+        ++phaseCalibration.assemblyCount;
+    }
+    cout << "Read calibration information from " << fileName << endl;
+}
+
+
+
+// Return the ratio of item counts for two phases,
+// as observed in past assemblies, or 0 if not available.
+double ResourceEstimator::getCalibratedRatio(
+    const string& numeratorPhaseName,
+    const string& denominatorPhaseName) const
+{
+    const auto it0 = calibration.find(numeratorPhaseName);
+    const auto it1 = calibration.find(denominatorPhaseName);
+    if(it0 == calibration.end() or it1 == calibration.end()) {
+        return 0.;
+    }
+    const PhaseCalibration& numerator = it0->second;
+    const PhaseCalibration& denominator = it1->second;
+    if(numerator.assemblyCount != denominator.assemblyCount or denominator.itemCount == 0.) {
+        return 0.;
+    }
+    return numerator.itemCount / denominator.itemCount;
+}
+
+
+
+// Create the phases and the data structures they create.
+// The phase names are the ones used in the phase log by --command assemble.
+void ResourceEstimator::createPhases()
+{
+    const double readCount = inputStatistics.readCount;
+    const double orientedReadCount = 2. * readCount;
+    const double baseCount = inputStatistics.baseCount;
+    const double rleBaseCount = inputStatistics.rleBaseCount;
+    const bool useRle = (assemblerOptions.readsOptions.representation == 1);
+    const uint64_t k = assemblerOptions.kmersOptions.k;
+    const double probability = assemblerOptions.kmersOptions.probability;
+    const auto& minHashOptions = assemblerOptions.minHashOptions;
+
+    // Markers, on both strands.
+    // Markers are found on the RLE sequence if using the RLE representation.
+    const double markerCount =
+        2. * probability * max(0., rleBaseCount - readCount * double(k - 1));
+    const double markersPerOrientedRead = markerCount / orientedReadCount;
+
+    // Alignment candidates.
+    double candidateCount = readCount * getCalibratedRatio("AlignmentCandidates", "LoadReads");
+    if(candidateCount == 0.) {
+        if(minHashOptions.allPairs) {
+            candidateCount = readCount * (readCount - 1.);
+        } else {
+            // alignmentCandidatesPerRead counts each candidate for both its reads.
+            candidateCount = 0.5 * readCount * minHashOptions.alignmentCandidatesPerRead;
+        }
+    }
+
+    // Alignments. If not calibrated, assume half of the candidates
+    // generate a good alignment.
+    double alignmentCount = readCount * getCalibratedRatio("Alignments", "LoadReads");
+    if(alignmentCount == 0.) {
+        alignmentCount = 0.5 * candidateCount;
+    }
+
+    // Read graph edges. They are stored in reverse complemented pairs.
+    double readGraphEdgeCount = readCount * getCalibratedRatio("ReadGraph", "LoadReads");
+    if(readGraphEdgeCount == 0.) {
+        readGraphEdgeCount = 2. * min(alignmentCount,
+            0.5 * readCount * double(assemblerOptions.readGraphOptions.maxAlignmentCount));
+    }
+
+    // Marker graph vertices, on both strands.
+    // Each vertex corresponds to a marker on the genome and its reverse complement,
+    // so if the genome size is known this is independent of coverage.
+    // Otherwise, use calibration if available, or assume 30x coverage.
+    const double genomeSize = double(assemblerOptions.commandLineOnlyOptions.genomeSize);
+    double vertexCount = 0.;
+    if(genomeSize > 0.) {
+        vertexCount = 2. * probability * genomeSize * (rleBaseCount / baseCount);
+    } else {
+        vertexCount = markerCount * getCalibratedRatio("MarkerGraph", "Markers");
+        if(vertexCount == 0.) {
+            vertexCount = markerCount / 30.;
+        }
+    }
+
+    // After transitive reduction, most vertices have one outgoing edge,
+    // but before that there are more edges.
+    const double markerGraphEdgeCount = 1.2 * vertexCount;
+
+    // Average number of RLE bases between consecutive markers.
+    const double markerSpacing = 1. / probability;
+
+
+
+    // Reads.
+    {
+        Phase phase;
+        phase.name = "LoadReads";
+        phase.structures.push_back({"Read sequences",
+            rleBaseCount / 4. + 16. * readCount, true});
+        if(useRle) {
+            phase.structures.push_back({"Read repeat counts",
+                rleBaseCount + 8. * readCount, true});
+        }
+        phase.structures.push_back({"Read names and meta data",
+            inputStatistics.nameAndMetaDataBytes + 16. * readCount, true});
+        phase.structures.push_back({"Read flags and sorted read ids",
+            readCount * double(sizeof(ReadFlags) + sizeof(ReadId)), true});
+        phases.push_back(phase);
+    }
+
+    // K-mers.
+    {
+        Phase phase;
+        phase.name = "Kmers";
+#ifndef SHASTA_LONG_KMERS
+        // Builds with long k-mers don't use a k-mer table.
+        phase.structures.push_back({"K-mer table",
+            std::pow(4., double(k)) * double(sizeof(KmerInfo)), true});
+#endif
+        phases.push_back(phase);
+    }
+
+    // Markers.
+    {
+        Phase phase;
+        phase.name = "Markers";
+        phase.structures.push_back({"Markers",
+            markerCount * double(sizeof(CompressedMarker)) + 8. * orientedReadCount, true});
+        phases.push_back(phase);
+    }
+
+    // Alignment candidates.
+    {
+        Phase phase;
+        phase.name = "AlignmentCandidates";
+        if(not minHashOptions.allPairs and minHashOptions.version == 2) {
+
+            // LowHash2 stores the low hash features of all oriented reads
+            // in a single index, then stores the ordinals of the chained
+            // common features of each candidate. We assume
+            // an average overlap of half a read.
+            const double lowHashCount = minHashOptions.hashFraction * markerCount;
+            const double log2LowHashCount = std::floor(std::log2(max(1., lowHashCount))) + 1.;
+            const double bucketCount = std::pow(2., 2. + log2LowHashCount);
+            phase.structures.push_back({"LowHash buckets",
+                12. * lowHashCount + 8. * bucketCount, false});
+            const double commonFeaturesPerCandidate =
+                minHashOptions.hashFraction * 0.5 * markersPerOrientedRead;
+            phase.structures.push_back({"LowHash common features",
+                candidateCount * commonFeaturesPerCandidate * double(sizeof(array<uint32_t, 2>)) +
+                8. * candidateCount, true});
+
+        } else if(not minHashOptions.allPairs) {
+
+            // The number of low hash buckets is chosen by LowHash0/LowHash1
+            // based on the expected number of low hashes.
+            const double lowHashCount = minHashOptions.hashFraction * markerCount;
+            const double log2LowHashCount = std::floor(std::log2(max(1., lowHashCount))) + 1.;
+            const double bucketCount = std::pow(2., min(31., 5. + log2LowHashCount));
+            phase.structures.push_back({"LowHash k-mer ids",
+                markerCount * double(sizeof(KmerId)) + 8. * orientedReadCount, false});
+            phase.structures.push_back({"LowHash low hashes",
+                8. * lowHashCount + 24. * orientedReadCount, false});
+            phase.structures.push_back({"LowHash buckets",
+                8. * lowHashCount + 8. * bucketCount, false});
+
+            // LowHash1 also stores the ordinals of the common features of each candidate.
+            // Each iteration finds the low hash features shared by the two reads,
+            // and we assume an average overlap of half a read.
+            if(minHashOptions.version == 1) {
+                const double commonFeaturesPerCandidate =
+                    double(minHashOptions.minHashIterationCount) *
+                    minHashOptions.hashFraction * 0.5 * markersPerOrientedRead;
+                phase.structures.push_back({"LowHash common features",
+                    candidateCount * commonFeaturesPerCandidate * double(sizeof(array<uint32_t, 2>)) +
+                    8. * candidateCount, true});
+            }
+        }
+        phase.structures.push_back({"Alignment candidates",
+            candidateCount * double(sizeof(OrientedReadPair)), true});
+
+        // LowHash1 and LowHash2 also store a band for each candidate.
+        if(not minHashOptions.allPairs and minHashOptions.version != 0) {
+            phase.structures.push_back({"Alignment candidate bands",
+                candidateCount * double(sizeof(AlignmentCandidateBand)), true});
+        }
+
+        // Each candidate appears in the candidate table for both reads in both orientations.
+        phase.structures.push_back({"Candidate table",
+            4. * 8. * candidateCount + 8. * orientedReadCount, true});
+        phases.push_back(phase);
+    }
+
+    // Alignments.
+    {
+        Phase phase;
+        phase.name = "Alignments";
+        if(assemblerOptions.alignOptions.alignMethod == 4) {
+            phase.structures.push_back({"Sorted markers",
+                markerCount * double(sizeof(pair<KmerId, uint32_t>)) + 8. * orientedReadCount, true});
+        }
+        phase.structures.push_back({"Alignment data",
+            alignmentCount * double(sizeof(AlignmentData)), true});
+
+        // The size of a compressed alignment depends on the number
+        // of gaps in the alignment. Use a rough average.
+        phase.structures.push_back({"Compressed alignments",
+            alignmentCount * (64. + 8.), true});
+        phase.structures.push_back({"Alignment table",
+            2. * 4. * alignmentCount + 4. * orientedReadCount, true});
+        phases.push_back(phase);
+    }
+
+    // Read graph.
+    {
+        Phase phase;
+        phase.name = "ReadGraph";
+        phase.structures.push_back({"Read graph",
+            readGraphEdgeCount * double(sizeof(ReadGraphEdge) + 2 * sizeof(uint32_t)) +
+            4. * orientedReadCount, true});
+        phases.push_back(phase);
+    }
+
+    // Marker graph.
+    {
+        Phase phase;
+        phase.name = "MarkerGraph";
+        phase.structures.push_back({"Disjoint sets",
+            markerCount * double(sizeof(DisjointSets::Aint)), false});
+        phase.structures.push_back({"Disjoint set table",
+            markerCount * double(sizeof(MarkerGraph::VertexId)), false});
+        phase.structures.push_back({"Marker graph vertices",
+            markerCount * double(sizeof(MarkerId) + sizeof(MarkerGraph::CompressedVertexId)) +
+            vertexCount * double(sizeof(MarkerGraph::CompressedVertexId) + sizeof(MarkerGraph::VertexId)),
+            true});
+        phase.structures.push_back({"Marker graph edges",
+            markerGraphEdgeCount * double(sizeof(MarkerGraph::Edge) + sizeof(MarkerGraph::EdgeId)) +
+            2. * (markerGraphEdgeCount * double(sizeof(Uint40)) + 8. * vertexCount), true});
+        phase.structures.push_back({"Marker graph edge marker intervals",
+            markerCount * double(sizeof(MarkerInterval)) + 8. * markerGraphEdgeCount, true});
+        phases.push_back(phase);
+    }
+
+    // Consensus and assembly.
+    {
+        Phase phase;
+        phase.name = "Assembly";
+        if(useRle) {
+            phase.structures.push_back({"Vertex repeat counts",
+                vertexCount * double(k), true});
+        }
+        phase.structures.push_back({"Edge consensus",
+            markerGraphEdgeCount * (markerSpacing * double(sizeof(pair<Base, uint8_t>)) + 9.), true});
+        phase.structures.push_back({"Assembled sequence",
+            vertexCount * markerSpacing * 2., true});
+        phases.push_back(phase);
+    }
+}
+
+
+
+// Estimate the elapsed time of a phase.
+// The cost of each phase is assumed to be proportional to the number
+// of input bases and inversely proportional to the number of threads.
+void ResourceEstimator::estimateTime(Phase& phase) const
+{
+    double cpuSecondsPerBase = 0.;
+    const auto it = calibration.find(phase.name);
+    if(it != calibration.end() and it->second.baseCount > 0.) {
+        cpuSecondsPerBase = it->second.cpuSeconds / it->second.baseCount;
+        phase.timeIsCalibrated = true;
+    } else {
+        cpuSecondsPerBase = defaultCpuSecondsPerBase(phase.name);
+        phase.timeIsCalibrated = false;
+    }
+    phase.elapsedSeconds = cpuSecondsPerBase * inputStatistics.baseCount / double(threadCount);
+}
+
+
+
+// Rough defaults, in cpu seconds per input base,
+// corresponding to about 2 cpu hours per Gb in total
+// and only meant to give an order of magnitude.
+double ResourceEstimator::defaultCpuSecondsPerBase(const string& phaseName)
+{
+    const double total = 2. * 3600. / 1.e9;
+    if(phaseName == "LoadReads") {
+        return 0.05 * total;
+    } else if(phaseName == "Kmers") {
+        return 0.02 * total;
+    } else if(phaseName == "Markers") {
+        return 0.05 * total;
+    } else if(phaseName == "AlignmentCandidates") {
+        return 0.15 * total;
+    } else if(phaseName == "Alignments") {
+        return 0.45 * total;
+    } else if(phaseName == "ReadGraph") {
+        return 0.03 * total;
+    } else if(phaseName == "MarkerGraph") {
+        return 0.15 * total;
+    } else if(phaseName == "Assembly") {
+        return 0.10 * total;
+    }
+    SHASTA_ASSERT(0);
+}
+
+
+
+void ResourceEstimator::write(ostream& s) const
+{
+    const double GiB = 1024. * 1024. * 1024.;
+    s << std::fixed << std::setprecision(2);
+
+    s << "\nEstimated input:\n"
+        "    Reads: " << uint64_t(inputStatistics.readCount) << "\n"
+        "    Bases: " << uint64_t(inputStatistics.baseCount) << "\n";
+    if(assemblerOptions.readsOptions.representation == 1) {
+        s << "    RLE bases: " << uint64_t(inputStatistics.rleBaseCount) << "\n";
+    }
+    s << "    Threads: " << threadCount << "\n";
+
+    for(const Phase& phase: phases) {
+        s << "\nPhase " << phase.name << ":\n";
+        for(const Structure& structure: phase.structures) {
+            s << "    " << std::setw(40) << std::left << structure.name <<
+                std::setw(10) << std::right << structure.bytes / GiB << " GiB" <<
+                (structure.isPersistent ? "" : " (temporary)") << "\n";
+        }
+        s << "    Memory at end of phase " << phase.memoryBytes / GiB << " GiB, "
+            "peak " << phase.peakMemoryBytes / GiB << " GiB.\n";
+        s << "    Elapsed time " << phase.elapsedSeconds / 60. << " minutes" <<
+            (phase.timeIsCalibrated ? "" : " (not calibrated)") << ".\n";
+    }
+
+    s << "\nEstimated peak memory: " << peakMemoryBytes / GiB << " GiB\n";
+    s << "Estimated size of binary data (Data directory): " << dataBytes / GiB << " GiB\n";
+    s << "Estimated elapsed time: " << elapsedSeconds / 3600. << " hours\n";
+
+    // If past assemblies are available, also show the peak memory
+    // they used, scaled by number of input bases.
+    const auto it = calibration.find("Assembly");
+    if(it != calibration.end() and it->second.baseCount > 0.) {
+        s << "Peak memory extrapolated from past assemblies: " <<
+            (it->second.peakMemoryBytes / it->second.baseCount) * inputStatistics.baseCount / GiB <<
+            " GiB\n";
+    } else {
+        s << "Use --calibrationDirectory with the assembly directories of past assemblies\n"
+            "of similar data on similar hardware to obtain meaningful time estimates.\n";
+    }
+    s << std::defaultfloat;
+}
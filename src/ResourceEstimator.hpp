@@ -0,0 +1,146 @@
+#ifndef SHASTA_RESOURCE_ESTIMATOR_HPP
+#define SHASTA_RESOURCE_ESTIMATOR_HPP
+
+/*******************************************************************************
+
+Class ResourceEstimator is used by --command estimateResources
+to predict the resources required by an assembly
+before running it:
+
+- Peak memory.
+- Size of the binary data in the Data directory.
+- Elapsed time for each phase of the assembly.
+
+The estimate uses:
+
+- The options in effect, including the ones
+  in the configuration specified with --config.
+
+- The sizes of the input files and a sample of the reads
+  at the beginning of each input file. This is used to estimate
+  the number of reads and bases that will be used in the assembly,
+  after discarding reads shorter than --Reads.minReadLength.
+
+- A model of the largest data structures created
+  during each phase of the assembly.
+
+- If --calibrationDirectory is used, the phase logs
+  (PerformancePhases.csv) of past assemblies, which are used to
+  calibrate the elapsed time of each phase and the sizes
+  that depend on the data (alignment candidates, alignments,
+  marker graph vertices).
+
+The estimates are rough, and the time estimates in particular are
+only meaningful if calibrated with past assemblies of similar data
+on similar hardware.
+
+*******************************************************************************/
+
+// Standard library.
+#include "cstdint.hpp"
+#include "iosfwd.hpp"
+#include <map>
+#include "string.hpp"
+#include "vector.hpp"
+
+namespace shasta {
+    class AssemblerOptions;
+    class ResourceEstimator;
+}
+
+
+
+class shasta::ResourceEstimator {
+public:
+
+    ResourceEstimator(
+        const AssemblerOptions&,
+        uint64_t threadCount);
+
+    void write(ostream&) const;
+
+private:
+    const AssemblerOptions& assemblerOptions;
+    uint64_t threadCount;
+
+
+
+    // Statistics of the input reads.
+    // These are extrapolated from a sample of the reads
+    // at the beginning of each input file.
+    class InputStatistics {
+    public:
+        uint64_t fileSize = 0;
+        uint64_t sampledBytes = 0;
+
+        // These only include reads that will be used in the assembly.
+        double readCount = 0.;
+        double baseCount = 0.;
+        double rleBaseCount = 0.;
+        double nameAndMetaDataBytes = 0.;
+    };
+    InputStatistics inputStatistics;
+    void sampleInputFile(const string& fileName);
+
+    // The maximum number of bytes sampled at the beginning of each input file.
+    static const uint64_t maxSampledBytes = 256 * 1024 * 1024;
+
+
+
+    // Calibration information from the phase logs of past assemblies,
+    // keyed by phase name.
+    class PhaseCalibration {
+    public:
+        double cpuSeconds = 0.;
+        double peakMemoryBytes = 0.;
+        double readCount = 0.;
+        double baseCount = 0.;
+        double itemCount = 0.;
+        uint64_t assemblyCount = 0;
+    };
+    std::map<string, PhaseCalibration> calibration;
+    void readCalibration(const string& directory);
+
+    double getCalibratedRatio(
+        const string& numeratorPhaseName,
+        const string& denominatorPhaseName) const;
+
+
+
+    // A data structure created during a phase of the assembly.
+    // Persistent structures are part of the binary data (Data directory)
+    // and remain in memory until the end of the assembly.
+    // Other structures are freed at the end of the phase.
+    class Structure {
+    public:
+        string name;
+        double bytes;
+        bool isPersistent;
+    };
+
+    class Phase {
+    public:
+        string name;
+        vector<Structure> structures;
+        double elapsedSeconds = 0.;
+        bool timeIsCalibrated = false;
+
+        // Memory at the end of the phase (persistent structures only),
+        // and peak memory during the phase.
+        double memoryBytes = 0.;
+        double peakMemoryBytes = 0.;
+    };
+    vector<Phase> phases;
+    void createPhases();
+    void estimateTime(Phase&) const;
+
+    double peakMemoryBytes = 0.;
+    double dataBytes = 0.;
+    double elapsedSeconds = 0.;
+
+    // Default cost of each phase, in cpu seconds per input base,
+    // used for phases for which no calibration is available.
+    static double defaultCpuSecondsPerBase(const string& phaseName);
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include "SimpleBayesianConsensusCaller.hpp"
 #include "Coverage.hpp"
 #include "ConsensusCaller.hpp"
+#include "cpuDispatch.hpp"
 using namespace shasta;
 
 // Boost libraries.
@@ -180,6 +181,17 @@ SimpleBayesianConsensusCaller::SimpleBayesianConsensusCaller(
     maxInputRunlength = uint16_t(probabilityMatrices[0][0].size() - 1);
     maxOutputRunlength = uint16_t(probabilityMatrices[0].size() - 1);
 
+    // Store the probability matrices transposed, for accumulateLogLikelihoods.
+    const uint64_t yCount = uint64_t(maxOutputRunlength) + 1;
+    for(uint64_t base=0; base<4; base++) {
+        transposedProbabilityMatrices[base].resize((uint64_t(maxInputRunlength) + 1) * yCount);
+        for(uint64_t y=0; y<yCount; y++) {
+            for(uint64_t x=0; x<=maxInputRunlength; x++) {
+                transposedProbabilityMatrices[base][x * yCount + y] = probabilityMatrices[base][y][x];
+            }
+        }
+    }
+
     cout << "Bayesian consensus caller configuration name is " <<
         configurationName << endl;
 }
@@ -376,9 +388,7 @@ uint16_t SimpleBayesianConsensusCaller::predictRunlength(const Coverage &coverag
 
     size_t priorIndex = -1;   // Used to determine which prior probability vector to access (AT=0 or GC=1)
     uint16_t x;               // Element of X = {x_0, x_1, ..., x_i} observed repeats
-    uint16_t c;               // Number of times x_i was observed
     uint16_t y;               // Element of Y = {y_0, y_1, ..., y_j} true repeat between 0 and j=max_runlength
-    double logSum;            // Product (in logspace) of P(x_i|y_j) for each i
 
     double yMaxLikelihood = -INF;     // Probability of most probable true repeat length
     uint16_t yMax = 0;                 // Most probable repeat length
@@ -400,32 +410,39 @@ uint16_t SimpleBayesianConsensusCaller::predictRunlength(const Coverage &coverag
         factorRepeats(factoredRepeats, coverage);
     }
 
-    // Iterate all possible Y from 0 to j to calculate p(Y_j|X) where X is all observations 0 to i,
-    // assuming i and j are less than maxRunlength
-    for (y = 0; y <= maxOutputRunlength; y++){
-        // Initialize logSum for this Y value using empirically determined priors
-        logSum = priors[priorIndex][y];
-
-        for (uint16_t strand = 0; strand <= factoredRepeats.size() - 1; strand++){
-            for (auto& item: factoredRepeats[strand]){
-                x = item.first;
-                c = item.second;
-
-                // In the case that observed runlength is too large for the matrix, cap it at maxRunlength
-                if (x > maxInputRunlength){
-                    x = maxInputRunlength;
-                }
+    // Gather the observed repeats and their counts, for both strands.
+    vector<uint16_t> xValues;
+    vector<double> counts;
+    for (uint16_t strand = 0; strand <= factoredRepeats.size() - 1; strand++){
+        for (auto& item: factoredRepeats[strand]){
+            x = item.first;
 
-                // Increment log likelihood for this y_j
-                logSum += double(c)*probabilityMatrices[consensusBase.value][y][x];
+            // In the case that observed runlength is too large for the matrix, cap it at maxRunlength
+            if (x > maxInputRunlength){
+                x = maxInputRunlength;
             }
+
+            xValues.push_back(x);
+            counts.push_back(double(item.second));
         }
+    }
 
-        logLikelihoodY[y] = logSum;
+    // Calculate the log likelihood of each Y from 0 to j, log p(Y_j|X) where X is all observations 0 to i,
+    // assuming i and j are less than maxRunlength.
+    // Initialize with the empirically determined priors.
+    const uint64_t yCount = uint64_t(maxOutputRunlength) + 1;
+    for (y = 0; y <= maxOutputRunlength; y++){
+        logLikelihoodY[y] = priors[priorIndex][y];
+    }
+    accumulateLogLikelihoods(
+        transposedProbabilityMatrices[consensusBase.value].data(), yCount,
+        xValues.data(), counts.data(), xValues.size(),
+        logLikelihoodY.data());
 
-        // Update max Y value if log likelihood is greater than previous maximum... Should do this outside this loop?
-        if (logSum > yMaxLikelihood){
-            yMaxLikelihood = logSum;
+    // Find the Y with the maximum log likelihood.
+    for (y = 0; y <= maxOutputRunlength; y++){
+        if (logLikelihoodY[y] > yMaxLikelihood){
+            yMaxLikelihood = logLikelihoodY[y];
             yMax = y;
         }
     }
@@ -436,6 +453,51 @@ uint16_t SimpleBayesianConsensusCaller::predictRunlength(const Coverage &coverag
 }
 
 
+// Add to logLikelihoodY[y] the log likelihood contributions of the observed repeats,
+// count * p(x|y), for y in [0, yCount). The contributions are added
+// for each y in the same order as the observed repeats, and multiplies and adds
+// are not contracted into fused multiply-adds, so the result does not depend
+// on which version of this dispatched kernel is used.
+SHASTA_CPU_DISPATCH __attribute__((optimize("fp-contract=off"))) void SimpleBayesianConsensusCaller::accumulateLogLikelihoods(
+    const double* transposedProbabilityMatrix,
+    uint64_t yCount,
+    const uint16_t* xValues,
+    const double* counts,
+    uint64_t n,
+    double* logLikelihoodY)
+{
+    // Process blocks of blockSize consecutive values of y,
+    // keeping their log likelihoods in registers.
+    const uint64_t blockSize = 8;
+    uint64_t yBegin = 0;
+    for(; yBegin+blockSize<=yCount; yBegin+=blockSize) {
+        double blockLogLikelihood[blockSize];
+        for(uint64_t j=0; j<blockSize; j++) {
+            blockLogLikelihood[j] = logLikelihoodY[yBegin + j];
+        }
+        for(uint64_t i=0; i<n; i++) {
+            const double* p = transposedProbabilityMatrix + uint64_t(xValues[i]) * yCount + yBegin;
+            const double c = counts[i];
+            for(uint64_t j=0; j<blockSize; j++) {
+                blockLogLikelihood[j] += c * p[j];
+            }
+        }
+        for(uint64_t j=0; j<blockSize; j++) {
+            logLikelihoodY[yBegin + j] = blockLogLikelihood[j];
+        }
+    }
+
+    // The remaining values of y.
+    for(uint64_t y=yBegin; y<yCount; y++) {
+        double logSum = logLikelihoodY[y];
+        for(uint64_t i=0; i<n; i++) {
+            logSum += counts[i] * transposedProbabilityMatrix[uint64_t(xValues[i]) * yCount + y];
+        }
+        logLikelihoodY[y] = logSum;
+    }
+}
+
+
 AlignedBase SimpleBayesianConsensusCaller::predictConsensusBase(const Coverage& coverage) const{
     const vector<CoverageData>& coverageDataVector = coverage.getReadCoverageData();
     vector<uint32_t> baseCounts(5,0);
@@ -92,6 +92,10 @@ private:
     // priors p(Y) normalized for each Y, where X = observed and Y = True run length
     array<vector<double>, 2> priors;
 
+    // The same as probabilityMatrices, but stored transposed and flattened:
+    // p(x|y) is at [x * (maxOutputRunlength + 1) + y].
+    array<vector<double>, 4> transposedProbabilityMatrices;
+
     /// ----- Methods ----- ///
 
     // Attempt to construct interpreting the constructor string as
@@ -118,6 +122,16 @@ private:
     // For a given vector of likelihoods over each Y value, normalize by the maximum
     void normalizeLikelihoods(vector<double>& x, double xMax) const;
 
+    // Add the log likelihood contributions of the observed repeats to logLikelihoodY.
+    // This is a runtime dispatched kernel (see cpuDispatch.hpp).
+    static void accumulateLogLikelihoods(
+        const double* transposedProbabilityMatrix,
+        uint64_t yCount,
+        const uint16_t* xValues,
+        const double* counts,
+        uint64_t n,
+        double* logLikelihoodY);
+
     // Count the number of times each unique repeat was observed, to reduce redundancy in calculating log likelihoods
     void factorRepeats(array<std::map<uint16_t, uint16_t>, 2>& factoredRepeats, const Coverage& coverage) const;
     void factorRepeats(array<std::map<uint16_t, uint16_t>, 2>& factoredRepeats, const Coverage& coverage, AlignedBase consensusBase) const;
@@ -0,0 +1,238 @@
+#ifndef SHASTA_ALIGN_LINEAR_GAPS_HPP
+#define SHASTA_ALIGN_LINEAR_GAPS_HPP
+
+/*******************************************************************************
+
+Global alignment of two integer sequences with linear gap scoring,
+optionally with free gaps at the beginning and/or end of the alignment.
+This computes the same alignment score as seqanAlign (see seqan.hpp)
+and returns the alignment in the same format, but it is designed
+for the many short alignments of integer sequences
+(for example, pseudo-paths) computed during iterative assembly:
+
+- It uses a LinearGapAlignerWorkArea that can be reused
+  for many alignments, so there are no memory allocations
+  after the first few alignments.
+
+- The dynamic programming matrix is filled one row at a time.
+  The diagonal and vertical moves for an entire row don't depend
+  on each other and are computed in a branch-free loop the compiler
+  can vectorize. Horizontal moves are then applied with
+  a single running maximum over the row.
+
+- Only two rows of scores are kept. The traceback uses one byte per cell.
+
+When more than one alignment achieves the optimal score,
+the alignment returned can be different from the one returned by seqanAlign.
+In the traceback, diagonal moves are preferred over vertical moves
+(gaps in the second sequence) which are preferred over horizontal moves
+(gaps in the first sequence).
+
+*******************************************************************************/
+
+// Shasta.
+#include "SHASTA_ASSERT.hpp"
+
+// Standard library.
+#include "algorithm.hpp"
+#include "cstdint.hpp"
+#include <cstdlib>
+#include <limits>
+#include "utility.hpp"
+#include "vector.hpp"
+
+namespace shasta {
+
+    class LinearGapAlignerWorkArea {
+    public:
+        // Scores for the previous and current row.
+        vector<int32_t> previousRow;
+        vector<int32_t> currentRow;
+
+        // The traceback, one byte per cell, stored by row.
+        vector<uint8_t> traceback;
+        static const uint8_t diagonalMove = 0;
+        static const uint8_t verticalMove = 1;
+        static const uint8_t horizontalMove = 2;
+    };
+
+    // The alignment is returned in the same format used by seqanAlign.
+    template<class Int>
+        int64_t alignLinearGaps(
+            const Int* sequence0, uint64_t n0,
+            const Int* sequence1, uint64_t n1,
+            int64_t matchScore,
+            int64_t mismatchScore,
+            int64_t gapScore,
+            bool freeOnLeft,
+            bool freeOnRight,
+            vector< pair<bool, bool> >& alignment,
+            LinearGapAlignerWorkArea&);
+
+    // Convenience overload for vectors.
+    template<class Int>
+        int64_t alignLinearGaps(
+            const vector<Int>& sequence0,
+            const vector<Int>& sequence1,
+            int64_t matchScore,
+            int64_t mismatchScore,
+            int64_t gapScore,
+            bool freeOnLeft,
+            bool freeOnRight,
+            vector< pair<bool, bool> >& alignment,
+            LinearGapAlignerWorkArea& workArea)
+    {
+        return alignLinearGaps(
+            sequence0.data(), sequence0.size(),
+            sequence1.data(), sequence1.size(),
+            matchScore, mismatchScore, gapScore,
+            freeOnLeft, freeOnRight,
+            alignment, workArea);
+    }
+}
+
+
+
+template<class Int>
+    int64_t shasta::alignLinearGaps(
+    const Int* sequence0, uint64_t n0,
+    const Int* sequence1, uint64_t n1,
+    int64_t matchScore,
+    int64_t mismatchScore,
+    int64_t gapScore,
+    bool freeOnLeft,
+    bool freeOnRight,
+    vector< pair<bool, bool> >& alignment,
+    LinearGapAlignerWorkArea& workArea)
+{
+    // Like seqanAlign, we don't handle empty sequences.
+    SHASTA_ASSERT(n0 > 0);
+    SHASTA_ASSERT(n1 > 0);
+
+    // Scores are stored as 32-bit integers.
+    // Make sure they cannot overflow.
+    const int64_t maxAbsoluteScore = std::max(
+        std::max(std::abs(matchScore), std::abs(mismatchScore)),
+        std::abs(gapScore));
+    SHASTA_ASSERT(int64_t(n0 + n1 + 1) * maxAbsoluteScore <
+        int64_t(std::numeric_limits<int32_t>::max() / 2));
+    const int32_t match = int32_t(matchScore);
+    const int32_t mismatch = int32_t(mismatchScore);
+    const int32_t gap = int32_t(gapScore);
+
+    using WorkArea = LinearGapAlignerWorkArea;
+    vector<int32_t>& previousRow = workArea.previousRow;
+    vector<int32_t>& currentRow = workArea.currentRow;
+    vector<uint8_t>& traceback = workArea.traceback;
+    previousRow.resize(n1 + 1);
+    currentRow.resize(n1 + 1);
+    traceback.resize((n0 + 1) * (n1 + 1));
+    const uint64_t rowSize = n1 + 1;
+
+    // Row 0.
+    for(uint64_t j=0; j<=n1; j++) {
+        previousRow[j] = freeOnLeft ? 0 : int32_t(j) * gap;
+        traceback[j] = WorkArea::horizontalMove;
+    }
+
+    // Keep track of the best score in the last column,
+    // in case freeOnRight is set.
+    int32_t bestLastColumnScore = previousRow[n1];
+    uint64_t bestLastColumnRow = 0;
+
+    // Fill in the remaining rows.
+    for(uint64_t i=1; i<=n0; i++) {
+        const Int x0 = sequence0[i-1];
+        uint8_t* tracebackRow = traceback.data() + i * rowSize;
+        int32_t* h = currentRow.data();
+        const int32_t* hPrevious = previousRow.data();
+
+        // Column 0.
+        h[0] = freeOnLeft ? 0 : int32_t(i) * gap;
+        tracebackRow[0] = WorkArea::verticalMove;
+
+        // Diagonal and vertical moves.
+        // This loop has no dependencies between iterations.
+        for(uint64_t j=1; j<=n1; j++) {
+            const int32_t diagonal = hPrevious[j-1] + ((sequence1[j-1] == x0) ? match : mismatch);
+            const int32_t vertical = hPrevious[j] + gap;
+            const bool useVertical = vertical > diagonal;
+            h[j] = useVertical ? vertical : diagonal;
+            tracebackRow[j] = useVertical ? WorkArea::verticalMove : WorkArea::diagonalMove;
+        }
+
+        // Horizontal moves.
+        for(uint64_t j=1; j<=n1; j++) {
+            const int32_t horizontal = h[j-1] + gap;
+            if(horizontal > h[j]) {
+                h[j] = horizontal;
+                tracebackRow[j] = WorkArea::horizontalMove;
+            }
+        }
+
+        if(h[n1] > bestLastColumnScore) {
+            bestLastColumnScore = h[n1];
+            bestLastColumnRow = i;
+        }
+
+        previousRow.swap(currentRow);
+    }
+
+    // Now previousRow contains the last row.
+    // Find the cell where the traceback starts.
+    uint64_t i = n0;
+    uint64_t j = n1;
+    int32_t score = previousRow[n1];
+    if(freeOnRight) {
+        for(uint64_t k=0; k<n1; k++) {
+            if(previousRow[k] > score) {
+                score = previousRow[k];
+                j = k;
+            }
+        }
+        if(bestLastColumnScore > score) {
+            score = bestLastColumnScore;
+            i = bestLastColumnRow;
+            j = n1;
+        }
+    }
+
+    // Construct the alignment in reverse order.
+    alignment.clear();
+    for(uint64_t k=j; k<n1; k++) {
+        alignment.push_back(make_pair(false, true));
+    }
+    for(uint64_t k=i; k<n0; k++) {
+        alignment.push_back(make_pair(true, false));
+    }
+    while(i>0 and j>0) {
+        switch(traceback[i * rowSize + j]) {
+        case WorkArea::diagonalMove:
+            alignment.push_back(make_pair(true, true));
+            --i;
+            --j;
+            break;
+        case WorkArea::verticalMove:
+            alignment.push_back(make_pair(true, false));
+            --i;
+            break;
+        case WorkArea::horizontalMove:
+            alignment.push_back(make_pair(false, true));
+            --j;
+            break;
+        default:
+            SHASTA_ASSERT(0);
+        }
+    }
+    for(; i>0; i--) {
+        alignment.push_back(make_pair(true, false));
+    }
+    for(; j>0; j--) {
+        alignment.push_back(make_pair(false, true));
+    }
+    std::reverse(alignment.begin(), alignment.end());
+
+    return score;
+}
+
+#endif
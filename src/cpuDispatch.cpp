@@ -0,0 +1,58 @@
+// Shasta.
+#include "cpuDispatch.hpp"
+
+// Standard library.
+#include "iostream.hpp"
+
+using namespace shasta;
+
+
+
+#if SHASTA_CPU_DISPATCH_IS_ENABLED
+// Versions of this function are selected by gcc in the same way
+// as the versions generated for SHASTA_CPU_DISPATCH,
+// so the one called tells which version of the dispatched kernels is in use.
+// The targets must be kept in sync with SHASTA_CPU_DISPATCH.
+namespace {
+    __attribute__((target("default"))) const char* selectedCpuDispatchTarget()
+    {
+        return "default";
+    }
+    __attribute__((target("arch=x86-64-v3"))) const char* selectedCpuDispatchTarget()
+    {
+        return "x86-64-v3";
+    }
+    __attribute__((target("arch=x86-64-v4"))) const char* selectedCpuDispatchTarget()
+    {
+        return "x86-64-v4";
+    }
+}
+#endif
+
+
+
+string shasta::cpuDispatchTarget()
+{
+#if SHASTA_CPU_DISPATCH_IS_ENABLED
+    return selectedCpuDispatchTarget();
+#else
+    return "default";
+#endif
+}
+
+
+
+void shasta::writeCpuDispatchInformation(ostream& s)
+{
+#if SHASTA_CPU_DISPATCH_IS_ENABLED
+    __builtin_cpu_init();
+    s << "CPU features: " <<
+        "popcnt " << (__builtin_cpu_supports("popcnt") ? "yes" : "no") <<
+        ", avx2 " << (__builtin_cpu_supports("avx2") ? "yes" : "no") <<
+        ", avx512f " << (__builtin_cpu_supports("avx512f") ? "yes" : "no") <<
+        ", avx512dq " << (__builtin_cpu_supports("avx512dq") ? "yes" : "no") <<
+        ". Using the " << cpuDispatchTarget() << " version of dispatched kernels." << endl;
+#else
+    s << "Runtime CPU dispatch is not used by this build." << endl;
+#endif
+}
@@ -0,0 +1,54 @@
+#ifndef SHASTA_CPU_DISPATCH_HPP
+#define SHASTA_CPU_DISPATCH_HPP
+
+// Runtime CPU dispatch for hot kernels.
+
+// The release binaries are built without -march=native (BUILD_NATIVE)
+// so they can run on any x86-64 machine. To let the compiler
+// use wider vector instructions where available, a function can be
+// declared with SHASTA_CPU_DISPATCH. The compiler then generates
+// several versions of it (x86-64-v4 with AVX-512, x86-64-v3 with AVX2,
+// baseline x86-64), and the best version supported by the CPU is selected
+// when the program is loaded (gcc function multiversioning, via ifunc).
+
+// This only makes a difference for loops compiled into the function
+// itself, so it should only be used on small leaf functions
+// whose running time is dominated by such loops.
+// It is currently used for:
+// - computeFeatureHashes (LowHash0, LowHash1, LowHash2).
+// - MarkerFinder::computeKmerIds.
+// - SimpleBayesianConsensusCaller::accumulateLogLikelihoods.
+// - touchMemory (this is limited by page faults, and the version used
+//   makes no measurable difference).
+// - Align4::Aligner::computeBandedAlignment.
+
+// Dispatch is only used with gcc on x86-64, and not when the build
+// already targets AVX2 or better (for example with -march=native).
+// It can be turned off with -DSHASTA_NO_CPU_DISPATCH.
+
+#include "iosfwd.hpp"
+#include "string.hpp"
+
+#if defined(__x86_64__) && defined(__GNUC__) && !defined(__clang__) && \
+    !defined(__AVX2__) && !defined(SHASTA_NO_CPU_DISPATCH)
+#define SHASTA_CPU_DISPATCH __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#define SHASTA_CPU_DISPATCH_IS_ENABLED 1
+#else
+#define SHASTA_CPU_DISPATCH
+#define SHASTA_CPU_DISPATCH_IS_ENABLED 0
+#endif
+
+namespace shasta {
+
+    // Return the version of the dispatched kernels
+    // selected for this CPU ("x86-64-v4", "x86-64-v3", or "default").
+    // This is obtained from gcc function multiversioning,
+    // using the same targets used by SHASTA_CPU_DISPATCH.
+    string cpuDispatchTarget();
+
+    // Write a one line description of the CPU features
+    // and of the dispatch choice.
+    void writeCpuDispatchInformation(ostream&);
+}
+
+#endif
@@ -0,0 +1,202 @@
+// Shasta.
+#include "featureHashes.hpp"
+#include "cpuDispatch.hpp"
+#include "MurmurHash2.hpp"
+#include "SHASTA_ASSERT.hpp"
+using namespace shasta;
+
+// Standard library.
+#include <bit>
+#include "algorithm.hpp"
+#include <random>
+#include "iostream.hpp"
+#include "vector.hpp"
+
+
+
+// The hashes are the same as computed by MurmurHash64A.
+// The code is reproduced here so it is compiled into each
+// version of the dispatched kernel, and so the 8-byte blocks
+// of each feature can be assembled directly from k-mer ids.
+// This assumes a little endian platform, like MurmurHash64A
+// reading its blocks from memory.
+static_assert(std::endian::native == std::endian::little);
+namespace shasta {
+    namespace featureHashes {
+
+        const uint64_t murmurM = 0xc6a4a7935bd1e995ULL;
+        const int murmurR = 47;
+
+        inline uint64_t addBlock(uint64_t h, uint64_t k)
+        {
+            k *= murmurM;
+            k ^= k >> murmurR;
+            k *= murmurM;
+            h ^= k;
+            h *= murmurM;
+            return h;
+        }
+
+        inline uint64_t finalize(uint64_t h)
+        {
+            h ^= h >> murmurR;
+            h *= murmurM;
+            h ^= h >> murmurR;
+            return h;
+        }
+
+        // Hash of the feature beginning at p.
+        inline __attribute__((always_inline)) uint64_t featureHash(
+            const KmerId* p, uint64_t m, uint64_t seed)
+        {
+            uint64_t h = seed ^ ((m * sizeof(KmerId)) * murmurM);
+            if constexpr(sizeof(KmerId) == 8) {
+                for(uint64_t j=0; j<m; j++) {
+                    h = addBlock(h, p[j]);
+                }
+            } else {
+                static_assert(sizeof(KmerId) == 4);
+                for(uint64_t j=0; j+1<m; j+=2) {
+                    h = addBlock(h, uint64_t(p[j]) | (uint64_t(p[j+1]) << 32));
+                }
+                if((m % 2) == 1) {
+                    // The last 4 bytes.
+                    h ^= uint64_t(p[m-1]);
+                    h *= murmurM;
+                }
+            }
+            return finalize(h);
+        }
+
+        // Version for a compile time constant m.
+        // The 8-byte blocks are first stored in a small buffer,
+        // so block j of feature i is blocks[i+j*(8/sizeof(KmerId))].
+        // The loop over features then only contains contiguous loads
+        // and the compiler can vectorize it.
+        const uint64_t chunkSize = 64;
+        const uint64_t laneCount = 4;
+        template<uint64_t m> inline __attribute__((always_inline)) void computeFeatureHashes(
+            const KmerId* kmerIds,
+            uint64_t featureCount,
+            uint64_t seed,
+            uint64_t* hashes)
+        {
+            const uint64_t step = 8 / sizeof(KmerId);
+            const uint64_t blockCount = m / step;
+            const uint64_t h0 = seed ^ ((m * sizeof(KmerId)) * murmurM);
+            uint64_t blocks[chunkSize + m];
+
+            for(uint64_t begin=0; begin<featureCount; begin+=chunkSize) {
+                const uint64_t n = min(chunkSize, featureCount - begin);
+                const KmerId* p = kmerIds + begin;
+
+                // Gather the blocks for the features in this chunk.
+                const uint64_t neededBlocks = n + (blockCount == 0 ? 0 : (blockCount - 1) * step);
+                for(uint64_t i=0; i<neededBlocks; i++) {
+                    if constexpr(step == 1) {
+                        blocks[i] = p[i];
+                    } else {
+                        blocks[i] = uint64_t(p[i]) | (uint64_t(p[i+1]) << 32);
+                    }
+                }
+
+                // Hash them, in groups of laneCount features.
+                // This loop is vectorized with 256-bit vectors
+                // where 64-bit vector multiplies are available (AVX-512DQ).
+                // With 512-bit vectors it was slower.
+                uint64_t i = 0;
+                for(; i+laneCount<=n; i+=laneCount) {
+                    uint64_t h[laneCount];
+                    for(uint64_t l=0; l<laneCount; l++) {
+                        h[l] = h0;
+                    }
+                    for(uint64_t j=0; j<blockCount; j++) {
+                        for(uint64_t l=0; l<laneCount; l++) {
+                            h[l] = addBlock(h[l], blocks[i + l + j*step]);
+                        }
+                    }
+                    if constexpr((m % step) != 0) {
+                        // The last 4 bytes.
+                        for(uint64_t l=0; l<laneCount; l++) {
+                            h[l] ^= uint64_t(p[i + l + m - 1]);
+                            h[l] *= murmurM;
+                        }
+                    }
+                    for(uint64_t l=0; l<laneCount; l++) {
+                        h[l] = finalize(h[l]);
+                    }
+                    for(uint64_t l=0; l<laneCount; l++) {
+                        hashes[begin + i + l] = h[l];
+                    }
+                }
+                for(; i<n; i++) {
+                    hashes[begin + i] = featureHash(p + i, m, seed);
+                }
+            }
+        }
+    }
+}
+
+
+
+SHASTA_CPU_DISPATCH void shasta::computeFeatureHashes(
+    const KmerId* kmerIds,
+    uint64_t kmerCount,
+    uint64_t m,
+    uint64_t seed,
+    uint64_t* hashes)
+{
+    using namespace featureHashes;
+    SHASTA_ASSERT(kmerCount >= m);
+    const uint64_t featureCount = kmerCount - m + 1;
+
+    // Use specialized versions for the most common values of m.
+    switch(m) {
+    case 2:
+        featureHashes::computeFeatureHashes<2>(kmerIds, featureCount, seed, hashes);
+        return;
+    case 3:
+        featureHashes::computeFeatureHashes<3>(kmerIds, featureCount, seed, hashes);
+        return;
+    case 4:
+        featureHashes::computeFeatureHashes<4>(kmerIds, featureCount, seed, hashes);
+        return;
+    case 5:
+        featureHashes::computeFeatureHashes<5>(kmerIds, featureCount, seed, hashes);
+        return;
+    case 6:
+        featureHashes::computeFeatureHashes<6>(kmerIds, featureCount, seed, hashes);
+        return;
+    default:
+        for(uint64_t i=0; i<featureCount; i++) {
+            hashes[i] = featureHash(kmerIds + i, m, seed);
+        }
+    }
+}
+
+
+
+// Check that computeFeatureHashes agrees with MurmurHash64A.
+void shasta::testFeatureHashes()
+{
+    std::mt19937_64 random(231);
+    vector<KmerId> kmerIds;
+    vector<uint64_t> hashes;
+    for(uint64_t kmerCount=1; kmerCount<200; kmerCount++) {
+        kmerIds.resize(kmerCount);
+        for(KmerId& kmerId: kmerIds) {
+            kmerId = KmerId(random());
+        }
+        for(uint64_t m=1; m<=min(kmerCount, uint64_t(10)); m++) {
+            const uint64_t seed = random() % 1000;
+            hashes.resize(kmerCount - m + 1);
+            computeFeatureHashes(kmerIds.data(), kmerCount, m, seed, hashes.data());
+            for(uint64_t i=0; i<hashes.size(); i++) {
+                SHASTA_ASSERT(hashes[i] ==
+                    MurmurHash64A(kmerIds.data() + i, int(m * sizeof(KmerId)), seed));
+            }
+        }
+    }
+    cout << "testFeatureHashes passed for the " << cpuDispatchTarget() <<
+        " version of dispatched kernels." << endl;
+}
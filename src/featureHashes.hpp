@@ -0,0 +1,25 @@
+#ifndef SHASTA_FEATURE_HASHES_HPP
+#define SHASTA_FEATURE_HASHES_HPP
+
+#include "shastaTypes.hpp"
+
+namespace shasta {
+
+    // Compute the hashes of the features of an oriented read,
+    // as used by LowHash0, LowHash1, and LowHash2.
+    // Feature i consists of the m k-mer ids kmerIds[i, i+m),
+    // and its hash is MurmurHash64A(kmerIds + i, m * sizeof(KmerId), seed).
+    // Requires kmerCount >= m. The hashes of the kmerCount - m + 1 features
+    // are stored in hashes, which must have room for them.
+    // This is a runtime dispatched kernel (see cpuDispatch.hpp).
+    void computeFeatureHashes(
+        const KmerId* kmerIds,
+        uint64_t kmerCount,
+        uint64_t m,
+        uint64_t seed,
+        uint64_t* hashes);
+
+    void testFeatureHashes();
+}
+
+#endif
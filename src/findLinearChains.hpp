@@ -3,10 +3,16 @@
 
 // Find linear chains in a directed graph
 
+// Shasta.
+#include "SHASTA_ASSERT.hpp"
+
 // Boost libraries.
 #include <boost/graph/adjacency_list.hpp>
 #include <boost/graph/iteration_macros.hpp>
+
+// Standard library.
 #include <list>
+#include <set>
 #include "vector.hpp"
 
 namespace shasta {
@@ -34,22 +40,108 @@ namespace shasta {
 
 
 // Version that uses vectors.
+// It generates the same chains, in the same order, as the version that uses lists.
 template<class Graph> void shasta::findLinearChains(
     const Graph& graph,
     uint64_t minimumLength,
-    vector< vector<typename Graph::edge_descriptor> >& chainVectors)
+    vector< vector<typename Graph::edge_descriptor> >& chains)
 {
+    using vertex_descriptor = typename Graph::vertex_descriptor;
     using edge_descriptor = typename Graph::edge_descriptor;
 
-    // Call the version that uses lists.
-    vector< std::list<edge_descriptor> > chains;
-    findLinearChains(graph, minimumLength, chains);
+    // The edges we have already encountered.
+    std::set<edge_descriptor> edgesFound;
+
+    // The edges found when extending backward, in reverse order.
+    vector<edge_descriptor> backwardEdges;
+
+    chains.clear();
+
+    // Consider all possible start edges for the chain.
+    BGL_FORALL_EDGES_T(eStart, graph, Graph) {
+
+        // If we already assigned this edge to a chain, skip it.
+        if(edgesFound.find(eStart) != edgesFound.end()) {
+            continue;
+        }
+        edgesFound.insert(eStart);
+
+        // Extend backward first, so the chain can be
+        // constructed in order without inserting at the front.
+        bool isCircular = false;
+        backwardEdges.clear();
+        edge_descriptor e = eStart;
+        while(true) {
+            const vertex_descriptor v = source(e, graph);
+            if(in_degree(v, graph) != 1) {
+                break;
+            }
+            if(out_degree(v, graph) != 1) {
+                break;
+            }
+            BGL_FORALL_INEDGES_T(v, ePrevious, graph, Graph) {
+                e = ePrevious;
+                break;
+            }
+            if(e == eStart) {
+                isCircular = true;
+                break;
+            }
+            backwardEdges.push_back(e);
+            SHASTA_ASSERT(edgesFound.find(e) == edgesFound.end());
+            edgesFound.insert(e);
+        }
+
+        chains.resize(chains.size() + 1);
+        vector<edge_descriptor>& chain = chains.back();
+        if(isCircular) {
+
+            // The backward extension already found all the edges.
+            // Store them in forward order starting at eStart,
+            // for consistency with the version that uses lists.
+            chain.push_back(eStart);
+            chain.insert(chain.end(), backwardEdges.rbegin(), backwardEdges.rend());
+
+        } else {
+
+            // The chain consists of the backward edges,
+            // followed by the start edge, followed by the forward edges.
+            chain.assign(backwardEdges.rbegin(), backwardEdges.rend());
+            chain.push_back(eStart);
+
+            // Extend forward.
+            edge_descriptor e = eStart;
+            while(true) {
+                const vertex_descriptor v = target(e, graph);
+                if(in_degree(v, graph) != 1) {
+                    break;
+                }
+                if(out_degree(v, graph) != 1) {
+                    break;
+                }
+                BGL_FORALL_OUTEDGES_T(v, eNext, graph, Graph) {
+                    e = eNext;
+                    break;
+                }
+                chain.push_back(e);
+                SHASTA_ASSERT(edgesFound.find(e) == edgesFound.end());
+                edgesFound.insert(e);
+            }
+        }
+
+        // If the chain is too short, get rid of it.
+        if(chain.size() < minimumLength) {
+            chains.resize(chains.size() - 1);
+        }
+    }
 
-    // Copy the lists to vectors.
-    chainVectors.clear();
-    for(const auto& chain: chains) {
-        chainVectors.push_back(vector<edge_descriptor>(chain.begin(), chain.end()));
+    // Check that all edges were found.
+    // Just using num_edges does not work if the graph is a filtered_graph.
+    uint64_t edgeCount = 0;
+    BGL_FORALL_EDGES_T(e, graph, Graph) {
+        ++edgeCount;
     }
+    SHASTA_ASSERT(edgesFound.size() == edgeCount);
 }
 
 
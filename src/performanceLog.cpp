@@ -2,9 +2,15 @@
 // for performance analysis but mostly uninteresting to users.
 
 #include "performanceLog.hpp"
+#include "platformDependent.hpp"
+
+#include "chrono.hpp"
 
 namespace shasta {
     ofstream performanceLog;
+
+    ofstream phaseLog;
+    steady_clock::time_point phaseLogTime;
 }
 
 
@@ -13,3 +19,44 @@ void shasta::openPerformanceLog(const string& fileName)
 {
     performanceLog.open(fileName);
 }
+
+
+
+void shasta::openPhaseLog(const string& fileName)
+{
+    phaseLog.open(fileName);
+    phaseLog << "Phase,ElapsedSeconds,PeakMemoryBytes,ThreadCount,ReadCount,BaseCount,ItemCount\n";
+    phaseLog.flush();
+    phaseLogTime = steady_clock::now();
+}
+
+
+
+// Write a line for a phase that just ended.
+// The elapsed time is measured from the end of the previous phase.
+// The meaning of itemCount depends on the phase
+// (markers, alignment candidates, alignments, and so on).
+void shasta::logPhase(
+    const string& phaseName,
+    uint64_t threadCount,
+    uint64_t readCount,
+    uint64_t baseCount,
+    uint64_t itemCount)
+{
+    if(not phaseLog.is_open()) {
+        return;
+    }
+    const auto t = steady_clock::now();
+    const double elapsedSeconds = seconds(t - phaseLogTime);
+    phaseLogTime = t;
+
+    phaseLog <<
+        phaseName << "," <<
+        elapsedSeconds << "," <<
+        getPeakMemoryUsage() << "," <<
+        threadCount << "," <<
+        readCount << "," <<
+        baseCount << "," <<
+        itemCount << "\n";
+    phaseLog.flush();
+}
@@ -1,15 +1,30 @@
 #ifndef SHASTA_PERFORMANCE_LOG_HPP
 #define SHASTA_PERFORMANCE_LOG_HPP
 
+#include "cstdint.hpp"
 #include "fstream.hpp"
 #include "string.hpp"
 
 // The performance log is used to write messages that are useful
 // for performance analysis but mostly uninteresting to users.
 
+// The phase log is a structured companion to the performance log.
+// It contains one csv line for each phase of an assembly, with
+// elapsed time, peak memory so far, and the amount of data processed.
+// It is used by --command estimateResources to calibrate
+// its estimates using past assemblies.
+
 namespace shasta {
     extern ofstream performanceLog;
     void openPerformanceLog(const string& fileName);
+
+    void openPhaseLog(const string& fileName);
+    void logPhase(
+        const string& phaseName,
+        uint64_t threadCount,
+        uint64_t readCount,
+        uint64_t baseCount,
+        uint64_t itemCount);
 }
 
 
@@ -5,7 +5,13 @@
 
 namespace shasta {
 
+    // Builds with long k-mers (SHASTA_LONG_KMERS) use a 64-bit KmerId,
+    // which allows k up to 32. See Kmer.hpp.
+#ifdef SHASTA_LONG_KMERS
+    using KmerId = uint64_t;
+#else
     using KmerId = uint32_t;
+#endif
 
     using ReadId = uint32_t;
     using Strand = ReadId;
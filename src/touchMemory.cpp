@@ -1,12 +1,16 @@
 
 
 #include "touchMemory.hpp"
+#include "cpuDispatch.hpp"
 using namespace shasta;
 
 // Touch a range of memory in order to cause the
 // supporting pages of virtual memory to be loaded in real memory.
 // The return value can be ignored.
-size_t shasta::touchMemory(
+// This is a runtime dispatched kernel (see cpuDispatch.hpp).
+// Its running time is dominated by page faults and memory latency
+// (one load per page), so the version used makes little difference.
+SHASTA_CPU_DISPATCH size_t shasta::touchMemory(
     const void* begin,
     const void* end,
     size_t pageSize)
@@ -10,10 +10,12 @@
 #include "AssemblyGraph.hpp"
 #include "buildId.hpp"
 #include "ConfigurationTable.hpp"
+#include "cpuDispatch.hpp"
 #include "Coverage.hpp"
 #include "filesystem.hpp"
 #include "performanceLog.hpp"
 #include "Reads.hpp"
+#include "ResourceEstimator.hpp"
 #include "Tee.hpp"
 #include "timestamp.hpp"
 #include "platformDependent.hpp"
@@ -55,6 +57,13 @@ namespace shasta {
         void setupHugePages();
         void segmentFaultHandler(int);
 
+        // Write a line to the phase log (PerformancePhases.csv).
+        void endPhase(
+            const Assembler&,
+            const string& phaseName,
+            uint32_t threadCount,
+            uint64_t itemCount);
+
         // Functions that implement --command keywords
         void assemble(const AssemblerOptions&, int argumentCount, const char** arguments);
         void saveBinaryData(const AssemblerOptions&);
@@ -64,11 +73,13 @@ namespace shasta {
         void listConfigurations();
         void listConfiguration(const AssemblerOptions&);
         void explore(const AssemblerOptions&);
+        void estimateResources(const AssemblerOptions&);
 
         const std::set<string> commands = {
             "assemble",
             "cleanupBinaryData",
             "createBashCompletionScript",
+            "estimateResources",
             "explore",
             "listCommands",
             "listConfiguration",
@@ -174,6 +185,9 @@ void shasta::main::main(int argumentCount, const char** arguments)
     } else if(assemblerOptions.commandLineOnlyOptions.command == "explore") {
         explore(assemblerOptions);
         return;
+    } else if(assemblerOptions.commandLineOnlyOptions.command == "estimateResources") {
+        estimateResources(assemblerOptions);
+        return;
     } else if(assemblerOptions.commandLineOnlyOptions.command == "createBashCompletionScript") {
         createBashCompletionScript(assemblerOptions);
         return;
@@ -229,10 +243,11 @@ void shasta::main::assemble(
 
     // Check assemblerOptions.minHashOptions.version.
     if( assemblerOptions.minHashOptions.version!=0 and
-        assemblerOptions.minHashOptions.version!=1) {
+        assemblerOptions.minHashOptions.version!=1 and
+        assemblerOptions.minHashOptions.version!=2) {
         throw runtime_error("Invalid value " +
             to_string(assemblerOptions.minHashOptions.version) +
-            " specified for --MinHash.version. Must be 0 or 1.");
+            " specified for --MinHash.version. Must be 0, 1, or 2.");
     }
 
     // Check assemblerOptions.minHashOptions minimum/maximum bucket size.
@@ -247,6 +262,15 @@ void shasta::main::assemble(
             );
     }
 
+    // Check assemblerOptions.minHashOptions.maxDrift.
+    // It is only used with --MinHash.version 2.
+    if( assemblerOptions.minHashOptions.version == 2 and
+        assemblerOptions.minHashOptions.maxDrift < 0) {
+        throw runtime_error("Invalid value " +
+            to_string(assemblerOptions.minHashOptions.maxDrift) +
+            " specified for --MinHash.maxDrift. Must not be negative.");
+    }
+
     // If coverage data was requested, memoryMode should be filesystem,
     // otherwise the coverage data cannot be accessed.
     if(assemblerOptions.assemblyOptions.storeCoverageData) {
@@ -263,6 +287,12 @@ void shasta::main::assemble(
             " is not valid. Valid options are 0, 1, 3, and 4.");
     }
 
+    if(not assemblerOptions.alignOptions.shard.empty()) {
+        throw runtime_error("--Align.shard is not supported by --command assemble. "
+            "Use Python scripts ComputeAlignmentShard.py and MergeAlignmentShards.py "
+            "to compute alignments in shards.");
+    }
+
     if(assemblerOptions.readGraphOptions.creationMethod != 0 and
         assemblerOptions.readGraphOptions.creationMethod != 2) {
         throw runtime_error("--ReadGraph.creationMethod " +
@@ -285,6 +315,13 @@ void shasta::main::assemble(
         throw runtime_error("--Assembly.mode 2 requires --ReadGraph.strandSeparationMethod 2.");
     }
 
+    // Read placements are only available for assembly mode 0.
+    if(assemblerOptions.assemblyOptions.writeReadPlacements and
+        assemblerOptions.assemblyOptions.mode != 0) {
+        throw runtime_error("--Assembly.writeReadPlacements is only supported "
+            "with --Assembly.mode 0.");
+    }
+
     // Find absolute paths of the input files.
     // We will use them below after changing directory to the output directory.
     vector<string> inputFileAbsolutePaths;
@@ -343,6 +380,10 @@ void shasta::main::assemble(
     }
     cout << endl;
 
+    // Log the version of the hot kernels selected for this CPU.
+    writeCpuDispatchInformation(cout);
+    writeCpuDispatchInformation(performanceLog);
+
 
 
     // Set up the run directory as required by the memoryMode and memoryBacking options.
@@ -521,6 +562,7 @@ void shasta::main::assemble(
     const auto steadyClock0 = std::chrono::steady_clock::now();
     const auto userClock0 = boost::chrono::process_user_cpu_clock::now();
     const auto systemClock0 = boost::chrono::process_system_cpu_clock::now();
+    openPhaseLog("PerformancePhases.csv");
 
     // Adjust the number of threads, if necessary.
     uint32_t threadCount = assemblerOptions.commandLineOnlyOptions.threadCount;
@@ -587,6 +629,7 @@ void shasta::main::assemble(
     const auto t1 = steady_clock::now();
     performanceLog << timestamp << "Done loading reads from " << inputFileNames.size() << " files." << endl;
     performanceLog << "Read loading took " << seconds(t1-t0) << "s." << endl;
+    endPhase(assembler, "LoadReads", threadCount, assembler.getReads().readCount());
 
 
 
@@ -643,6 +686,7 @@ void shasta::main::assemble(
         throw runtime_error("Invalid --Kmers generationMethod. "
             "Specify a value between 0 and 4, inclusive.");
     }
+    endPhase(assembler, "Kmers", threadCount, 0);
 
 
 
@@ -662,6 +706,7 @@ void shasta::main::assemble(
             assemblerOptions.readsOptions.palindromicReads.deltaThreshold,
             threadCount);
     }
+    endPhase(assembler, "Markers", threadCount, assembler.getCompressedMarkers().totalSize());
 
 
 
@@ -679,8 +724,7 @@ void shasta::main::assemble(
             assemblerOptions.minHashOptions.maxBucketSize,
             assemblerOptions.minHashOptions.minFrequency,
             threadCount);
-    } else {
-        SHASTA_ASSERT(assemblerOptions.minHashOptions.version == 1);    // Already checked for that.
+    } else if(assemblerOptions.minHashOptions.version == 1) {
         assembler.findAlignmentCandidatesLowHash1(
             assemblerOptions.minHashOptions.m,
             assemblerOptions.minHashOptions.hashFraction,
@@ -690,6 +734,16 @@ void shasta::main::assemble(
             assemblerOptions.minHashOptions.maxBucketSize,
             assemblerOptions.minHashOptions.minFrequency,
             threadCount);
+    } else {
+        SHASTA_ASSERT(assemblerOptions.minHashOptions.version == 2);    // Already checked for that.
+        assembler.findAlignmentCandidatesLowHash2(
+            assemblerOptions.minHashOptions.m,
+            assemblerOptions.minHashOptions.hashFraction,
+            assemblerOptions.minHashOptions.minBucketSize,
+            assemblerOptions.minHashOptions.maxBucketSize,
+            assemblerOptions.minHashOptions.minFrequency,
+            assemblerOptions.minHashOptions.maxDrift,
+            threadCount);
     }
 
 
@@ -703,13 +757,15 @@ void shasta::main::assemble(
 
 
     // For http server and debugging/development purposes, generate an exhaustive table of candidates
-    assembler.computeCandidateTable();
+    assembler.computeCandidateTable(threadCount);
+    endPhase(assembler, "AlignmentCandidates", threadCount, assembler.getAlignmentCandidateCount());
 
 
     // Compute alignments.
     assembler.computeAlignments(
         assemblerOptions.alignOptions,
         threadCount);
+    endPhase(assembler, "Alignments", threadCount, assembler.getAlignmentData().size());
 
 
 
@@ -773,6 +829,7 @@ void shasta::main::assemble(
     if(assemblerOptions.readGraphOptions.strandSeparationMethod != 2) {
         assembler.computeReadGraphConnectedComponents();
     }
+    endPhase(assembler, "ReadGraph", threadCount, assembler.getReadGraph().edges.size());
 
 
 
@@ -793,6 +850,7 @@ void shasta::main::assemble(
             to_string(assemblerOptions.assemblyOptions.mode) +
             " was specified.");
     }
+    endPhase(assembler, "Assembly", threadCount, 0);
 
 
     // Store elapsed time for assembly.
@@ -842,6 +900,21 @@ void shasta::main::assemble(
 
 
 
+// Write a line to the phase log (PerformancePhases.csv).
+// This is used by --command estimateResources
+// to calibrate its estimates.
+void shasta::main::endPhase(
+    const Assembler& assembler,
+    const string& phaseName,
+    uint32_t threadCount,
+    uint64_t itemCount)
+{
+    const Reads& reads = assembler.getReads();
+    logPhase(phaseName, threadCount, reads.readCount(), reads.getTotalBaseCount(), itemCount);
+}
+
+
+
 void shasta::main::mode0Assembly(
     Assembler& assembler,
     const AssemblerOptions& assemblerOptions,
@@ -850,6 +923,14 @@ void shasta::main::mode0Assembly(
 
     // Iterative assembly, if requested (experimental).
     if(assemblerOptions.assemblyOptions.iterative) {
+
+        // If requested, the marker graph disjoint sets are computed incrementally,
+        // starting from the ones computed during the previous iteration.
+        if(assemblerOptions.assemblyOptions.iterativeIncrementalMarkerGraph) {
+            assembler.enableIncrementalMarkerGraphVertices(
+                assemblerOptions.assemblyOptions.iterativeVerifyIncrementalMarkerGraph);
+        }
+
         for(uint64_t iteration=0;
             iteration<assemblerOptions.assemblyOptions.iterativeIterationCount;
             iteration++) {
@@ -907,6 +988,18 @@ void shasta::main::mode0Assembly(
 
 
 
+    // If requested, estimate the marker graph coverage histogram
+    // and the automatic value of minCoverage using a sample of reads.
+    // This is compared with the exact values computed below.
+    if(assemblerOptions.markerGraphOptions.coverageEstimateSampleReadCount > 0) {
+        assembler.estimateMarkerGraphCoverageHistogram(
+            assemblerOptions.markerGraphOptions.coverageEstimateSampleReadCount,
+            assemblerOptions.markerGraphOptions.maxCoverage,
+            assemblerOptions.markerGraphOptions.peakFinderMinAreaFraction,
+            assemblerOptions.markerGraphOptions.peakFinderAreaStartIndex,
+            threadCount);
+    }
+
     // Create marker graph vertices.
     // This uses a disjoint sets data structure to merge markers
     // that are aligned based on an alignment present in the read graph.
@@ -918,6 +1011,10 @@ void shasta::main::mode0Assembly(
         assemblerOptions.markerGraphOptions.peakFinderMinAreaFraction,
         assemblerOptions.markerGraphOptions.peakFinderAreaStartIndex,
         threadCount);
+    if(assemblerOptions.assemblyOptions.iterative and
+        assemblerOptions.assemblyOptions.iterativeIncrementalMarkerGraph) {
+        assembler.disableIncrementalMarkerGraphVertices();
+    }
 
     // Find the reverse complement of each marker graph vertex.
     assembler.findMarkerGraphReverseComplementVertices(threadCount);
@@ -1004,6 +1101,8 @@ void shasta::main::mode0Assembly(
         assembler.createAssemblyGraphVertices();
     }
 
+    endPhase(assembler, "MarkerGraph", threadCount, assembler.markerGraph.vertexCount());
+
     // Compute optimal repeat counts for each vertex of the marker graph.
     if(assemblerOptions.readsOptions.representation == 1) {
         assembler.assembleMarkerGraphVertices(threadCount);
@@ -1042,6 +1141,11 @@ void shasta::main::mode0Assembly(
         assembler.gatherOrientedReadsByAssemblyGraphEdge(threadCount);
         assembler.writeOrientedReadsByAssemblyGraphEdge();
     }
+
+    // If requested, write placements of reads on assembled segments.
+    if(assemblerOptions.assemblyOptions.writeReadPlacements) {
+        assembler.writeReadPlacements("ReadPlacements.paf", threadCount);
+    }
 }
 
 
@@ -1085,6 +1189,8 @@ void shasta::main::mode2Assembly(
     // Coverage histograms for vertices and edges of the marker graph.
     assembler.computeMarkerGraphCoverageHistogram();
 
+    endPhase(assembler, "MarkerGraph", threadCount, assembler.markerGraph.vertexCount());
+
     // Compute optimal repeat counts for each vertex of the marker graph.
     if(assemblerOptions.readsOptions.representation == 1) {
         assembler.assembleMarkerGraphVertices(threadCount);
@@ -1145,6 +1251,8 @@ void shasta::main::mode3Assembly(
     // Coverage histograms for vertices and edges of the marker graph.
     assembler.computeMarkerGraphCoverageHistogram();
 
+    endPhase(assembler, "MarkerGraph", threadCount, assembler.markerGraph.vertexCount());
+
     // Compute optimal repeat counts for each vertex of the marker graph.
     if(assemblerOptions.readsOptions.representation == 1) {
         assembler.assembleMarkerGraphVertices(threadCount);
@@ -1328,6 +1436,9 @@ void shasta::main::explore(
     // Access all available binary data.
     assembler.accessAllSoft();
 
+    // Log the version of the hot kernels selected for this CPU.
+    writeCpuDispatchInformation(cout);
+
     string executablePath = filesystem::executablePath();
     // On Linux it will be something like - `/path/to/install_root/bin/shasta`
 
@@ -1347,6 +1458,11 @@ void shasta::main::explore(
         assembler.loadAlignmentsPafFile(alignmentsPafFileAbsolutePath);
     }
 
+    // Set up the http response cache.
+    assembler.setupHttpResponseCache(
+        assemblerOptions.commandLineOnlyOptions.exploreCacheSize * 1024 * 1024,
+        assemblerOptions.commandLineOnlyOptions.exploreCacheDirectory);
+
     // Start the http server.
     assembler.httpServerData.assemblerOptions = &assemblerOptions;
     bool localOnly;
@@ -1373,6 +1489,36 @@ void shasta::main::explore(
 
 
 
+// Implementation of --command estimateResources.
+// This estimates peak memory, size of binary data, and elapsed time
+// for an assembly with the specified input files and options,
+// without running it. See ResourceEstimator.hpp for more information.
+void shasta::main::estimateResources(const AssemblerOptions& assemblerOptions)
+{
+    SHASTA_ASSERT(assemblerOptions.commandLineOnlyOptions.command == "estimateResources");
+
+    // Check that we have at least one input file.
+    if(assemblerOptions.commandLineOnlyOptions.inputFileNames.empty()) {
+        throw runtime_error("Specify at least one input file "
+            "using command line option \"--input\".");
+    }
+
+    // Adjust the number of threads, if necessary.
+    uint32_t threadCount = assemblerOptions.commandLineOnlyOptions.threadCount;
+    if(threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+
+    const ResourceEstimator resourceEstimator(assemblerOptions, threadCount);
+    resourceEstimator.write(cout);
+
+    const uint64_t totalMemory = getTotalPhysicalMemory();
+    cout << "Total physical memory on this machine: " <<
+        std::round(double(totalMemory) / (1024. * 1024. * 1024.)) << " GiB" << endl;
+}
+
+
+
 // This creates a bash completion script for the Shasta executable,
 // which makes it easier to type long option names.
 // To use it: